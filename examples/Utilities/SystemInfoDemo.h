@@ -158,6 +158,7 @@ static String getAllSystemInfo()
       << "CPU has 3DNOW:           " << (SystemStats::has3DNow()           ? "yes" : "no") << newLine
       << "CPU has AVX:             " << (SystemStats::hasAVX()             ? "yes" : "no") << newLine
       << "CPU has AVX2:            " << (SystemStats::hasAVX2()            ? "yes" : "no") << newLine
+      << "CPU has FMA3:            " << (SystemStats::hasFMA3()            ? "yes" : "no") << newLine
       << "CPU has AVX512F:         " << (SystemStats::hasAVX512F()         ? "yes" : "no") << newLine
       << "CPU has AVX512BW:        " << (SystemStats::hasAVX512BW()        ? "yes" : "no") << newLine
       << "CPU has AVX512CD:        " << (SystemStats::hasAVX512CD()        ? "yes" : "no") << newLine
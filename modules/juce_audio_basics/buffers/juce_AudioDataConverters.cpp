@@ -23,19 +23,350 @@
 namespace juce
 {
 
-void AudioDataConverters::convertFloatToInt16LE (const float* source, void* dest, int numSamples, int destBytesPerSample)
+namespace VectorisedConversionHelpers
 {
-    auto maxVal = (double) 0x7fff;
-    auto intData = static_cast<char*> (dest);
+    template <int bytesPerSample, bool bigEndian> struct IntSample;
 
-    if (dest != (void*) source || destBytesPerSample <= 4)
+    template <bool bigEndian>
+    struct IntSample<2, bigEndian>
     {
-        for (int i = 0; i < numSamples; ++i)
+        static forcedinline int32 read (const char* p) noexcept
         {
-            *reinterpret_cast<uint16*> (intData) = ByteOrder::swapIfBigEndian ((uint16) (short) roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])));
-            intData += destBytesPerSample;
+            return (int16) (bigEndian ? ByteOrder::bigEndianShort (p) : ByteOrder::littleEndianShort (p));
+        }
+
+        static forcedinline void write (char* p, int32 v) noexcept
+        {
+            *reinterpret_cast<uint16*> (p) = bigEndian ? ByteOrder::swapIfLittleEndian ((uint16) v)
+                                                      : ByteOrder::swapIfBigEndian ((uint16) v);
+        }
+    };
+
+    template <bool bigEndian>
+    struct IntSample<3, bigEndian>
+    {
+        static forcedinline int32 read (const char* p) noexcept
+        {
+            return bigEndian ? ByteOrder::bigEndian24Bit (p) : ByteOrder::littleEndian24Bit (p);
+        }
+
+        static forcedinline void write (char* p, int32 v) noexcept
+        {
+            if (bigEndian)
+                ByteOrder::bigEndian24BitToChars (v, p);
+            else
+                ByteOrder::littleEndian24BitToChars (v, p);
+        }
+    };
+
+    template <bool bigEndian>
+    struct IntSample<4, bigEndian>
+    {
+        static forcedinline int32 read (const char* p) noexcept
+        {
+            return (int32) (bigEndian ? ByteOrder::bigEndianInt (p) : ByteOrder::littleEndianInt (p));
+        }
+
+        static forcedinline void write (char* p, int32 v) noexcept
+        {
+            *reinterpret_cast<uint32*> (p) = bigEndian ? ByteOrder::swapIfLittleEndian ((uint32) v)
+                                                      : ByteOrder::swapIfBigEndian ((uint32) v);
+        }
+    };
+
+   #if JUCE_USE_SSE_INTRINSICS
+    using IntVector = __m128i;
+
+    static forcedinline __m128i swapBytesIn16BitWords (__m128i v) noexcept
+    {
+        return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+    }
+
+    // Reads 4 samples into the lanes of a vector, using whole-vector loads when the samples are contiguous
+    template <int bytesPerSample, bool bigEndian>
+    static forcedinline __m128i readFour (const char* p, int stride) noexcept
+    {
+        using Sample = IntSample<bytesPerSample, bigEndian>;
+
+        if (bytesPerSample == 2 && stride == 2)
+        {
+            auto v = _mm_loadl_epi64 (reinterpret_cast<const __m128i*> (p));
+
+            if (bigEndian != (bool) AudioData::NativeEndian::isBigEndian)
+                v = swapBytesIn16BitWords (v);
+
+            return _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16);
+        }
+
+        if (bytesPerSample == 4 && stride == 4)
+        {
+            auto v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (p));
+
+            if (bigEndian != (bool) AudioData::NativeEndian::isBigEndian)
+                v = swapBytesIn16BitWords (_mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, 0xb1), 0xb1));
+
+            return v;
+        }
+
+        return _mm_setr_epi32 (Sample::read (p), Sample::read (p + stride),
+                               Sample::read (p + 2 * stride), Sample::read (p + 3 * stride));
+    }
+
+    static forcedinline void toFloat (float* dest, __m128i ints, float scale) noexcept
+    {
+        _mm_storeu_ps (dest, _mm_mul_ps (_mm_cvtepi32_ps (ints), _mm_set1_ps (scale)));
+    }
+
+    static forcedinline __m128i toInt (const float* source, double scale, double limit, int shift) noexcept
+    {
+        auto s = _mm_loadu_ps (source);
+        auto lo = _mm_mul_pd (_mm_cvtps_pd (s), _mm_set1_pd (scale));
+        auto hi = _mm_mul_pd (_mm_cvtps_pd (_mm_movehl_ps (s, s)), _mm_set1_pd (scale));
+
+        auto upper = _mm_set1_pd (limit), lower = _mm_set1_pd (-limit);
+        lo = _mm_max_pd (lower, _mm_min_pd (upper, lo));
+        hi = _mm_max_pd (lower, _mm_min_pd (upper, hi));
+
+        auto ints = _mm_unpacklo_epi64 (_mm_cvtpd_epi32 (lo), _mm_cvtpd_epi32 (hi));
+        return _mm_sra_epi32 (ints, _mm_cvtsi32_si128 (shift));
+    }
+
+    template <int bytesPerSample, bool bigEndian>
+    static forcedinline void writeFour (char* p, int stride, __m128i v) noexcept
+    {
+        if (bytesPerSample == 2 && stride == 2 && bigEndian == (bool) AudioData::NativeEndian::isBigEndian)
+        {
+            _mm_storel_epi64 (reinterpret_cast<__m128i*> (p), _mm_packs_epi32 (v, v));
+            return;
+        }
+
+        if (bytesPerSample == 4 && stride == 4 && bigEndian == (bool) AudioData::NativeEndian::isBigEndian)
+        {
+            _mm_storeu_si128 (reinterpret_cast<__m128i*> (p), v);
+            return;
+        }
+
+        alignas (16) int32 lanes[4];
+        _mm_store_si128 (reinterpret_cast<__m128i*> (lanes), v);
+
+        for (int i = 0; i < 4; ++i)
+            IntSample<bytesPerSample, bigEndian>::write (p + i * stride, lanes[i]);
+    }
+
+    #define JUCE_VECTORISED_INT_TO_FLOAT 1
+    #define JUCE_VECTORISED_FLOAT_TO_INT 1
+
+   #elif JUCE_USE_ARM_NEON
+    using IntVector = int32x4_t;
+
+    template <int bytesPerSample, bool bigEndian>
+    static forcedinline int32x4_t readFour (const char* p, int stride) noexcept
+    {
+        using Sample = IntSample<bytesPerSample, bigEndian>;
+
+        if (bytesPerSample == 2 && stride == 2)
+        {
+            auto v = vld1_s16 (reinterpret_cast<const int16_t*> (p));
+
+            if (bigEndian != (bool) AudioData::NativeEndian::isBigEndian)
+                v = vreinterpret_s16_s8 (vrev16_s8 (vreinterpret_s8_s16 (v)));
+
+            return vmovl_s16 (v);
+        }
+
+        if (bytesPerSample == 4 && stride == 4)
+        {
+            auto v = vld1q_s32 (reinterpret_cast<const int32_t*> (p));
+
+            if (bigEndian != (bool) AudioData::NativeEndian::isBigEndian)
+                v = vreinterpretq_s32_s8 (vrev32q_s8 (vreinterpretq_s8_s32 (v)));
+
+            return v;
         }
+
+        const int32_t lanes[] = { Sample::read (p), Sample::read (p + stride),
+                                  Sample::read (p + 2 * stride), Sample::read (p + 3 * stride) };
+        return vld1q_s32 (lanes);
+    }
+
+    static forcedinline void toFloat (float* dest, int32x4_t ints, float scale) noexcept
+    {
+        vst1q_f32 (dest, vmulq_n_f32 (vcvtq_f32_s32 (ints), scale));
+    }
+
+    #define JUCE_VECTORISED_INT_TO_FLOAT 1
+
+    // rounding to the nearest integer in double precision needs AArch64
+    #if JUCE_64BIT
+     static forcedinline int32x4_t toInt (const float* source, double scale, double limit, int shift) noexcept
+     {
+         auto s = vld1q_f32 (source);
+         auto lo = vmulq_n_f64 (vcvt_f64_f32 (vget_low_f32 (s)), scale);
+         auto hi = vmulq_n_f64 (vcvt_high_f64_f32 (s), scale);
+
+         auto upper = vdupq_n_f64 (limit), lower = vdupq_n_f64 (-limit);
+         lo = vmaxq_f64 (lower, vminq_f64 (upper, lo));
+         hi = vmaxq_f64 (lower, vminq_f64 (upper, hi));
+
+         auto ints = vcombine_s32 (vmovn_s64 (vcvtnq_s64_f64 (lo)), vmovn_s64 (vcvtnq_s64_f64 (hi)));
+         return vshlq_s32 (ints, vdupq_n_s32 (-shift));
+     }
+
+     template <int bytesPerSample, bool bigEndian>
+     static forcedinline void writeFour (char* p, int stride, int32x4_t v) noexcept
+     {
+         if (bytesPerSample == 4 && stride == 4 && bigEndian == (bool) AudioData::NativeEndian::isBigEndian)
+         {
+             vst1q_s32 (reinterpret_cast<int32_t*> (p), v);
+             return;
+         }
+
+         if (bytesPerSample == 2 && stride == 2 && bigEndian == (bool) AudioData::NativeEndian::isBigEndian)
+         {
+             vst1_s16 (reinterpret_cast<int16_t*> (p), vmovn_s32 (v));
+             return;
+         }
+
+         int32_t lanes[4];
+         vst1q_s32 (lanes, v);
+
+         for (int i = 0; i < 4; ++i)
+             IntSample<bytesPerSample, bigEndian>::write (p + i * stride, lanes[i]);
+     }
+
+     #define JUCE_VECTORISED_FLOAT_TO_INT 1
+    #endif
+   #endif
+
+    //==============================================================================
+    template <int bytesPerSample, bool bigEndian>
+    static void convertIntToFloat (const char* source, int stride, float* dest, int numSamples, float scale) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_VECTORISED_INT_TO_FLOAT
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            toFloat (dest + i, readFour<bytesPerSample, bigEndian> (source, stride), scale);
+            source += 4 * stride;
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            dest[i] = scale * (float) IntSample<bytesPerSample, bigEndian>::read (source);
+            source += stride;
+        }
+    }
+
+    template <int bytesPerSample, bool bigEndian>
+    static void convertFloatToInt (const float* source, char* dest, int stride, int numSamples,
+                                   double scale, double limit, int shift) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_VECTORISED_FLOAT_TO_INT
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            writeFour<bytesPerSample, bigEndian> (dest, stride, toInt (source + i, scale, limit, shift));
+            dest += 4 * stride;
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            IntSample<bytesPerSample, bigEndian>::write (dest, roundToInt (jlimit (-limit, limit, scale * source[i])) >> shift);
+            dest += stride;
+        }
+    }
+
+    #undef JUCE_VECTORISED_INT_TO_FLOAT
+    #undef JUCE_VECTORISED_FLOAT_TO_INT
+}
+
+void AudioData::VectorisedConversion::intToFloat (IntFormat sourceFormat, bool sourceIsBigEndian, const void* source,
+                                                  int sourceBytesBetweenSamples, float* dest, int numSamples, float scale) noexcept
+{
+    using namespace VectorisedConversionHelpers;
+    auto src = static_cast<const char*> (source);
+    auto stride = sourceBytesBetweenSamples;
+
+    switch (sourceFormat)
+    {
+        case int16:
+            if (sourceIsBigEndian)
+                convertIntToFloat<2, true> (src, stride, dest, numSamples, scale);
+            else
+                convertIntToFloat<2, false> (src, stride, dest, numSamples, scale);
+            break;
+
+        case int24:
+            if (sourceIsBigEndian)
+                convertIntToFloat<3, true> (src, stride, dest, numSamples, scale);
+            else
+                convertIntToFloat<3, false> (src, stride, dest, numSamples, scale);
+            break;
+
+        case int32:
+            if (sourceIsBigEndian)
+                convertIntToFloat<4, true> (src, stride, dest, numSamples, scale);
+            else
+                convertIntToFloat<4, false> (src, stride, dest, numSamples, scale);
+            break;
+
+        case notAnIntFormat:
+        default:
+            jassertfalse;
+            break;
+    }
+}
+
+void AudioData::VectorisedConversion::floatToInt (IntFormat destFormat, bool destIsBigEndian, void* dest, int destBytesBetweenSamples,
+                                                  const float* source, int numSamples, double scale, double limit, int shift) noexcept
+{
+    using namespace VectorisedConversionHelpers;
+    auto dst = static_cast<char*> (dest);
+    auto stride = destBytesBetweenSamples;
+
+    switch (destFormat)
+    {
+        case int16:
+            if (destIsBigEndian)
+                convertFloatToInt<2, true> (source, dst, stride, numSamples, scale, limit, shift);
+            else
+                convertFloatToInt<2, false> (source, dst, stride, numSamples, scale, limit, shift);
+            break;
+
+        case int24:
+            if (destIsBigEndian)
+                convertFloatToInt<3, true> (source, dst, stride, numSamples, scale, limit, shift);
+            else
+                convertFloatToInt<3, false> (source, dst, stride, numSamples, scale, limit, shift);
+            break;
+
+        case int32:
+            if (destIsBigEndian)
+                convertFloatToInt<4, true> (source, dst, stride, numSamples, scale, limit, shift);
+            else
+                convertFloatToInt<4, false> (source, dst, stride, numSamples, scale, limit, shift);
+            break;
+
+        case notAnIntFormat:
+        default:
+            jassertfalse;
+            break;
     }
+}
+
+//==============================================================================
+void AudioDataConverters::convertFloatToInt16LE (const float* source, void* dest, int numSamples, int destBytesPerSample)
+{
+    auto maxVal = (double) 0x7fff;
+    auto intData = static_cast<char*> (dest);
+
+    if (dest != (void*) source || destBytesPerSample <= 4)
+        AudioData::VectorisedConversion::floatToInt (AudioData::VectorisedConversion::int16, false, dest, destBytesPerSample,
+                                                     source, numSamples, maxVal, maxVal, 0);
     else
     {
         intData += destBytesPerSample * numSamples;
@@ -54,13 +385,8 @@ void AudioDataConverters::convertFloatToInt16BE (const float* source, void* dest
     auto intData = static_cast<char*> (dest);
 
     if (dest != (void*) source || destBytesPerSample <= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            *reinterpret_cast<uint16*> (intData) = ByteOrder::swapIfLittleEndian ((uint16) (short) roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])));
-            intData += destBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::floatToInt (AudioData::VectorisedConversion::int16, true, dest, destBytesPerSample,
+                                                     source, numSamples, maxVal, maxVal, 0);
     else
     {
         intData += destBytesPerSample * numSamples;
@@ -79,13 +405,8 @@ void AudioDataConverters::convertFloatToInt24LE (const float* source, void* dest
     auto intData = static_cast<char*> (dest);
 
     if (dest != (void*) source || destBytesPerSample <= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            ByteOrder::littleEndian24BitToChars (roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])), intData);
-            intData += destBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::floatToInt (AudioData::VectorisedConversion::int24, false, dest, destBytesPerSample,
+                                                     source, numSamples, maxVal, maxVal, 0);
     else
     {
         intData += destBytesPerSample * numSamples;
@@ -104,13 +425,8 @@ void AudioDataConverters::convertFloatToInt24BE (const float* source, void* dest
     auto intData = static_cast<char*> (dest);
 
     if (dest != (void*) source || destBytesPerSample <= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            ByteOrder::bigEndian24BitToChars (roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])), intData);
-            intData += destBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::floatToInt (AudioData::VectorisedConversion::int24, true, dest, destBytesPerSample,
+                                                     source, numSamples, maxVal, maxVal, 0);
     else
     {
         intData += destBytesPerSample * numSamples;
@@ -129,13 +445,8 @@ void AudioDataConverters::convertFloatToInt32LE (const float* source, void* dest
     auto intData = static_cast<char*> (dest);
 
     if (dest != (void*) source || destBytesPerSample <= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            *reinterpret_cast<uint32*> (intData) = ByteOrder::swapIfBigEndian ((uint32) roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])));
-            intData += destBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::floatToInt (AudioData::VectorisedConversion::int32, false, dest, destBytesPerSample,
+                                                     source, numSamples, maxVal, maxVal, 0);
     else
     {
         intData += destBytesPerSample * numSamples;
@@ -154,13 +465,8 @@ void AudioDataConverters::convertFloatToInt32BE (const float* source, void* dest
     auto intData = static_cast<char*> (dest);
 
     if (dest != (void*) source || destBytesPerSample <= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            *reinterpret_cast<uint32*> (intData) = ByteOrder::swapIfLittleEndian ((uint32) roundToInt (jlimit (-maxVal, maxVal, maxVal * source[i])));
-            intData += destBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::floatToInt (AudioData::VectorisedConversion::int32, true, dest, destBytesPerSample,
+                                                     source, numSamples, maxVal, maxVal, 0);
     else
     {
         intData += destBytesPerSample * numSamples;
@@ -216,13 +522,8 @@ void AudioDataConverters::convertInt16LEToFloat (const void* source, float* dest
     auto intData = static_cast<const char*> (source);
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (short) ByteOrder::swapIfBigEndian (*reinterpret_cast<const uint16*> (intData));
-            intData += srcBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::intToFloat (AudioData::VectorisedConversion::int16, false, source, srcBytesPerSample,
+                                                     dest, numSamples, scale);
     else
     {
         intData += srcBytesPerSample * numSamples;
@@ -241,13 +542,8 @@ void AudioDataConverters::convertInt16BEToFloat (const void* source, float* dest
     auto intData = static_cast<const char*> (source);
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (short) ByteOrder::swapIfLittleEndian (*reinterpret_cast<const uint16*> (intData));
-            intData += srcBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::intToFloat (AudioData::VectorisedConversion::int16, true, source, srcBytesPerSample,
+                                                     dest, numSamples, scale);
     else
     {
         intData += srcBytesPerSample * numSamples;
@@ -266,13 +562,8 @@ void AudioDataConverters::convertInt24LEToFloat (const void* source, float* dest
     auto intData = static_cast<const char*> (source);
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (short) ByteOrder::littleEndian24Bit (intData);
-            intData += srcBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::intToFloat (AudioData::VectorisedConversion::int24, false, source, srcBytesPerSample,
+                                                     dest, numSamples, scale);
     else
     {
         intData += srcBytesPerSample * numSamples;
@@ -280,7 +571,7 @@ void AudioDataConverters::convertInt24LEToFloat (const void* source, float* dest
         for (int i = numSamples; --i >= 0;)
         {
             intData -= srcBytesPerSample;
-            dest[i] = scale * (short) ByteOrder::littleEndian24Bit (intData);
+            dest[i] = scale * (float) ByteOrder::littleEndian24Bit (intData);
         }
     }
 }
@@ -291,13 +582,8 @@ void AudioDataConverters::convertInt24BEToFloat (const void* source, float* dest
     auto intData = static_cast<const char*> (source);
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (short) ByteOrder::bigEndian24Bit (intData);
-            intData += srcBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::intToFloat (AudioData::VectorisedConversion::int24, true, source, srcBytesPerSample,
+                                                     dest, numSamples, scale);
     else
     {
         intData += srcBytesPerSample * numSamples;
@@ -305,7 +591,7 @@ void AudioDataConverters::convertInt24BEToFloat (const void* source, float* dest
         for (int i = numSamples; --i >= 0;)
         {
             intData -= srcBytesPerSample;
-            dest[i] = scale * (short) ByteOrder::bigEndian24Bit (intData);
+            dest[i] = scale * (float) ByteOrder::bigEndian24Bit (intData);
         }
     }
 }
@@ -316,13 +602,8 @@ void AudioDataConverters::convertInt32LEToFloat (const void* source, float* dest
     auto intData = static_cast<const char*> (source);
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (int) ByteOrder::swapIfBigEndian (*reinterpret_cast<const uint32*> (intData));
-            intData += srcBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::intToFloat (AudioData::VectorisedConversion::int32, false, source, srcBytesPerSample,
+                                                     dest, numSamples, scale);
     else
     {
         intData += srcBytesPerSample * numSamples;
@@ -341,13 +622,8 @@ void AudioDataConverters::convertInt32BEToFloat (const void* source, float* dest
     auto intData = static_cast<const char*> (source);
 
     if (source != (void*) dest || srcBytesPerSample >= 4)
-    {
-        for (int i = 0; i < numSamples; ++i)
-        {
-            dest[i] = scale * (int) ByteOrder::swapIfLittleEndian (*reinterpret_cast<const uint32*> (intData));
-            intData += srcBytesPerSample;
-        }
-    }
+        AudioData::VectorisedConversion::intToFloat (AudioData::VectorisedConversion::int32, true, source, srcBytesPerSample,
+                                                     dest, numSamples, scale);
     else
     {
         intData += srcBytesPerSample * numSamples;
@@ -431,6 +707,33 @@ void AudioDataConverters::convertFormatToFloat (DataFormat sourceFormat, const v
 //==============================================================================
 void AudioDataConverters::interleaveSamples (const float** source, float* dest, int numSamples, int numChannels)
 {
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    if (numChannels == 2)
+    {
+        auto left = source[0], right = source[1];
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+           #if JUCE_USE_SSE_INTRINSICS
+            auto l = _mm_loadu_ps (left + i), r = _mm_loadu_ps (right + i);
+            _mm_storeu_ps (dest + 2 * i,     _mm_unpacklo_ps (l, r));
+            _mm_storeu_ps (dest + 2 * i + 4, _mm_unpackhi_ps (l, r));
+           #else
+            vst2q_f32 (dest + 2 * i, float32x4x2_t { { vld1q_f32 (left + i), vld1q_f32 (right + i) } });
+           #endif
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            dest[2 * i]     = left[i];
+            dest[2 * i + 1] = right[i];
+        }
+
+        return;
+    }
+   #endif
+
     for (int chan = 0; chan < numChannels; ++chan)
     {
         auto i = chan;
@@ -446,6 +749,35 @@ void AudioDataConverters::interleaveSamples (const float** source, float* dest,
 
 void AudioDataConverters::deinterleaveSamples (const float* source, float** dest, int numSamples, int numChannels)
 {
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    if (numChannels == 2)
+    {
+        auto left = dest[0], right = dest[1];
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+           #if JUCE_USE_SSE_INTRINSICS
+            auto a = _mm_loadu_ps (source + 2 * i), b = _mm_loadu_ps (source + 2 * i + 4);
+            _mm_storeu_ps (left + i,  _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+            _mm_storeu_ps (right + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)));
+           #else
+            auto v = vld2q_f32 (source + 2 * i);
+            vst1q_f32 (left + i, v.val[0]);
+            vst1q_f32 (right + i, v.val[1]);
+           #endif
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            left[i]  = source[2 * i];
+            right[i] = source[2 * i + 1];
+        }
+
+        return;
+    }
+   #endif
+
     for (int chan = 0; chan < numChannels; ++chan)
     {
         auto i = chan;
@@ -534,6 +866,53 @@ public:
         }
     };
 
+    // Checks the vectorised paths of convertSamples() against converting one sample at a time
+    template <class IntFormat, class IntEndianness>
+    struct VectorisedTest
+    {
+        using FloatPointer = AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>;
+        using IntPointer   = AudioData::Pointer<IntFormat, IntEndianness, AudioData::Interleaved, AudioData::NonConst>;
+
+        static void test (UnitTest& unitTest, Random& r)
+        {
+            const int numSamples = 203, numChannels = 3;
+            HeapBlock<float> floats (numSamples), expectedFloats (numSamples);
+            HeapBlock<char> ints ((size_t) (numSamples * numChannels * 4), true), expectedInts ((size_t) (numSamples * numChannels * 4), true);
+
+            for (int i = 0; i < numSamples; ++i)
+                floats[i] = r.nextFloat() * 2.4f - 1.2f;
+
+            floats[0] = 1.0f;
+            floats[1] = -1.0f;
+            floats[2] = 0.5f / 32768.0f;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                IntPointer (ints.get() + channel * IntPointer::getBytesPerSample(), numChannels).convertSamples (FloatPointer (floats.get()), numSamples);
+
+                IntPointer dest (expectedInts.get() + channel * IntPointer::getBytesPerSample(), numChannels);
+                FloatPointer source (floats.get());
+
+                for (int i = 0; i < numSamples; ++i, ++dest, ++source)
+                    dest.setAsInt32 (source.getAsInt32());
+            }
+
+            unitTest.expect (memcmp (ints.get(), expectedInts.get(), (size_t) (numSamples * numChannels * IntPointer::getBytesPerSample())) == 0);
+
+            for (int i = 0; i < numSamples * numChannels * IntPointer::getBytesPerSample(); ++i)
+                ints[i] = (char) r.nextInt();
+
+            FloatPointer (floats.get()).convertSamples (IntPointer (ints.get() + IntPointer::getBytesPerSample(), numChannels), numSamples);
+
+            IntPointer source (ints.get() + IntPointer::getBytesPerSample(), numChannels);
+
+            for (int i = 0; i < numSamples; ++i, ++source)
+                expectedFloats[i] = source.getAsFloat();
+
+            unitTest.expect (memcmp (floats.get(), expectedFloats.get(), sizeof (float) * (size_t) numSamples) == 0);
+        }
+    };
+
     template <class F1, class E1, class FormatType>
     struct Test3
     {
@@ -581,6 +960,39 @@ public:
         Test1 <AudioData::Int32>::test (*this, r);
         beginTest ("Round-trip conversion: Float32");
         Test1 <AudioData::Float32>::test (*this, r);
+
+        beginTest ("Vectorised conversion");
+        VectorisedTest <AudioData::Int16, AudioData::LittleEndian>::test (*this, r);
+        VectorisedTest <AudioData::Int16, AudioData::BigEndian>::test (*this, r);
+        VectorisedTest <AudioData::Int24, AudioData::LittleEndian>::test (*this, r);
+        VectorisedTest <AudioData::Int24, AudioData::BigEndian>::test (*this, r);
+        VectorisedTest <AudioData::Int32, AudioData::LittleEndian>::test (*this, r);
+        VectorisedTest <AudioData::Int32, AudioData::BigEndian>::test (*this, r);
+
+        beginTest ("Stereo interleaving");
+        {
+            const int numSamples = 37;
+            float left[numSamples], right[numSamples], interleaved[numSamples * 2], outLeft[numSamples], outRight[numSamples];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                left[i] = (float) i;
+                right[i] = (float) -i;
+            }
+
+            const float* channels[] = { left, right };
+            float* outChannels[] = { outLeft, outRight };
+            AudioDataConverters::interleaveSamples (channels, interleaved, numSamples, 2);
+            AudioDataConverters::deinterleaveSamples (interleaved, outChannels, numSamples, 2);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                expectEquals (interleaved[2 * i], left[i]);
+                expectEquals (interleaved[2 * i + 1], right[i]);
+                expectEquals (outLeft[i], left[i]);
+                expectEquals (outRight[i], right[i]);
+            }
+        }
     }
 };
 
@@ -320,6 +320,32 @@ public:
         static inline void* toVoidPtr (VoidType* v) noexcept { return const_cast<void*> (v); }
         enum { isConst = 1 };
     };
+
+    //==============================================================================
+    /*  SIMD loops for converting between contiguous native floats and the packed integer
+        formats, which Pointer::convertSamples() and AudioDataConverters use for the most
+        common conversions. The integer side can be interleaved and of either endianness.
+    */
+    struct JUCE_API  VectorisedConversion
+    {
+        enum IntFormat { notAnIntFormat = 0, int16 = 2, int24 = 3, int32 = 4 };
+
+        static IntFormat getIntFormat (int bytesPerSample, int resolution, bool isFloat) noexcept
+        {
+            if (isFloat || bytesPerSample < 2 || bytesPerSample > 4 || resolution != (1 << (32 - 8 * bytesPerSample)))
+                return notAnIntFormat;
+
+            return (IntFormat) bytesPerSample;
+        }
+
+        // dest[i] = scale * (float) source[i]
+        static void intToFloat (IntFormat sourceFormat, bool sourceIsBigEndian, const void* source, int sourceBytesBetweenSamples,
+                                float* dest, int numSamples, float scale) noexcept;
+
+        // dest[i] = roundToInt (jlimit (-limit, limit, scale * source[i])) >> shift, calculated in double precision
+        static void floatToInt (IntFormat destFormat, bool destIsBigEndian, void* dest, int destBytesBetweenSamples,
+                                const float* source, int numSamples, double scale, double limit, int shift) noexcept;
+    };
   #endif
 
     //==============================================================================
@@ -465,6 +491,9 @@ public:
 
             if (source.getRawData() != getRawData() || source.getNumBytesBetweenSamples() >= getNumBytesBetweenSamples())
             {
+                if (convertSamplesWithVectorOperations (source, numSamples))
+                    return;
+
                 while (--numSamples >= 0)
                 {
                     Endianness::copyFrom (dest.data, source);
@@ -571,6 +600,47 @@ public:
 
         inline void advance() noexcept                          { this->advanceData (data); }
 
+        template <class OtherPointerType>
+        bool convertSamplesWithVectorOperations (const OtherPointerType& source, int numSamples) const noexcept
+        {
+            auto isNativeContiguousFloat = [] (bool isFloat, bool bigEndian, int numInterleaved)
+            {
+                return isFloat && bigEndian == (bool) NativeEndian::isBigEndian && numInterleaved == 1;
+            };
+
+            if (isNativeContiguousFloat (isFloatingPoint(), isBigEndian(), getNumInterleavedChannels()))
+            {
+                auto sourceFormat = VectorisedConversion::getIntFormat (OtherPointerType::getBytesPerSample(),
+                                                                        OtherPointerType::get32BitResolution(),
+                                                                        OtherPointerType::isFloatingPoint());
+
+                if (sourceFormat == VectorisedConversion::notAnIntFormat)
+                    return false;
+
+                VectorisedConversion::intToFloat (sourceFormat, OtherPointerType::isBigEndian(),
+                                                  source.getRawData(), source.getNumBytesBetweenSamples(),
+                                                  static_cast<float*> (const_cast<void*> (getRawData())), numSamples,
+                                                  (float) (OtherPointerType::get32BitResolution() / (1.0 + Int32::maxValue)));
+                return true;
+            }
+
+            if (isNativeContiguousFloat (OtherPointerType::isFloatingPoint(), OtherPointerType::isBigEndian(), source.getNumInterleavedChannels()))
+            {
+                auto destFormat = VectorisedConversion::getIntFormat (getBytesPerSample(), get32BitResolution(), isFloatingPoint());
+
+                if (destFormat == VectorisedConversion::notAnIntFormat)
+                    return false;
+
+                // this matches copying each sample with setAsInt32 (source.getAsInt32())
+                VectorisedConversion::floatToInt (destFormat, isBigEndian(), const_cast<void*> (getRawData()), getNumBytesBetweenSamples(),
+                                                  static_cast<const float*> (source.getRawData()), numSamples,
+                                                  (double) Int32::maxValue, (double) Int32::maxValue, 32 - 8 * (int) destFormat);
+                return true;
+            }
+
+            return false;
+        }
+
         Pointer operator++ (int); // private to force you to use the more efficient pre-increment!
         Pointer operator-- (int);
     };
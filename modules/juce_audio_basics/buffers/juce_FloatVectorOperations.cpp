@@ -485,6 +485,388 @@ namespace FloatVectorHelpers
         }
     };
    #endif
+
+   #if JUCE_USE_AVX_DISPATCH
+    //==============================================================================
+    /*  The AVX2/FMA and AVX-512 versions of the operations are compiled with per-function
+        target attributes, so the rest of the module can still be built for a baseline SSE2
+        machine. They're only ever called after getWideVectorLevel() has checked that the CPU
+        supports them, and every function that handles the wide register types must carry the
+        same target attribute, otherwise the compiler can't inline (or even correctly call) it.
+    */
+   #if JUCE_MSVC
+    #define JUCE_AVX2_TARGET
+    #define JUCE_AVX512_TARGET
+   #else
+    #define JUCE_AVX2_TARGET    __attribute__ ((target ("avx2,fma")))
+    #define JUCE_AVX512_TARGET  __attribute__ ((target ("avx512f")))
+   #endif
+
+   #if JUCE_GCC
+    // GCC's AVX-512 headers pass _mm512_undefined_* values to the unmasked min, max and
+    // conversion builtins, which makes it produce bogus warnings wherever they're inlined
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+   #endif
+
+    template <typename Type> struct AVX2Ops;
+    template <typename Type> struct AVX512Ops;
+
+    template <>
+    struct AVX2Ops<float>
+    {
+        using Type = float;
+        using ParallelType = __m256;
+        enum { numParallel = 8 };
+
+        static forcedinline JUCE_AVX2_TARGET ParallelType load1 (Type v) noexcept                        { return _mm256_set1_ps (v); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType loadU (const Type* v) noexcept                 { return _mm256_loadu_ps (v); }
+        static forcedinline JUCE_AVX2_TARGET void storeU (Type* dest, ParallelType a) noexcept           { _mm256_storeu_ps (dest, a); }
+
+        static forcedinline JUCE_AVX2_TARGET ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm256_add_ps (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm256_sub_ps (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm256_mul_ps (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm256_max_ps (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm256_min_ps (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType bit_and (ParallelType a, ParallelType b) noexcept  { return _mm256_and_ps (a, b); }
+
+        // a + (b * c) and a - (b * c), with a single rounding step
+        static forcedinline JUCE_AVX2_TARGET ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm256_fmadd_ps  (b, c, a); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType multiplySub (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm256_fnmadd_ps (b, c, a); }
+
+        static forcedinline JUCE_AVX2_TARGET ParallelType loadInt (const int* v) noexcept  { return _mm256_cvtepi32_ps (_mm256_loadu_si256 (reinterpret_cast<const __m256i*> (v))); }
+
+        static forcedinline JUCE_AVX2_TARGET Type max (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return juce::findMaximum (v, (int) numParallel); }
+        static forcedinline JUCE_AVX2_TARGET Type min (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return juce::findMinimum (v, (int) numParallel); }
+    };
+
+    template <>
+    struct AVX2Ops<double>
+    {
+        using Type = double;
+        using ParallelType = __m256d;
+        enum { numParallel = 4 };
+
+        static forcedinline JUCE_AVX2_TARGET ParallelType load1 (Type v) noexcept                        { return _mm256_set1_pd (v); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType loadU (const Type* v) noexcept                 { return _mm256_loadu_pd (v); }
+        static forcedinline JUCE_AVX2_TARGET void storeU (Type* dest, ParallelType a) noexcept           { _mm256_storeu_pd (dest, a); }
+
+        static forcedinline JUCE_AVX2_TARGET ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm256_add_pd (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm256_sub_pd (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm256_mul_pd (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm256_max_pd (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm256_min_pd (a, b); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType bit_and (ParallelType a, ParallelType b) noexcept  { return _mm256_and_pd (a, b); }
+
+        static forcedinline JUCE_AVX2_TARGET ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm256_fmadd_pd  (b, c, a); }
+        static forcedinline JUCE_AVX2_TARGET ParallelType multiplySub (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm256_fnmadd_pd (b, c, a); }
+
+        static forcedinline JUCE_AVX2_TARGET Type max (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return jmax (v[0], v[1], v[2], v[3]); }
+        static forcedinline JUCE_AVX2_TARGET Type min (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return jmin (v[0], v[1], v[2], v[3]); }
+    };
+
+    template <>
+    struct AVX512Ops<float>
+    {
+        using Type = float;
+        using ParallelType = __m512;
+        enum { numParallel = 16 };
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType load1 (Type v) noexcept                        { return _mm512_set1_ps (v); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType loadU (const Type* v) noexcept                 { return _mm512_loadu_ps (v); }
+        static forcedinline JUCE_AVX512_TARGET void storeU (Type* dest, ParallelType a) noexcept           { _mm512_storeu_ps (dest, a); }
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm512_add_ps (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm512_sub_ps (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm512_mul_ps (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm512_max_ps (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm512_min_ps (a, b); }
+
+        // _mm512_and_ps needs AVX512DQ, so go via the integer version which is part of AVX512F
+        static forcedinline JUCE_AVX512_TARGET ParallelType bit_and (ParallelType a, ParallelType b) noexcept
+        {
+            return _mm512_castsi512_ps (_mm512_and_si512 (_mm512_castps_si512 (a), _mm512_castps_si512 (b)));
+        }
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm512_fmadd_ps  (b, c, a); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType multiplySub (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm512_fnmadd_ps (b, c, a); }
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType loadInt (const int* v) noexcept  { return _mm512_cvtepi32_ps (_mm512_loadu_si512 (v)); }
+
+        static forcedinline JUCE_AVX512_TARGET Type max (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return juce::findMaximum (v, (int) numParallel); }
+        static forcedinline JUCE_AVX512_TARGET Type min (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return juce::findMinimum (v, (int) numParallel); }
+    };
+
+    template <>
+    struct AVX512Ops<double>
+    {
+        using Type = double;
+        using ParallelType = __m512d;
+        enum { numParallel = 8 };
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType load1 (Type v) noexcept                        { return _mm512_set1_pd (v); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType loadU (const Type* v) noexcept                 { return _mm512_loadu_pd (v); }
+        static forcedinline JUCE_AVX512_TARGET void storeU (Type* dest, ParallelType a) noexcept           { _mm512_storeu_pd (dest, a); }
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType add (ParallelType a, ParallelType b) noexcept  { return _mm512_add_pd (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType sub (ParallelType a, ParallelType b) noexcept  { return _mm512_sub_pd (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType mul (ParallelType a, ParallelType b) noexcept  { return _mm512_mul_pd (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType max (ParallelType a, ParallelType b) noexcept  { return _mm512_max_pd (a, b); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType min (ParallelType a, ParallelType b) noexcept  { return _mm512_min_pd (a, b); }
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType bit_and (ParallelType a, ParallelType b) noexcept
+        {
+            return _mm512_castsi512_pd (_mm512_and_si512 (_mm512_castpd_si512 (a), _mm512_castpd_si512 (b)));
+        }
+
+        static forcedinline JUCE_AVX512_TARGET ParallelType multiplyAdd (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm512_fmadd_pd  (b, c, a); }
+        static forcedinline JUCE_AVX512_TARGET ParallelType multiplySub (ParallelType a, ParallelType b, ParallelType c) noexcept  { return _mm512_fnmadd_pd (b, c, a); }
+
+        static forcedinline JUCE_AVX512_TARGET Type max (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return juce::findMaximum (v, (int) numParallel); }
+        static forcedinline JUCE_AVX512_TARGET Type min (ParallelType a) noexcept  { Type v[numParallel]; storeU (v, a); return juce::findMinimum (v, (int) numParallel); }
+    };
+
+    //==============================================================================
+    #define JUCE_WIDE_VEC_LOOP(locals, vecOp, normalOp) \
+        int i = 0; \
+        for (; i <= num - Ops::numParallel; i += Ops::numParallel) \
+        { \
+            locals \
+            Ops::storeU (dest + i, vecOp); \
+        } \
+        for (; i < num; ++i) normalOp;
+
+    #define JUCE_WIDE_LOAD_NONE
+    #define JUCE_WIDE_LOAD_DEST             const ParallelType d = Ops::loadU (dest + i);
+    #define JUCE_WIDE_LOAD_SRC              const ParallelType s = Ops::loadU (src + i);
+    #define JUCE_WIDE_LOAD_SRC_DEST         const ParallelType d = Ops::loadU (dest + i), s = Ops::loadU (src + i);
+    #define JUCE_WIDE_LOAD_SRC1_SRC2        const ParallelType s1 = Ops::loadU (src1 + i), s2 = Ops::loadU (src2 + i);
+    #define JUCE_WIDE_LOAD_SRC1_SRC2_DEST   const ParallelType d = Ops::loadU (dest + i), s1 = Ops::loadU (src1 + i), s2 = Ops::loadU (src2 + i);
+
+    /*  Declares a set of vector operations built from an AVX2Ops or AVX512Ops type. This has
+        to be a macro rather than a plain template because the target attribute of every
+        function must match the instruction set of the Ops type that it gets instantiated with.
+    */
+    #define JUCE_DECLARE_WIDE_VECTOR_OPS(ClassName, targetAttribute) \
+        template <typename Ops> \
+        struct ClassName \
+        { \
+            using Type = typename Ops::Type; \
+            using ParallelType = typename Ops::ParallelType; \
+        \
+            static targetAttribute void fill (Type* dest, Type valueToFill, int num) noexcept \
+            { \
+                const ParallelType val = Ops::load1 (valueToFill); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_NONE, val, dest[i] = valueToFill) \
+            } \
+        \
+            static targetAttribute void add (Type* dest, Type amount, int num) noexcept \
+            { \
+                const ParallelType am = Ops::load1 (amount); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_DEST, Ops::add (d, am), dest[i] += amount) \
+            } \
+        \
+            static targetAttribute void add (Type* dest, const Type* src, Type amount, int num) noexcept \
+            { \
+                const ParallelType am = Ops::load1 (amount); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC, Ops::add (s, am), dest[i] = src[i] + amount) \
+            } \
+        \
+            static targetAttribute void add (Type* dest, const Type* src, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC_DEST, Ops::add (d, s), dest[i] += src[i]) \
+            } \
+        \
+            static targetAttribute void add (Type* dest, const Type* src1, const Type* src2, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC1_SRC2, Ops::add (s1, s2), dest[i] = src1[i] + src2[i]) \
+            } \
+        \
+            static targetAttribute void subtract (Type* dest, const Type* src, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC_DEST, Ops::sub (d, s), dest[i] -= src[i]) \
+            } \
+        \
+            static targetAttribute void subtract (Type* dest, const Type* src1, const Type* src2, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC1_SRC2, Ops::sub (s1, s2), dest[i] = src1[i] - src2[i]) \
+            } \
+        \
+            static targetAttribute void addWithMultiply (Type* dest, const Type* src, Type multiplier, int num) noexcept \
+            { \
+                const ParallelType mult = Ops::load1 (multiplier); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC_DEST, Ops::multiplyAdd (d, s, mult), dest[i] += src[i] * multiplier) \
+            } \
+        \
+            static targetAttribute void addWithMultiply (Type* dest, const Type* src1, const Type* src2, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC1_SRC2_DEST, Ops::multiplyAdd (d, s1, s2), dest[i] += src1[i] * src2[i]) \
+            } \
+        \
+            static targetAttribute void subtractWithMultiply (Type* dest, const Type* src, Type multiplier, int num) noexcept \
+            { \
+                const ParallelType mult = Ops::load1 (multiplier); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC_DEST, Ops::multiplySub (d, s, mult), dest[i] -= src[i] * multiplier) \
+            } \
+        \
+            static targetAttribute void subtractWithMultiply (Type* dest, const Type* src1, const Type* src2, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC1_SRC2_DEST, Ops::multiplySub (d, s1, s2), dest[i] -= src1[i] * src2[i]) \
+            } \
+        \
+            static targetAttribute void multiply (Type* dest, const Type* src, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC_DEST, Ops::mul (d, s), dest[i] *= src[i]) \
+            } \
+        \
+            static targetAttribute void multiply (Type* dest, const Type* src1, const Type* src2, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC1_SRC2, Ops::mul (s1, s2), dest[i] = src1[i] * src2[i]) \
+            } \
+        \
+            static targetAttribute void multiply (Type* dest, Type multiplier, int num) noexcept \
+            { \
+                const ParallelType mult = Ops::load1 (multiplier); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_DEST, Ops::mul (d, mult), dest[i] *= multiplier) \
+            } \
+        \
+            static targetAttribute void multiply (Type* dest, const Type* src, Type multiplier, int num) noexcept \
+            { \
+                const ParallelType mult = Ops::load1 (multiplier); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC, Ops::mul (mult, s), dest[i] = src[i] * multiplier) \
+            } \
+        \
+            static targetAttribute void abs (Type* dest, const Type* src, Type signMask, int num) noexcept \
+            { \
+                const ParallelType mask = Ops::load1 (signMask); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC, Ops::bit_and (s, mask), dest[i] = std::abs (src[i])) \
+            } \
+        \
+            static targetAttribute void convertFixedToFloat (Type* dest, const int* src, Type multiplier, int num) noexcept \
+            { \
+                const ParallelType mult = Ops::load1 (multiplier); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_NONE, Ops::mul (mult, Ops::loadInt (src + i)), dest[i] = (Type) src[i] * multiplier) \
+            } \
+        \
+            static targetAttribute void min (Type* dest, const Type* src, Type comp, int num) noexcept \
+            { \
+                const ParallelType cmp = Ops::load1 (comp); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC, Ops::min (s, cmp), dest[i] = jmin (src[i], comp)) \
+            } \
+        \
+            static targetAttribute void min (Type* dest, const Type* src1, const Type* src2, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC1_SRC2, Ops::min (s1, s2), dest[i] = jmin (src1[i], src2[i])) \
+            } \
+        \
+            static targetAttribute void max (Type* dest, const Type* src, Type comp, int num) noexcept \
+            { \
+                const ParallelType cmp = Ops::load1 (comp); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC, Ops::max (s, cmp), dest[i] = jmax (src[i], comp)) \
+            } \
+        \
+            static targetAttribute void max (Type* dest, const Type* src1, const Type* src2, int num) noexcept \
+            { \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC1_SRC2, Ops::max (s1, s2), dest[i] = jmax (src1[i], src2[i])) \
+            } \
+        \
+            static targetAttribute void clip (Type* dest, const Type* src, Type low, Type high, int num) noexcept \
+            { \
+                const ParallelType lo = Ops::load1 (low), hi = Ops::load1 (high); \
+                JUCE_WIDE_VEC_LOOP (JUCE_WIDE_LOAD_SRC, Ops::max (Ops::min (s, hi), lo), dest[i] = jmax (jmin (src[i], high), low)) \
+            } \
+        \
+            static targetAttribute Type findMinOrMax (const Type* src, int num, bool isMinimum) noexcept \
+            { \
+                if (num < Ops::numParallel) \
+                    return isMinimum ? juce::findMinimum (src, num) : juce::findMaximum (src, num); \
+        \
+                ParallelType val = Ops::loadU (src); \
+                int i = Ops::numParallel; \
+        \
+                if (isMinimum) \
+                    for (; i <= num - Ops::numParallel; i += Ops::numParallel) \
+                        val = Ops::min (val, Ops::loadU (src + i)); \
+                else \
+                    for (; i <= num - Ops::numParallel; i += Ops::numParallel) \
+                        val = Ops::max (val, Ops::loadU (src + i)); \
+        \
+                Type result = isMinimum ? Ops::min (val) : Ops::max (val); \
+        \
+                for (; i < num; ++i) \
+                    result = isMinimum ? jmin (result, src[i]) : jmax (result, src[i]); \
+        \
+                return result; \
+            } \
+        \
+            static targetAttribute Range<Type> findMinAndMax (const Type* src, int num) noexcept \
+            { \
+                if (num < Ops::numParallel) \
+                    return Range<Type>::findMinAndMax (src, num); \
+        \
+                ParallelType mn = Ops::loadU (src), mx = mn; \
+                int i = Ops::numParallel; \
+        \
+                for (; i <= num - Ops::numParallel; i += Ops::numParallel) \
+                { \
+                    const ParallelType v = Ops::loadU (src + i); \
+                    mn = Ops::min (mn, v); \
+                    mx = Ops::max (mx, v); \
+                } \
+        \
+                Range<Type> result (Ops::min (mn), Ops::max (mx)); \
+        \
+                for (; i < num; ++i) \
+                    result = result.getUnionWith (src[i]); \
+        \
+                return result; \
+            } \
+        };
+
+    JUCE_DECLARE_WIDE_VECTOR_OPS (AVX2VectorOps,   JUCE_AVX2_TARGET)
+    JUCE_DECLARE_WIDE_VECTOR_OPS (AVX512VectorOps, JUCE_AVX512_TARGET)
+
+   #if JUCE_GCC
+    #pragma GCC diagnostic pop
+   #endif
+
+    //==============================================================================
+    enum class WideVectorLevel
+    {
+        none,
+        avx2,
+        avx512
+    };
+
+    // SystemStats only reports the AVX features if the OS has also enabled the register
+    // state that they need, so these are safe to use whenever it says they're available.
+    static WideVectorLevel getWideVectorLevel() noexcept
+    {
+        if (SystemStats::hasAVX512F())
+            return WideVectorLevel::avx512;
+
+        if (SystemStats::hasAVX2() && SystemStats::hasFMA3())
+            return WideVectorLevel::avx2;
+
+        return WideVectorLevel::none;
+    }
+
+    // Checked once at startup. Anything called before static initialisation has finished will
+    // see the zero-initialised value and use the SSE code. The unit tests call each level's
+    // VectorOps directly rather than changing this.
+    static const WideVectorLevel wideVectorLevel = getWideVectorLevel();
+
+    #define JUCE_DISPATCH_WIDE_VEC_OP(Type, operation) \
+        switch (FloatVectorHelpers::wideVectorLevel) \
+        { \
+            case FloatVectorHelpers::WideVectorLevel::avx512:  return FloatVectorHelpers::AVX512VectorOps<FloatVectorHelpers::AVX512Ops<Type>>::operation; \
+            case FloatVectorHelpers::WideVectorLevel::avx2:    return FloatVectorHelpers::AVX2VectorOps<FloatVectorHelpers::AVX2Ops<Type>>::operation; \
+            case FloatVectorHelpers::WideVectorLevel::none: \
+            default:                                           break; \
+        }
+   #else
+    #define JUCE_DISPATCH_WIDE_VEC_OP(Type, operation)
+   #endif
 }
 
 //==============================================================================
@@ -522,6 +904,7 @@ void JUCE_CALLTYPE FloatVectorOperations::fill (float* dest, float valueToFill,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vfill (&valueToFill, dest, 1, (size_t) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, fill (dest, valueToFill, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] = valueToFill, val, JUCE_LOAD_NONE,
                               const Mode::ParallelType val = Mode::load1 (valueToFill);)
    #endif
@@ -532,6 +915,7 @@ void JUCE_CALLTYPE FloatVectorOperations::fill (double* dest, double valueToFill
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vfillD (&valueToFill, dest, 1, (size_t) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, fill (dest, valueToFill, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] = valueToFill, val, JUCE_LOAD_NONE,
                               const Mode::ParallelType val = Mode::load1 (valueToFill);)
    #endif
@@ -552,6 +936,7 @@ void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (float* dest, const f
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (src, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, multiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -563,6 +948,7 @@ void JUCE_CALLTYPE FloatVectorOperations::copyWithMultiply (double* dest, const
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmulD (src, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, multiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -574,6 +960,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, float amount, int nu
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsadd (dest, 1, &amount, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, add (dest, amount, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] += amount, Mode::add (d, amountToAdd), JUCE_LOAD_DEST,
                               const Mode::ParallelType amountToAdd = Mode::load1 (amount);)
    #endif
@@ -581,6 +968,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, float amount, int nu
 
 void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, double amount, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (double, add (dest, amount, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] += amount, Mode::add (d, amountToAdd), JUCE_LOAD_DEST,
                               const Mode::ParallelType amountToAdd = Mode::load1 (amount);)
 }
@@ -590,6 +978,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src, fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsadd (osx108sdkCompatibilityCast (src), 1, &amount, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, add (dest, src, amount, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] + amount, Mode::add (am, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType am = Mode::load1 (amount);)
@@ -601,6 +990,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsaddD (osx108sdkCompatibilityCast (src), 1, &amount, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, add (dest, src, amount, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] + amount, Mode::add (am, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType am = Mode::load1 (amount);)
@@ -612,6 +1002,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src, in
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, add (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i], Mode::add (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -621,6 +1012,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vaddD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, add (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i], Mode::add (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -630,6 +1022,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src1, c
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vadd (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, add (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] + src2[i], Mode::add (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -639,6 +1032,7 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src1,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vaddD (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, add (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] + src2[i], Mode::add (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -648,6 +1042,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsub (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, subtract (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i], Mode::sub (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -657,6 +1052,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsubD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, subtract (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i], Mode::sub (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -666,6 +1062,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsub (src2, 1, src1, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, subtract (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] - src2[i], Mode::sub (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -675,6 +1072,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtract (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsubD (src2, 1, src1, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, subtract (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] - src2[i], Mode::sub (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -684,6 +1082,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsma (src, 1, &multiplier, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, addWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i] * multiplier, Mode::add (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -695,6 +1094,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const d
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmaD (src, 1, &multiplier, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, addWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] += src[i] * multiplier, Mode::add (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -706,6 +1106,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (float* dest, const fl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vma ((float*) src1, 1, (float*) src2, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, addWithMultiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * src2[i], Mode::add (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -717,6 +1118,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const d
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmaD ((double*) src1, 1, (double*) src2, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, addWithMultiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] += src1[i] * src2[i], Mode::add (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -725,6 +1127,7 @@ void JUCE_CALLTYPE FloatVectorOperations::addWithMultiply (double* dest, const d
 
 void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (float* dest, const float* src, float multiplier, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (float, subtractWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i] * multiplier, Mode::sub (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -732,6 +1135,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (float* dest, con
 
 void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (double* dest, const double* src, double multiplier, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (double, subtractWithMultiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] -= src[i] * multiplier, Mode::sub (d, Mode::mul (mult, s)),
                                   JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -739,6 +1143,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (double* dest, co
 
 void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (float* dest, const float* src1, const float* src2, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (float, subtractWithMultiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] -= src1[i] * src2[i], Mode::sub (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -746,6 +1151,7 @@ void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (float* dest, con
 
 void JUCE_CALLTYPE FloatVectorOperations::subtractWithMultiply (double* dest, const double* src1, const double* src2, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (double, subtractWithMultiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST_DEST (dest[i] -= src1[i] * src2[i], Mode::sub (d, Mode::mul (s1, s2)),
                                              JUCE_LOAD_SRC1_SRC2_DEST,
                                              JUCE_INCREMENT_SRC1_SRC2_DEST, )
@@ -756,6 +1162,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmul (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, multiply (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] *= src[i], Mode::mul (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -765,6 +1172,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmulD (src, 1, dest, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, multiply (dest, src, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] *= src[i], Mode::mul (d, s), JUCE_LOAD_SRC_DEST, JUCE_INCREMENT_SRC_DEST, )
    #endif
 }
@@ -774,6 +1182,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmul (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, multiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] * src2[i], Mode::mul (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -783,6 +1192,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double*
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmulD (src1, 1, src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, multiply (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = src1[i] * src2[i], Mode::mul (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -792,6 +1202,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, float multiplie
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmul (dest, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, multiply (dest, multiplier, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] *= multiplier, Mode::mul (d, mult), JUCE_LOAD_DEST,
                               const Mode::ParallelType mult = Mode::load1 (multiplier);)
    #endif
@@ -802,6 +1213,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, double multipl
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vsmulD (dest, 1, &multiplier, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, multiply (dest, multiplier, num))
     JUCE_PERFORM_VEC_OP_DEST (dest[i] *= multiplier, Mode::mul (d, mult), JUCE_LOAD_DEST,
                               const Mode::ParallelType mult = Mode::load1 (multiplier);)
    #endif
@@ -809,6 +1221,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, double multipl
 
 void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* src, float multiplier, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (float, multiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -816,6 +1229,7 @@ void JUCE_CALLTYPE FloatVectorOperations::multiply (float* dest, const float* sr
 
 void JUCE_CALLTYPE FloatVectorOperations::multiply (double* dest, const double* src, double multiplier, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (double, multiply (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = src[i] * multiplier, Mode::mul (mult, s),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mult = Mode::load1 (multiplier);)
@@ -846,6 +1260,7 @@ void FloatVectorOperations::abs (float* dest, const float* src, int num) noexcep
    #else
     FloatVectorHelpers::signMask32 signMask;
     signMask.i = 0x7fffffffUL;
+    JUCE_DISPATCH_WIDE_VEC_OP (float, abs (dest, src, signMask.f, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = std::abs (src[i]), Mode::bit_and (s, mask),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mask = Mode::load1 (signMask.f);)
@@ -862,6 +1277,7 @@ void FloatVectorOperations::abs (double* dest, const double* src, int num) noexc
     FloatVectorHelpers::signMask64 signMask;
     signMask.i = 0x7fffffffffffffffULL;
 
+    JUCE_DISPATCH_WIDE_VEC_OP (double, abs (dest, src, signMask.d, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = std::abs (src[i]), Mode::bit_and (s, mask),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType mask = Mode::load1 (signMask.d);)
@@ -877,6 +1293,7 @@ void JUCE_CALLTYPE FloatVectorOperations::convertFixedToFloat (float* dest, cons
                                   vmulq_n_f32 (vcvtq_f32_s32 (vld1q_s32 (src)), multiplier),
                                   JUCE_LOAD_NONE, JUCE_INCREMENT_SRC_DEST, )
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, convertFixedToFloat (dest, src, multiplier, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = (float) src[i] * multiplier,
                                   Mode::mul (mult, _mm_cvtepi32_ps (_mm_loadu_si128 (reinterpret_cast<const __m128i*> (src)))),
                                   JUCE_LOAD_NONE, JUCE_INCREMENT_SRC_DEST,
@@ -886,6 +1303,7 @@ void JUCE_CALLTYPE FloatVectorOperations::convertFixedToFloat (float* dest, cons
 
 void JUCE_CALLTYPE FloatVectorOperations::min (float* dest, const float* src, float comp, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (float, min (dest, src, comp, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmin (src[i], comp), Mode::min (s, cmp),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType cmp = Mode::load1 (comp);)
@@ -893,6 +1311,7 @@ void JUCE_CALLTYPE FloatVectorOperations::min (float* dest, const float* src, fl
 
 void JUCE_CALLTYPE FloatVectorOperations::min (double* dest, const double* src, double comp, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (double, min (dest, src, comp, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmin (src[i], comp), Mode::min (s, cmp),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType cmp = Mode::load1 (comp);)
@@ -903,6 +1322,7 @@ void JUCE_CALLTYPE FloatVectorOperations::min (float* dest, const float* src1, c
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmin ((float*) src1, 1, (float*) src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, min (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = jmin (src1[i], src2[i]), Mode::min (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -912,12 +1332,14 @@ void JUCE_CALLTYPE FloatVectorOperations::min (double* dest, const double* src1,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vminD ((double*) src1, 1, (double*) src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, min (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = jmin (src1[i], src2[i]), Mode::min (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
 
 void JUCE_CALLTYPE FloatVectorOperations::max (float* dest, const float* src, float comp, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (float, max (dest, src, comp, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmax (src[i], comp), Mode::max (s, cmp),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType cmp = Mode::load1 (comp);)
@@ -925,6 +1347,7 @@ void JUCE_CALLTYPE FloatVectorOperations::max (float* dest, const float* src, fl
 
 void JUCE_CALLTYPE FloatVectorOperations::max (double* dest, const double* src, double comp, int num) noexcept
 {
+    JUCE_DISPATCH_WIDE_VEC_OP (double, max (dest, src, comp, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmax (src[i], comp), Mode::max (s, cmp),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType cmp = Mode::load1 (comp);)
@@ -935,6 +1358,7 @@ void JUCE_CALLTYPE FloatVectorOperations::max (float* dest, const float* src1, c
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmax ((float*) src1, 1, (float*) src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, max (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = jmax (src1[i], src2[i]), Mode::max (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -944,6 +1368,7 @@ void JUCE_CALLTYPE FloatVectorOperations::max (double* dest, const double* src1,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vmaxD ((double*) src1, 1, (double*) src2, 1, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, max (dest, src1, src2, num))
     JUCE_PERFORM_VEC_OP_SRC1_SRC2_DEST (dest[i] = jmax (src1[i], src2[i]), Mode::max (s1, s2), JUCE_LOAD_SRC1_SRC2, JUCE_INCREMENT_SRC1_SRC2_DEST, )
    #endif
 }
@@ -955,6 +1380,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (float* dest, const float* src, f
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vclip ((float*) src, 1, &low, &high, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (float, clip (dest, src, low, high, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmax (jmin (src[i], high), low), Mode::max (Mode::min (s, hi), lo),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType lo = Mode::load1 (low); const Mode::ParallelType hi = Mode::load1 (high);)
@@ -968,6 +1394,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (double* dest, const double* src,
    #if JUCE_USE_VDSP_FRAMEWORK
     vDSP_vclipD ((double*) src, 1, &low, &high, dest, 1, (vDSP_Length) num);
    #else
+    JUCE_DISPATCH_WIDE_VEC_OP (double, clip (dest, src, low, high, num))
     JUCE_PERFORM_VEC_OP_SRC_DEST (dest[i] = jmax (jmin (src[i], high), low), Mode::max (Mode::min (s, hi), lo),
                                   JUCE_LOAD_SRC, JUCE_INCREMENT_SRC_DEST,
                                   const Mode::ParallelType lo = Mode::load1 (low); const Mode::ParallelType hi = Mode::load1 (high);)
@@ -977,6 +1404,7 @@ void JUCE_CALLTYPE FloatVectorOperations::clip (double* dest, const double* src,
 Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_WIDE_VEC_OP (float, findMinAndMax (src, num))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinAndMax (src, num);
    #else
     return Range<float>::findMinAndMax (src, num);
@@ -986,6 +1414,7 @@ Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const float* sr
 Range<double> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const double* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_WIDE_VEC_OP (double, findMinAndMax (src, num))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps64>::findMinAndMax (src, num);
    #else
     return Range<double>::findMinAndMax (src, num);
@@ -995,6 +1424,7 @@ Range<double> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const double*
 float JUCE_CALLTYPE FloatVectorOperations::findMinimum (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_WIDE_VEC_OP (float, findMinOrMax (src, num, true))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinOrMax (src, num, true);
    #else
     return juce::findMinimum (src, num);
@@ -1004,6 +1434,7 @@ float JUCE_CALLTYPE FloatVectorOperations::findMinimum (const float* src, int nu
 double JUCE_CALLTYPE FloatVectorOperations::findMinimum (const double* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_WIDE_VEC_OP (double, findMinOrMax (src, num, true))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps64>::findMinOrMax (src, num, true);
    #else
     return juce::findMinimum (src, num);
@@ -1013,6 +1444,7 @@ double JUCE_CALLTYPE FloatVectorOperations::findMinimum (const double* src, int
 float JUCE_CALLTYPE FloatVectorOperations::findMaximum (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_WIDE_VEC_OP (float, findMinOrMax (src, num, false))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinOrMax (src, num, false);
    #else
     return juce::findMaximum (src, num);
@@ -1022,6 +1454,7 @@ float JUCE_CALLTYPE FloatVectorOperations::findMaximum (const float* src, int nu
 double JUCE_CALLTYPE FloatVectorOperations::findMaximum (const double* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    JUCE_DISPATCH_WIDE_VEC_OP (double, findMinOrMax (src, num, false))
     return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps64>::findMinOrMax (src, num, false);
    #else
     return juce::findMaximum (src, num);
@@ -1230,6 +1663,57 @@ public:
             FloatVectorOperations::fill (data2, (ValueType) 3, num);
             FloatVectorOperations::addWithMultiply (data1, data1, data2, num);
             u.expect (areAllValuesEqual (data1, num, (ValueType) 8));
+
+            doMultiplyAccumulateTest (u, random, data1, data2, num);
+        }
+
+        // Checks the multiply-accumulate functions against a scalar reference, using the same
+        // misaligned buffers and odd lengths as the other tests. The SIMD versions may use fused
+        // multiply-adds, which round once instead of twice, so the reference is done in double
+        // precision and the tolerance depends on the size of the terms.
+        static void doMultiplyAccumulateTest (UnitTest& u, Random& random, ValueType* dest, ValueType* src, int num)
+        {
+            HeapBlock<ValueType> other (num);
+            HeapBlock<double> expected (num), magnitudes (num);
+
+            fillRandomly (random, src, num);
+            fillRandomly (random, other.get(), num);
+
+            enum { addScalar, subtractScalar, addVector, subtractVector };
+
+            for (int op = addScalar; op <= subtractVector; ++op)
+            {
+                fillRandomly (random, dest, num);
+
+                const auto multiplier = (ValueType) (random.nextDouble() * 4.0 - 2.0);
+                const bool isVector = (op == addVector || op == subtractVector);
+                const double sign = (op == addScalar || op == addVector) ? 1.0 : -1.0;
+
+                for (int i = 0; i < num; ++i)
+                {
+                    auto product = (double) src[i] * (isVector ? (double) other[i] : (double) multiplier);
+                    expected[i] = (double) dest[i] + sign * product;
+                    magnitudes[i] = std::abs ((double) dest[i]) + std::abs (product);
+                }
+
+                switch (op)
+                {
+                    case addScalar:       FloatVectorOperations::addWithMultiply (dest, src, multiplier, num); break;
+                    case subtractScalar:  FloatVectorOperations::subtractWithMultiply (dest, src, multiplier, num); break;
+                    case addVector:       FloatVectorOperations::addWithMultiply (dest, src, other.get(), num); break;
+                    case subtractVector:  FloatVectorOperations::subtractWithMultiply (dest, src, other.get(), num); break;
+                    default:              break;
+                }
+
+                const double epsilon = std::numeric_limits<ValueType>::epsilon();
+                bool allMatch = true;
+
+                for (int i = 0; i < num; ++i)
+                    if (std::abs ((double) dest[i] - expected[i]) > 2.0 * epsilon * magnitudes[i])
+                        allMatch = false;
+
+                u.expect (allMatch);
+            }
         }
 
         static void doConversionTest (UnitTest& u, float* data1, float* data2, int* const int1, int num)
@@ -1283,6 +1767,242 @@ public:
         }
     };
 
+   #if JUCE_USE_AVX_DISPATCH
+    // Runs one of the wide instruction set implementations directly, so that each one gets
+    // tested regardless of which is picked at runtime.
+    template <typename VectorOps>
+    struct WideTestRunner
+    {
+        using ValueType = typename VectorOps::Type;
+
+        static void runTest (UnitTest& u, Random random)
+        {
+            const int num = random.nextInt (100) + 1;
+
+            // the wide loads and stores are unaligned, so start the buffers at odd offsets too
+            HeapBlock<ValueType> src1Data (num + 8), src2Data (num + 8), destData (num + 8), expected (num);
+            ValueType* const src1 = src1Data + random.nextInt (8);
+            ValueType* const src2 = src2Data + random.nextInt (8);
+            ValueType* const dest = destData + random.nextInt (8);
+            fillRandomly (random, src1, num);
+            fillRandomly (random, src2, num);
+
+            VectorOps::add (dest, src1, src2, num);
+            for (int i = 0; i < num; ++i) expected[i] = src1[i] + src2[i];
+            u.expect (buffersMatch (dest, expected, num, 0));
+
+            VectorOps::multiply (dest, src1, src2, num);
+            for (int i = 0; i < num; ++i) expected[i] = src1[i] * src2[i];
+            u.expect (buffersMatch (dest, expected, num, 0));
+
+            VectorOps::multiply (dest, src1, (ValueType) 3, num);
+            for (int i = 0; i < num; ++i) expected[i] = src1[i] * (ValueType) 3;
+            u.expect (buffersMatch (dest, expected, num, 0));
+
+            // the fused multiply-adds only round once, so allow a little slack here
+            const ValueType fmaTolerance = 2000000 * std::numeric_limits<ValueType>::epsilon();
+
+            FloatVectorOperations::copy (dest, src1, num);
+            VectorOps::addWithMultiply (dest, src1, src2, num);
+            for (int i = 0; i < num; ++i) expected[i] = src1[i] + src1[i] * src2[i];
+            u.expect (buffersMatch (dest, expected, num, fmaTolerance));
+
+            FloatVectorOperations::copy (dest, src1, num);
+            VectorOps::subtractWithMultiply (dest, src2, (ValueType) 0.5, num);
+            for (int i = 0; i < num; ++i) expected[i] = src1[i] - src2[i] * (ValueType) 0.5;
+            u.expect (buffersMatch (dest, expected, num, fmaTolerance));
+
+            VectorOps::clip (dest, src1, (ValueType) -100, (ValueType) 200, num);
+            for (int i = 0; i < num; ++i) expected[i] = jlimit ((ValueType) -100, (ValueType) 200, src1[i]);
+            u.expect (buffersMatch (dest, expected, num, 0));
+
+            u.expect (VectorOps::findMinAndMax (src1, num) == Range<ValueType>::findMinAndMax (src1, num));
+            u.expect (VectorOps::findMinOrMax (src2, num, true)  == juce::findMinimum (src2, num));
+            u.expect (VectorOps::findMinOrMax (src2, num, false) == juce::findMaximum (src2, num));
+        }
+
+        static void fillRandomly (Random& random, ValueType* d, int num)
+        {
+            while (--num >= 0)
+                *d++ = (ValueType) (random.nextDouble() * 1000.0 - 500.0);
+        }
+
+        static bool buffersMatch (const ValueType* d1, const ValueType* d2, int num, ValueType tolerance)
+        {
+            while (--num >= 0)
+                if (std::abs (*d1++ - *d2++) > tolerance)
+                    return false;
+
+            return true;
+        }
+    };
+
+    // Plain loops for the level comparison to check against. These round after every
+    // operation, just like the SSE code does.
+    template <typename ValueType>
+    struct ReferenceVectorOps
+    {
+        using Type = ValueType;
+
+        static void fill (Type* dest, Type value, int num)                         { for (int i = 0; i < num; ++i) dest[i] = value; }
+        static void add (Type* dest, Type amount, int num)                         { for (int i = 0; i < num; ++i) dest[i] += amount; }
+        static void add (Type* dest, const Type* src, Type amount, int num)        { for (int i = 0; i < num; ++i) dest[i] = src[i] + amount; }
+        static void add (Type* dest, const Type* src, int num)                     { for (int i = 0; i < num; ++i) dest[i] += src[i]; }
+        static void add (Type* dest, const Type* src1, const Type* src2, int num)  { for (int i = 0; i < num; ++i) dest[i] = src1[i] + src2[i]; }
+        static void subtract (Type* dest, const Type* src, int num)                { for (int i = 0; i < num; ++i) dest[i] -= src[i]; }
+        static void subtract (Type* dest, const Type* src1, const Type* src2, int num)  { for (int i = 0; i < num; ++i) dest[i] = src1[i] - src2[i]; }
+        static void multiply (Type* dest, const Type* src, int num)                { for (int i = 0; i < num; ++i) dest[i] *= src[i]; }
+        static void multiply (Type* dest, const Type* src1, const Type* src2, int num)  { for (int i = 0; i < num; ++i) dest[i] = src1[i] * src2[i]; }
+        static void multiply (Type* dest, Type multiplier, int num)                { for (int i = 0; i < num; ++i) dest[i] *= multiplier; }
+        static void multiply (Type* dest, const Type* src, Type multiplier, int num)    { for (int i = 0; i < num; ++i) dest[i] = src[i] * multiplier; }
+        static void abs (Type* dest, const Type* src, Type, int num)               { for (int i = 0; i < num; ++i) dest[i] = std::abs (src[i]); }
+        static void min (Type* dest, const Type* src, Type comp, int num)          { for (int i = 0; i < num; ++i) dest[i] = jmin (src[i], comp); }
+        static void min (Type* dest, const Type* src1, const Type* src2, int num)  { for (int i = 0; i < num; ++i) dest[i] = jmin (src1[i], src2[i]); }
+        static void max (Type* dest, const Type* src, Type comp, int num)          { for (int i = 0; i < num; ++i) dest[i] = jmax (src[i], comp); }
+        static void max (Type* dest, const Type* src1, const Type* src2, int num)  { for (int i = 0; i < num; ++i) dest[i] = jmax (src1[i], src2[i]); }
+        static void clip (Type* dest, const Type* src, Type low, Type high, int num)    { for (int i = 0; i < num; ++i) dest[i] = jlimit (low, high, src[i]); }
+        static void convertFixedToFloat (Type* dest, const int* src, Type multiplier, int num)  { for (int i = 0; i < num; ++i) dest[i] = (Type) src[i] * multiplier; }
+
+        static void addWithMultiply (Type* dest, const Type* src, Type multiplier, int num)       { for (int i = 0; i < num; ++i) dest[i] += src[i] * multiplier; }
+        static void addWithMultiply (Type* dest, const Type* src1, const Type* src2, int num)     { for (int i = 0; i < num; ++i) dest[i] += src1[i] * src2[i]; }
+        static void subtractWithMultiply (Type* dest, const Type* src, Type multiplier, int num)  { for (int i = 0; i < num; ++i) dest[i] -= src[i] * multiplier; }
+        static void subtractWithMultiply (Type* dest, const Type* src1, const Type* src2, int num){ for (int i = 0; i < num; ++i) dest[i] -= src1[i] * src2[i]; }
+
+        static Range<Type> findMinAndMax (const Type* src, int num)                { return Range<Type>::findMinAndMax (src, num); }
+        static Type findMinOrMax (const Type* src, int num, bool isMinimum)        { return isMinimum ? juce::findMinimum (src, num) : juce::findMaximum (src, num); }
+    };
+
+    // Runs the same operations through each level's VectorOps, and checks that the AVX2 and
+    // AVX-512 results agree with the reference loops. They should be identical, except for
+    // the fused multiply-adds, which only round once. This calls the implementations directly
+    // rather than going through the public functions, which always use the level that was
+    // picked at startup.
+    template <typename ValueType>
+    struct LevelComparisonRunner
+    {
+        struct Results
+        {
+            Array<ValueType> exact, fused;
+        };
+
+        struct Inputs
+        {
+            Inputs (Random& random, int n)  : num (n), src1 (n), src2 (n), ints (n)
+            {
+                WideTestRunner<ReferenceVectorOps<ValueType>>::fillRandomly (random, src1, num);
+                WideTestRunner<ReferenceVectorOps<ValueType>>::fillRandomly (random, src2, num);
+
+                for (int i = 0; i < num; ++i)
+                    ints[i] = random.nextInt (2000000) - 1000000;
+            }
+
+            const int num;
+            HeapBlock<ValueType> src1, src2;
+            HeapBlock<int> ints;
+        };
+
+        template <typename VectorOps>
+        static Results collectResults (const Inputs& in)
+        {
+            const int num = in.num;
+            const ValueType* src1 = in.src1;
+            const ValueType* src2 = in.src2;
+            HeapBlock<ValueType> dest (num);
+            Results r;
+
+            auto addDest = [&] (Array<ValueType>& results) { results.addArray (dest.get(), num); };
+            const auto signMask = getSignMask (ValueType());
+
+            VectorOps::fill (dest, (ValueType) 1.5, num);                    addDest (r.exact);
+            VectorOps::add (dest, src1, src2, num);                          addDest (r.exact);
+            VectorOps::add (dest, src1, (ValueType) 3, num);                 addDest (r.exact);
+            VectorOps::add (dest, (ValueType) -7, num);                      addDest (r.exact);
+            VectorOps::add (dest, src2, num);                                addDest (r.exact);
+            VectorOps::subtract (dest, src1, src2, num);                     addDest (r.exact);
+            VectorOps::subtract (dest, src1, num);                           addDest (r.exact);
+            VectorOps::multiply (dest, src1, src2, num);                     addDest (r.exact);
+            VectorOps::multiply (dest, src1, (ValueType) 0.3, num);          addDest (r.exact);
+            VectorOps::multiply (dest, src2, num);                           addDest (r.exact);
+            VectorOps::multiply (dest, (ValueType) 1.1, num);                addDest (r.exact);
+            VectorOps::abs (dest, src1, signMask, num);                      addDest (r.exact);
+            VectorOps::min (dest, src1, src2, num);                          addDest (r.exact);
+            VectorOps::min (dest, src1, (ValueType) 10, num);                addDest (r.exact);
+            VectorOps::max (dest, src1, src2, num);                          addDest (r.exact);
+            VectorOps::max (dest, src2, (ValueType) -10, num);               addDest (r.exact);
+            VectorOps::clip (dest, src1, (ValueType) -100, (ValueType) 200, num);  addDest (r.exact);
+            convertFixedToFloat<VectorOps> (r.exact, dest, in.ints, num);
+
+            auto range = VectorOps::findMinAndMax (src1, num);
+            r.exact.add (range.getStart(), range.getEnd(),
+                         VectorOps::findMinOrMax (src2, num, true),
+                         VectorOps::findMinOrMax (src2, num, false));
+
+            FloatVectorOperations::copy (dest, src1, num);
+            VectorOps::addWithMultiply (dest, src2, (ValueType) 0.7, num);       addDest (r.fused);
+            VectorOps::addWithMultiply (dest, src1, src2, num);                  addDest (r.fused);
+            VectorOps::subtractWithMultiply (dest, src2, (ValueType) 0.7, num);  addDest (r.fused);
+            VectorOps::subtractWithMultiply (dest, src1, src2, num);             addDest (r.fused);
+
+            return r;
+        }
+
+        // the abs functions take a mask that clears the sign bit, like the public ones use
+        static float getSignMask (float)
+        {
+            FloatVectorHelpers::signMask32 signMask;
+            signMask.i = 0x7fffffffUL;
+            return signMask.f;
+        }
+
+        static double getSignMask (double)
+        {
+            FloatVectorHelpers::signMask64 signMask;
+            signMask.i = 0x7fffffffffffffffULL;
+            return signMask.d;
+        }
+
+        // there's only a float version of this one
+        template <typename VectorOps>
+        static void convertFixedToFloat (Array<float>& results, float* dest, const int* src, int num)
+        {
+            VectorOps::convertFixedToFloat (dest, src, 1.0f / 1000.0f, num);
+            results.addArray (dest, num);
+        }
+
+        template <typename VectorOps>
+        static void convertFixedToFloat (Array<double>&, double*, const int*, int) {}
+
+        template <typename VectorOps>
+        static void compareWithReference (UnitTest& u, const Inputs& in, const Results& reference)
+        {
+            auto results = collectResults<VectorOps> (in);
+
+            // the values are up to 500, so their products and sums are up to about 2^18
+            const auto tolerance = (ValueType) (1 << 20) * std::numeric_limits<ValueType>::epsilon();
+
+            u.expect (results.exact == reference.exact);
+            u.expect (results.fused.size() == reference.fused.size());
+
+            for (int i = 0; i < reference.fused.size(); ++i)
+                u.expect (std::abs (results.fused[i] - reference.fused[i]) <= tolerance);
+        }
+
+        static void runTest (UnitTest& u, Random random, bool testAVX2, bool testAVX512)
+        {
+            using namespace FloatVectorHelpers;
+
+            const Inputs in (random, random.nextInt (200) + 1);
+            const auto reference = collectResults<ReferenceVectorOps<ValueType>> (in);
+
+            if (testAVX2)
+                compareWithReference<AVX2VectorOps<AVX2Ops<ValueType>>> (u, in, reference);
+
+            if (testAVX512)
+                compareWithReference<AVX512VectorOps<AVX512Ops<ValueType>>> (u, in, reference);
+        }
+    };
+   #endif
+
     void runTest() override
     {
         beginTest ("FloatVectorOperations");
@@ -1292,6 +2012,46 @@ public:
             TestRunner<float>::runTest (*this, getRandom());
             TestRunner<double>::runTest (*this, getRandom());
         }
+
+       #if JUCE_USE_AVX_DISPATCH
+        using namespace FloatVectorHelpers;
+
+        if (SystemStats::hasAVX2() && SystemStats::hasFMA3())
+        {
+            beginTest ("AVX2 operations");
+
+            for (int i = 100; --i >= 0;)
+            {
+                WideTestRunner<AVX2VectorOps<AVX2Ops<float>>>::runTest (*this, getRandom());
+                WideTestRunner<AVX2VectorOps<AVX2Ops<double>>>::runTest (*this, getRandom());
+            }
+        }
+
+        if (SystemStats::hasAVX512F())
+        {
+            beginTest ("AVX-512 operations");
+
+            for (int i = 100; --i >= 0;)
+            {
+                WideTestRunner<AVX512VectorOps<AVX512Ops<float>>>::runTest (*this, getRandom());
+                WideTestRunner<AVX512VectorOps<AVX512Ops<double>>>::runTest (*this, getRandom());
+            }
+        }
+
+        const bool testAVX2   = SystemStats::hasAVX2() && SystemStats::hasFMA3();
+        const bool testAVX512 = SystemStats::hasAVX512F();
+
+        if (testAVX2 || testAVX512)
+        {
+            beginTest ("AVX2 and AVX-512 results agree with the reference");
+
+            for (int i = 100; --i >= 0;)
+            {
+                LevelComparisonRunner<float>::runTest (*this, getRandom(), testAVX2, testAVX512);
+                LevelComparisonRunner<double>::runTest (*this, getRandom(), testAVX2, testAVX512);
+            }
+        }
+       #endif
     }
 };
 
@@ -49,6 +49,17 @@
  #undef JUCE_USE_VDSP_FRAMEWORK
 #endif
 
+#ifndef JUCE_USE_AVX_DISPATCH
+ #if JUCE_USE_SSE_INTRINSICS && ! (JUCE_USE_VDSP_FRAMEWORK || JUCE_MINGW) \
+      && (JUCE_CLANG || (JUCE_GCC && __GNUC__ >= 5) || (JUCE_MSVC && _MSC_VER >= 1910))
+  #define JUCE_USE_AVX_DISPATCH 1
+ #endif
+#endif
+
+#if JUCE_USE_AVX_DISPATCH
+ #include <immintrin.h>
+#endif
+
 #if JUCE_USE_ARM_NEON
  #include <arm_neon.h>
 #endif
@@ -60,6 +71,8 @@
 #include "utilities/juce_IIRFilter.cpp"
 #include "utilities/juce_LagrangeInterpolator.cpp"
 #include "utilities/juce_CatmullRomInterpolator.cpp"
+#include "utilities/juce_MultiChannelInterpolator.cpp"
+#include "utilities/juce_WindowedSincTable.cpp"
 #include "utilities/juce_SmoothedValue.cpp"
 #include "midi/juce_MidiBuffer.cpp"
 #include "midi/juce_MidiFile.cpp"
@@ -67,6 +80,8 @@
 #include "midi/juce_MidiMessage.cpp"
 #include "midi/juce_MidiMessageSequence.cpp"
 #include "midi/juce_MidiRPN.cpp"
+#include "utilities/juce_AudioRenderThreadPool.h"
+#include "synthesisers/juce_ParallelVoiceRenderer.cpp"
 #include "mpe/juce_MPEValue.cpp"
 #include "mpe/juce_MPENote.cpp"
 #include "mpe/juce_MPEZoneLayout.cpp"
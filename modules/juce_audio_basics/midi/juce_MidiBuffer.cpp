@@ -76,24 +76,28 @@ namespace MidiBufferHelpers
         return size;
     }
 
-    static uint8* findEventAfter (uint8* d, uint8* endData, const int samplePosition) noexcept
-    {
-        while (d < endData && getEventTime (d) <= samplePosition)
-            d += getEventTotalSize (d);
-
-        return d;
-    }
 }
 
+//==============================================================================
+struct MidiBuffer::MergeSource
+{
+    const MidiBuffer* buffer;
+    int firstEvent, endEvent, timeDelta;
+};
+
 //==============================================================================
 MidiBuffer::MidiBuffer() noexcept {}
 MidiBuffer::~MidiBuffer() {}
 
-MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept  : data (other.data) {}
+MidiBuffer::MidiBuffer (const MidiBuffer& other) noexcept
+    : data (other.data), eventOffsets (other.eventOffsets)
+{
+}
 
 MidiBuffer& MidiBuffer::operator= (const MidiBuffer& other) noexcept
 {
     data = other.data;
+    eventOffsets = other.eventOffsets;
     return *this;
 }
 
@@ -102,17 +106,71 @@ MidiBuffer::MidiBuffer (const MidiMessage& message) noexcept
     addEvent (message, 0);
 }
 
-void MidiBuffer::swapWith (MidiBuffer& other) noexcept      { data.swapWith (other.data); }
-void MidiBuffer::clear() noexcept                           { data.clearQuick(); }
-void MidiBuffer::ensureSize (size_t minimumNumBytes)        { data.ensureStorageAllocated ((int) minimumNumBytes); }
+void MidiBuffer::swapWith (MidiBuffer& other) noexcept
+{
+    data.swapWith (other.data);
+    eventOffsets.swapWith (other.eventOffsets);
+}
+
+void MidiBuffer::clear() noexcept
+{
+    data.clearQuick();
+    eventOffsets.clearQuick();
+}
+
+void MidiBuffer::ensureSize (size_t minimumNumBytes)
+{
+    data.ensureStorageAllocated ((int) minimumNumBytes);
+
+    // enough index entries for the smallest possible events
+    eventOffsets.ensureStorageAllocated ((int) (minimumNumBytes / (sizeof (int32) + sizeof (uint16) + 1)));
+}
+
 bool MidiBuffer::isEmpty() const noexcept                   { return data.size() == 0; }
 
+int MidiBuffer::getEventTime (int eventIndex) const noexcept
+{
+    return MidiBufferHelpers::getEventTime (data.begin() + eventOffsets.getUnchecked (eventIndex));
+}
+
+int MidiBuffer::findIndexOfFirstEventAfter (int samplePosition) const noexcept
+{
+    int start = 0, end = eventOffsets.size();
+
+    // events are usually added in order, so check for that before searching
+    if (end == 0 || getEventTime (end - 1) <= samplePosition)
+        return end;
+
+    while (start < end)
+    {
+        auto middle = (start + end) / 2;
+
+        if (getEventTime (middle) <= samplePosition)
+            start = middle + 1;
+        else
+            end = middle;
+    }
+
+    return start;
+}
+
 void MidiBuffer::clear (const int startSample, const int numSamples)
 {
-    uint8* const start = MidiBufferHelpers::findEventAfter (data.begin(), data.end(), startSample - 1);
-    uint8* const end   = MidiBufferHelpers::findEventAfter (start,        data.end(), startSample + numSamples - 1);
+    auto firstEvent = findIndexOfFirstEventAfter (startSample - 1);
+    auto endEvent   = findIndexOfFirstEventAfter (startSample + numSamples - 1);
+
+    if (endEvent > firstEvent)
+    {
+        auto startByte = eventOffsets.getUnchecked (firstEvent);
+        auto endByte = endEvent < eventOffsets.size() ? eventOffsets.getUnchecked (endEvent) : data.size();
+        auto numBytesRemoved = endByte - startByte;
 
-    data.removeRange ((int) (start - data.begin()), (int) (end - data.begin()));
+        data.removeRange (startByte, numBytesRemoved);
+        eventOffsets.removeRange (firstEvent, endEvent - firstEvent);
+
+        for (auto* offset = eventOffsets.begin() + firstEvent; offset < eventOffsets.end(); ++offset)
+            *offset -= numBytesRemoved;
+    }
 }
 
 void MidiBuffer::addEvent (const MidiMessage& m, const int sampleNumber)
@@ -126,15 +184,21 @@ void MidiBuffer::addEvent (const void* const newData, const int maxBytes, const
 
     if (numBytes > 0)
     {
-        const size_t newItemSize = (size_t) numBytes + sizeof (int32) + sizeof (uint16);
-        const int offset = (int) (MidiBufferHelpers::findEventAfter (data.begin(), data.end(), sampleNumber) - data.begin());
+        const int newItemSize = numBytes + (int) (sizeof (int32) + sizeof (uint16));
+        const int index = findIndexOfFirstEventAfter (sampleNumber);
+        const int offset = index < eventOffsets.size() ? eventOffsets.getUnchecked (index) : data.size();
 
-        data.insertMultiple (offset, 0, (int) newItemSize);
+        data.insertMultiple (offset, 0, newItemSize);
 
         uint8* const d = data.begin() + offset;
         writeUnaligned<int32>  (d, sampleNumber);
         writeUnaligned<uint16> (d + 4, static_cast<uint16> (numBytes));
         memcpy (d + 6, newData, (size_t) numBytes);
+
+        eventOffsets.insert (index, offset);
+
+        for (auto* o = eventOffsets.begin() + index + 1; o < eventOffsets.end(); ++o)
+            *o += newItemSize;
     }
 }
 
@@ -143,28 +207,128 @@ void MidiBuffer::addEvents (const MidiBuffer& otherBuffer,
                             const int numSamples,
                             const int sampleDeltaToAdd)
 {
-    Iterator i (otherBuffer);
-    i.setNextSamplePosition (startSample);
+    MergeSource source { &otherBuffer,
+                         otherBuffer.findIndexOfFirstEventAfter (startSample - 1),
+                         numSamples < 0 ? otherBuffer.getNumEvents()
+                                        : otherBuffer.findIndexOfFirstEventAfter (startSample + numSamples - 1),
+                         sampleDeltaToAdd };
+
+    mergeEvents (&source, 1);
+}
+
+void MidiBuffer::addEventsFromBuffers (const MidiBuffer* const* buffers, int numBuffers,
+                                       const int startSample, const int numSamples)
+{
+    MergeSource localSources[16];
+    HeapBlock<MergeSource> allocatedSources;
+    auto* sources = localSources;
 
-    const uint8* eventData;
-    int eventSize, position;
+    if (numBuffers > numElementsInArray (localSources))
+    {
+        allocatedSources.malloc (numBuffers);
+        sources = allocatedSources;
+    }
 
-    while (i.getNextEvent (eventData, eventSize, position)
-            && (position < startSample + numSamples || numSamples < 0))
+    for (int i = 0; i < numBuffers; ++i)
     {
-        addEvent (eventData, eventSize, position + sampleDeltaToAdd);
+        auto& b = *buffers[i];
+        sources[i] = { &b,
+                       b.findIndexOfFirstEventAfter (startSample - 1),
+                       numSamples < 0 ? b.getNumEvents()
+                                      : b.findIndexOfFirstEventAfter (startSample + numSamples - 1),
+                       0 };
     }
+
+    mergeEvents (sources, numBuffers);
 }
 
-int MidiBuffer::getNumEvents() const noexcept
+void MidiBuffer::mergeEvents (MergeSource* sources, int numSources)
 {
-    int n = 0;
-    const uint8* const end = data.end();
+    int numNewEvents = 0, numNewBytes = 0;
+
+    for (int i = 0; i < numSources; ++i)
+    {
+        auto& s = sources[i];
+        jassert (s.buffer != this);
+
+        if (s.endEvent > s.firstEvent)
+        {
+            auto& offsets = s.buffer->eventOffsets;
+            auto endByte = s.endEvent < offsets.size() ? offsets.getUnchecked (s.endEvent) : s.buffer->data.size();
+
+            numNewEvents += s.endEvent - s.firstEvent;
+            numNewBytes += endByte - offsets.getUnchecked (s.firstEvent);
+        }
+    }
+
+    if (numNewEvents == 0)
+        return;
+
+    auto numOwnEvents = eventOffsets.size();
+    data.insertMultiple (data.size(), 0, numNewBytes);
+    eventOffsets.insertMultiple (numOwnEvents, 0, numNewEvents);
+
+    // Merge backwards from the end, so that this buffer's own events can be moved
+    // along in-place, and stop once they're the only ones left.
+    auto* dest = data.begin();
+    auto* destOffsets = eventOffsets.begin();
+    auto writePos = data.size();
+    auto writeIndex = eventOffsets.size();
+
+    for (;;)
+    {
+        // find the latest of the remaining events from the other sources - later
+        // sources win ties, as their events have to go after the others
+        int chosenSource = -1, chosenTime = 0;
+
+        for (int i = 0; i < numSources; ++i)
+        {
+            auto& s = sources[i];
+
+            if (s.endEvent > s.firstEvent)
+            {
+                auto time = s.buffer->getEventTime (s.endEvent - 1) + s.timeDelta;
+
+                if (chosenSource < 0 || time >= chosenTime)
+                {
+                    chosenSource = i;
+                    chosenTime = time;
+                }
+            }
+        }
+
+        if (chosenSource < 0)
+            break;
 
-    for (const uint8* d = data.begin(); d < end; ++n)
-        d += MidiBufferHelpers::getEventTotalSize (d);
+        // move along any of our own events that need to go after it
+        while (numOwnEvents > 0)
+        {
+            auto* ownEvent = dest + destOffsets[numOwnEvents - 1];
 
-    return n;
+            if (MidiBufferHelpers::getEventTime (ownEvent) <= chosenTime)
+                break;
+
+            auto ownSize = MidiBufferHelpers::getEventTotalSize (ownEvent);
+            writePos -= ownSize;
+            memmove (dest + writePos, ownEvent, ownSize);
+            destOffsets[--writeIndex] = writePos;
+            --numOwnEvents;
+        }
+
+        auto& s = sources[chosenSource];
+        auto* event = s.buffer->data.begin() + s.buffer->eventOffsets.getUnchecked (--s.endEvent);
+        auto size = MidiBufferHelpers::getEventTotalSize (event);
+
+        writePos -= size;
+        memcpy (dest + writePos, event, size);
+        writeUnaligned<int32> (dest + writePos, chosenTime);
+        destOffsets[--writeIndex] = writePos;
+    }
+}
+
+int MidiBuffer::getNumEvents() const noexcept
+{
+    return eventOffsets.size();
 }
 
 int MidiBuffer::getFirstEventTime() const noexcept
@@ -174,20 +338,7 @@ int MidiBuffer::getFirstEventTime() const noexcept
 
 int MidiBuffer::getLastEventTime() const noexcept
 {
-    if (data.size() == 0)
-        return 0;
-
-    const uint8* const endData = data.end();
-
-    for (const uint8* d = data.begin();;)
-    {
-        const uint8* const nextOne = d + MidiBufferHelpers::getEventTotalSize (d);
-
-        if (nextOne >= endData)
-            return MidiBufferHelpers::getEventTime (d);
-
-        d = nextOne;
-    }
+    return eventOffsets.isEmpty() ? 0 : getEventTime (eventOffsets.size() - 1);
 }
 
 //==============================================================================
@@ -200,11 +351,10 @@ MidiBuffer::Iterator::~Iterator() noexcept{}
 
 void MidiBuffer::Iterator::setNextSamplePosition (const int samplePosition) noexcept
 {
-    data = buffer.data.begin();
-    const uint8* const dataEnd = buffer.data.end();
+    auto index = buffer.findIndexOfFirstEventAfter (samplePosition - 1);
 
-    while (data < dataEnd && MidiBufferHelpers::getEventTime (data) < samplePosition)
-        data += MidiBufferHelpers::getEventTotalSize (data);
+    data = index < buffer.eventOffsets.size() ? buffer.data.begin() + buffer.eventOffsets.getUnchecked (index)
+                                              : buffer.data.end();
 }
 
 bool MidiBuffer::Iterator::getNextEvent (const uint8* &midiData, int& numBytes, int& samplePosition) noexcept
@@ -234,4 +384,218 @@ bool MidiBuffer::Iterator::getNextEvent (MidiMessage& result, int& samplePositio
     return true;
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MidiBufferTests  : public UnitTest
+{
+public:
+    MidiBufferTests() : UnitTest ("MidiBuffer", "Audio") {}
+
+    // A simple list of (time, note number) pairs to check the buffer against
+    using Events = Array<std::pair<int, int>>;
+
+    static void addToEvents (Events& events, int time, int note)
+    {
+        int index = 0;
+
+        while (index < events.size() && events.getReference (index).first <= time)
+            ++index;
+
+        events.insert (index, { time, note });
+    }
+
+    static MidiMessage createEvent (Random& r, int note)
+    {
+        // mix in some sysexes so that the events aren't all the same size
+        if (r.nextInt (5) == 0)
+        {
+            uint8 sysexData[] = { 0x7e, (uint8) note, 1, 2, 3 };
+            return MidiMessage::createSysExMessage (sysexData, 2 + r.nextInt (4));
+        }
+
+        return MidiMessage::noteOn (1, note, (uint8) 100);
+    }
+
+    static int getNoteNumber (const MidiMessage& m)
+    {
+        return m.isSysEx() ? m.getSysExData()[1] : m.getNoteNumber();
+    }
+
+    void fillRandomly (Random& r, MidiBuffer& buffer, Events& events, int numEvents)
+    {
+        for (int i = 0; i < numEvents; ++i)
+        {
+            auto time = r.nextInt (100);
+            auto note = r.nextInt (128);
+            buffer.addEvent (createEvent (r, note), time);
+            addToEvents (events, time, note);
+        }
+    }
+
+    void expectMatches (const MidiBuffer& buffer, const Events& expected)
+    {
+        Events actual;
+        MidiBuffer::Iterator iter (buffer);
+        MidiMessage message;
+        int time;
+
+        while (iter.getNextEvent (message, time))
+            actual.add ({ time, getNoteNumber (message) });
+
+        expect (actual == expected);
+        expectEquals (buffer.getNumEvents(), expected.size());
+        expectEquals (buffer.getLastEventTime(), expected.isEmpty() ? 0 : expected.getLast().first);
+    }
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Adding events keeps them sorted");
+        {
+            MidiBuffer buffer;
+            Events expected;
+            fillRandomly (r, buffer, expected, 300);
+            expectMatches (buffer, expected);
+        }
+
+        beginTest ("Clearing a range");
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                MidiBuffer buffer;
+                Events expected;
+                fillRandomly (r, buffer, expected, 100);
+
+                auto start = r.nextInt (100), num = r.nextInt (50);
+                buffer.clear (start, num);
+
+                expected.removeIf ([=] (const std::pair<int, int>& e) { return e.first >= start && e.first < start + num; });
+                expectMatches (buffer, expected);
+
+                // check that the buffer is still usable afterwards
+                buffer.addEvent (MidiMessage::noteOn (1, 1, (uint8) 100), start);
+                addToEvents (expected, start, 1);
+                expectMatches (buffer, expected);
+            }
+        }
+
+        beginTest ("Iterator positioning");
+        {
+            MidiBuffer buffer;
+            Events expected;
+            fillRandomly (r, buffer, expected, 100);
+
+            for (int position = -1; position <= 101; ++position)
+            {
+                MidiBuffer::Iterator iter (buffer);
+                iter.setNextSamplePosition (position);
+
+                MidiMessage message;
+                int time;
+                int expectedIndex = 0;
+
+                while (expectedIndex < expected.size() && expected.getReference (expectedIndex).first < position)
+                    ++expectedIndex;
+
+                if (iter.getNextEvent (message, time))
+                    expectEquals (time, expected.getReference (expectedIndex).first);
+                else
+                    expectEquals (expectedIndex, expected.size());
+            }
+        }
+
+        beginTest ("Adding a range of events from another buffer");
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                MidiBuffer buffer, other;
+                Events expected, otherEvents;
+                fillRandomly (r, buffer, expected, r.nextInt (50));
+                fillRandomly (r, other, otherEvents, r.nextInt (50));
+
+                auto start = r.nextInt (100), num = r.nextInt (60) - 10, delta = r.nextInt (40) - 20;
+                buffer.addEvents (other, start, num, delta);
+
+                for (auto& e : otherEvents)
+                    if (e.first >= start && (num < 0 || e.first < start + num))
+                        addToEvents (expected, e.first + delta, e.second);
+
+                expectMatches (buffer, expected);
+            }
+        }
+
+        beginTest ("Merging several buffers");
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                MidiBuffer merged, sequential;
+                Events expected;
+                fillRandomly (r, merged, expected, r.nextInt (30));
+                sequential = merged;
+
+                OwnedArray<MidiBuffer> others;
+                Array<const MidiBuffer*> pointers;
+
+                for (int j = r.nextInt (20); --j >= 0;)
+                {
+                    Events unused;
+                    auto* other = others.add (new MidiBuffer());
+                    fillRandomly (r, *other, unused, r.nextInt (30));
+                    pointers.add (other);
+
+                    // adding the events one at a time gives the order that the merge should match
+                    MidiBuffer::Iterator iter (*other);
+                    const uint8* eventData;
+                    int size, time;
+
+                    while (iter.getNextEvent (eventData, size, time))
+                        sequential.addEvent (eventData, size, time);
+                }
+
+                merged.addEventsFromBuffers (pointers.getRawDataPointer(), pointers.size());
+
+                expectEquals (merged.getNumEvents(), sequential.getNumEvents());
+                expect (merged.data == sequential.data);
+            }
+        }
+
+        beginTest ("Merging a range of several buffers");
+        {
+            for (int i = 0; i < 20; ++i)
+            {
+                MidiBuffer merged, sequential;
+                Events expected;
+                fillRandomly (r, merged, expected, r.nextInt (30));
+                sequential = merged;
+
+                OwnedArray<MidiBuffer> others;
+                Array<const MidiBuffer*> pointers;
+                auto startSample = r.nextInt (100);
+                auto numSamples = r.nextInt (100) - 10;
+
+                for (int j = r.nextInt (20); --j >= 0;)
+                {
+                    Events unused;
+                    auto* other = others.add (new MidiBuffer());
+                    fillRandomly (r, *other, unused, r.nextInt (30));
+                    pointers.add (other);
+
+                    sequential.addEvents (*other, startSample, numSamples, 0);
+                }
+
+                merged.addEventsFromBuffers (pointers.getRawDataPointer(), pointers.size(), startSample, numSamples);
+
+                expectEquals (merged.getNumEvents(), sequential.getNumEvents());
+                expect (merged.data == sequential.data);
+            }
+        }
+    }
+};
+
+static MidiBufferTests midiBufferTests;
+
+#endif // JUCE_UNIT_TESTS
+
 } // namespace juce
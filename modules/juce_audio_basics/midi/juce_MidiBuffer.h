@@ -28,7 +28,9 @@ namespace juce
     Holds a sequence of time-stamped midi events.
 
     Analogous to the AudioBuffer, this holds a set of midi events with
-    integer time-stamps. The buffer is kept sorted in order of the time-stamps.
+    integer time-stamps. The buffer is kept sorted in order of the time-stamps,
+    and keeps an index of where each event starts, so finding the events at a
+    given time only needs a binary search.
 
     If you're working with a sequence of midi events that may need to be manipulated
     or read/written to a midi file, then MidiMessageSequence is probably a more
@@ -74,12 +76,7 @@ public:
     */
     bool isEmpty() const noexcept;
 
-    /** Counts the number of events in the buffer.
-
-        This is actually quite a slow operation, as it has to iterate through all
-        the events, so you might prefer to call isEmpty() if that's all you need
-        to know.
-    */
+    /** Returns the number of events in the buffer. */
     int getNumEvents() const noexcept;
 
     /** Adds an event to the buffer.
@@ -134,6 +131,23 @@ public:
                     int numSamples,
                     int sampleDeltaToAdd);
 
+    /** Adds the events from a set of other buffers to this one.
+
+        This gives the same result as calling addEvents (*buffers[i], startSample, numSamples, 0)
+        for each of the buffers in turn - i.e. events with the same time-stamp will be ordered
+        with the ones that were already in this buffer first, followed by those from each of
+        the other buffers in the order that they're given. But rather than inserting the events
+        one at a time, this merges them all in a single pass, so it's much faster when you're
+        combining the midi from lots of sources.
+
+        The startSample and numSamples parameters select the range of events to take from each
+        buffer, in the same way as they do for addEvents(). By default, all the events are added.
+
+        None of the buffers may be this buffer.
+    */
+    void addEventsFromBuffers (const MidiBuffer* const* buffers, int numBuffers,
+                               int startSample = 0, int numSamples = -1);
+
     /** Returns the sample number of the first event in the buffer.
         If the buffer's empty, this will just return 0.
     */
@@ -226,11 +240,22 @@ public:
 
     /** The raw data holding this buffer.
         Obviously access to this data is provided at your own risk. Its internal format could
-        change in future, so don't write code that relies on it!
+        change in future, so don't write code that relies on it! The buffer also keeps an index
+        of the events in this data, so modifying it directly will leave the buffer in an
+        invalid state.
     */
     Array<uint8> data;
 
 private:
+    //==============================================================================
+    struct MergeSource;
+
+    Array<int> eventOffsets;
+
+    int getEventTime (int eventIndex) const noexcept;
+    int findIndexOfFirstEventAfter (int samplePosition) const noexcept;
+    void mergeEvents (MergeSource*, int numSources);
+
     JUCE_LEAK_DETECTOR (MidiBuffer)
 };
 
@@ -260,6 +260,7 @@ void MPESynthesiser::addVoice (MPESynthesiserVoice* const newVoice)
 {
     const ScopedLock sl (voicesLock);
     newVoice->setCurrentSampleRate (getSampleRate());
+    activeVoices.ensureStorageAllocated (voices.size() + 1);
     voices.add (newVoice);
 }
 
@@ -297,6 +298,24 @@ void MPESynthesiser::reduceNumVoices (const int newNumVoices)
     }
 }
 
+void MPESynthesiser::setNumRenderThreads (int numThreads, int maximumBlockSize, int numChannels)
+{
+    std::unique_ptr<ParallelVoiceRenderer> newRenderer;
+
+    if (numThreads > 0)
+        newRenderer.reset (new ParallelVoiceRenderer (numThreads, maximumBlockSize, numChannels));
+
+    {
+        const ScopedLock sl (voicesLock);
+        std::swap (parallelRenderer, newRenderer);
+    }
+}
+
+int MPESynthesiser::getNumRenderThreads() const noexcept
+{
+    return parallelRenderer != nullptr ? parallelRenderer->getNumThreads() : 0;
+}
+
 void MPESynthesiser::turnOffAllVoices (bool allowTailOff)
 {
     // first turn off all voices (it's more efficient to do this immediately
@@ -311,6 +330,9 @@ void MPESynthesiser::turnOffAllVoices (bool allowTailOff)
 //==============================================================================
 void MPESynthesiser::renderNextSubBlock (AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
+    if (parallelRenderer != nullptr)
+        return renderVoicesInParallel (buffer, startSample, numSamples);
+
     for (auto* voice : voices)
     {
         if (voice->isActive())
@@ -320,6 +342,9 @@ void MPESynthesiser::renderNextSubBlock (AudioBuffer<float>& buffer, int startSa
 
 void MPESynthesiser::renderNextSubBlock (AudioBuffer<double>& buffer, int startSample, int numSamples)
 {
+    if (parallelRenderer != nullptr)
+        return renderVoicesInParallel (buffer, startSample, numSamples);
+
     for (auto* voice : voices)
     {
         if (voice->isActive())
@@ -327,4 +352,17 @@ void MPESynthesiser::renderNextSubBlock (AudioBuffer<double>& buffer, int startS
     }
 }
 
+template <typename floatType>
+void MPESynthesiser::renderVoicesInParallel (AudioBuffer<floatType>& buffer, int startSample, int numSamples)
+{
+    activeVoices.clearQuick();
+
+    for (auto* voice : voices)
+        if (voice->isActive())
+            activeVoices.add (voice);
+
+    parallelRenderer->render (buffer, startSample, numSamples,
+                              activeVoices.getRawDataPointer(), activeVoices.size());
+}
+
 } // namespace juce
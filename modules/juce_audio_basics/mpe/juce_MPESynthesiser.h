@@ -115,6 +115,31 @@ public:
     */
     virtual void turnOffAllVoices (bool allowTailOff);
 
+    //==============================================================================
+    /** Makes the synthesiser render its voices in parallel on a set of worker threads.
+
+        If the number of threads is greater than zero, the default renderNextSubBlock()
+        methods will use a ParallelVoiceRenderer to split the active voices between that
+        many real-time worker threads and the calling thread. Pass zero to go back to
+        rendering all the voices on the calling thread, which is the default.
+
+        Only enable this if your voices don't touch any shared state from inside their
+        renderNextBlock() methods. This mustn't be called while the synthesiser is
+        rendering audio, so call it before playback starts, e.g. from prepareToPlay().
+
+        The maximumBlockSize and numChannels are used to pre-allocate the scratch buffers
+        that each thread renders into, so they should match the buffers you'll pass to
+        renderNextBlock() to avoid allocating on the audio thread.
+
+        @see ParallelVoiceRenderer, Synthesiser::setNumRenderThreads
+    */
+    void setNumRenderThreads (int numThreads, int maximumBlockSize = 512, int numChannels = 2);
+
+    /** Returns the number of worker threads used to render the voices.
+        @see setNumRenderThreads
+    */
+    int getNumRenderThreads() const noexcept;
+
     //==============================================================================
     /** If set to true, then the synth will try to take over an existing voice if
         it runs out and needs to play another note.
@@ -306,6 +331,12 @@ private:
     bool shouldStealVoices = false;
     uint32 lastNoteOnCounter = 0;
 
+    std::unique_ptr<ParallelVoiceRenderer> parallelRenderer;
+    Array<MPESynthesiserVoice*> activeVoices;
+
+    template <typename floatType>
+    void renderVoicesInParallel (AudioBuffer<floatType>&, int startSample, int numSamples);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MPESynthesiser)
 };
 
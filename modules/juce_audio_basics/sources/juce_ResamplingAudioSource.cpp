@@ -23,6 +23,50 @@
 namespace juce
 {
 
+//==============================================================================
+/*  The windowed-sinc filter tables only depend on the cutoff frequency, so one set of
+    them is built up front for the whole range of ratios and shared by all the resamplers
+    that use windowed-sinc. Finding the table for a ratio is then just an array lookup,
+    which is safe to do on the audio thread whenever the ratio changes.
+*/
+struct ResamplingAudioSource::SincFilterBank
+{
+    enum
+    {
+        numTaps = 32,
+        numPhases = 256,
+        ratioStepsPerUnit = 16,
+        maxDownSamplingRatio = 4,
+        numTables = (maxDownSamplingRatio - 1) * ratioStepsPerUnit + 1,
+
+        // Higher ratios are clamped to this, so that the history can be allocated up front
+        maxRatio = 64
+    };
+
+    SincFilterBank()
+    {
+        // When down-sampling, the cutoff has to drop below the new Nyquist frequency. The
+        // ratio is rounded up to a fixed step so that only a limited number of tables are needed.
+        for (int i = 0; i < numTables; ++i)
+            tables[i].reset (new WindowedSincTable ((int) numTaps, (int) numPhases,
+                                                    i == 0 ? 0.5 : 0.46 * ratioStepsPerUnit / (i + ratioStepsPerUnit), 8.0));
+    }
+
+    const WindowedSincTable& getForRatio (double ratio) const noexcept
+    {
+        // Above the maximum ratio, the lowest cutoff is used, so there'll be some aliasing
+        auto index = ratio > 1.0 ? jmin ((int) std::ceil (ratio * ratioStepsPerUnit) - ratioStepsPerUnit, numTables - 1)
+                                 : 0;
+
+        return *tables[index];
+    }
+
+    std::unique_ptr<WindowedSincTable> tables[numTables];
+
+    JUCE_DECLARE_NON_COPYABLE (SincFilterBank)
+};
+
+//==============================================================================
 ResamplingAudioSource::ResamplingAudioSource (AudioSource* const inputSource,
                                               const bool deleteInputWhenDeleted,
                                               const int channels)
@@ -48,6 +92,17 @@ void ResamplingAudioSource::setResamplingRatio (const double samplesInPerOutputS
     ratio = jmax (0.0, samplesInPerOutputSample);
 }
 
+void ResamplingAudioSource::setQuality (Quality newQuality)
+{
+    // The shared tables are built here by the first resampler that needs them, and freed
+    // when the last one is deleted, so that this never has to happen while rendering.
+    if (newQuality == Quality::windowedSinc && sincFilterBanks == nullptr)
+        sincFilterBanks.reset (new SharedResourcePointer<SincFilterBank>());
+
+    const SpinLock::ScopedLockType sl (ratioLock);
+    quality = newQuality;
+}
+
 void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double sampleRate)
 {
     const SpinLock::ScopedLockType sl (ratioLock);
@@ -57,6 +112,14 @@ void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double s
 
     buffer.setSize (numChannels, scaledBlockSize + 32);
 
+    // This is allocated whatever the quality, so that switching to windowed-sinc later
+    // doesn't have to allocate on the audio thread. If the ratio goes up after this, the
+    // blocks are rendered in smaller parts, but there's always room for at least one
+    // output sample at the maximum ratio.
+    sincHistory.setSize (numChannels, jmax (scaledBlockSize, (int) SincFilterBank::maxRatio)
+                                        + SincFilterBank::numTaps + 32);
+
+    lastQuality = quality;
     filterStates.calloc (numChannels);
     srcBuffers.calloc (numChannels);
     destBuffers.calloc (numChannels);
@@ -72,21 +135,41 @@ void ResamplingAudioSource::flushBuffers()
     sampsInBuffer = 0;
     subSampleOffset = 0.0;
     resetFilters();
+
+    // start with enough silence before the first input sample to fill the sinc filter's taps
+    sincHistory.clear();
+    sincSamplesInHistory = SincFilterBank::numTaps / 2 - 1;
+    sincPosition = sincSamplesInHistory;
 }
 
 void ResamplingAudioSource::releaseResources()
 {
     input->releaseResources();
     buffer.setSize (numChannels, 0);
+    sincHistory.setSize (numChannels, 0);
 }
 
 void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
 {
     double localRatio;
+    Quality localQuality;
 
     {
         const SpinLock::ScopedLockType sl (ratioLock);
         localRatio = ratio;
+        localQuality = quality;
+    }
+
+    if (localQuality != lastQuality)
+    {
+        flushBuffers();
+        lastQuality = localQuality;
+    }
+
+    if (localQuality == Quality::windowedSinc)
+    {
+        getNextSincBlock (info, localRatio);
+        return;
     }
 
     if (lastRatio != localRatio)
@@ -196,6 +279,78 @@ void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& inf
     jassert (sampsInBuffer >= 0);
 }
 
+void ResamplingAudioSource::getNextSincBlock (const AudioSourceChannelInfo& info, double localRatio)
+{
+    constexpr int numTaps = SincFilterBank::numTaps;
+    constexpr int halfTaps = numTaps / 2;
+
+    const int channelsToProcess = jmin (numChannels, info.buffer->getNumChannels());
+    localRatio = jmin (localRatio, (double) SincFilterBank::maxRatio);
+    auto& filter = (*sincFilterBanks)->getForRatio (localRatio);
+
+    for (int done = 0; done < info.numSamples;)
+    {
+        // The output sample at position p is made from the input samples from (int) p - halfTaps + 1
+        // to (int) p + halfTaps. If the ratio has gone up since prepareToPlay(), the input for the
+        // whole block may not fit into the history, so the block is done in as many parts as needed.
+        // The position is always less than the clamped ratio plus halfTaps, so prepareToPlay()
+        // leaves enough room for at least one output sample.
+        jassert ((int) sincPosition + halfTaps + 2 <= sincHistory.getNumSamples());
+
+        auto spaceLeft = sincHistory.getNumSamples() - halfTaps - 2 - sincPosition;
+        auto maxNumToDo = localRatio > 0 ? 1 + (int) jmin ((double) info.numSamples, spaceLeft / localRatio)
+                                         : info.numSamples;
+        auto numToDo = jmin (info.numSamples - done, maxNumToDo);
+
+        auto lastPosition = sincPosition + (numToDo - 1) * localRatio;
+        auto samplesNeeded = (int) lastPosition + halfTaps + 1;
+
+        if (samplesNeeded > sincSamplesInHistory)
+        {
+            AudioSourceChannelInfo readInfo (&sincHistory, sincSamplesInHistory, samplesNeeded - sincSamplesInHistory);
+            input->getNextAudioBlock (readInfo);
+            sincSamplesInHistory = samplesNeeded;
+        }
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+        {
+            destBuffers[channel] = info.buffer->getWritePointer (channel, info.startSample + done);
+            srcBuffers[channel] = sincHistory.getReadPointer (channel);
+        }
+
+        auto position = sincPosition;
+
+        for (int i = 0; i < numToDo; ++i)
+        {
+            auto index = (int) position;
+            auto alpha = (float) (position - index);
+
+            for (int channel = 0; channel < channelsToProcess; ++channel)
+                destBuffers[channel][i] = filter.getValueAt (srcBuffers[channel] + index, alpha);
+
+            position += localRatio;
+        }
+
+        // drop the input samples that no future output will need
+        auto numToDiscard = jmin ((int) position - halfTaps + 1, sincSamplesInHistory);
+
+        if (numToDiscard > 0)
+        {
+            sincSamplesInHistory -= numToDiscard;
+            position -= numToDiscard;
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                auto* data = sincHistory.getWritePointer (channel);
+                memmove (data, data + numToDiscard, (size_t) sincSamplesInHistory * sizeof (float));
+            }
+        }
+
+        sincPosition = position;
+        done += numToDo;
+    }
+}
+
 void ResamplingAudioSource::createLowPass (const double frequencyRatio)
 {
     const double proportionalRate = (frequencyRatio > 1.0) ? 0.5 / frequencyRatio
@@ -263,4 +418,162 @@ void ResamplingAudioSource::applyFilter (float* samples, int num, FilterState& f
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ResamplingAudioSourceTests  : public UnitTest
+{
+public:
+    ResamplingAudioSourceTests() : UnitTest ("ResamplingAudioSource", "Audio") {}
+
+    struct NoiseSource  : public AudioSource
+    {
+        void prepareToPlay (int, double) override {}
+        void releaseResources() override {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            for (int ch = 0; ch < info.buffer->getNumChannels(); ++ch)
+                for (int i = 0; i < info.numSamples; ++i)
+                    info.buffer->setSample (ch, info.startSample + i, random.nextFloat() * 2.0f - 1.0f);
+
+
+            for (int i = 0; i < info.numSamples; ++i)
+                history.add (info.buffer->getSample (0, info.startSample + i));
+        }
+
+        Random random { 1234 };
+        Array<float> history;
+    };
+
+    static AudioBuffer<float> render (ResamplingAudioSource& source, int numChannels, int numSamples)
+    {
+        AudioBuffer<float> output (numChannels, numSamples);
+        const int blockSizes[] = { 512, 1, 37, 128, 300 };
+
+        for (int pos = 0, block = 0; pos < numSamples; ++block)
+        {
+            auto num = jmin (blockSizes[block % numElementsInArray (blockSizes)], numSamples - pos);
+            source.getNextAudioBlock (AudioSourceChannelInfo (&output, pos, num));
+            pos += num;
+        }
+
+        return output;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Windowed-sinc with a ratio of 1 passes the input through");
+        {
+            auto* noise = new NoiseSource();
+            ResamplingAudioSource resampler (noise, true, 2);
+            resampler.setQuality (ResamplingAudioSource::Quality::windowedSinc);
+            resampler.prepareToPlay (512, 44100.0);
+
+            auto output = render (resampler, 2, 4000);
+
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                expectWithinAbsoluteError (output.getSample (0, i), noise->history[i], 1.0e-6f);
+        }
+
+        beginTest ("Windowed-sinc up-sampling");
+        {
+            auto* tone = new ToneGeneratorAudioSource();
+            tone->setFrequency (1000.0);
+
+            ResamplingAudioSource resampler (tone, true, 2);
+            resampler.setQuality (ResamplingAudioSource::Quality::windowedSinc);
+            resampler.setResamplingRatio (0.37);
+            resampler.prepareToPlay (512, 44100.0);
+
+            auto output = render (resampler, 2, 8000);
+            auto phasePerSample = MathConstants<double>::twoPi * 1000.0 / 44100.0;
+            float maxError = 0;
+
+            for (int i = 64; i < output.getNumSamples(); ++i)
+                for (int ch = 0; ch < 2; ++ch)
+                    maxError = jmax (maxError, std::abs (output.getSample (ch, i) - 0.5f * (float) std::sin (i * phasePerSample)));
+
+            expectLessThan (maxError, 1.0e-3f);
+        }
+
+        beginTest ("Windowed-sinc down-sampling removes frequencies above the new Nyquist");
+        {
+            auto* tone = new ToneGeneratorAudioSource();
+            tone->setFrequency (30000.0);
+
+            ResamplingAudioSource resampler (tone, true, 1);
+            resampler.setQuality (ResamplingAudioSource::Quality::windowedSinc);
+            resampler.setResamplingRatio (2.0);
+            resampler.prepareToPlay (512, 44100.0);
+
+            auto output = render (resampler, 1, 8000);
+            expectLessThan (output.getRMSLevel (0, 64, output.getNumSamples() - 64), 0.005f);
+        }
+
+        beginTest ("Windowed-sinc down-sampling beyond the largest table's ratio");
+        {
+            auto* tone = new ToneGeneratorAudioSource();
+            tone->setFrequency (30000.0);
+
+            ResamplingAudioSource resampler (tone, true, 1);
+            resampler.setQuality (ResamplingAudioSource::Quality::windowedSinc);
+            resampler.prepareToPlay (512, 44100.0);
+            resampler.setResamplingRatio (6.0);
+
+            auto output = render (resampler, 1, 8000);
+            expectLessThan (output.getRMSLevel (0, 64, output.getNumSamples() - 64), 0.005f);
+        }
+
+        beginTest ("Windowed-sinc output doesn't change when the ratio goes up after prepareToPlay");
+        {
+            auto renderWithRatio = [] (double ratioWhenPrepared)
+            {
+                ResamplingAudioSource resampler (new NoiseSource(), true, 1);
+                resampler.setQuality (ResamplingAudioSource::Quality::windowedSinc);
+                resampler.setResamplingRatio (ratioWhenPrepared);
+                resampler.prepareToPlay (512, 44100.0);
+                resampler.setResamplingRatio (3.3);
+
+                return render (resampler, 1, 8000);
+            };
+
+            auto expected = renderWithRatio (3.3);
+            auto output = renderWithRatio (0.25);
+            float maxError = 0;
+
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                maxError = jmax (maxError, std::abs (output.getSample (0, i) - expected.getSample (0, i)));
+
+            expectLessThan (maxError, 1.0e-5f);
+        }
+
+        beginTest ("Windowed-sinc clamps ratios above the maximum");
+        {
+            auto renderWithRatio = [] (double newRatio)
+            {
+                ResamplingAudioSource resampler (new NoiseSource(), true, 1);
+                resampler.setQuality (ResamplingAudioSource::Quality::windowedSinc);
+                resampler.prepareToPlay (512, 44100.0);
+                resampler.setResamplingRatio (newRatio);
+
+                return render (resampler, 1, 2000);
+            };
+
+            auto expected = renderWithRatio (64.0);
+            auto output = renderWithRatio (1000.0);
+            float maxError = 0;
+
+            for (int i = 0; i < output.getNumSamples(); ++i)
+                maxError = jmax (maxError, std::abs (output.getSample (0, i) - expected.getSample (0, i)));
+
+            expectEquals (maxError, 0.0f);
+        }
+    }
+};
+
+static ResamplingAudioSourceTests resamplingAudioSourceTests;
+
+#endif // JUCE_UNIT_TESTS
+
 } // namespace juce
@@ -27,6 +27,10 @@ namespace juce
 /**
     A type of AudioSource that takes an input source and changes its sample rate.
 
+    By default it uses linear interpolation, which is cheap but adds some audible
+    aliasing. For better quality, use setQuality() to switch to a windowed-sinc
+    filter instead.
+
     @see AudioSource, LagrangeInterpolator, CatmullRomInterpolator
 
     @tags{Audio}
@@ -68,6 +72,36 @@ public:
     /** Clears any buffers and filters that the resampler is using. */
     void flushBuffers();
 
+    //==============================================================================
+    /** The methods that a ResamplingAudioSource can use to interpolate its input. */
+    enum class Quality
+    {
+        /** Linear interpolation, with a simple IIR low-pass filter to reduce aliasing. */
+        linear,
+
+        /** A 32-tap polyphase windowed-sinc filter. This sounds much cleaner than linear
+            interpolation, and as its filter tables are shared between all the resamplers,
+            it's still cheap enough to use on lots of streams. When down-sampling by more
+            than a ratio of 4, some aliasing will creep back in, and ratios above 64 are
+            treated as 64.
+        */
+        windowedSinc
+    };
+
+    /** Changes the interpolation method.
+
+        This can be called while the source is running, but the resampler's buffers will be
+        flushed when the change takes effect, so there may be a small glitch.
+
+        The first time windowed-sinc is selected, the filter tables are built if no other
+        resampler is already using them, which is slow and allocates memory. So ideally
+        you should choose the quality before you start playing.
+    */
+    void setQuality (Quality newQuality);
+
+    /** Returns the interpolation method that's being used. */
+    Quality getQuality() const noexcept                         { return quality.load(); }
+
     //==============================================================================
     void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
     void releaseResources() override;
@@ -85,6 +119,8 @@ private:
     const int numChannels;
     HeapBlock<float*> destBuffers;
     HeapBlock<const float*> srcBuffers;
+    std::atomic<Quality> quality { Quality::linear };
+    Quality lastQuality = Quality::linear;
 
     void setFilterCoefficients (double c1, double c2, double c3, double c4, double c5, double c6);
     void createLowPass (double proportionalRate);
@@ -99,6 +135,14 @@ private:
 
     void applyFilter (float* samples, int num, FilterState& fs);
 
+    struct SincFilterBank;
+    std::unique_ptr<SharedResourcePointer<SincFilterBank>> sincFilterBanks;
+    AudioBuffer<float> sincHistory;
+    int sincSamplesInHistory = 0;
+    double sincPosition = 0;
+
+    void getNextSincBlock (const AudioSourceChannelInfo&, double ratio);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResamplingAudioSource)
 };
 
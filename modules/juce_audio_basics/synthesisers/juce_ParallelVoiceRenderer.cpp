@@ -0,0 +1,498 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct ParallelVoiceRenderer::Pimpl  : private AudioRenderThreadPool::Job
+{
+    Pimpl (int numWorkerThreads, int maximumBlockSize, int numChannels)
+        : pool (numWorkerThreads, "Voice Render Thread")
+    {
+        for (int i = 0; i <= numWorkerThreads; ++i)
+            groups.add (new Group (numChannels, maximumBlockSize));
+
+        // each group is a task, and none of them depend on each other
+        Array<Array<int>> dependants;
+        dependants.resize (groups.size());
+        setDependencies (dependants);
+    }
+
+    //==============================================================================
+    template <typename FloatType>
+    void render (AudioBuffer<FloatType>& outputAudio, int startSample, int numSamples,
+                 const void* voiceList, int numVoices, RenderFunction<FloatType> renderFunction)
+    {
+        auto numGroupsToUse = jmin (numVoices, groups.size());
+
+        if (numGroupsToUse <= 1)
+        {
+            for (int i = 0; i < numVoices; ++i)
+                renderFunction (voiceList, i, outputAudio, startSample, numSamples);
+
+            return;
+        }
+
+        auto numChannels = outputAudio.getNumChannels();
+
+        for (int g = 0; g < numGroupsToUse; ++g)
+            groups.getUnchecked (g)->ensureSize<FloatType> (numChannels, numSamples);
+
+        setRenderFunction (renderFunction);
+        currentVoiceList = voiceList;
+        currentNumVoices = numVoices;
+        currentNumGroups = numGroupsToUse;
+        currentNumChannels = numChannels;
+        currentNumSamples = numSamples;
+
+        pool.perform (*this);
+
+        for (int g = 0; g < numGroupsToUse; ++g)
+        {
+            auto& scratch = groups.getUnchecked (g)->getBuffer<FloatType>();
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                outputAudio.addFrom (ch, startSample, scratch.getReadPointer (ch), numSamples);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct Group
+    {
+        Group (int numChannels, int numSamples)
+            : floatBuffer (numChannels, numSamples), doubleBuffer (numChannels, numSamples) {}
+
+        template <typename FloatType>
+        AudioBuffer<FloatType>& getBuffer() noexcept;
+
+        template <typename FloatType>
+        void ensureSize (int numChannels, int numSamples)
+        {
+            auto& buffer = getBuffer<FloatType>();
+
+            if (numChannels > buffer.getNumChannels() || numSamples > buffer.getNumSamples())
+                buffer.setSize (jmax (numChannels, buffer.getNumChannels()),
+                                jmax (numSamples, buffer.getNumSamples()));
+        }
+
+        AudioBuffer<float> floatBuffer;
+        AudioBuffer<double> doubleBuffer;
+
+        JUCE_DECLARE_NON_COPYABLE (Group)
+    };
+
+    //==============================================================================
+    void setRenderFunction (RenderFunction<float> f) noexcept     { floatRenderFunction = f;  doubleRenderFunction = nullptr; }
+    void setRenderFunction (RenderFunction<double> f) noexcept    { doubleRenderFunction = f; floatRenderFunction = nullptr; }
+
+    void runTask (int groupIndex) override
+    {
+        // there's a task for every group, but smaller blocks of voices may not use them all
+        if (groupIndex >= currentNumGroups)
+            return;
+
+        if (floatRenderFunction != nullptr)
+            renderGroup (groupIndex, floatRenderFunction);
+        else
+            renderGroup (groupIndex, doubleRenderFunction);
+    }
+
+    template <typename FloatType>
+    void renderGroup (int groupIndex, RenderFunction<FloatType> renderFunction) const
+    {
+        auto& scratch = groups.getUnchecked (groupIndex)->template getBuffer<FloatType>();
+        AudioBuffer<FloatType> region (scratch.getArrayOfWritePointers(), currentNumChannels, currentNumSamples);
+        region.clear();
+
+        auto firstVoice = (currentNumVoices * groupIndex) / currentNumGroups;
+        auto endVoice   = (currentNumVoices * (groupIndex + 1)) / currentNumGroups;
+
+        for (auto i = firstVoice; i < endVoice; ++i)
+            renderFunction (currentVoiceList, i, region, 0, currentNumSamples);
+    }
+
+    //==============================================================================
+    OwnedArray<Group> groups;
+
+    RenderFunction<float> floatRenderFunction = nullptr;
+    RenderFunction<double> doubleRenderFunction = nullptr;
+    const void* currentVoiceList = nullptr;
+    int currentNumVoices = 0, currentNumGroups = 0, currentNumChannels = 0, currentNumSamples = 0;
+
+    // declared last, so that the worker threads are stopped before anything else is deleted
+    AudioRenderThreadPool pool;
+
+    friend class ParallelVoiceRenderer;
+
+    JUCE_DECLARE_NON_COPYABLE (Pimpl)
+};
+
+template <>
+AudioBuffer<float>& ParallelVoiceRenderer::Pimpl::Group::getBuffer<float>() noexcept    { return floatBuffer; }
+
+template <>
+AudioBuffer<double>& ParallelVoiceRenderer::Pimpl::Group::getBuffer<double>() noexcept  { return doubleBuffer; }
+
+//==============================================================================
+ParallelVoiceRenderer::ParallelVoiceRenderer (int numWorkerThreads, int maximumBlockSize, int numChannels)
+    : pimpl (new Pimpl (jmax (0, numWorkerThreads), maximumBlockSize, numChannels))
+{
+}
+
+ParallelVoiceRenderer::~ParallelVoiceRenderer()
+{
+}
+
+int ParallelVoiceRenderer::getNumThreads() const noexcept
+{
+    return pimpl->pool.getNumThreads();
+}
+
+void ParallelVoiceRenderer::renderVoices (AudioBuffer<float>& outputAudio, int startSample, int numSamples,
+                                          const void* voiceList, int numVoices, RenderFunction<float> renderFunction)
+{
+    pimpl->render (outputAudio, startSample, numSamples, voiceList, numVoices, renderFunction);
+}
+
+void ParallelVoiceRenderer::renderVoices (AudioBuffer<double>& outputAudio, int startSample, int numSamples,
+                                          const void* voiceList, int numVoices, RenderFunction<double> renderFunction)
+{
+    pimpl->render (outputAudio, startSample, numSamples, voiceList, numVoices, renderFunction);
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ParallelVoiceRendererTests  : public UnitTest
+{
+public:
+    ParallelVoiceRendererTests() : UnitTest ("ParallelVoiceRenderer", "Audio") {}
+
+    struct TestVoice
+    {
+        template <typename FloatType>
+        void renderNextBlock (AudioBuffer<FloatType>& buffer, int startSample, int numSamples)
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                auto* data = buffer.getWritePointer (ch, startSample);
+
+                for (int i = 0; i < numSamples; ++i)
+                    data[i] += (FloatType) std::sin (0.01 * frequency * (position + i) + ch);
+            }
+
+            position += numSamples;
+            ++numCalls;
+        }
+
+        double frequency = 1.0;
+        int position = 0, numCalls = 0;
+    };
+
+    template <typename FloatType>
+    void checkAgainstSerialRender (int numThreads, int numVoices)
+    {
+        const int numChannels = 2, numSamples = 300, startSample = 17;
+
+        OwnedArray<TestVoice> serialVoices, parallelVoices;
+        Array<TestVoice*> voiceList;
+
+        for (int i = 0; i < numVoices; ++i)
+        {
+            serialVoices.add (new TestVoice())->frequency = i + 1.0;
+            voiceList.add (parallelVoices.add (new TestVoice()));
+            voiceList.getLast()->frequency = i + 1.0;
+        }
+
+        AudioBuffer<FloatType> expected (numChannels, startSample + numSamples);
+        expected.clear();
+
+        for (auto* v : serialVoices)
+            v->renderNextBlock (expected, startSample, numSamples);
+
+        ParallelVoiceRenderer renderer (numThreads, 64, numChannels);
+        expectEquals (renderer.getNumThreads(), numThreads);
+
+        AudioBuffer<FloatType> first (numChannels, startSample + numSamples), second;
+        first.clear();
+        second.makeCopyOf (first);
+
+        renderer.render (first, startSample, numSamples, voiceList.getRawDataPointer(), voiceList.size());
+
+        for (auto* v : parallelVoices)
+            v->position = 0;
+
+        renderer.render (second, startSample, numSamples, voiceList.getRawDataPointer(), voiceList.size());
+
+        for (auto* v : parallelVoices)
+            expectEquals (v->numCalls, 2);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            for (int i = 0; i < startSample; ++i)
+                expectEquals ((double) first.getSample (ch, i), 0.0);
+
+            for (int i = startSample; i < startSample + numSamples; ++i)
+            {
+                expectWithinAbsoluteError ((double) first.getSample (ch, i), (double) expected.getSample (ch, i), 1.0e-4);
+                expect (first.getSample (ch, i) == second.getSample (ch, i));
+            }
+        }
+    }
+
+    //==============================================================================
+    struct SineSound  : public SynthesiserSound
+    {
+        bool appliesToNote (int) override       { return true; }
+        bool appliesToChannel (int) override    { return true; }
+    };
+
+    struct SineOscillator
+    {
+        void start (double frequency, double sampleRate, float velocity)
+        {
+            phase = 0.0;
+            increment = MathConstants<double>::twoPi * frequency / sampleRate;
+            level = 0.1 * velocity;
+        }
+
+        template <typename FloatType>
+        void render (AudioBuffer<FloatType>& buffer, int startSample, int numSamples)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto sample = level * std::sin (phase);
+                phase += increment;
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    buffer.addSample (ch, startSample + i, (FloatType) (sample * (ch + 1)));
+            }
+        }
+
+        double phase = 0.0, increment = 0.0, level = 0.0;
+    };
+
+    struct SineVoice  : public SynthesiserVoice
+    {
+        bool canPlaySound (SynthesiserSound*) override    { return true; }
+
+        void startNote (int midiNoteNumber, float velocity, SynthesiserSound*, int) override
+        {
+            osc.start (MidiMessage::getMidiNoteInHertz (midiNoteNumber), getSampleRate(), velocity);
+            tailSamplesLeft = 0;
+        }
+
+        // The note is cleared straight away, but the voice carries on playing a short tail,
+        // which the parallel renderer mustn't skip.
+        void stopNote (float, bool allowTailOff) override
+        {
+            tailSamplesLeft = allowTailOff ? 300 : 0;
+            clearCurrentNote();
+        }
+
+        void pitchWheelMoved (int) override                 {}
+        void controllerMoved (int, int) override            {}
+
+        void renderNextBlock (AudioBuffer<float>& b, int start, int num) override   { render (b, start, num); }
+        void renderNextBlock (AudioBuffer<double>& b, int start, int num) override  { render (b, start, num); }
+
+        template <typename FloatType>
+        void render (AudioBuffer<FloatType>& buffer, int startSample, int numSamples)
+        {
+            if (isVoiceActive())
+            {
+                osc.render (buffer, startSample, numSamples);
+            }
+            else if (tailSamplesLeft > 0)
+            {
+                auto numToRender = jmin (numSamples, tailSamplesLeft);
+                osc.render (buffer, startSample, numToRender);
+                tailSamplesLeft -= numToRender;
+            }
+        }
+
+        SineOscillator osc;
+        int tailSamplesLeft = 0;
+    };
+
+    struct MPESineVoice  : public MPESynthesiserVoice
+    {
+        void noteStarted() override
+        {
+            auto note = getCurrentlyPlayingNote();
+            osc.start (note.getFrequencyInHertz(), getSampleRate(), note.noteOnVelocity.asUnsignedFloat());
+        }
+
+        void noteStopped (bool) override        { clearCurrentNote(); }
+        void notePressureChanged() override     {}
+        void notePitchbendChanged() override    {}
+        void noteTimbreChanged() override       {}
+        void noteKeyStateChanged() override     {}
+
+        void renderNextBlock (AudioBuffer<float>& b, int start, int num) override   { render (b, start, num); }
+        void renderNextBlock (AudioBuffer<double>& b, int start, int num) override  { render (b, start, num); }
+
+        template <typename FloatType>
+        void render (AudioBuffer<FloatType>& buffer, int startSample, int numSamples)
+        {
+            if (isActive())
+                osc.render (buffer, startSample, numSamples);
+        }
+
+        SineOscillator osc;
+    };
+
+    static MidiBuffer createTestMidi (int numNotes, int numSamples)
+    {
+        MidiBuffer midi;
+
+        for (int i = 0; i < numNotes; ++i)
+        {
+            auto channel = (i % 15) + 2;
+            midi.addEvent (MidiMessage::noteOn (channel, 40 + i * 3, (uint8) (60 + i)), (i * 37) % (numSamples / 2));
+            midi.addEvent (MidiMessage::noteOff (channel, 40 + i * 3), numSamples / 2 + (i * 53) % (numSamples / 2));
+        }
+
+        return midi;
+    }
+
+    template <typename SynthType, typename FloatType>
+    AudioBuffer<FloatType> renderSynth (SynthType& synth, int numThreads, int numChannels)
+    {
+        const int blockSize = 256, numBlocks = 8;
+
+        synth.setCurrentPlaybackSampleRate (44100.0);
+        synth.setNumRenderThreads (numThreads, blockSize, numChannels);
+        expectEquals (synth.getNumRenderThreads(), numThreads);
+
+        auto midi = createTestMidi (12, blockSize * numBlocks / 2);
+
+        AudioBuffer<FloatType> output (numChannels, blockSize * numBlocks);
+        output.clear();
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            MidiBuffer blockMidi;
+            blockMidi.addEvents (midi, block * blockSize, blockSize, -block * blockSize);
+
+            AudioBuffer<FloatType> region (output.getArrayOfWritePointers(), numChannels, block * blockSize, blockSize);
+            synth.renderNextBlock (region, blockMidi, 0, blockSize);
+        }
+
+        return output;
+    }
+
+    template <typename FloatType>
+    void expectBuffersMatch (const AudioBuffer<FloatType>& actual, const AudioBuffer<FloatType>& expected)
+    {
+        expectEquals (actual.getNumChannels(), expected.getNumChannels());
+        expectEquals (actual.getNumSamples(), expected.getNumSamples());
+        expect (expected.getMagnitude (0, expected.getNumSamples()) > (FloatType) 0.1);
+
+        for (int ch = 0; ch < expected.getNumChannels(); ++ch)
+            for (int i = 0; i < expected.getNumSamples(); ++i)
+                expectWithinAbsoluteError ((double) actual.getSample (ch, i), (double) expected.getSample (ch, i), 1.0e-4);
+    }
+
+    template <typename FloatType>
+    void checkSynthesiser (int numThreads, int numChannels)
+    {
+        auto createSynth = []
+        {
+            std::unique_ptr<Synthesiser> synth (new Synthesiser());
+            synth->addSound (new SineSound());
+
+            for (int i = 0; i < 16; ++i)
+                synth->addVoice (new SineVoice());
+
+            return synth;
+        };
+
+        auto serial = createSynth();
+        auto parallel = createSynth();
+
+        auto expected = renderSynth<Synthesiser, FloatType> (*serial, 0, numChannels);
+        expectBuffersMatch (renderSynth<Synthesiser, FloatType> (*parallel, numThreads, numChannels), expected);
+    }
+
+    template <typename FloatType>
+    void checkMPESynthesiser (int numThreads, int numChannels)
+    {
+        auto createSynth = []
+        {
+            std::unique_ptr<MPESynthesiser> synth (new MPESynthesiser());
+            synth->enableLegacyMode();
+
+            for (int i = 0; i < 16; ++i)
+                synth->addVoice (new MPESineVoice());
+
+            return synth;
+        };
+
+        auto serial = createSynth();
+        auto parallel = createSynth();
+
+        auto expected = renderSynth<MPESynthesiser, FloatType> (*serial, 0, numChannels);
+        expectBuffersMatch (renderSynth<MPESynthesiser, FloatType> (*parallel, numThreads, numChannels), expected);
+    }
+
+    void runTest() override
+    {
+        beginTest ("Matches serial rendering");
+        {
+            checkAgainstSerialRender<float> (3, 20);
+            checkAgainstSerialRender<double> (3, 20);
+        }
+
+        beginTest ("Fewer voices than threads");
+        {
+            checkAgainstSerialRender<float> (4, 2);
+            checkAgainstSerialRender<float> (4, 1);
+            checkAgainstSerialRender<float> (2, 0);
+        }
+
+        beginTest ("No worker threads");
+        {
+            checkAgainstSerialRender<float> (0, 5);
+        }
+
+        beginTest ("Synthesiser matches serial rendering");
+        {
+            checkSynthesiser<float> (3, 2);
+            checkSynthesiser<double> (2, 4);
+        }
+
+        beginTest ("MPESynthesiser matches serial rendering");
+        {
+            checkMPESynthesiser<float> (3, 2);
+            checkMPESynthesiser<double> (2, 4);
+        }
+    }
+};
+
+static ParallelVoiceRendererTests parallelVoiceRendererTests;
+
+#endif // JUCE_UNIT_TESTS
+
+} // namespace juce
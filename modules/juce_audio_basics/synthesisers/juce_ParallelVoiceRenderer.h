@@ -0,0 +1,102 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Renders a set of synthesiser voices concurrently on a pool of real-time
+    worker threads.
+
+    The voices passed to render() are split into contiguous groups, one for each
+    worker thread plus one for the calling thread. Each group is rendered into its
+    own scratch buffer, and once they've all finished the scratch buffers are added
+    to the output in group order. The way the voices get divided up only depends on
+    the number of voices and threads, so the output is the same no matter which
+    thread ends up rendering which group, or how long each one takes.
+
+    Synthesiser and MPESynthesiser use this class when you call their
+    setNumRenderThreads() methods, but you can also use it directly from the
+    renderNextSubBlock() method of your own MPESynthesiserBase subclass.
+
+    Voices that are rendered in parallel must not modify any state that they share
+    with other voices from within their renderNextBlock() methods.
+
+    @see Synthesiser::setNumRenderThreads, MPESynthesiser::setNumRenderThreads
+
+    @tags{Audio}
+*/
+class JUCE_API  ParallelVoiceRenderer
+{
+public:
+    //==============================================================================
+    /** Creates a renderer and starts its worker threads.
+
+        The scratch buffers are allocated here for the given number of channels and
+        block size. If render() is later called with a bigger buffer than this, the
+        scratch buffers will be re-allocated on the audio thread.
+    */
+    ParallelVoiceRenderer (int numWorkerThreads,
+                           int maximumBlockSize = 512,
+                           int numChannels = 2);
+
+    /** Destructor. This stops the worker threads. */
+    ~ParallelVoiceRenderer();
+
+    /** Returns the number of worker threads, not counting the thread that calls render(). */
+    int getNumThreads() const noexcept;
+
+    //==============================================================================
+    /** Renders a list of voices and adds their output to a buffer.
+
+        Each voice's renderNextBlock (AudioBuffer<FloatType>&, int, int) method will be
+        called once, either on the calling thread or on one of the worker threads.
+        This method returns once all of the voices have been rendered and mixed
+        into the output buffer.
+    */
+    template <typename VoiceType, typename FloatType>
+    void render (AudioBuffer<FloatType>& outputAudio, int startSample, int numSamples,
+                 VoiceType* const* voicesToRender, int numVoices)
+    {
+        renderVoices (outputAudio, startSample, numSamples, voicesToRender, numVoices,
+                      [] (const void* voiceList, int index, AudioBuffer<FloatType>& buffer, int start, int num)
+                      {
+                          static_cast<VoiceType* const*> (voiceList)[index]->renderNextBlock (buffer, start, num);
+                      });
+    }
+
+private:
+    //==============================================================================
+    template <typename FloatType>
+    using RenderFunction = void (*) (const void*, int, AudioBuffer<FloatType>&, int, int);
+
+    void renderVoices (AudioBuffer<float>&, int, int, const void*, int, RenderFunction<float>);
+    void renderVoices (AudioBuffer<double>&, int, int, const void*, int, RenderFunction<double>);
+
+    struct Pimpl;
+    std::unique_ptr<Pimpl> pimpl;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelVoiceRenderer)
+};
+
+} // namespace juce
@@ -72,8 +72,140 @@ void SynthesiserVoice::renderNextBlock (AudioBuffer<double>& outputBuffer,
     subBuffer.makeCopyOf (tempBuffer, true);
 }
 
+//==============================================================================
+/*  Something that has to be done by the thread that's rendering: either a short midi
+    message, a call to one of the trigger methods, or a new list of voices or sounds, or
+    a new voice renderer, to install.
+*/
+struct Synthesiser::PendingCommand
+{
+    enum Type : uint8
+    {
+        midiEvent,
+        noteOn,
+        noteOff,
+        allNotesOff,
+        pitchWheel,
+        controller,
+        aftertouch,
+        channelPressure,
+        sustainPedal,
+        sostenutoPedal,
+        setVoices,
+        setSounds,
+        setRenderer
+    };
+
+    PendingCommand (Type t = midiEvent, int ch = 0, int num = 0, int val = 0,
+                    float vel = 0, bool f = false, void* obj = nullptr) noexcept
+        : type (t), channel (ch), number (num), value (val), velocity (vel), flag (f), object (obj)
+    {}
+
+    bool installsObject() const noexcept    { return type >= setVoices; }
+
+    Type type;
+    int channel, number, value;
+    float velocity;
+    bool flag;
+    void* object;
+    uint8 midiData[3] = {};
+    uint8 numMidiBytes = 0;
+};
+
+//==============================================================================
+/*  A bounded multiple-producer, single-consumer queue of pending commands.
+
+    Each slot has a sequence number which tells producers whether it's free and the
+    consumer whether it has been filled, so pushing a command is just a compare-and-swap
+    on the write position and popping one needs no atomic read-modify-write at all.
+*/
+struct Synthesiser::PendingEventQueue
+{
+    PendingEventQueue()
+    {
+        for (uint32 i = 0; i < capacity; ++i)
+            slots[i].sequence.store (i, std::memory_order_relaxed);
+    }
+
+    bool push (const PendingCommand& command) noexcept
+    {
+        auto pos = writePosition.load (std::memory_order_relaxed);
+
+        for (;;)
+        {
+            auto& slot = slots[pos & (capacity - 1)];
+            auto difference = (int32) (slot.sequence.load (std::memory_order_acquire) - pos);
+
+            if (difference == 0)
+            {
+                if (writePosition.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+                {
+                    slot.command = command;
+                    slot.sequence.store (pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = writePosition.load (std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // only meaningful while a single thread is pushing
+    bool isFull() const noexcept
+    {
+        auto pos = writePosition.load (std::memory_order_relaxed);
+        return (int32) (slots[pos & (capacity - 1)].sequence.load (std::memory_order_acquire) - pos) < 0;
+    }
+
+    // front() and pop() must only be called by one thread at a time
+    const PendingCommand* front() const noexcept
+    {
+        auto& slot = slots[readPosition & (capacity - 1)];
+
+        if (slot.sequence.load (std::memory_order_acquire) != readPosition + 1)
+            return nullptr;
+
+        return &slot.command;
+    }
+
+    bool pop (PendingCommand& result) noexcept
+    {
+        if (auto* command = front())
+        {
+            result = *command;
+            slots[readPosition & (capacity - 1)].sequence.store (readPosition + capacity, std::memory_order_release);
+            ++readPosition;
+            return true;
+        }
+
+        return false;
+    }
+
+    static constexpr uint32 capacity = 1024;
+
+    struct Slot
+    {
+        std::atomic<uint32> sequence { 0 };
+        PendingCommand command;
+    };
+
+    Slot slots[capacity];
+    std::atomic<uint32> writePosition { 0 };
+    uint32 readPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (PendingEventQueue)
+};
+
 //==============================================================================
 Synthesiser::Synthesiser()
+    : pendingEvents (new PendingEventQueue()),
+      retiredObjects (new PendingEventQueue())
 {
     for (int i = 0; i < numElementsInArray (lastPitchWheelValues); ++i)
         lastPitchWheelValues[i] = 0x2000;
@@ -81,50 +213,191 @@ Synthesiser::Synthesiser()
 
 Synthesiser::~Synthesiser()
 {
+    // Anything that's still queued owns the voices, sounds or renderer that it would have
+    // installed, so install it all, and then delete whatever that replaces.
+    renderThread = nullptr;
+
+    while (pendingEvents->front() != nullptr)
+    {
+        performQueuedCommands();
+        deleteRetiredObjects();
+    }
 }
 
 //==============================================================================
+// The rendering thread sees the voices and sounds that it's rendering, and any other
+// thread sees them as they'll be once everything that has been queued has been installed.
+int Synthesiser::getNumVoices() const noexcept
+{
+    if (renderThread.load() == Thread::getCurrentThreadId())
+        return voices.size();
+
+    const ScopedLock sl (lock);
+    return latestVoices.size();
+}
+
 SynthesiserVoice* Synthesiser::getVoice (const int index) const
 {
+    if (renderThread.load() == Thread::getCurrentThreadId())
+        return voices[index];
+
     const ScopedLock sl (lock);
-    return voices [index];
+    return latestVoices[index];
 }
 
-void Synthesiser::clearVoices()
+int Synthesiser::getNumSounds() const noexcept
 {
+    if (renderThread.load() == Thread::getCurrentThreadId())
+        return sounds.size();
+
     const ScopedLock sl (lock);
-    voices.clear();
+    return latestSounds.size();
 }
 
-SynthesiserVoice* Synthesiser::addVoice (SynthesiserVoice* const newVoice)
+SynthesiserSound::Ptr Synthesiser::getSound (const int index) const noexcept
 {
+    if (renderThread.load() == Thread::getCurrentThreadId())
+        return sounds[index];
+
     const ScopedLock sl (lock);
-    newVoice->setCurrentPlaybackSampleRate (sampleRate);
-    return voices.add (newVoice);
+    return latestSounds[index];
+}
+
+void Synthesiser::clearVoices()
+{
+    {
+        const ScopedLock sl (lock);
+        installVoices ({});
+    }
+
+    deleteRetiredObjects();
+}
+
+SynthesiserVoice* Synthesiser::addVoice (SynthesiserVoice* const newVoice)
+{
+    std::unique_ptr<SynthesiserVoice> voice (newVoice);
+    voice->setCurrentPlaybackSampleRate (sampleRate);
+
+    {
+        const ScopedLock sl (lock);
+        auto newVoices = latestVoices;
+        newVoices.add (newVoice);
+
+        if (installVoices (newVoices))
+            voice.release();
+    }
+
+    deleteRetiredObjects();
+    return voice == nullptr ? newVoice : nullptr;
 }
 
 void Synthesiser::removeVoice (const int index)
 {
-    const ScopedLock sl (lock);
-    voices.remove (index);
+    {
+        const ScopedLock sl (lock);
+        auto newVoices = latestVoices;
+        newVoices.remove (index);
+        installVoices (newVoices);
+    }
+
+    deleteRetiredObjects();
 }
 
 void Synthesiser::clearSounds()
 {
-    const ScopedLock sl (lock);
-    sounds.clear();
+    {
+        const ScopedLock sl (lock);
+        ReferenceCountedArray<SynthesiserSound> noSounds;
+        installSounds (noSounds);
+    }
+
+    deleteRetiredObjects();
 }
 
 SynthesiserSound* Synthesiser::addSound (const SynthesiserSound::Ptr& newSound)
 {
-    const ScopedLock sl (lock);
-    return sounds.add (newSound);
+    bool wasAdded;
+
+    {
+        const ScopedLock sl (lock);
+        ReferenceCountedArray<SynthesiserSound> newSounds;
+        newSounds.addArray (latestSounds);
+        newSounds.add (newSound);
+        wasAdded = installSounds (newSounds);
+    }
+
+    deleteRetiredObjects();
+    return wasAdded ? newSound.get() : nullptr;
 }
 
 void Synthesiser::removeSound (const int index)
 {
-    const ScopedLock sl (lock);
-    sounds.remove (index);
+    {
+        const ScopedLock sl (lock);
+        ReferenceCountedArray<SynthesiserSound> newSounds;
+        newSounds.addArray (latestSounds);
+        newSounds.remove (index);
+        installSounds (newSounds);
+    }
+
+    deleteRetiredObjects();
+}
+
+// The rendering thread swaps the new list in, so it never allocates anything. The list
+// that it replaces comes back through retiredObjects, holding just the voices that have
+// been removed, and is deleted by another thread.
+bool Synthesiser::installVoices (const Array<SynthesiserVoice*>& newVoices)
+{
+    std::unique_ptr<OwnedArray<SynthesiserVoice>> list (new OwnedArray<SynthesiserVoice>());
+    list->addArray (newVoices);
+
+    if (! postCommand (PendingCommand (PendingCommand::setVoices, 0, 0, 0, 0, false, list.get())))
+    {
+        list->clear (false);
+        return false;
+    }
+
+    list.release();
+    latestVoices = newVoices;
+    return true;
+}
+
+bool Synthesiser::installSounds (ReferenceCountedArray<SynthesiserSound>& newSounds)
+{
+    std::unique_ptr<ReferenceCountedArray<SynthesiserSound>> list (new ReferenceCountedArray<SynthesiserSound>());
+    list->addArray (newSounds);
+
+    if (! postCommand (PendingCommand (PendingCommand::setSounds, 0, 0, 0, 0, false, list.get())))
+        return false;
+
+    list.release();
+    latestSounds.swapWith (newSounds);
+    return true;
+}
+
+void Synthesiser::deleteRetiredObjects()
+{
+    OwnedArray<OwnedArray<SynthesiserVoice>> voiceLists;
+    OwnedArray<ReferenceCountedArray<SynthesiserSound>> soundLists;
+    OwnedArray<ParallelVoiceRenderer> renderers;
+
+    {
+        const ScopedLock sl (lock);
+        PendingCommand retired;
+
+        while (retiredObjects->pop (retired))
+        {
+            switch (retired.type)
+            {
+                case PendingCommand::setVoices:     voiceLists.add (static_cast<OwnedArray<SynthesiserVoice>*> (retired.object)); break;
+                case PendingCommand::setSounds:     soundLists.add (static_cast<ReferenceCountedArray<SynthesiserSound>*> (retired.object)); break;
+                case PendingCommand::setRenderer:   renderers.add (static_cast<ParallelVoiceRenderer*> (retired.object)); break;
+                default:                            jassertfalse; break;
+            }
+        }
+    }
+
+    // they're deleted here, after the lock has been released
 }
 
 void Synthesiser::setNoteStealingEnabled (const bool shouldSteal)
@@ -139,18 +412,50 @@ void Synthesiser::setMinimumRenderingSubdivisionSize (int numSamples, bool shoul
     subBlockSubdivisionIsStrict = shouldBeStrict;
 }
 
+void Synthesiser::setNumRenderThreads (int numThreads, int maximumBlockSize, int numChannels)
+{
+    std::unique_ptr<ParallelVoiceRenderer> newRenderer;
+
+    if (numThreads > 0)
+        newRenderer.reset (new ParallelVoiceRenderer (numThreads, maximumBlockSize, numChannels));
+
+    if (postCommand (PendingCommand (PendingCommand::setRenderer, 0, 0, 0, 0, false, newRenderer.get())))
+    {
+        newRenderer.release();
+        numRenderThreads = jmax (0, numThreads);
+    }
+
+    deleteRetiredObjects();
+}
+
+int Synthesiser::getNumRenderThreads() const noexcept
+{
+    return numRenderThreads;
+}
+
 //==============================================================================
 void Synthesiser::setCurrentPlaybackSampleRate (const double newRate)
 {
-    if (sampleRate != newRate)
+    // This is called when playback is being prepared, so anything that's still queued is
+    // performed now, and until the next block is rendered, calls from any thread are
+    // performed straight away again.
+    renderThread = nullptr;
+
     {
         const ScopedLock sl (lock);
-        allNotesOff (0, false);
-        sampleRate = newRate;
+        performQueuedCommands();
 
-        for (auto* voice : voices)
-            voice->setCurrentPlaybackSampleRate (newRate);
+        if (sampleRate != newRate)
+        {
+            performAllNotesOff (0, false);
+            sampleRate = newRate;
+
+            for (auto* voice : voices)
+                voice->setCurrentPlaybackSampleRate (newRate);
+        }
     }
+
+    deleteRetiredObjects();
 }
 
 template <typename floatType>
@@ -170,7 +475,19 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
     int midiEventPos;
     MidiMessage m;
 
-    const ScopedLock sl (lock);
+    auto thisThread = Thread::getCurrentThreadId();
+
+    // Once this thread has started rendering, calls from any other thread get queued
+    // rather than performed, so nothing else touches the voices and the lock isn't needed.
+    // Another thread might have been in the middle of one when rendering started though,
+    // so the first block has to let it finish.
+    if (renderThread.exchange (thisThread) == nullptr)
+    {
+        const ScopedLock sl (lock);
+    }
+
+    performingThread = thisThread;
+    handlePendingCommands();
 
     while (numSamples > 0)
     {
@@ -179,7 +496,7 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
             if (targetChannels > 0)
                 renderVoices (outputAudio, startSample, numSamples);
 
-            return;
+            break;
         }
 
         const int samplesToNextMidiMessage = midiEventPos - startSample;
@@ -211,6 +528,8 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
 
     while (midiIterator.getNextEvent (m, midiEventPos))
         handleMidiEvent (m);
+
+    performingThread = nullptr;
 }
 
 // explicit template instantiation
@@ -231,16 +550,31 @@ void Synthesiser::renderNextBlock (AudioBuffer<double>& outputAudio, const MidiB
 
 void Synthesiser::renderVoices (AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
+    if (parallelRenderer != nullptr)
+        return renderVoicesInParallel (buffer, startSample, numSamples);
+
     for (auto* voice : voices)
         voice->renderNextBlock (buffer, startSample, numSamples);
 }
 
 void Synthesiser::renderVoices (AudioBuffer<double>& buffer, int startSample, int numSamples)
 {
+    if (parallelRenderer != nullptr)
+        return renderVoicesInParallel (buffer, startSample, numSamples);
+
     for (auto* voice : voices)
         voice->renderNextBlock (buffer, startSample, numSamples);
 }
 
+template <typename floatType>
+void Synthesiser::renderVoicesInParallel (AudioBuffer<floatType>& buffer, int startSample, int numSamples)
+{
+    // every voice is rendered, like in the serial path, as a voice may still be playing
+    // a tail after clearCurrentNote() has been called
+    parallelRenderer->render (buffer, startSample, numSamples,
+                              voices.getRawDataPointer(), voices.size());
+}
+
 void Synthesiser::handleMidiEvent (const MidiMessage& m)
 {
     const int channel = m.getChannel();
@@ -281,13 +615,132 @@ void Synthesiser::handleMidiEvent (const MidiMessage& m)
     }
 }
 
+bool Synthesiser::queueMidiEvent (const MidiMessage& message) noexcept
+{
+    auto numBytes = message.getRawDataSize();
+
+    if (numBytes <= 0 || numBytes > 3)
+    {
+        jassertfalse; // only short messages can be queued
+        return false;
+    }
+
+    PendingCommand command;
+    memcpy (command.midiData, message.getRawData(), (size_t) numBytes);
+    command.numMidiBytes = (uint8) numBytes;
+
+    return pendingEvents->push (command);
+}
+
+bool Synthesiser::postCommand (const PendingCommand& command)
+{
+    if (! pendingEvents->push (command))
+    {
+        // The queue is full, so this call has been dropped! Either the audio thread has
+        // stopped calling renderNextBlock() without setCurrentPlaybackSampleRate() being
+        // called again, or it's being sent more calls than it can handle between blocks.
+        jassertfalse;
+        return false;
+    }
+
+    // Until the synth is being rendered, the command is performed straight away, along
+    // with anything that was queued before it.
+    if (renderThread.load() == nullptr)
+        performQueuedCommands();
+
+    return true;
+}
+
+void Synthesiser::performQueuedCommands()
+{
+    const ScopedLock sl (lock);
+
+    if (renderThread.load() == nullptr)
+    {
+        auto previousThread = performingThread.exchange (Thread::getCurrentThreadId());
+        handlePendingCommands();
+        performingThread = previousThread;
+    }
+}
+
+bool Synthesiser::isPerformingCommands() const noexcept
+{
+    return performingThread.load() == Thread::getCurrentThreadId();
+}
+
+void Synthesiser::handlePendingCommands()
+{
+    while (auto* next = pendingEvents->front())
+    {
+        // if there's no room to hand back the objects it replaces, it waits for the next block
+        if (next->installsObject() && retiredObjects->isFull())
+            break;
+
+        PendingCommand command;
+        pendingEvents->pop (command);
+
+        switch (command.type)
+        {
+            case PendingCommand::midiEvent:         handleMidiEvent (MidiMessage (command.midiData, (int) command.numMidiBytes)); break;
+            case PendingCommand::noteOn:            performNoteOn (command.channel, command.number, command.velocity); break;
+            case PendingCommand::noteOff:           performNoteOff (command.channel, command.number, command.velocity, command.flag); break;
+            case PendingCommand::allNotesOff:       performAllNotesOff (command.channel, command.flag); break;
+            case PendingCommand::pitchWheel:        performPitchWheel (command.channel, command.value); break;
+            case PendingCommand::controller:        performController (command.channel, command.number, command.value); break;
+            case PendingCommand::aftertouch:        performAftertouch (command.channel, command.number, command.value); break;
+            case PendingCommand::channelPressure:   performChannelPressure (command.channel, command.value); break;
+            case PendingCommand::sustainPedal:      performSustainPedal (command.channel, command.flag); break;
+            case PendingCommand::sostenutoPedal:    performSostenutoPedal (command.channel, command.flag); break;
+
+            case PendingCommand::setVoices:
+            {
+                auto* oldVoices = static_cast<OwnedArray<SynthesiserVoice>*> (command.object);
+                voices.swapWith (*oldVoices);
+
+                // only the voices that have gone will be deleted with the old list
+                for (int i = 0; i < oldVoices->size(); ++i)
+                    if (voices.contains (oldVoices->getUnchecked (i)))
+                        oldVoices->set (i, nullptr, false);
+
+                command.object = oldVoices;
+                break;
+            }
+
+            case PendingCommand::setSounds:
+                sounds.swapWith (*static_cast<ReferenceCountedArray<SynthesiserSound>*> (command.object));
+                break;
+
+            case PendingCommand::setRenderer:
+            {
+                auto* oldRenderer = parallelRenderer.release();
+                parallelRenderer.reset (static_cast<ParallelVoiceRenderer*> (command.object));
+                command.object = oldRenderer;
+                break;
+            }
+
+            default:
+                jassertfalse;
+                break;
+        }
+
+        if (command.installsObject() && command.object != nullptr)
+            retiredObjects->push (command);
+    }
+}
+
 //==============================================================================
 void Synthesiser::noteOn (const int midiChannel,
                           const int midiNoteNumber,
                           const float velocity)
 {
-    const ScopedLock sl (lock);
+    if (isPerformingCommands())
+        performNoteOn (midiChannel, midiNoteNumber, velocity);
+    else
+        postCommand (PendingCommand (PendingCommand::noteOn, midiChannel, midiNoteNumber, 0, velocity));
+}
 
+void Synthesiser::performNoteOn (int midiChannel, int midiNoteNumber, float velocity)
+{
     for (auto* sound : sounds)
     {
         if (sound->appliesToNote (midiNoteNumber) && sound->appliesToChannel (midiChannel))
@@ -343,8 +796,14 @@ void Synthesiser::noteOff (const int midiChannel,
                            const float velocity,
                            const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    if (isPerformingCommands())
+        performNoteOff (midiChannel, midiNoteNumber, velocity, allowTailOff);
+    else
+        postCommand (PendingCommand (PendingCommand::noteOff, midiChannel, midiNoteNumber, 0, velocity, allowTailOff));
+}
 
+void Synthesiser::performNoteOff (int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff)
+{
     for (auto* voice : voices)
     {
         if (voice->getCurrentlyPlayingNote() == midiNoteNumber
@@ -369,8 +828,14 @@ void Synthesiser::noteOff (const int midiChannel,
 
 void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    if (isPerformingCommands())
+        performAllNotesOff (midiChannel, allowTailOff);
+    else
+        postCommand (PendingCommand (PendingCommand::allNotesOff, midiChannel, 0, 0, 0, allowTailOff));
+}
 
+void Synthesiser::performAllNotesOff (int midiChannel, bool allowTailOff)
+{
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
             voice->stopNote (1.0f, allowTailOff);
@@ -380,8 +845,14 @@ void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 
 void Synthesiser::handlePitchWheel (const int midiChannel, const int wheelValue)
 {
-    const ScopedLock sl (lock);
+    if (isPerformingCommands())
+        performPitchWheel (midiChannel, wheelValue);
+    else
+        postCommand (PendingCommand (PendingCommand::pitchWheel, midiChannel, 0, wheelValue));
+}
 
+void Synthesiser::performPitchWheel (int midiChannel, int wheelValue)
+{
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
             voice->pitchWheelMoved (wheelValue);
@@ -390,6 +861,14 @@ void Synthesiser::handlePitchWheel (const int midiChannel, const int wheelValue)
 void Synthesiser::handleController (const int midiChannel,
                                     const int controllerNumber,
                                     const int controllerValue)
+{
+    if (isPerformingCommands())
+        performController (midiChannel, controllerNumber, controllerValue);
+    else
+        postCommand (PendingCommand (PendingCommand::controller, midiChannel, controllerNumber, controllerValue));
+}
+
+void Synthesiser::performController (int midiChannel, int controllerNumber, int controllerValue)
 {
     switch (controllerNumber)
     {
@@ -399,8 +878,6 @@ void Synthesiser::handleController (const int midiChannel,
         default:    break;
     }
 
-    const ScopedLock sl (lock);
-
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
             voice->controllerMoved (controllerNumber, controllerValue);
@@ -408,8 +885,14 @@ void Synthesiser::handleController (const int midiChannel,
 
 void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue)
 {
-    const ScopedLock sl (lock);
+    if (isPerformingCommands())
+        performAftertouch (midiChannel, midiNoteNumber, aftertouchValue);
+    else
+        postCommand (PendingCommand (PendingCommand::aftertouch, midiChannel, midiNoteNumber, aftertouchValue));
+}
 
+void Synthesiser::performAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue)
+{
     for (auto* voice : voices)
         if (voice->getCurrentlyPlayingNote() == midiNoteNumber
               && (midiChannel <= 0 || voice->isPlayingChannel (midiChannel)))
@@ -418,8 +901,14 @@ void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aft
 
 void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureValue)
 {
-    const ScopedLock sl (lock);
+    if (isPerformingCommands())
+        performChannelPressure (midiChannel, channelPressureValue);
+    else
+        postCommand (PendingCommand (PendingCommand::channelPressure, midiChannel, 0, channelPressureValue));
+}
 
+void Synthesiser::performChannelPressure (int midiChannel, int channelPressureValue)
+{
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
             voice->channelPressureChanged (channelPressureValue);
@@ -428,8 +917,15 @@ void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureVal
 void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
 
+    if (isPerformingCommands())
+        performSustainPedal (midiChannel, isDown);
+    else
+        postCommand (PendingCommand (PendingCommand::sustainPedal, midiChannel, 0, 0, 0, isDown));
+}
+
+void Synthesiser::performSustainPedal (int midiChannel, bool isDown)
+{
     if (isDown)
     {
         sustainPedalsDown.setBit (midiChannel);
@@ -458,8 +954,15 @@ void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 void Synthesiser::handleSostenutoPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
 
+    if (isPerformingCommands())
+        performSostenutoPedal (midiChannel, isDown);
+    else
+        postCommand (PendingCommand (PendingCommand::sostenutoPedal, midiChannel, 0, 0, 0, isDown));
+}
+
+void Synthesiser::performSostenutoPedal (int midiChannel, bool isDown)
+{
     for (auto* voice : voices)
     {
         if (voice->isPlayingChannel (midiChannel))
@@ -489,8 +992,6 @@ SynthesiserVoice* Synthesiser::findFreeVoice (SynthesiserSound* soundToPlay,
                                               int midiChannel, int midiNoteNumber,
                                               const bool stealIfNoneAvailable) const
 {
-    const ScopedLock sl (lock);
-
     for (auto* voice : voices)
         if ((! voice->isVoiceActive()) && voice->canPlaySound (soundToPlay))
             return voice;
@@ -583,4 +1084,392 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
     return low;
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SynthesiserEventQueueTests  : public UnitTest
+{
+public:
+    SynthesiserEventQueueTests() : UnitTest ("Synthesiser event queue", "Audio") {}
+
+    struct RecordingSynth  : public Synthesiser
+    {
+        void handleMidiEvent (const MidiMessage& m) override
+        {
+            received.add (m);
+            Synthesiser::handleMidiEvent (m);
+        }
+
+        CriticalSection& getLock() noexcept     { return lock; }
+
+        Array<MidiMessage> received;
+    };
+
+    struct LockHolderThread  : public Thread
+    {
+        LockHolderThread (RecordingSynth& s)  : Thread ("Synth lock holder"), synth (s) {}
+
+        void run() override
+        {
+            const ScopedLock sl (synth.getLock());
+            lockTaken.signal();
+            canRelease.wait (-1);
+        }
+
+        RecordingSynth& synth;
+        WaitableEvent lockTaken, canRelease;
+    };
+
+    // Applies to a single note, so that each note gets its own voice
+    struct SingleNoteSound  : public SynthesiserSound
+    {
+        SingleNoteSound (int n)  : note (n) {}
+
+        bool appliesToNote (int n) override       { return n == note; }
+        bool appliesToChannel (int) override      { return true; }
+
+        int note;
+    };
+
+    // Writes a ramp to channel 0 while it's playing the drone note, and a constant
+    // to channel 1 while it's playing any other one.
+    struct RampVoice  : public SynthesiserVoice
+    {
+        RampVoice (std::atomic<int>& counter)  : numOtherNotesStarted (counter) {}
+
+        bool canPlaySound (SynthesiserSound*) override          { return true; }
+        void stopNote (float, bool) override                    { clearCurrentNote(); }
+        void pitchWheelMoved (int) override                     {}
+        void controllerMoved (int, int) override                {}
+
+        void startNote (int note, float, SynthesiserSound*, int) override
+        {
+            isDrone = (note == droneNote);
+
+            if (! isDrone)
+                ++numOtherNotesStarted;
+        }
+
+        void renderNextBlock (AudioBuffer<float>& buffer, int startSample, int numSamples) override
+        {
+            if (! isVoiceActive())
+                return;
+
+            for (int i = startSample; i < startSample + numSamples; ++i)
+            {
+                if (isDrone)
+                    buffer.addSample (0, i, (float) position++);
+                else
+                    buffer.addSample (1, i, 1.0f);
+            }
+        }
+
+        using SynthesiserVoice::renderNextBlock;
+
+        static constexpr int droneNote = 60;
+        std::atomic<int>& numOtherNotesStarted;
+        bool isDrone = false;
+        int position = 0;
+    };
+
+    struct DeletionTrackingVoice  : public RampVoice
+    {
+        DeletionTrackingVoice (std::atomic<int>& counter, std::atomic<Thread::ThreadID>& t)
+            : RampVoice (counter), deletionThread (t)
+        {}
+
+        ~DeletionTrackingVoice() override   { deletionThread = Thread::getCurrentThreadId(); }
+
+        std::atomic<Thread::ThreadID>& deletionThread;
+    };
+
+    struct NoteHammerThread  : public Thread
+    {
+        NoteHammerThread (Synthesiser& s)  : Thread ("Synth note hammer"), synth (s) {}
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                synth.noteOn (1, 70, 1.0f);
+                synth.noteOff (1, 70, 1.0f, false);
+                started.signal();
+                Thread::yield();
+            }
+        }
+
+        Synthesiser& synth;
+        WaitableEvent started { true };
+    };
+
+    struct RenderThread  : public Thread
+    {
+        RenderThread (Synthesiser& s)  : Thread ("Synth renderer"), synth (s) {}
+
+        void run() override
+        {
+            buffer.clear();
+            synth.renderNextBlock (buffer, {}, 0, buffer.getNumSamples());
+        }
+
+        void renderBlock()
+        {
+            startThread();
+            waitForThreadToExit (-1);
+        }
+
+        Synthesiser& synth;
+        AudioBuffer<float> buffer { 2, 64 };
+    };
+
+    struct ProducerThread  : public Thread
+    {
+        ProducerThread (Synthesiser& s, int ch, int num)
+            : Thread ("Synth event producer"), synth (s), channel (ch), numEvents (num)
+        {}
+
+        void run() override
+        {
+            for (int i = 0; i < numEvents; ++i)
+                if (! synth.queueMidiEvent (MidiMessage::noteOn (channel, i % 128, (uint8) 100)))
+                    ++numFailures;
+        }
+
+        Synthesiser& synth;
+        int channel, numEvents, numFailures = 0;
+    };
+
+    void renderBlock (Synthesiser& synth, const MidiBuffer& midi = {})
+    {
+        AudioBuffer<float> buffer (2, 64);
+        buffer.clear();
+        synth.renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
+    }
+
+    void runTest() override
+    {
+        beginTest ("Queued events are handled before the block's midi");
+        {
+            RecordingSynth synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+
+            expect (synth.queueMidiEvent (MidiMessage::noteOn (1, 60, (uint8) 100)));
+            expect (synth.queueMidiEvent (MidiMessage::noteOff (1, 60)));
+
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::controllerEvent (1, 7, 100), 10);
+            renderBlock (synth, midi);
+
+            expectEquals (synth.received.size(), 3);
+            expect (synth.received[0].isNoteOn());
+            expect (synth.received[1].isNoteOff());
+            expect (synth.received[2].isController());
+
+            renderBlock (synth);
+            expectEquals (synth.received.size(), 3);
+        }
+
+        beginTest ("Notes triggered from another thread don't interrupt rendering");
+        {
+            std::atomic<int> numOtherNotesStarted { 0 };
+
+            Synthesiser synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+            synth.addSound (new SingleNoteSound (RampVoice::droneNote));
+            synth.addSound (new SingleNoteSound (70));
+
+            for (int i = 0; i < 4; ++i)
+                synth.addVoice (new RampVoice (numOtherNotesStarted));
+
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOn (1, RampVoice::droneNote, (uint8) 100), 0);
+
+            AudioBuffer<float> buffer (2, 256);
+            buffer.clear();
+            synth.renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
+
+            NoteHammerThread hammer (synth);
+            hammer.startThread();
+            expect (hammer.started.wait (5000));
+
+            int expectedPosition = 0, numDiscontinuities = 0;
+
+            for (int block = 0; block < 500; ++block)
+            {
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    if (buffer.getSample (0, i) != (float) expectedPosition++)
+                        ++numDiscontinuities;
+
+                buffer.clear();
+                synth.renderNextBlock (buffer, {}, 0, buffer.getNumSamples());
+            }
+
+            hammer.stopThread (5000);
+            expectEquals (numDiscontinuities, 0);
+            expect (numOtherNotesStarted > 0);
+        }
+
+        beginTest ("Voice changes are installed at the start of the next block");
+        {
+            std::atomic<int> numOtherNotesStarted { 0 };
+
+            Synthesiser synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+            synth.addSound (new SingleNoteSound (70));
+
+            RenderThread renderer (synth);
+            renderer.renderBlock();
+
+            expect (synth.addVoice (new RampVoice (numOtherNotesStarted)) != nullptr);
+            synth.noteOn (1, 70, 1.0f);
+            expectEquals (synth.getNumVoices(), 1);
+            expect (synth.getVoice (0) != nullptr);
+            expectEquals (numOtherNotesStarted.load(), 0);
+
+            renderer.renderBlock();
+            expectEquals (numOtherNotesStarted.load(), 1);
+            expectEquals (renderer.buffer.getSample (1, 0), 1.0f);
+
+            synth.removeVoice (0);
+            synth.addSound (new SingleNoteSound (71));
+            expectEquals (synth.getNumVoices(), 0);
+            expectEquals (synth.getNumSounds(), 2);
+
+            renderer.renderBlock();
+            expectEquals (renderer.buffer.getSample (1, 0), 0.0f);
+
+            synth.clearVoices();
+            synth.clearSounds();
+            expectEquals (synth.getNumVoices(), 0);
+            expectEquals (synth.getNumSounds(), 0);
+        }
+
+        beginTest ("Removed voices aren't deleted by the rendering thread");
+        {
+            std::atomic<int> numOtherNotesStarted { 0 };
+            std::atomic<Thread::ThreadID> deletionThread { nullptr };
+
+            Synthesiser synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+            synth.addVoice (new DeletionTrackingVoice (numOtherNotesStarted, deletionThread));
+
+            RenderThread renderer (synth);
+            renderer.renderBlock();
+
+            synth.removeVoice (0);
+            renderer.renderBlock();
+            expect (deletionThread.load() == nullptr);
+
+            synth.clearSounds();
+            expect (deletionThread.load() == Thread::getCurrentThreadId());
+        }
+
+        beginTest ("Rendering doesn't wait for the lock");
+        {
+            std::atomic<int> numOtherNotesStarted { 0 };
+
+            RecordingSynth synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+            synth.addSound (new SingleNoteSound (RampVoice::droneNote));
+            synth.addVoice (new RampVoice (numOtherNotesStarted));
+            renderBlock (synth);
+
+            LockHolderThread holder (synth);
+            holder.startThread();
+            expect (holder.lockTaken.wait (5000));
+
+            expect (synth.queueMidiEvent (MidiMessage::noteOn (1, RampVoice::droneNote, (uint8) 100)));
+
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOff (1, RampVoice::droneNote), 40);
+
+            AudioBuffer<float> buffer (2, 64);
+            buffer.clear();
+            synth.renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
+
+            expectEquals (synth.received.size(), 2);
+            expect (synth.received[0].isNoteOn());
+            expect (synth.received[1].isNoteOff());
+            expectEquals (buffer.getSample (0, 39), 39.0f);
+            expectEquals (buffer.getSample (0, 40), 0.0f);
+
+            holder.canRelease.signal();
+            holder.waitForThreadToExit (-1);
+        }
+
+        beginTest ("Preparing playback again stops queueing");
+        {
+            std::atomic<int> numOtherNotesStarted { 0 };
+
+            Synthesiser synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+            synth.addSound (new SingleNoteSound (70));
+            synth.addVoice (new RampVoice (numOtherNotesStarted));
+
+            RenderThread renderer (synth);
+            renderer.renderBlock();
+
+            synth.noteOn (1, 70, 1.0f);
+            expectEquals (numOtherNotesStarted.load(), 0);
+
+            synth.setCurrentPlaybackSampleRate (48000.0);
+            expectEquals (numOtherNotesStarted.load(), 1);
+
+            synth.noteOn (1, 70, 1.0f);
+            expectEquals (numOtherNotesStarted.load(), 2);
+        }
+
+        beginTest ("Events from several threads");
+        {
+            RecordingSynth synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+
+            const int numThreads = 4, numEventsPerThread = 250;
+            OwnedArray<ProducerThread> producers;
+
+            for (int i = 0; i < numThreads; ++i)
+                producers.add (new ProducerThread (synth, i + 1, numEventsPerThread));
+
+            for (auto* p : producers)
+                p->startThread();
+
+            for (auto* p : producers)
+            {
+                p->waitForThreadToExit (-1);
+                expectEquals (p->numFailures, 0);
+            }
+
+            renderBlock (synth);
+            expectEquals (synth.received.size(), numThreads * numEventsPerThread);
+
+            int nextNote[numThreads] = {};
+
+            for (auto& m : synth.received)
+                expectEquals (m.getNoteNumber(), nextNote[m.getChannel() - 1]++ % 128);
+        }
+
+        beginTest ("Full queue");
+        {
+            RecordingSynth synth;
+            synth.setCurrentPlaybackSampleRate (44100.0);
+
+            int numQueued = 0;
+
+            while (synth.queueMidiEvent (MidiMessage::noteOn (1, numQueued % 128, (uint8) 100)))
+                ++numQueued;
+
+            expectEquals (numQueued, 1024);
+
+            renderBlock (synth);
+            expectEquals (synth.received.size(), numQueued);
+            expect (synth.queueMidiEvent (MidiMessage::allNotesOff (1)));
+        }
+    }
+};
+
+static SynthesiserEventQueueTests synthesiserEventQueueTests;
+
+#endif // JUCE_UNIT_TESTS
+
 } // namespace juce
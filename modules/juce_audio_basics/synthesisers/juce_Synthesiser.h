@@ -301,7 +301,20 @@ private:
     start and stop the voices playing the appropriate sounds.
 
     While it's playing, you can also cause notes to be triggered by calling the noteOn(),
-    noteOff() and other controller methods.
+    noteOff() and other controller methods. Once the synthesiser has started rendering,
+    any of these calls that are made from a thread other than the one that's rendering
+    (e.g. from an on-screen keyboard) are put on a lock-free queue, and take effect at
+    the start of the next block, so the audio thread never has to wait for them. You
+    can also use queueMidiEvent() to queue raw midi messages in the same way.
+
+    Adding or removing voices and sounds, and calling setNumRenderThreads(), works the
+    same way: the audio thread installs the change at the start of its next block without
+    taking a lock or allocating, and whatever gets removed is deleted later by another
+    thread. getNumVoices(), getVoice() and the other getters reflect the change straight
+    away on the thread that made it. Everything is performed in the order it was queued.
+
+    Until the first block has been rendered, and again after setCurrentPlaybackSampleRate()
+    has been called when playback is prepared, all these calls take effect straight away.
 
     Before rendering, be sure to call the setCurrentPlaybackSampleRate() to tell it
     what the target playback rate is. This value is passed on to the voices so that
@@ -325,8 +338,11 @@ public:
     /** Deletes all voices. */
     void clearVoices();
 
-    /** Returns the number of voices that have been added. */
-    int getNumVoices() const noexcept                               { return voices.size(); }
+    /** Returns the number of voices that have been added.
+        On the thread that's rendering, this is the number that it's rendering, which
+        won't include any changes that are still queued.
+    */
+    int getNumVoices() const noexcept;
 
     /** Returns one of the voices that have been added. */
     SynthesiserVoice* getVoice (int index) const;
@@ -338,6 +354,9 @@ public:
         The object passed in will be managed by the synthesiser, which will delete
         it later on when no longer needed. The caller should not retain a pointer to the
         voice.
+
+        If the synthesiser is being rendered and its queue of pending changes is full,
+        the voice is deleted and this returns nullptr.
     */
     SynthesiserVoice* addVoice (SynthesiserVoice* newVoice);
 
@@ -348,16 +367,22 @@ public:
     /** Deletes all sounds. */
     void clearSounds();
 
-    /** Returns the number of sounds that have been added to the synth. */
-    int getNumSounds() const noexcept                               { return sounds.size(); }
+    /** Returns the number of sounds that have been added to the synth.
+        On the thread that's rendering, this is the number that it's using, which
+        won't include any changes that are still queued.
+    */
+    int getNumSounds() const noexcept;
 
     /** Returns one of the sounds. */
-    SynthesiserSound::Ptr getSound (int index) const noexcept       { return sounds[index]; }
+    SynthesiserSound::Ptr getSound (int index) const noexcept;
 
     /** Adds a new sound to the synthesiser.
 
         The object passed in is reference counted, so will be deleted when the
         synthesiser and all voices are no longer using it.
+
+        If the synthesiser is being rendered and its queue of pending changes is full,
+        the sound isn't added and this returns nullptr.
     */
     SynthesiserSound* addSound (const SynthesiserSound::Ptr& newSound);
 
@@ -505,6 +530,21 @@ public:
     virtual void handleProgramChange (int midiChannel,
                                       int programNumber);
 
+    //==============================================================================
+    /** Adds a midi message to a queue of events that will be handled at the start of the
+        next call to renderNextBlock().
+
+        This never takes the synthesiser's lock, so it's safe to call from any thread
+        (including several threads at once) without ever blocking or being blocked by the
+        audio thread. It also never allocates any memory. Unlike the trigger methods, the
+        message is always queued, even if the synth isn't being rendered yet.
+
+        Only short messages of up to 3 bytes can be queued, and the queue can hold up to
+        1024 events between two render callbacks. If the message is too long or the queue
+        is full, the message is dropped and this returns false.
+    */
+    bool queueMidiEvent (const MidiMessage& message) noexcept;
+
     //==============================================================================
     /** Tells the synthesiser what the sample rate is for the audio it's being used to render.
 
@@ -524,6 +564,13 @@ public:
         and these are used to trigger the voices. Note that the startSample offset applies
         both to the audio output buffer and the midi input buffer, so any midi events
         with timestamps outside the specified region will be ignored.
+
+        Any calls that other threads have queued since the last block, including changes
+        to the voices and sounds, are performed before the block's own midi events.
+
+        This never takes the synthesiser's lock, apart from in the first block after
+        setCurrentPlaybackSampleRate(), where it has to wait for any call that another
+        thread was already in the middle of performing.
     */
     void renderNextBlock (AudioBuffer<float>& outputAudio,
                           const MidiBuffer& inputMidi,
@@ -562,9 +609,37 @@ public:
     */
     void setMinimumRenderingSubdivisionSize (int numSamples, bool shouldBeStrict = false) noexcept;
 
+    //==============================================================================
+    /** Makes the synthesiser render its voices in parallel on a set of worker threads.
+
+        By default all the voices are rendered one after the other on the thread that
+        calls renderNextBlock(). If you pass a number of threads greater than zero here,
+        the default renderVoices() method will instead use a ParallelVoiceRenderer to
+        split the voices between that many real-time worker threads and the
+        calling thread. The output is deterministic, but because the voices are summed
+        in groups it won't be bit-identical to the serial rendering.
+
+        Only enable this if your voices don't touch any shared state from inside their
+        renderNextBlock() methods. The maximumBlockSize and numChannels are used to
+        pre-allocate the scratch buffers that each thread renders into, so they should
+        match the buffers you'll pass to renderNextBlock() to avoid allocating on the
+        audio thread.
+
+        @see ParallelVoiceRenderer
+    */
+    void setNumRenderThreads (int numThreads, int maximumBlockSize = 512, int numChannels = 2);
+
+    /** Returns the number of worker threads used to render the voices.
+        @see setNumRenderThreads
+    */
+    int getNumRenderThreads() const noexcept;
+
 protected:
     //==============================================================================
-    /** This is used to control access to the rendering callback and the note trigger methods. */
+    /** This is used to control access to the rendering callback and the note trigger methods.
+        Once the synth is being rendered, only the other threads take it, to serialise their
+        changes to the voices and sounds, so the rendering thread never has to wait for it.
+    */
     CriticalSection lock;
 
     OwnedArray<SynthesiserVoice> voices;
@@ -633,6 +708,39 @@ private:
     bool shouldStealNotes = true;
     BigInteger sustainPedalsDown;
 
+    std::unique_ptr<ParallelVoiceRenderer> parallelRenderer;
+    std::atomic<int> numRenderThreads { 0 };
+
+    // the voices and sounds as they'll be once every queued change has been installed
+    Array<SynthesiserVoice*> latestVoices;
+    ReferenceCountedArray<SynthesiserSound> latestSounds;
+
+    struct PendingCommand;
+    struct PendingEventQueue;
+    std::unique_ptr<PendingEventQueue> pendingEvents, retiredObjects;
+    std::atomic<Thread::ThreadID> renderThread { nullptr }, performingThread { nullptr };
+
+    bool postCommand (const PendingCommand&);
+    void performQueuedCommands();
+    bool isPerformingCommands() const noexcept;
+    void handlePendingCommands();
+    bool installVoices (const Array<SynthesiserVoice*>&);
+    bool installSounds (ReferenceCountedArray<SynthesiserSound>&);
+    void deleteRetiredObjects();
+
+    void performNoteOn (int midiChannel, int midiNoteNumber, float velocity);
+    void performNoteOff (int midiChannel, int midiNoteNumber, float velocity, bool allowTailOff);
+    void performAllNotesOff (int midiChannel, bool allowTailOff);
+    void performPitchWheel (int midiChannel, int wheelValue);
+    void performController (int midiChannel, int controllerNumber, int controllerValue);
+    void performAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue);
+    void performChannelPressure (int midiChannel, int channelPressureValue);
+    void performSustainPedal (int midiChannel, bool isDown);
+    void performSostenutoPedal (int midiChannel, bool isDown);
+
+    template <typename floatType>
+    void renderVoicesInParallel (AudioBuffer<floatType>&, int startSample, int numSamples);
+
     template <typename floatType>
     void processNextBlock (AudioBuffer<floatType>&, const MidiBuffer&, int startSample, int numSamples);
 
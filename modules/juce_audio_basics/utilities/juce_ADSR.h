@@ -124,7 +124,7 @@ public:
     //==============================================================================
     /** Returns the next sample value for an ADSR object.
 
-        @see applyEnvelopeToBuffer
+        @see applyEnvelopeToBuffer, getNextBlock
     */
     float getNextSample()
     {
@@ -170,6 +170,88 @@ public:
         return envelopeVal;
     }
 
+    /** Fills an array with the next numSamples envelope values.
+
+        This produces exactly the same values as calling getNextSample() repeatedly, but
+        the sustain and idle stages are filled with vector operations and the ramps are
+        generated in tight loops, so it's much cheaper when you can process a block of
+        samples at a time.
+
+        @see getNextSample
+    */
+    void getNextBlock (float* destination, int numSamples) noexcept
+    {
+        while (numSamples > 0)
+        {
+            if (currentState == State::idle)
+            {
+                FloatVectorOperations::clear (destination, numSamples);
+                return;
+            }
+
+            if (currentState == State::sustain)
+            {
+                envelopeVal = sustainLevel;
+                FloatVectorOperations::fill (destination, sustainLevel, numSamples);
+                return;
+            }
+
+            if (currentState == State::attack)
+            {
+                while (numSamples > 0)
+                {
+                    --numSamples;
+                    envelopeVal += attackRate;
+
+                    if (envelopeVal >= 1.0f)
+                    {
+                        envelopeVal = 1.0f;
+                        currentState = decayRate > 0.0f ? State::decay : State::sustain;
+                        *destination++ = envelopeVal;
+                        break;
+                    }
+
+                    *destination++ = envelopeVal;
+                }
+            }
+            else if (currentState == State::decay)
+            {
+                while (numSamples > 0)
+                {
+                    --numSamples;
+                    envelopeVal -= decayRate;
+
+                    if (envelopeVal <= sustainLevel)
+                    {
+                        envelopeVal = sustainLevel;
+                        currentState = State::sustain;
+                        *destination++ = envelopeVal;
+                        break;
+                    }
+
+                    *destination++ = envelopeVal;
+                }
+            }
+            else if (currentState == State::release)
+            {
+                while (numSamples > 0)
+                {
+                    --numSamples;
+                    envelopeVal -= releaseRate;
+
+                    if (envelopeVal <= 0.0f)
+                    {
+                        reset();
+                        *destination++ = envelopeVal;
+                        break;
+                    }
+
+                    *destination++ = envelopeVal;
+                }
+            }
+        }
+    }
+
     /** This method will conveniently apply the next numSamples number of envelope values
         to an AudioBuffer.
 
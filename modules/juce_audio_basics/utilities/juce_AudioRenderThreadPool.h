@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/*  A set of real-time worker threads that can run the tasks of a job concurrently.
+    AudioProcessorGraph uses it to render independent branches of its rendering
+    sequence, and ParallelVoiceRenderer uses it to render groups of voices.
+
+    The thread calling perform() also takes part in the work, and perform() only
+    returns once every task in the job has completed.
+
+    This is an internal class, shared by the juce_audio_basics and
+    juce_audio_processors modules.
+*/
+struct AudioRenderThreadPool
+{
+    //==============================================================================
+    /*  A fixed set of tasks, together with the order in which they must be run.
+
+        Everything needed for scheduling is allocated by setDependencies(), so that
+        running the job from the audio thread never allocates or takes a lock.
+        Ready tasks are published into a list which is only ever appended to during
+        a run, so the list can never overflow and needs no wrap-around handling.
+    */
+    struct Job
+    {
+        Job() {}
+        virtual ~Job() {}
+
+        virtual void runTask (int taskIndex) = 0;
+
+        void setDependencies (const Array<Array<int>>& dependantsOfEachTask)
+        {
+            dependants = dependantsOfEachTask;
+            numTasks = dependants.size();
+
+            numDependencies.clearQuick();
+            numDependencies.insertMultiple (0, 0, numTasks);
+
+            for (auto& taskDependants : dependants)
+                for (auto t : taskDependants)
+                    ++numDependencies.getReference (t);
+
+            pendingDependencies.reset (new std::atomic<int>[(size_t) jmax (1, numTasks)]);
+            readyTasks.reset (new std::atomic<int>[(size_t) jmax (1, numTasks)]);
+        }
+
+        int getNumTasks() const noexcept        { return numTasks; }
+
+    private:
+        friend struct AudioRenderThreadPool;
+
+        Array<Array<int>> dependants;
+        Array<int> numDependencies;
+        int numTasks = 0;
+
+        std::unique_ptr<std::atomic<int>[]> pendingDependencies, readyTasks;
+        std::atomic<int> numReady { 0 }, numClaimed { 0 }, numRemaining { 0 };
+
+        void begin() noexcept
+        {
+            numReady = 0;
+            numClaimed = 0;
+            numRemaining = numTasks;
+
+            for (int i = 0; i < numTasks; ++i)
+            {
+                readyTasks[i] = -1;
+                pendingDependencies[i] = numDependencies.getUnchecked (i);
+            }
+
+            for (int i = 0; i < numTasks; ++i)
+                if (numDependencies.getUnchecked (i) == 0)
+                    markAsReady (i);
+        }
+
+        bool isFinished() const noexcept         { return numRemaining.load() == 0; }
+
+        void markAsReady (int taskIndex) noexcept
+        {
+            readyTasks[numReady++].store (taskIndex, std::memory_order_release);
+        }
+
+        bool runNextTask() noexcept
+        {
+            auto slot = numClaimed.load();
+
+            do
+            {
+                if (slot >= numReady.load())
+                    return false;
+            }
+            while (! numClaimed.compare_exchange_weak (slot, slot + 1));
+
+            int taskIndex;
+
+            // the slot has been reserved, but another thread may not have finished writing it yet
+            while ((taskIndex = readyTasks[slot].load (std::memory_order_acquire)) < 0)
+            {}
+
+            runTask (taskIndex);
+
+            for (auto d : dependants.getReference (taskIndex))
+                if (--pendingDependencies[d] == 0)
+                    markAsReady (d);
+
+            --numRemaining;
+            return true;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (Job)
+    };
+
+    //==============================================================================
+    AudioRenderThreadPool (int numThreadsToUse, const String& threadName)
+    {
+        for (int i = 0; i < numThreadsToUse; ++i)
+            workers.add (new WorkerThread (*this, threadName + " " + String (i + 1)));
+
+        for (auto* w : workers)
+            w->startThread (Thread::realtimeAudioPriority);
+    }
+
+    ~AudioRenderThreadPool()
+    {
+        for (auto* w : workers)
+            w->signalThreadShouldExit();
+
+        for (auto* w : workers)
+        {
+            w->notify();
+            w->stopThread (2000);
+        }
+    }
+
+    int getNumThreads() const noexcept      { return workers.size(); }
+
+    void perform (Job& job) noexcept
+    {
+        job.begin();
+        currentJob = &job;
+
+        for (auto* w : workers)
+            w->notify();
+
+        while (! job.isFinished())
+            job.runNextTask();
+
+        currentJob = nullptr;
+
+        // make sure no worker is still looking at the job before it's returned to the caller
+        while (numActiveWorkers.load() > 0)
+        {}
+    }
+
+private:
+    //==============================================================================
+    struct WorkerThread  : public Thread
+    {
+        WorkerThread (AudioRenderThreadPool& p, const String& name)
+            : Thread (name), pool (p)
+        {}
+
+        void run() override
+        {
+            FloatVectorOperations::disableDenormalisedNumberSupport();
+
+            while (! threadShouldExit())
+            {
+                pool.helpWithCurrentJob();
+                wait (-1);
+            }
+        }
+
+        AudioRenderThreadPool& pool;
+
+        JUCE_DECLARE_NON_COPYABLE (WorkerThread)
+    };
+
+    void helpWithCurrentJob() noexcept
+    {
+        ++numActiveWorkers;
+
+        if (auto* job = currentJob.load())
+        {
+            while (! job->isFinished())
+                if (! job->runNextTask())
+                    Thread::yield();
+        }
+
+        --numActiveWorkers;
+    }
+
+    OwnedArray<WorkerThread> workers;
+    std::atomic<Job*> currentJob { nullptr };
+    std::atomic<int> numActiveWorkers { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (AudioRenderThreadPool)
+};
+
+} // namespace juce
@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace MultiChannelInterpolatorHelpers
+{
+    // The weights that each of the last five input samples (newest first) contribute to the output
+    static forcedinline void getLagrangeWeights (float offset, float* weights) noexcept
+    {
+        // distances from the interpolated position to the samples at -2, -1, 0, 1 and 2
+        auto d0 = -2.0f - offset, d1 = -1.0f - offset, d2 = -offset, d3 = 1.0f - offset, d4 = 2.0f - offset;
+        auto d01 = d0 * d1, d34 = d3 * d4;
+
+        weights[4] = d1 * d2 * d34 * (1.0f / 24.0f);
+        weights[3] = d0 * d2 * d34 * (-1.0f / 6.0f);
+        weights[2] = d01 * d34 * (1.0f / 4.0f);
+        weights[1] = d01 * d2 * d4 * (-1.0f / 6.0f);
+        weights[0] = d01 * d2 * d3 * (1.0f / 24.0f);
+    }
+
+    static forcedinline void getCatmullRomWeights (float offset, float* weights) noexcept
+    {
+        auto offset2 = offset * offset;
+        auto offset3 = offset2 * offset;
+
+        weights[0] = 0.5f * (offset3 - offset2);
+        weights[1] = 0.5f * offset + 2.0f * offset2 - 1.5f * offset3;
+        weights[2] = 1.0f - 2.5f * offset2 + 1.5f * offset3;
+        weights[3] = offset2 - 0.5f * (offset + offset3);
+        weights[4] = 0.0f;
+    }
+
+    static forcedinline void writeResult (float* dest, float value, float gain, bool isAdding) noexcept
+    {
+        if (isAdding)
+            *dest += gain * value;
+        else
+            *dest = value;
+    }
+}
+
+//==============================================================================
+MultiChannelInterpolator::MultiChannelInterpolator (Algorithm algorithmToUse, int channels)
+    : algorithm (algorithmToUse),
+      numChannels (channels),
+      numPaddedChannels ((channels + 3) & ~3),
+      history ((size_t) (2 * numHistorySamples * numPaddedChannels))
+{
+    jassert (channels > 0);
+    reset();
+}
+
+MultiChannelInterpolator::~MultiChannelInterpolator() noexcept {}
+
+void MultiChannelInterpolator::reset() noexcept
+{
+    subSamplePos = 1.0;
+    newestSample = 0;
+    history.clear ((size_t) (2 * numHistorySamples * numPaddedChannels));
+}
+
+int MultiChannelInterpolator::process (double actualRatio, const float* const* in, float* const* out, int numOut) noexcept
+{
+    return interpolate (actualRatio, in, out, numOut, 1.0f, false);
+}
+
+int MultiChannelInterpolator::processAdding (double actualRatio, const float* const* in, float* const* out, int numOut, float gain) noexcept
+{
+    return interpolate (actualRatio, in, out, numOut, gain, true);
+}
+
+void MultiChannelInterpolator::pushSample (const float* const* in, int index) noexcept
+{
+    // The history is a ring of frames, each of which holds one sample for every channel.
+    // Every frame is stored twice, so the last five are always contiguous, newest first.
+    newestSample = (newestSample == 0 ? numHistorySamples : newestSample) - 1;
+    auto* frame = history + newestSample * numPaddedChannels;
+    auto* copy = frame + numHistorySamples * numPaddedChannels;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        frame[channel] = copy[channel] = in[channel][index];
+}
+
+int MultiChannelInterpolator::interpolate (double actualRatio, const float* const* in, float* const* out,
+                                           int numOut, float gain, bool isAdding) noexcept
+{
+    using namespace MultiChannelInterpolatorHelpers;
+
+    auto pos = subSamplePos;
+
+    if (actualRatio == 1.0 && pos == 1.0)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            if (isAdding)
+                FloatVectorOperations::addWithMultiply (out[channel], in[channel], gain, numOut);
+            else
+                memcpy (out[channel], in[channel], (size_t) numOut * sizeof (float));
+        }
+
+        for (int i = jmax (0, numOut - (int) numHistorySamples); i < numOut; ++i)
+            pushSample (in, i);
+
+        return numOut;
+    }
+
+    int numUsed = 0;
+    float weights[numHistorySamples];
+
+    for (int i = 0; i < numOut; ++i)
+    {
+        while (pos >= 1.0)
+        {
+            pushSample (in, numUsed++);
+            pos -= 1.0;
+        }
+
+        if (algorithm == Algorithm::lagrange)
+            getLagrangeWeights ((float) pos, weights);
+        else
+            getCatmullRomWeights ((float) pos, weights);
+
+        auto* frames = history + newestSample * numPaddedChannels;
+
+        for (int channel = 0; channel < numPaddedChannels; channel += 4)
+        {
+            float results[4];
+            auto* samples = frames + channel;
+
+           #if JUCE_USE_SSE_INTRINSICS
+            auto sum = _mm_mul_ps (_mm_set1_ps (weights[0]), _mm_loadu_ps (samples));
+
+            for (int j = 1; j < numHistorySamples; ++j)
+                sum = _mm_add_ps (sum, _mm_mul_ps (_mm_set1_ps (weights[j]), _mm_loadu_ps (samples + j * numPaddedChannels)));
+
+            _mm_storeu_ps (results, sum);
+           #elif JUCE_USE_ARM_NEON
+            auto sum = vmulq_n_f32 (vld1q_f32 (samples), weights[0]);
+
+            for (int j = 1; j < numHistorySamples; ++j)
+                sum = vmlaq_n_f32 (sum, vld1q_f32 (samples + j * numPaddedChannels), weights[j]);
+
+            vst1q_f32 (results, sum);
+           #else
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                results[lane] = 0;
+
+                for (int j = 0; j < numHistorySamples; ++j)
+                    results[lane] += weights[j] * samples[j * numPaddedChannels + lane];
+            }
+           #endif
+
+            for (int lane = 0; lane < jmin (4, numChannels - channel); ++lane)
+                writeResult (out[channel + lane] + i, results[lane], gain, isAdding);
+        }
+
+        pos += actualRatio;
+    }
+
+    subSamplePos = pos;
+    return numUsed;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class MultiChannelInterpolatorTests  : public UnitTest
+{
+public:
+    MultiChannelInterpolatorTests() : UnitTest ("MultiChannelInterpolator", "Audio") {}
+
+    template <typename SingleChannelInterpolator>
+    void checkMatchesSingleChannel (MultiChannelInterpolator::Algorithm algorithm, Random& r)
+    {
+        for (auto numChannels : { 1, 3, 4, 7, 16 })
+        {
+            for (auto ratio : { 1.0, 0.3, 0.77, 1.5, 2.3 })
+            {
+                const int numOut = 300;
+                AudioBuffer<float> input (numChannels, (int) (numOut * 3 * ratio) + 10);
+                AudioBuffer<float> expected (numChannels, numOut * 3), actual (numChannels, numOut * 3);
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    for (int i = 0; i < input.getNumSamples(); ++i)
+                        input.setSample (ch, i, r.nextFloat() * 2.0f - 1.0f);
+
+                expected.clear();
+                actual.clear();
+
+                // do three blocks, and use processAdding for the last one
+                OwnedArray<SingleChannelInterpolator> singles;
+                int expectedUsed = 0;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                {
+                    auto* s = singles.add (new SingleChannelInterpolator());
+                    int used = 0;
+
+                    for (int block = 0; block < 3; ++block)
+                    {
+                        auto* src = input.getReadPointer (ch, used);
+                        auto* dest = expected.getWritePointer (ch, block * numOut);
+
+                        used += block < 2 ? s->process (ratio, src, dest, numOut)
+                                          : s->processAdding (ratio, src, dest, numOut, 0.5f);
+                    }
+
+                    expectedUsed = used;
+                }
+
+                MultiChannelInterpolator multi (algorithm, numChannels);
+                int used = 0;
+
+                for (int block = 0; block < 3; ++block)
+                {
+                    HeapBlock<const float*> src (numChannels);
+                    HeapBlock<float*> dest (numChannels);
+
+                    for (int ch = 0; ch < numChannels; ++ch)
+                    {
+                        src[ch] = input.getReadPointer (ch, used);
+                        dest[ch] = actual.getWritePointer (ch, block * numOut);
+                    }
+
+                    used += block < 2 ? multi.process (ratio, src, dest, numOut)
+                                      : multi.processAdding (ratio, src, dest, numOut, 0.5f);
+                }
+
+                expectEquals (used, expectedUsed);
+
+                float maxError = 0;
+
+                for (int ch = 0; ch < numChannels; ++ch)
+                    for (int i = 0; i < actual.getNumSamples(); ++i)
+                        maxError = jmax (maxError, std::abs (actual.getSample (ch, i) - expected.getSample (ch, i)));
+
+                expectLessThan (maxError, 1.0e-5f);
+            }
+        }
+    }
+
+    void runTest() override
+    {
+        auto r = getRandom();
+
+        beginTest ("Lagrange matches LagrangeInterpolator");
+        checkMatchesSingleChannel<LagrangeInterpolator> (MultiChannelInterpolator::Algorithm::lagrange, r);
+
+        beginTest ("Catmull-Rom matches CatmullRomInterpolator");
+        checkMatchesSingleChannel<CatmullRomInterpolator> (MultiChannelInterpolator::Algorithm::catmullRom, r);
+    }
+};
+
+static MultiChannelInterpolatorTests multiChannelInterpolatorTests;
+
+#endif // JUCE_UNIT_TESTS
+
+} // namespace juce
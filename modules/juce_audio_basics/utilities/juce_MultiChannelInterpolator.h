@@ -0,0 +1,121 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+/**
+    Resamples several channels of a stream of floats at once, using either
+    4-point lagrange or Catmull-Rom interpolation.
+
+    This produces the same results as using a separate LagrangeInterpolator or
+    CatmullRomInterpolator for each channel, but as all the channels share the
+    same position, the interpolation coefficients only need to be calculated once
+    for each output sample, and the channels are then processed in groups of four
+    using SIMD instructions where they're available.
+
+    Like the single-channel interpolators, this is stateful, so when there's a break
+    in the continuity of the input stream you should call reset() before feeding it
+    any new data.
+
+    @see LagrangeInterpolator, CatmullRomInterpolator
+
+    @tags{Audio}
+*/
+class JUCE_API  MultiChannelInterpolator
+{
+public:
+    /** The interpolation algorithms that can be used. */
+    enum class Algorithm
+    {
+        lagrange,       /**< The same algorithm as LagrangeInterpolator. */
+        catmullRom      /**< The same algorithm as CatmullRomInterpolator. */
+    };
+
+    /** Creates an interpolator for a given number of channels. */
+    MultiChannelInterpolator (Algorithm algorithm, int numChannels);
+
+    /** Destructor. */
+    ~MultiChannelInterpolator() noexcept;
+
+    /** Returns the number of channels that this interpolator processes. */
+    int getNumChannels() const noexcept             { return numChannels; }
+
+    /** Resets the state of the interpolator.
+        Call this when there's a break in the continuity of the input data stream.
+    */
+    void reset() noexcept;
+
+    /** Resamples a stream of samples.
+
+        @param speedRatio       the number of input samples to use for each output sample
+        @param inputChannels    the source data to read from, one pointer for each channel. Each
+                                channel must contain at least (speedRatio * numOutputSamplesToProduce)
+                                samples.
+        @param outputChannels   the buffers to write the results into, one for each channel
+        @param numOutputSamplesToProduce    the number of output samples that should be created
+
+        @returns the actual number of input samples that were used
+    */
+    int process (double speedRatio,
+                 const float* const* inputChannels,
+                 float* const* outputChannels,
+                 int numOutputSamplesToProduce) noexcept;
+
+    /** Resamples a stream of samples, adding the results to the output data
+        with a gain.
+
+        @param speedRatio       the number of input samples to use for each output sample
+        @param inputChannels    the source data to read from, one pointer for each channel. Each
+                                channel must contain at least (speedRatio * numOutputSamplesToProduce)
+                                samples.
+        @param outputChannels   the buffers to write the results to - the result values will be
+                                added to any pre-existing data in these buffers after being
+                                multiplied by the gain factor
+        @param numOutputSamplesToProduce    the number of output samples that should be created
+        @param gain             a gain factor to multiply the resulting samples by before
+                                adding them to the destination buffers
+
+        @returns the actual number of input samples that were used
+    */
+    int processAdding (double speedRatio,
+                       const float* const* inputChannels,
+                       float* const* outputChannels,
+                       int numOutputSamplesToProduce,
+                       float gain) noexcept;
+
+private:
+    enum { numHistorySamples = 5 };
+
+    const Algorithm algorithm;
+    const int numChannels, numPaddedChannels;
+    HeapBlock<float> history;
+    int newestSample = 0;
+    double subSamplePos;
+
+    void pushSample (const float* const* inputChannels, int index) noexcept;
+    int interpolate (double, const float* const*, float* const*, int, float gain, bool isAdding) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiChannelInterpolator)
+};
+
+} // namespace juce
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce
+{
+
+static double besselI0 (double x) noexcept
+{
+    double sum = 1.0, term = 1.0;
+
+    for (int k = 1; k < 32; ++k)
+    {
+        auto t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+
+        if (term < sum * 1.0e-12)
+            break;
+    }
+
+    return sum;
+}
+
+WindowedSincTable::WindowedSincTable (int taps, int phases, double cutoff, double beta)
+    : numTaps (taps), numPhases (phases),
+      coefficients ((size_t) ((phases + 1) * taps))
+{
+    jassert (numTaps > 0 && numTaps % 4 == 0);
+    jassert (numPhases > 0);
+
+    const double halfLength = numTaps / 2;
+    auto windowScale = 1.0 / besselI0 (beta);
+
+    for (int phase = 0; phase <= numPhases; ++phase)
+    {
+        auto* kernel = coefficients + phase * numTaps;
+        auto offset = phase / (double) numPhases;
+        double sum = 0;
+
+        for (int i = 0; i < numTaps; ++i)
+        {
+            // the distance from the interpolated position to the sample under this tap
+            auto distance = (i - getNumSamplesBefore()) - offset;
+            auto x = 2.0 * cutoff * distance;
+            auto sinc = x == 0 ? 1.0 : std::sin (MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+
+            auto windowPosition = distance / halfLength;
+            auto window = windowPosition * windowPosition < 1.0 ? besselI0 (beta * std::sqrt (1.0 - windowPosition * windowPosition)) * windowScale
+                                                                : 0.0;
+
+            auto value = sinc * window;
+            kernel[i] = (float) value;
+            sum += value;
+        }
+
+        // normalise each kernel to unity gain at DC
+        for (int i = 0; i < numTaps; ++i)
+            kernel[i] = (float) (kernel[i] / sum);
+    }
+}
+
+float WindowedSincTable::getValueAt (const float* samples, float alpha) const noexcept
+{
+    auto phase = alpha * numPhases;
+    auto index = jlimit (0, numPhases - 1, (int) phase);
+    auto frac = phase - index;
+
+    auto* kernel1 = coefficients + index * numTaps;
+    auto* kernel2 = kernel1 + numTaps;
+    samples -= getNumSamplesBefore();
+
+    // Convolves the samples with two adjacent kernels, and interpolates between the results
+   #if JUCE_USE_SSE_INTRINSICS
+    auto sum1 = _mm_setzero_ps(), sum2 = _mm_setzero_ps();
+
+    for (int i = 0; i < numTaps; i += 4)
+    {
+        auto s = _mm_loadu_ps (samples + i);
+        sum1 = _mm_add_ps (sum1, _mm_mul_ps (s, _mm_loadu_ps (kernel1 + i)));
+        sum2 = _mm_add_ps (sum2, _mm_mul_ps (s, _mm_loadu_ps (kernel2 + i)));
+    }
+
+    // sum1 + frac * (sum2 - sum1), then add up the four lanes
+    auto v = _mm_add_ps (sum1, _mm_mul_ps (_mm_set1_ps (frac), _mm_sub_ps (sum2, sum1)));
+    v = _mm_add_ps (v, _mm_movehl_ps (v, v));
+    v = _mm_add_ss (v, _mm_shuffle_ps (v, v, 1));
+    return _mm_cvtss_f32 (v);
+   #elif JUCE_USE_ARM_NEON
+    auto sum1 = vdupq_n_f32 (0), sum2 = vdupq_n_f32 (0);
+
+    for (int i = 0; i < numTaps; i += 4)
+    {
+        auto s = vld1q_f32 (samples + i);
+        sum1 = vmlaq_f32 (sum1, s, vld1q_f32 (kernel1 + i));
+        sum2 = vmlaq_f32 (sum2, s, vld1q_f32 (kernel2 + i));
+    }
+
+    auto v = vmlaq_n_f32 (sum1, vsubq_f32 (sum2, sum1), frac);
+    auto pair = vadd_f32 (vget_low_f32 (v), vget_high_f32 (v));
+    return vget_lane_f32 (vpadd_f32 (pair, pair), 0);
+   #else
+    float sum1 = 0, sum2 = 0;
+
+    for (int i = 0; i < numTaps; ++i)
+    {
+        sum1 += samples[i] * kernel1[i];
+        sum2 += samples[i] * kernel2[i];
+    }
+
+    return sum1 + frac * (sum2 - sum1);
+   #endif
+}
+
+} // namespace juce
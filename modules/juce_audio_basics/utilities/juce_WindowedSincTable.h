@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce
+{
+
+/**
+    A table of Kaiser-windowed sinc kernels, one for each of a set of evenly spaced
+    sub-sample offsets, which can be used to interpolate a signal at fractional
+    positions.
+
+    Building the table is slow and allocates memory, so it should be done before
+    any audio processing starts. After that, getValueAt() is safe to call from the
+    audio thread, and the same table can be shared by any number of threads.
+
+    This is used internally by ResamplingAudioSource and SamplerVoice.
+
+    @tags{Audio}
+*/
+class JUCE_API  WindowedSincTable
+{
+public:
+    /** Creates a table.
+
+        @param numTaps      the length of each kernel. This must be a multiple of 4
+        @param numPhases    the number of sub-sample offsets in the table
+        @param cutoff       the filter's cutoff frequency, as a proportion of the
+                            sample rate, so 0.5 is the Nyquist frequency
+        @param beta         the Kaiser window's beta parameter
+    */
+    WindowedSincTable (int numTaps, int numPhases, double cutoff, double beta);
+
+    /** Returns the length of each kernel. */
+    int getNumTaps() const noexcept                 { return numTaps; }
+
+    /** Returns the number of sub-sample offsets in the table. */
+    int getNumPhases() const noexcept               { return numPhases; }
+
+    /** Returns the kernel for one of the sub-sample offsets, from 0 up to and including
+        getNumPhases(), which is the kernel for an offset of a whole sample. This lets
+        callers do the same calculation as getValueAt() for several positions at once.
+    */
+    const float* getKernel (int phase) const noexcept   { return coefficients + phase * numTaps; }
+
+    /** Returns the number of samples before the interpolated position that are read by
+        getValueAt(). The number read after it is getNumTaps() - getNumSamplesBefore().
+    */
+    int getNumSamplesBefore() const noexcept        { return numTaps / 2 - 1; }
+
+    /** Returns the signal's value at a position between two samples.
+
+        @param samples  the sample just before the position. The samples from
+                        samples[-getNumSamplesBefore()] to
+                        samples[getNumTaps() - getNumSamplesBefore() - 1] are read
+        @param alpha    the position's offset from samples[0], from 0 to 1
+    */
+    float getValueAt (const float* samples, float alpha) const noexcept;
+
+private:
+    const int numTaps, numPhases;
+    HeapBlock<float> coefficients;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WindowedSincTable)
+};
+
+} // namespace juce
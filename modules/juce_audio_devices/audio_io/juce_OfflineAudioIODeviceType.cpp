@@ -0,0 +1,441 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct OfflineAudioIODevice::CallbackThread  : public Thread
+{
+    CallbackThread (OfflineAudioIODevice& d, AudioIODeviceCallback& cb)
+        : Thread ("Offline Audio Device"), owner (d), callback (cb),
+          random (d.options.randomSeed)
+    {}
+
+    void run() override
+    {
+        auto blockDurationSeconds = owner.currentBufferSize / owner.currentSampleRate;
+        auto clockSpeed = owner.options.clockSpeed;
+        auto nextCallbackTime = Time::getMillisecondCounterHiRes();
+
+        while (! threadShouldExit())
+        {
+            if (clockSpeed > 0)
+            {
+                waitUntil (nextCallbackTime);
+                nextCallbackTime += 1000.0 * blockDurationSeconds / clockSpeed;
+            }
+
+            if (owner.options.maxJitterMs > 0)
+                waitUntil (Time::getMillisecondCounterHiRes() + owner.options.maxJitterMs * random.nextDouble());
+
+            if (threadShouldExit())
+                break;
+
+            owner.renderNextBlock (callback);
+        }
+    }
+
+    void waitUntil (double targetTimeMs)
+    {
+        for (;;)
+        {
+            auto msToWait = targetTimeMs - Time::getMillisecondCounterHiRes();
+
+            if (msToWait <= 0 || threadShouldExit())
+                return;
+
+            // sleep for most of the time, and then spin to get close to the target
+            if (msToWait > 2.0)
+                wait (jmax (1, (int) msToWait - 2));
+            else
+                Thread::yield();
+        }
+    }
+
+    OfflineAudioIODevice& owner;
+    AudioIODeviceCallback& callback;
+    Random random;
+
+    JUCE_DECLARE_NON_COPYABLE (CallbackThread)
+};
+
+//==============================================================================
+OfflineAudioIODevice::OfflineAudioIODevice (const String& deviceName, const Options& o)
+    : AudioIODevice (deviceName, OfflineAudioIODeviceType::typeName), options (o)
+{
+}
+
+OfflineAudioIODevice::~OfflineAudioIODevice()
+{
+    close();
+}
+
+StringArray OfflineAudioIODevice::getOutputChannelNames()
+{
+    StringArray names;
+
+    for (int i = 1; i <= options.numOutputChannels; ++i)
+        names.add ("Output " + String (i));
+
+    return names;
+}
+
+StringArray OfflineAudioIODevice::getInputChannelNames()
+{
+    StringArray names;
+
+    for (int i = 1; i <= options.numInputChannels; ++i)
+        names.add ("Input " + String (i));
+
+    return names;
+}
+
+Array<double> OfflineAudioIODevice::getAvailableSampleRates()    { return options.sampleRates; }
+Array<int> OfflineAudioIODevice::getAvailableBufferSizes()       { return options.bufferSizes; }
+
+int OfflineAudioIODevice::getDefaultBufferSize()
+{
+    return options.bufferSizes.contains (512) ? 512 : options.bufferSizes.getFirst();
+}
+
+String OfflineAudioIODevice::open (const BigInteger& inputChannels, const BigInteger& outputChannels,
+                                   double sampleRate, int bufferSizeSamples)
+{
+    close();
+
+    currentSampleRate = sampleRate > 0 ? sampleRate : options.sampleRates.getFirst();
+    currentBufferSize = bufferSizeSamples > 0 ? bufferSizeSamples : getDefaultBufferSize();
+
+    if (currentSampleRate <= 0 || currentBufferSize <= 0)
+        return "Invalid sample rate or buffer size";
+
+    activeInputChannels = inputChannels;
+    activeInputChannels.setRange (options.numInputChannels, jmax (0, activeInputChannels.getHighestBit() + 1 - options.numInputChannels), false);
+    activeOutputChannels = outputChannels;
+    activeOutputChannels.setRange (options.numOutputChannels, jmax (0, activeOutputChannels.getHighestBit() + 1 - options.numOutputChannels), false);
+
+    inputBuffer.setSize (activeInputChannels.countNumberOfSetBits(), currentBufferSize);
+    outputBuffer.setSize (activeOutputChannels.countNumberOfSetBits(), currentBufferSize);
+    inputBuffer.clear();
+    outputBuffer.clear();
+
+    activeInputs.clearQuick();
+    activeOutputs.clearQuick();
+
+    for (int i = 0; i < inputBuffer.getNumChannels(); ++i)
+        activeInputs.add (inputBuffer.getReadPointer (i));
+
+    for (int i = 0; i < outputBuffer.getNumChannels(); ++i)
+        activeOutputs.add (outputBuffer.getWritePointer (i));
+
+    deviceIsOpen = true;
+    return {};
+}
+
+void OfflineAudioIODevice::close()
+{
+    stop();
+    deviceIsOpen = false;
+}
+
+bool OfflineAudioIODevice::isOpen()    { return deviceIsOpen; }
+
+void OfflineAudioIODevice::start (AudioIODeviceCallback* newCallback)
+{
+    if (! deviceIsOpen || newCallback == nullptr)
+        return;
+
+    const ScopedLock sl (startStopLock);
+
+    if (newCallback == callback)
+        return;
+
+    stop();
+
+    newCallback->audioDeviceAboutToStart (this);
+
+    callback = newCallback;
+    samplePosition = 0;
+    resetStatistics();
+
+    thread.reset (new CallbackThread (*this, *callback));
+    thread->startThread (Thread::realtimeAudioPriority);
+}
+
+void OfflineAudioIODevice::stop()
+{
+    const ScopedLock sl (startStopLock);
+
+    if (thread != nullptr)
+    {
+        thread->signalThreadShouldExit();
+        thread->notify();
+        thread->stopThread (5000);
+        thread.reset();
+    }
+
+    if (auto* lastCallback = callback)
+    {
+        callback = nullptr;
+        lastCallback->audioDeviceStopped();
+    }
+}
+
+bool OfflineAudioIODevice::isPlaying()                           { return callback != nullptr; }
+String OfflineAudioIODevice::getLastError()                      { return {}; }
+int OfflineAudioIODevice::getCurrentBufferSizeSamples()          { return currentBufferSize; }
+double OfflineAudioIODevice::getCurrentSampleRate()              { return currentSampleRate; }
+int OfflineAudioIODevice::getCurrentBitDepth()                   { return 32; }
+BigInteger OfflineAudioIODevice::getActiveOutputChannels() const { return activeOutputChannels; }
+BigInteger OfflineAudioIODevice::getActiveInputChannels() const  { return activeInputChannels; }
+int OfflineAudioIODevice::getOutputLatencyInSamples()            { return 0; }
+int OfflineAudioIODevice::getInputLatencyInSamples()             { return 0; }
+
+int OfflineAudioIODevice::getXRunCount() const noexcept
+{
+    // late callbacks only count as xruns if there's a clock to be late for
+    if (options.clockSpeed <= 0)
+        return 0;
+
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    return statistics.numLateCallbacks;
+}
+
+//==============================================================================
+void OfflineAudioIODevice::renderNextBlock (AudioIODeviceCallback& cb)
+{
+    if (options.generateInput != nullptr)
+        options.generateInput (inputBuffer, samplePosition);
+
+    auto startTicks = Time::getHighResolutionTicks();
+
+    cb.audioDeviceIOCallback (activeInputs.getRawDataPointer(), activeInputs.size(),
+                              activeOutputs.getRawDataPointer(), activeOutputs.size(),
+                              currentBufferSize);
+
+    recordCallbackTime (1000.0 * Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTicks));
+
+    if (options.receiveOutput != nullptr)
+        options.receiveOutput (outputBuffer, samplePosition);
+
+    samplePosition += currentBufferSize;
+}
+
+void OfflineAudioIODevice::recordCallbackTime (double milliseconds)
+{
+    auto blockDurationMs = 1000.0 * currentBufferSize / currentSampleRate;
+
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    auto& s = statistics;
+
+    s.minimumMs = s.numCallbacks == 0 ? milliseconds : jmin (s.minimumMs, milliseconds);
+    s.maximumMs = jmax (s.maximumMs, milliseconds);
+    s.averageMs = (s.averageMs * (double) s.numCallbacks + milliseconds) / (double) (s.numCallbacks + 1);
+    s.lastMs = milliseconds;
+    ++s.numCallbacks;
+    s.numSamplesProcessed += currentBufferSize;
+
+    if (milliseconds > blockDurationMs)
+        ++s.numLateCallbacks;
+}
+
+OfflineAudioIODevice::Statistics OfflineAudioIODevice::getStatistics() const
+{
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    return statistics;
+}
+
+void OfflineAudioIODevice::resetStatistics()
+{
+    const SpinLock::ScopedLockType sl (statisticsLock);
+    statistics = {};
+}
+
+//==============================================================================
+const char* const OfflineAudioIODeviceType::typeName = "Offline";
+
+OfflineAudioIODeviceType::OfflineAudioIODeviceType (const OfflineAudioIODevice::Options& o)
+    : AudioIODeviceType (typeName), options (o)
+{
+}
+
+OfflineAudioIODeviceType::~OfflineAudioIODeviceType() {}
+
+void OfflineAudioIODeviceType::scanForDevices() {}
+
+StringArray OfflineAudioIODeviceType::getDeviceNames (bool) const
+{
+    return { "Offline Audio Device" };
+}
+
+int OfflineAudioIODeviceType::getDefaultDeviceIndex (bool) const   { return 0; }
+
+int OfflineAudioIODeviceType::getIndexOfDevice (AudioIODevice* device, bool) const
+{
+    return dynamic_cast<OfflineAudioIODevice*> (device) != nullptr ? 0 : -1;
+}
+
+bool OfflineAudioIODeviceType::hasSeparateInputsAndOutputs() const  { return false; }
+
+AudioIODevice* OfflineAudioIODeviceType::createDevice (const String& outputDeviceName, const String& inputDeviceName)
+{
+    auto names = getDeviceNames (false);
+
+    if (names.contains (outputDeviceName) || names.contains (inputDeviceName))
+        return new OfflineAudioIODevice (names[0], options);
+
+    return nullptr;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class OfflineAudioIODeviceTests  : public UnitTest
+{
+public:
+    OfflineAudioIODeviceTests() : UnitTest ("OfflineAudioIODevice", "Audio") {}
+
+    struct OfflineDeviceManager  : public AudioDeviceManager
+    {
+        OfflineDeviceManager (const OfflineAudioIODevice::Options& o)  : options (o) {}
+
+        void createAudioDeviceTypes (OwnedArray<AudioIODeviceType>& types) override
+        {
+            types.add (new OfflineAudioIODeviceType (options));
+        }
+
+        OfflineAudioIODevice::Options options;
+    };
+
+    // Passes the input through at half the level, and signals once it's been called enough times
+    struct HalfGainCallback  : public AudioIODeviceCallback
+    {
+        void audioDeviceIOCallback (const float** inputs, int numInputs,
+                                    float** outputs, int numOutputs, int numSamples) override
+        {
+            for (int ch = 0; ch < numOutputs; ++ch)
+            {
+                if (ch < numInputs)
+                    FloatVectorOperations::copyWithMultiply (outputs[ch], inputs[ch], 0.5f, numSamples);
+                else
+                    FloatVectorOperations::clear (outputs[ch], numSamples);
+            }
+
+            if (++numCallbacks == numCallbacksWanted)
+                finished.signal();
+        }
+
+        void audioDeviceAboutToStart (AudioIODevice*) override {}
+        void audioDeviceStopped() override {}
+
+        int numCallbacks = 0, numCallbacksWanted = 100;
+        WaitableEvent finished;
+    };
+
+    static float getTestSample (int64 position, int channel) noexcept
+    {
+        return (float) ((position + channel * 7) % 1000) / 1000.0f;
+    }
+
+    void runTest() override
+    {
+        beginTest ("Runs the callback through an AudioDeviceManager");
+        {
+            Array<int64> inputPositions, outputPositions;
+            int numMismatches = 0;
+
+            OfflineAudioIODevice::Options options;
+            options.clockSpeed = 0.0;
+
+            options.generateInput = [&] (AudioBuffer<float>& buffer, int64 position)
+            {
+                inputPositions.add (position);
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    for (int i = 0; i < buffer.getNumSamples(); ++i)
+                        buffer.setSample (ch, i, getTestSample (position + i, ch));
+            };
+
+            options.receiveOutput = [&] (const AudioBuffer<float>& buffer, int64 position)
+            {
+                outputPositions.add (position);
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    for (int i = 0; i < buffer.getNumSamples(); ++i)
+                        if (buffer.getSample (ch, i) != 0.5f * getTestSample (position + i, ch))
+                            ++numMismatches;
+            };
+
+            // add the callback first, so that it sees every block from the start
+            HalfGainCallback callback;
+            OfflineDeviceManager manager (options);
+            manager.addAudioCallback (&callback);
+            expect (manager.initialise (2, 2, nullptr, false).isEmpty());
+
+            auto* device = dynamic_cast<OfflineAudioIODevice*> (manager.getCurrentAudioDevice());
+            expect (device != nullptr);
+
+            if (device == nullptr)
+                return;
+
+            expectEquals (device->getActiveInputChannels().countNumberOfSetBits(), 2);
+            expectEquals (device->getActiveOutputChannels().countNumberOfSetBits(), 2);
+
+            const auto blockSize = device->getCurrentBufferSizeSamples();
+            expect (callback.finished.wait (10000));
+
+            // stopping the device waits for its thread, so everything below is safe to read
+            device->stop();
+
+            const auto numCallbacks = callback.numCallbacks;
+            expect (numCallbacks >= callback.numCallbacksWanted);
+            expectEquals (inputPositions.size(), numCallbacks);
+            expectEquals (outputPositions.size(), numCallbacks);
+            expectEquals (numMismatches, 0);
+
+            for (int i = 0; i < numCallbacks; ++i)
+            {
+                expectEquals (inputPositions[i], (int64) i * blockSize);
+                expectEquals (outputPositions[i], (int64) i * blockSize);
+            }
+
+            auto stats = device->getStatistics();
+            expectEquals (stats.numCallbacks, (int64) numCallbacks);
+            expectEquals (stats.numSamplesProcessed, (int64) numCallbacks * blockSize);
+            expect (stats.minimumMs >= 0 && stats.minimumMs <= stats.averageMs && stats.averageMs <= stats.maximumMs);
+            expect (stats.lastMs >= stats.minimumMs && stats.lastMs <= stats.maximumMs);
+            expectEquals (device->getXRunCount(), 0);
+
+            device->resetStatistics();
+            expectEquals (device->getStatistics().numCallbacks, (int64) 0);
+
+            manager.removeAudioCallback (&callback);
+        }
+    }
+};
+
+static OfflineAudioIODeviceTests offlineAudioIODeviceTests;
+
+#endif // JUCE_UNIT_TESTS
+
+} // namespace juce
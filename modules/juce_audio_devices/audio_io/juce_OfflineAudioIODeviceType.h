@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A virtual audio device that isn't connected to any hardware.
+
+    The device drives its AudioIODeviceCallback from a thread of its own, so a full
+    AudioDeviceManager -> AudioProcessorPlayer -> AudioProcessorGraph pipeline can be run
+    on a machine without any audio hardware, e.g. to benchmark it in CI, or to render its
+    output faster than real time.
+
+    It can either call the callback back-to-back as fast as possible, or at the rate a
+    real device would (or a multiple of it), optionally delaying each callback by a random
+    amount to simulate scheduling jitter. The random numbers are seeded, so a given set of
+    options always produces the same sequence of callbacks.
+
+    The device keeps timing statistics for its callbacks - see getStatistics().
+
+    @see OfflineAudioIODeviceType
+
+    @tags{Audio}
+*/
+class JUCE_API  OfflineAudioIODevice  : public AudioIODevice
+{
+public:
+    //==============================================================================
+    /** The settings used by an OfflineAudioIODevice. */
+    struct Options
+    {
+        /** The number of input and output channels that the device has. */
+        int numInputChannels = 2, numOutputChannels = 2;
+
+        /** The sample rates and buffer sizes that the device will offer. */
+        Array<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0 };
+        Array<int> bufferSizes { 16, 32, 64, 128, 256, 512, 1024, 2048 };
+
+        /** How fast the simulated clock runs, relative to real time.
+            If this is 0, the callbacks are made as quickly as possible.
+        */
+        double clockSpeed = 0.0;
+
+        /** The largest random delay that will be added before each callback, in milliseconds. */
+        double maxJitterMs = 0.0;
+
+        /** The seed for the random jitter. */
+        int64 randomSeed = 1;
+
+        /** If this is set, it's called to fill the input channels before each callback.
+            Otherwise, the inputs are silent. The second parameter is the position of the
+            block's first sample since the device was started.
+        */
+        std::function<void (AudioBuffer<float>&, int64)> generateInput;
+
+        /** If this is set, it's called after each callback with the output that was rendered,
+            which lets you write it to a file, check it, etc.
+        */
+        std::function<void (const AudioBuffer<float>&, int64)> receiveOutput;
+    };
+
+    /** The timing of the callbacks that the device has made since it was started. */
+    struct Statistics
+    {
+        int64 numCallbacks = 0;         /**< The number of callbacks that have been made. */
+        int64 numSamplesProcessed = 0;  /**< The total number of samples per channel. */
+        double minimumMs = 0;           /**< The shortest time a callback took. */
+        double maximumMs = 0;           /**< The longest time a callback took. */
+        double averageMs = 0;           /**< The mean time of the callbacks. */
+        double lastMs = 0;              /**< The time that the most recent callback took. */
+        int numLateCallbacks = 0;       /**< The number of callbacks that took longer than the duration of their block. */
+    };
+
+    //==============================================================================
+    /** Creates a device. You'd normally get one from an OfflineAudioIODeviceType instead. */
+    OfflineAudioIODevice (const String& deviceName, const Options& options);
+
+    /** Destructor. */
+    ~OfflineAudioIODevice() override;
+
+    //==============================================================================
+    /** Returns the timing statistics for the callbacks since the device was last started. */
+    Statistics getStatistics() const;
+
+    /** Clears the timing statistics. */
+    void resetStatistics();
+
+    //==============================================================================
+    StringArray getOutputChannelNames() override;
+    StringArray getInputChannelNames() override;
+    Array<double> getAvailableSampleRates() override;
+    Array<int> getAvailableBufferSizes() override;
+    int getDefaultBufferSize() override;
+
+    String open (const BigInteger& inputChannels, const BigInteger& outputChannels,
+                 double sampleRate, int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override;
+
+    void start (AudioIODeviceCallback*) override;
+    void stop() override;
+    bool isPlaying() override;
+
+    String getLastError() override;
+    int getCurrentBufferSizeSamples() override;
+    double getCurrentSampleRate() override;
+    int getCurrentBitDepth() override;
+    BigInteger getActiveOutputChannels() const override;
+    BigInteger getActiveInputChannels() const override;
+    int getOutputLatencyInSamples() override;
+    int getInputLatencyInSamples() override;
+    int getXRunCount() const noexcept override;
+
+private:
+    //==============================================================================
+    struct CallbackThread;
+
+    void renderNextBlock (AudioIODeviceCallback&);
+    void recordCallbackTime (double milliseconds);
+
+    const Options options;
+    std::unique_ptr<CallbackThread> thread;
+    AudioIODeviceCallback* callback = nullptr;
+    CriticalSection startStopLock;
+
+    AudioBuffer<float> inputBuffer, outputBuffer;
+    Array<const float*> activeInputs;
+    Array<float*> activeOutputs;
+    BigInteger activeInputChannels, activeOutputChannels;
+    double currentSampleRate = 0;
+    int currentBufferSize = 0;
+    int64 samplePosition = 0;
+    bool deviceIsOpen = false;
+
+    SpinLock statisticsLock;
+    Statistics statistics;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineAudioIODevice)
+};
+
+//==============================================================================
+/**
+    An AudioIODeviceType that creates OfflineAudioIODevices.
+
+    This type isn't added to an AudioDeviceManager automatically - to use it, add one
+    with AudioDeviceManager::addAudioDeviceType() and then select it:
+
+    @code
+    OfflineAudioIODevice::Options options;
+    options.clockSpeed = 0.0; // as fast as possible
+
+    deviceManager.addAudioDeviceType (new OfflineAudioIODeviceType (options));
+    deviceManager.initialiseWithDefaultDevices (2, 2);
+    deviceManager.setCurrentAudioDeviceType (OfflineAudioIODeviceType::typeName, true);
+    @endcode
+
+    @see OfflineAudioIODevice
+
+    @tags{Audio}
+*/
+class JUCE_API  OfflineAudioIODeviceType  : public AudioIODeviceType
+{
+public:
+    /** Creates a type whose devices will use the given options. */
+    explicit OfflineAudioIODeviceType (const OfflineAudioIODevice::Options& options = {});
+
+    /** Destructor. */
+    ~OfflineAudioIODeviceType() override;
+
+    /** The name of this device type. */
+    static const char* const typeName;
+
+    //==============================================================================
+    void scanForDevices() override;
+    StringArray getDeviceNames (bool wantInputNames) const override;
+    int getDefaultDeviceIndex (bool forInput) const override;
+    int getIndexOfDevice (AudioIODevice*, bool asInput) const override;
+    bool hasSeparateInputsAndOutputs() const override;
+    AudioIODevice* createDevice (const String& outputDeviceName, const String& inputDeviceName) override;
+
+private:
+    const OfflineAudioIODevice::Options options;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineAudioIODeviceType)
+};
+
+} // namespace juce
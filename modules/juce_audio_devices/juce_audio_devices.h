@@ -117,6 +117,16 @@
  #define JUCE_ALSA 1
 #endif
 
+/** Config: JUCE_ALSA_MMAP
+    Enables memory-mapped access to ALSA devices. Samples are converted straight into and
+    out of the device's ring buffer instead of being copied through snd_pcm_readi/writei,
+    which saves a copy on each callback and helps when running with very small buffer sizes.
+    Devices that can't be memory-mapped will carry on using the normal read/write calls.
+*/
+#ifndef JUCE_ALSA_MMAP
+ #define JUCE_ALSA_MMAP 0
+#endif
+
 /** Config: JUCE_JACK
     Enables JACK audio devices (Linux only).
 */
@@ -176,6 +186,7 @@
 #include "midi_io/juce_MidiOutput.h"
 #include "audio_io/juce_AudioIODevice.h"
 #include "audio_io/juce_AudioIODeviceType.h"
+#include "audio_io/juce_OfflineAudioIODeviceType.h"
 #include "audio_io/juce_SystemAudioVolume.h"
 #include "sources/juce_AudioSourcePlayer.h"
 #include "sources/juce_AudioTransportSource.h"
@@ -149,13 +149,14 @@ static void silentErrorHandler (const char*, int, const char*, int, const char*,
 class ALSADevice
 {
 public:
-    ALSADevice (const String& devID, bool forInput)
+    ALSADevice (const String& devID, bool forInput, bool allowMemoryMappedAccess = JUCE_ALSA_MMAP != 0)
         : handle (nullptr),
           bitDepth (16),
           numChannelsRunning (0),
           latency (0),
           deviceID (devID),
           isInput (forInput),
+          allowMemoryMapping (allowMemoryMappedAccess),
           isInterleaved (true)
     {
         JUCE_ALSA_LOG ("snd_pcm_open (" << deviceID.toUTF8().getAddress() << ", forInput=" << (int) forInput << ")");
@@ -210,7 +211,19 @@ public:
             return false;
         }
 
-        if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) >= 0) // works better for plughw..
+        isMemoryMapped = false;
+
+        if (allowMemoryMapping && snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_MMAP_INTERLEAVED) >= 0)
+        {
+            isInterleaved = true;
+            isMemoryMapped = true;
+        }
+        else if (allowMemoryMapping && snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_MMAP_NONINTERLEAVED) >= 0)
+        {
+            isInterleaved = false;
+            isMemoryMapped = true;
+        }
+        else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_INTERLEAVED) >= 0) // works better for plughw..
             isInterleaved = true;
         else if (snd_pcm_hw_params_set_access (handle, hwParams, SND_PCM_ACCESS_RW_NONINTERLEAVED) >= 0)
             isInterleaved = false;
@@ -239,6 +252,10 @@ public:
             {
                 const int type = formatsToTry [i + 1];
                 bitDepth = type & 255;
+                physicalBitsPerSample = snd_pcm_format_physical_width ((_snd_pcm_format) formatsToTry [i]);
+
+                // the converters assume that each sample takes up bitDepth bits
+                jassert (physicalBitsPerSample == bitDepth);
 
                 converter.reset (createConverter (isInput, bitDepth,
                                                   (type & isFloatBit) != 0,
@@ -279,7 +296,7 @@ public:
             latency = (int) frames * ((int) periods - 1); // (this is the method JACK uses to guess the latency..)
 
         JUCE_ALSA_LOG ("frames: " << (int) frames << ", periods: " << (int) periods
-                          << ", samplesPerPeriod: " << (int) samplesPerPeriod);
+                          << ", samplesPerPeriod: " << (int) samplesPerPeriod << ", mmap: " << (int) isMemoryMapped);
 
         snd_pcm_sw_params_t* swParams;
         snd_pcm_sw_params_alloca (&swParams);
@@ -290,12 +307,20 @@ public:
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_silence_threshold (handle, swParams, 0))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_silence_size (handle, swParams, boundary))
             || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_start_threshold (handle, swParams, samplesPerPeriod))
-            || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_stop_threshold (handle, swParams, boundary))
-            || JUCE_ALSA_FAILED (snd_pcm_sw_params (handle, swParams)))
+            || JUCE_ALSA_FAILED (snd_pcm_sw_params_set_stop_threshold (handle, swParams, boundary)))
         {
             return false;
         }
 
+        // In mmap mode, snd_pcm_wait() is used to wait for space in the buffer, so make it
+        // wake up once per period rather than as soon as a single frame is available.
+        if (isMemoryMapped
+             && JUCE_ALSA_FAILED (snd_pcm_sw_params_set_avail_min (handle, swParams, frames > 0 ? frames : samplesPerPeriod)))
+            return false;
+
+        if (JUCE_ALSA_FAILED (snd_pcm_sw_params (handle, swParams)))
+            return false;
+
        #if JUCE_ALSA_LOGGING
         // enable this to dump the config of the devices that get opened
         snd_output_t* out;
@@ -313,6 +338,10 @@ public:
     bool writeToOutputDevice (AudioBuffer<float>& outputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= outputChannelBuffer.getNumChannels());
+
+        if (isMemoryMapped)
+            return transferMemoryMapped (outputChannelBuffer, numSamples);
+
         float* const* const data = outputChannelBuffer.getArrayOfWritePointers();
         snd_pcm_sframes_t numDone = 0;
 
@@ -351,6 +380,10 @@ public:
     bool readFromInputDevice (AudioBuffer<float>& inputChannelBuffer, const int numSamples)
     {
         jassert (numChannelsRunning <= inputChannelBuffer.getNumChannels());
+
+        if (isMemoryMapped)
+            return transferMemoryMapped (inputChannelBuffer, numSamples);
+
         float* const* const data = inputChannelBuffer.getArrayOfWritePointers();
 
         if (isInterleaved)
@@ -399,17 +432,136 @@ public:
         return true;
     }
 
+    bool isUsingMemoryMappedAccess() const noexcept     { return isMemoryMapped; }
+
+    //==============================================================================
+    /*  With mmap access, the samples are converted directly between our buffer and the
+        areas of the device's ring buffer that snd_pcm_mmap_begin() hands out.
+    */
+    bool transferMemoryMapped (AudioBuffer<float>& channelBuffer, const int numSamples)
+    {
+        int numDone = 0;
+
+        while (numDone < numSamples)
+        {
+            // unlike snd_pcm_readi, nothing starts a capture stream automatically
+            if (isInput && snd_pcm_state (handle) == SND_PCM_STATE_PREPARED
+                 && JUCE_ALSA_FAILED (snd_pcm_start (handle)))
+                return false;
+
+            auto avail = snd_pcm_avail_update (handle);
+
+            if (avail < 0)
+            {
+                if (! recoverFromError ((int) avail))
+                    return false;
+
+                continue;
+            }
+
+            if (avail == 0)
+            {
+                auto result = snd_pcm_wait (handle, 2000);
+
+                if (result < 0 && ! recoverFromError (result))
+                    return false;
+
+                if (result == 0)
+                {
+                    // The rest of the block is lost, so this counts as an xrun, and the stream
+                    // is restarted in case the device has stalled
+                    JUCE_ALSA_LOG ("Timed out waiting for the device");
+
+                    if (isInput)
+                        for (int i = 0; i < numChannelsRunning; ++i)
+                            zeromem (channelBuffer.getWritePointer (i, numDone), sizeof (float) * (size_t) (numSamples - numDone));
+
+                    return recoverFromError (-EPIPE);
+                }
+
+                continue;
+            }
+
+            const snd_pcm_channel_area_t* areas = nullptr;
+            snd_pcm_uframes_t offset = 0;
+            auto frames = (snd_pcm_uframes_t) (numSamples - numDone);
+
+            auto err = snd_pcm_mmap_begin (handle, &areas, &offset, &frames);
+
+            if (err < 0)
+            {
+                if (! recoverFromError (err))
+                    return false;
+
+                continue;
+            }
+
+            for (int i = 0; i < numChannelsRunning; ++i)
+            {
+                auto& area = areas[i];
+
+                // the converter expects each channel's samples to be a fixed distance apart
+                if (area.step != (unsigned int) (physicalBitsPerSample * (isInterleaved ? numChannelsRunning : 1)) || (area.first & 7) != 0)
+                {
+                    error = "unsupported mmap channel layout";
+                    return false;
+                }
+
+                auto deviceData = addBytesToPointer (area.addr, (area.first + offset * area.step) / 8);
+
+                if (isInput)
+                    converter->convertSamples (channelBuffer.getWritePointer (i, numDone), deviceData, (int) frames);
+                else
+                    converter->convertSamples (deviceData, channelBuffer.getReadPointer (i, numDone), (int) frames);
+            }
+
+            auto numCommitted = snd_pcm_mmap_commit (handle, offset, frames);
+
+            if (numCommitted < 0 || (snd_pcm_uframes_t) numCommitted != frames)
+            {
+                if (! recoverFromError (numCommitted < 0 ? (int) numCommitted : -EPIPE))
+                    return false;
+
+                continue;
+            }
+
+            numDone += (int) numCommitted;
+
+            // a playback stream needs starting once there's something in its buffer
+            if (! isInput && snd_pcm_state (handle) == SND_PCM_STATE_PREPARED
+                 && JUCE_ALSA_FAILED (snd_pcm_start (handle)))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool recoverFromError (int err)
+    {
+        if (err == -EPIPE)
+        {
+            if (isInput)
+                overrunCount++;
+            else
+                underrunCount++;
+        }
+
+        return ! JUCE_ALSA_FAILED (snd_pcm_recover (handle, err, 1 /* silent */));
+    }
+
     //==============================================================================
     snd_pcm_t* handle;
     String error;
     int bitDepth, numChannelsRunning, latency;
+    int physicalBitsPerSample = 0;
     int underrunCount = 0, overrunCount = 0;
 
 private:
     //==============================================================================
     String deviceID;
-    const bool isInput;
+    const bool isInput, allowMemoryMapping;
     bool isInterleaved;
+    bool isMemoryMapped = false;
     MemoryBlock scratch;
     std::unique_ptr<AudioData::Converter> converter;
 
@@ -1304,4 +1456,129 @@ AudioIODeviceType* AudioIODeviceType::createAudioIODeviceType_ALSA()
     return createAudioIODeviceType_ALSA_PCMDevices();
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ALSADeviceTests  : public UnitTest
+{
+public:
+    ALSADeviceTests() : UnitTest ("ALSA devices", "Audio") {}
+
+    struct CountingCallback  : public AudioIODeviceCallback
+    {
+        void audioDeviceIOCallback (const float**, int, float** outputs, int numOutputs, int numSamples) override
+        {
+            for (int ch = 0; ch < numOutputs; ++ch)
+                FloatVectorOperations::fill (outputs[ch], 0.25f, numSamples);
+
+            if (++numCallbacks == numCallbacksWanted)
+                finished.signal();
+        }
+
+        void audioDeviceAboutToStart (AudioIODevice*) override {}
+        void audioDeviceStopped() override {}
+
+        std::atomic<int> numCallbacks { 0 };
+        int numCallbacksWanted = 50;
+        WaitableEvent finished;
+    };
+
+    // The "null" PCM discards its output and captures silence, and supports both mmap
+    // and read/write access, but it may not be available in every configuration.
+    static bool isNullDeviceAvailable (bool forInput)
+    {
+        snd_pcm_t* handle = nullptr;
+
+        if (snd_pcm_open (&handle, "null", forInput ? SND_PCM_STREAM_CAPTURE : SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK) < 0)
+            return false;
+
+        snd_pcm_close (handle);
+        return true;
+    }
+
+    void checkDeviceTransfers (bool forInput, bool memoryMapped)
+    {
+        ALSADevice device ("null", forInput, memoryMapped);
+        expect (device.error.isEmpty(), device.error);
+
+        auto ok = device.setParameters (44100, 2, 256);
+        expect (ok, device.error);
+
+        if (! ok)
+            return;
+
+        expectEquals ((int) device.isUsingMemoryMappedAccess(), (int) memoryMapped);
+        expect (snd_pcm_prepare (device.handle) >= 0);
+
+        AudioBuffer<float> buffer (2, 256);
+        buffer.clear();
+
+        for (int i = 0; i < 20; ++i)
+        {
+            ok = forInput ? device.readFromInputDevice (buffer, buffer.getNumSamples())
+                          : device.writeToOutputDevice (buffer, buffer.getNumSamples());
+            expect (ok, device.error);
+        }
+
+        if (forInput)
+            expectEquals (buffer.getMagnitude (0, buffer.getNumSamples()), 0.0f);
+    }
+
+    void runTest() override
+    {
+        snd_lib_error_set_handler (&silentErrorHandler);
+
+        // Both kinds of access are tested, whatever JUCE_ALSA_MMAP is set to
+        for (auto memoryMapped : { false, true })
+        {
+            const String access (memoryMapped ? " with mmap access" : " with read/write access");
+
+            beginTest ("Playback to the null PCM" + access);
+
+            if (isNullDeviceAvailable (false))
+                checkDeviceTransfers (false, memoryMapped);
+            else
+                logMessage ("Skipped: the null PCM isn't available");
+
+            beginTest ("Capture from the null PCM" + access);
+
+            if (isNullDeviceAvailable (true))
+                checkDeviceTransfers (true, memoryMapped);
+            else
+                logMessage ("Skipped: the null PCM isn't available");
+        }
+
+        beginTest ("Callbacks run on the null PCM");
+
+        if (isNullDeviceAvailable (false))
+        {
+            ALSAAudioIODevice device ("null", "ALSA", {}, "null");
+            BigInteger outputs;
+            outputs.setRange (0, 2, true);
+
+            auto error = device.open ({}, outputs, 44100.0, 256);
+            expect (error.isEmpty(), error);
+
+            if (error.isEmpty())
+            {
+                CountingCallback callback;
+                device.start (&callback);
+                expect (callback.finished.wait (10000));
+                device.stop();
+                expect (callback.numCallbacks >= callback.numCallbacksWanted);
+            }
+        }
+        else
+        {
+            logMessage ("Skipped: the null PCM isn't available");
+        }
+
+        snd_lib_error_set_handler (nullptr);
+    }
+};
+
+static ALSADeviceTests alsaDeviceTests;
+
+#endif // JUCE_UNIT_TESTS
+
 } // namespace juce
@@ -27,6 +27,200 @@
 namespace juce
 {
 
+struct SamplerDiskStreamer::Stream
+{
+    Stream (int numSamples)  : buffer (2, numSamples), fifo (numSamples) {}
+
+    /*  A stream is claimed by a voice on the audio thread (free -> settingUp -> active),
+        and handed back by the voice (active -> released). Only the reader moves it from
+        released back to free, so it never gets re-used while it's being read.
+    */
+    enum State { free, settingUp, active, released };
+    std::atomic<int> state { free };
+
+    bool isInUse() const noexcept
+    {
+        auto s = state.load (std::memory_order_acquire);
+        return s == settingUp || s == active;
+    }
+
+    void freeIfReleased()
+    {
+        if (state.load (std::memory_order_acquire) == released)
+        {
+            sound = nullptr;
+            samplerSound = nullptr;
+            state.store (free, std::memory_order_release);
+        }
+    }
+
+    SynthesiserSound::Ptr sound;  // keeps the sound and its reader alive while it's being streamed
+    SamplerSound* samplerSound = nullptr;
+
+    AudioBuffer<float> buffer;
+    AbstractFifo fifo;
+
+    int64 nextSampleToRead = 0, endSample = 0;  // only used by the reader thread
+    int64 firstSampleInFifo = 0;                // only used by the voice
+
+    JUCE_DECLARE_NON_COPYABLE (Stream)
+};
+
+//==============================================================================
+struct SamplerDiskStreamer::Reader  : public TimeSliceClient
+{
+    Reader (TimeSliceThread& t, int numStreams, int samplesPerStream)  : thread (t)
+    {
+        for (int i = 0; i < numStreams; ++i)
+            streams.add (new Stream (samplesPerStream));
+
+        thread.addTimeSliceClient (this);
+    }
+
+    ~Reader()
+    {
+        thread.removeTimeSliceClient (this);
+
+        for (auto* s : streams)
+        {
+            // the voices that use this streamer must be deleted before it
+            jassert (! s->isInUse());
+            s->freeIfReleased();
+        }
+    }
+
+    int useTimeSlice() override
+    {
+        for (int i = 0; i < maxReadsPerTimeSlice; ++i)
+        {
+            auto* mostUrgent = findMostUrgentStream();
+
+            if (mostUrgent == nullptr)
+                return 5;
+
+            fillStream (*mostUrgent);
+        }
+
+        return 0;
+    }
+
+    Stream* findMostUrgentStream()
+    {
+        Stream* mostUrgent = nullptr;
+        auto leastReady = std::numeric_limits<int>::max();
+
+        for (auto* s : streams)
+        {
+            s->freeIfReleased();
+
+            if (s->state.load (std::memory_order_acquire) == Stream::active && s->nextSampleToRead < s->endSample)
+            {
+                auto numWanted = jmin ((int64) minSamplesPerRead, s->endSample - s->nextSampleToRead);
+                auto numReady = s->fifo.getNumReady();
+
+                if (s->fifo.getFreeSpace() >= numWanted && numReady < leastReady)
+                {
+                    leastReady = numReady;
+                    mostUrgent = s;
+                }
+            }
+        }
+
+        return mostUrgent;
+    }
+
+    void fillStream (Stream& s)
+    {
+        auto numToRead = (int) jmin ((int64) s.fifo.getFreeSpace(), (int64) maxSamplesPerRead,
+                                     s.endSample - s.nextSampleToRead);
+
+        int start1, size1, start2, size2;
+        s.fifo.prepareToWrite (numToRead, start1, size1, start2, size2);
+
+        auto& source = *s.samplerSound->reader;
+
+        if (size1 > 0)  source.read (&s.buffer, start1, size1, s.nextSampleToRead, true, true);
+        if (size2 > 0)  source.read (&s.buffer, start2, size2, s.nextSampleToRead + size1, true, true);
+
+        s.fifo.finishedWrite (size1 + size2);
+        s.nextSampleToRead += size1 + size2;
+    }
+
+    enum
+    {
+        minSamplesPerRead = 2048,
+        maxSamplesPerRead = 16384,
+        maxReadsPerTimeSlice = 8
+    };
+
+    TimeSliceThread& thread;
+    OwnedArray<Stream> streams;
+    std::atomic<int> numUnderruns { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (Reader)
+};
+
+//==============================================================================
+SamplerDiskStreamer::SamplerDiskStreamer (TimeSliceThread& threadToUse, int maxNumStreams, int samplesPerStream)
+    : reader (new Reader (threadToUse, jmax (1, maxNumStreams), jmax ((int) Reader::minSamplesPerRead * 2, samplesPerStream)))
+{
+}
+
+SamplerDiskStreamer::~SamplerDiskStreamer()
+{
+}
+
+int SamplerDiskStreamer::getMaxNumStreams() const noexcept
+{
+    return reader->streams.size();
+}
+
+int SamplerDiskStreamer::getNumActiveStreams() const noexcept
+{
+    int num = 0;
+
+    for (auto* s : reader->streams)
+        if (s->isInUse())
+            ++num;
+
+    return num;
+}
+
+int SamplerDiskStreamer::getNumUnderruns() const noexcept
+{
+    return reader->numUnderruns;
+}
+
+SamplerDiskStreamer::Stream* SamplerDiskStreamer::acquireStream (SamplerSound& sound, int64 firstSample) noexcept
+{
+    for (auto* s : reader->streams)
+    {
+        int expected = Stream::free;
+
+        if (s->state.compare_exchange_strong (expected, Stream::settingUp, std::memory_order_acquire))
+        {
+            s->sound = &sound;
+            s->samplerSound = &sound;
+            s->fifo.reset();
+            s->nextSampleToRead = firstSample;
+            s->firstSampleInFifo = firstSample;
+            s->endSample = sound.length + 4;
+
+            s->state.store (Stream::active, std::memory_order_release);
+            return s;
+        }
+    }
+
+    return nullptr;
+}
+
+void SamplerDiskStreamer::releaseStream (Stream* s) noexcept
+{
+    if (s != nullptr)
+        s->state.store (Stream::released, std::memory_order_release);
+}
+
+//==============================================================================
 SamplerSound::SamplerSound (const String& soundName,
                             AudioFormatReader& source,
                             const BigInteger& notes,
@@ -53,6 +247,45 @@ SamplerSound::SamplerSound (const String& soundName,
     }
 }
 
+SamplerSound::SamplerSound (const String& soundName,
+                            AudioFormatReader* sourceToStreamFrom,
+                            const BigInteger& notes,
+                            int midiNoteForNormalPitch,
+                            double attackTimeSecs,
+                            double releaseTimeSecs,
+                            double maxSampleLengthSeconds,
+                            SamplerDiskStreamer& diskStreamer,
+                            double preloadTimeSecs)
+    : name (soundName),
+      reader (sourceToStreamFrom),
+      sourceSampleRate (sourceToStreamFrom != nullptr ? sourceToStreamFrom->sampleRate : 0.0),
+      midiNotes (notes),
+      midiRootNote (midiNoteForNormalPitch)
+{
+    if (reader != nullptr && sourceSampleRate > 0 && reader->lengthInSamples > 0)
+    {
+        length = jmin ((int) reader->lengthInSamples,
+                       (int) (maxSampleLengthSeconds * sourceSampleRate));
+
+        preloadLength = jmin (length, (int) (preloadTimeSecs * sourceSampleRate));
+
+        // if it all fits in the preload time, there's no point streaming it
+        if (preloadLength < length)
+            streamer = &diskStreamer;
+
+        auto numToLoad = isStreaming() ? preloadLength : length + 4;
+
+        data.reset (new AudioBuffer<float> (jmin (2, (int) reader->numChannels), numToLoad));
+        reader->read (data.get(), 0, numToLoad, 0, true, true);
+
+        if (! isStreaming())
+            reader.reset();
+
+        params.attack  = static_cast<float> (attackTimeSecs);
+        params.release = static_cast<float> (releaseTimeSecs);
+    }
+}
+
 SamplerSound::~SamplerSound()
 {
 }
@@ -68,8 +301,350 @@ bool SamplerSound::appliesToChannel (int /*midiChannel*/)
 }
 
 //==============================================================================
-SamplerVoice::SamplerVoice() {}
-SamplerVoice::~SamplerVoice() {}
+// The vectorised interpolators step through the positions with double-precision vectors,
+// which NEON only has on 64-bit ARM
+#if JUCE_USE_SSE_INTRINSICS || (JUCE_USE_ARM_NEON && JUCE_64BIT)
+ #define JUCE_SAMPLER_VECTORISED 1
+#else
+ #define JUCE_SAMPLER_VECTORISED 0
+#endif
+
+struct SamplerInterpolators
+{
+    enum
+    {
+        numFramesBefore = 15,   // the most frames that any interpolator reads before a position..
+        numFramesAfter  = 16,   // ..and after it
+        windowCapacity  = 1024,
+        maxChunkSize    = 256
+    };
+
+   #if JUCE_SAMPLER_VECTORISED
+    // Four floats, with just enough arithmetic for the polynomial interpolators
+    struct Float4
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        using NativeType = __m128;
+
+        Float4() = default;
+        Float4 (NativeType value) noexcept  : v (value) {}
+        Float4 (float value) noexcept       : v (_mm_set1_ps (value)) {}
+
+        static forcedinline Float4 load (const float* src) noexcept     { return _mm_loadu_ps (src); }
+        forcedinline void store (float* dest) const noexcept            { _mm_storeu_ps (dest, v); }
+
+        friend forcedinline Float4 operator+ (Float4 a, Float4 b) noexcept    { return _mm_add_ps (a.v, b.v); }
+        friend forcedinline Float4 operator- (Float4 a, Float4 b) noexcept    { return _mm_sub_ps (a.v, b.v); }
+        friend forcedinline Float4 operator* (Float4 a, Float4 b) noexcept    { return _mm_mul_ps (a.v, b.v); }
+
+        static forcedinline void transpose (Float4& a, Float4& b, Float4& c, Float4& d) noexcept
+        {
+            _MM_TRANSPOSE4_PS (a.v, b.v, c.v, d.v);
+        }
+       #else
+        using NativeType = float32x4_t;
+
+        Float4() = default;
+        Float4 (NativeType value) noexcept  : v (value) {}
+        Float4 (float value) noexcept       : v (vdupq_n_f32 (value)) {}
+
+        static forcedinline Float4 load (const float* src) noexcept     { return vld1q_f32 (src); }
+        forcedinline void store (float* dest) const noexcept            { vst1q_f32 (dest, v); }
+
+        friend forcedinline Float4 operator+ (Float4 a, Float4 b) noexcept    { return vaddq_f32 (a.v, b.v); }
+        friend forcedinline Float4 operator- (Float4 a, Float4 b) noexcept    { return vsubq_f32 (a.v, b.v); }
+        friend forcedinline Float4 operator* (Float4 a, Float4 b) noexcept    { return vmulq_f32 (a.v, b.v); }
+
+        static forcedinline void transpose (Float4& a, Float4& b, Float4& c, Float4& d) noexcept
+        {
+            auto ab = vtrnq_f32 (a.v, b.v);
+            auto cd = vtrnq_f32 (c.v, d.v);
+
+            a = vcombine_f32 (vget_low_f32  (ab.val[0]), vget_low_f32  (cd.val[0]));
+            b = vcombine_f32 (vget_low_f32  (ab.val[1]), vget_low_f32  (cd.val[1]));
+            c = vcombine_f32 (vget_high_f32 (ab.val[0]), vget_high_f32 (cd.val[0]));
+            d = vcombine_f32 (vget_high_f32 (ab.val[1]), vget_high_f32 (cd.val[1]));
+        }
+       #endif
+
+        NativeType v;
+    };
+
+    // Four evenly spaced positions, which are split into frame indexes and fractions
+    struct Positions4
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        Positions4 (double start, double increment) noexcept
+            : p01 (_mm_set_pd (start + increment, start)),
+              p23 (_mm_set_pd (start + 3.0 * increment, start + 2.0 * increment)),
+              step (_mm_set1_pd (4.0 * increment))
+        {}
+
+        forcedinline Float4 split (int* indexes) const noexcept
+        {
+            auto i01 = _mm_cvttpd_epi32 (p01);
+            auto i23 = _mm_cvttpd_epi32 (p23);
+            _mm_storeu_si128 ((__m128i*) indexes, _mm_unpacklo_epi64 (i01, i23));
+
+            return _mm_movelh_ps (_mm_cvtpd_ps (_mm_sub_pd (p01, _mm_cvtepi32_pd (i01))),
+                                  _mm_cvtpd_ps (_mm_sub_pd (p23, _mm_cvtepi32_pd (i23))));
+        }
+
+        forcedinline void advance() noexcept
+        {
+            p01 = _mm_add_pd (p01, step);
+            p23 = _mm_add_pd (p23, step);
+        }
+
+        __m128d p01, p23, step;
+       #else
+        Positions4 (double start, double increment) noexcept
+        {
+            const double positions[] = { start, start + increment, start + 2.0 * increment, start + 3.0 * increment };
+            p01 = vld1q_f64 (positions);
+            p23 = vld1q_f64 (positions + 2);
+            step = vdupq_n_f64 (4.0 * increment);
+        }
+
+        forcedinline Float4 split (int* indexes) const noexcept
+        {
+            auto i01 = vcvtq_s64_f64 (p01);
+            auto i23 = vcvtq_s64_f64 (p23);
+            vst1_s32 (indexes,     vmovn_s64 (i01));
+            vst1_s32 (indexes + 2, vmovn_s64 (i23));
+
+            return vcombine_f32 (vcvt_f32_f64 (vsubq_f64 (p01, vcvtq_f64_s64 (i01))),
+                                 vcvt_f32_f64 (vsubq_f64 (p23, vcvtq_f64_s64 (i23))));
+        }
+
+        forcedinline void advance() noexcept
+        {
+            p01 = vaddq_f64 (p01, step);
+            p23 = vaddq_f64 (p23, step);
+        }
+
+        float64x2_t p01, p23, step;
+       #endif
+    };
+   #endif
+
+    // The polynomial interpolators are written for any type with +, - and *, so that
+    // the same expressions are used for single values and for four at once.
+    struct Linear
+    {
+        enum { firstFrame = 0 };    // the frame, relative to the position, that the four frames start at
+
+        template <typename Type>
+        static forcedinline Type interpolate (Type y0, Type y1, Type alpha) noexcept
+        {
+            return y0 * (1.0f - alpha) + y1 * alpha;
+        }
+
+        static forcedinline float valueAt (const float* in, float alpha) noexcept
+        {
+            return interpolate (in[0], in[1], alpha);
+        }
+
+       #if JUCE_SAMPLER_VECTORISED
+        static forcedinline Float4 valuesAt (const Float4* frames, Float4 alpha) noexcept
+        {
+            return interpolate (frames[0], frames[1], alpha);
+        }
+       #endif
+    };
+
+    struct Cubic
+    {
+        enum { firstFrame = -1 };
+
+        template <typename Type>
+        static forcedinline Type interpolate (Type y0, Type y1, Type y2, Type y3, Type alpha) noexcept
+        {
+            auto halfY0 = 0.5f * y0;
+            auto halfY3 = 0.5f * y3;
+
+            return y1 + alpha * ((0.5f * y2 - halfY0)
+                                   + (alpha * (((y0 + 2.0f * y2) - (halfY3 + 2.5f * y1))
+                                                 + (alpha * ((halfY3 + 1.5f * y1) - (halfY0 + 1.5f * y2))))));
+        }
+
+        static forcedinline float valueAt (const float* in, float alpha) noexcept
+        {
+            return interpolate (in[-1], in[0], in[1], in[2], alpha);
+        }
+
+       #if JUCE_SAMPLER_VECTORISED
+        static forcedinline Float4 valuesAt (const Float4* frames, Float4 alpha) noexcept
+        {
+            return interpolate (frames[0], frames[1], frames[2], frames[3], alpha);
+        }
+       #endif
+    };
+
+    struct Sinc
+    {
+        forcedinline float valueAt (const float* in, float alpha) const noexcept
+        {
+            return table.getValueAt (in, alpha);
+        }
+
+       #if JUCE_SAMPLER_VECTORISED
+        // Does the same as valueAt() for four positions. The products for each position are
+        // summed four taps at a time, and the partial sums of all four are then transposed
+        // and added, so that no horizontal additions are needed.
+        forcedinline Float4 valuesAt (const float* firstFrame, const int* indexes, Float4 alpha) const noexcept
+        {
+            auto numTaps = table.getNumTaps();
+            auto numPhases = table.getNumPhases();
+
+            float phases[4];
+            (alpha * (float) numPhases).store (phases);
+
+            Float4 sums[4];
+
+            for (int j = 0; j < 4; ++j)
+            {
+                auto phase = jlimit (0, numPhases - 1, (int) phases[j]);
+                auto* kernel1 = table.getKernel (phase);
+                auto* kernel2 = kernel1 + numTaps;
+                auto* frames = firstFrame + indexes[j];
+
+                Float4 sum1 (0.0f), sum2 (0.0f);
+
+                for (int i = 0; i < numTaps; i += 4)
+                {
+                    auto samples = Float4::load (frames + i);
+                    sum1 = sum1 + samples * Float4::load (kernel1 + i);
+                    sum2 = sum2 + samples * Float4::load (kernel2 + i);
+                }
+
+                sums[j] = sum1 + Float4 (phases[j] - (float) phase) * (sum2 - sum1);
+            }
+
+            Float4::transpose (sums[0], sums[1], sums[2], sums[3]);
+            return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        }
+       #endif
+
+        const WindowedSincTable& table;
+    };
+
+    // The sinc tables for transposing a sound up by 0, 0.5, 1, 1.5 and 2 octaves. Each one's
+    // cutoff is brought down by that ratio so that nothing above the output's Nyquist
+    // frequency is folded back, and its kernels are made longer by the same ratio so that
+    // the transition band stays as narrow, relative to the cutoff.
+    enum { numSincTables = 5 };
+    static const WindowedSincTable sincTables[numSincTables];
+
+    // Picks the table whose cutoff is the highest one that is no higher than 0.5 / ratio,
+    // or the last one for the ratios which are bigger than any of them.
+    static const WindowedSincTable& getSincTable (double ratio) noexcept
+    {
+        auto index = ratio > 1.0 ? (int) std::ceil (2.0 * std::log2 (ratio) - 1.0e-9) : 0;
+        return sincTables[jmin (index, (int) numSincTables - 1)];
+    }
+
+    // Fills an output array with values interpolated at evenly spaced positions. The
+    // window holds the source frames starting at windowStart.
+    template <typename InterpolatorType>
+    static void process (InterpolatorType interpolator, const float* window, int64 windowStart,
+                         double position, double increment, float* output, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto index = (int) position;
+            output[i] = interpolator.valueAt (window + (index - windowStart), (float) (position - index));
+            position += increment;
+        }
+    }
+
+    // Does the same as process(), but four output samples at a time. The positions are
+    // split into indexes and fractions four at a time, and the four frames that each one
+    // needs are loaded and transposed, so that frames[n] holds the n'th frame for all four
+    // positions and the interpolator's arithmetic can be done on all of them at once.
+    template <typename InterpolatorType>
+    static void processPolynomial (const float* window, int64 windowStart,
+                                   double position, double increment, float* output, int numSamples) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_SAMPLER_VECTORISED
+        auto* firstFrame = window - windowStart + InterpolatorType::firstFrame;
+        Positions4 positions (position, increment);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            int indexes[4];
+            auto alpha = positions.split (indexes);
+            positions.advance();
+
+            Float4 frames[4];
+
+            for (int j = 0; j < 4; ++j)
+                frames[j] = Float4::load (firstFrame + indexes[j]);
+
+            Float4::transpose (frames[0], frames[1], frames[2], frames[3]);
+            InterpolatorType::valuesAt (frames, alpha).store (output + i);
+        }
+       #endif
+
+        process (InterpolatorType(), window, windowStart, position + i * increment, increment, output + i, numSamples - i);
+    }
+
+    // Does the same as process() with the sinc table that suits the increment, four
+    // output samples at a time.
+    static void processSinc (const float* window, int64 windowStart,
+                             double position, double increment, float* output, int numSamples) noexcept
+    {
+        Sinc sinc { getSincTable (increment) };
+        int i = 0;
+
+       #if JUCE_SAMPLER_VECTORISED
+        auto* firstFrame = window - windowStart - sinc.table.getNumSamplesBefore();
+        Positions4 positions (position, increment);
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            int indexes[4];
+            auto alpha = positions.split (indexes);
+            positions.advance();
+
+            sinc.valuesAt (firstFrame, indexes, alpha).store (output + i);
+        }
+       #endif
+
+        process (sinc, window, windowStart, position + i * increment, increment, output + i, numSamples - i);
+    }
+
+    static void process (SamplerVoice::Interpolation type, const float* window, int64 windowStart,
+                         double position, double increment, float* output, int numSamples) noexcept
+    {
+        switch (type)
+        {
+            case SamplerVoice::Interpolation::cubic:  processPolynomial<Cubic>  (window, windowStart, position, increment, output, numSamples); break;
+            case SamplerVoice::Interpolation::sinc:   processSinc (window, windowStart, position, increment, output, numSamples); break;
+            case SamplerVoice::Interpolation::linear:
+            default:                                  processPolynomial<Linear> (window, windowStart, position, increment, output, numSamples); break;
+        }
+    }
+};
+
+// built when the library is loaded, so that no voice ever has to do it on the audio thread
+const WindowedSincTable SamplerInterpolators::sincTables[] = { {  8, 256, 0.5,                                      6.0 },
+                                                               { 12, 256, 0.5  / MathConstants<double>::sqrt2,      6.0 },
+                                                               { 16, 256, 0.25,                                     6.0 },
+                                                               { 24, 256, 0.25 / MathConstants<double>::sqrt2,      6.0 },
+                                                               { 32, 256, 0.125,                                    6.0 } };
+
+#undef JUCE_SAMPLER_VECTORISED
+
+//==============================================================================
+SamplerVoice::SamplerVoice()  : sourceWindow (2, SamplerInterpolators::windowCapacity) {}
+
+SamplerVoice::~SamplerVoice()
+{
+    releaseStream();
+}
 
 bool SamplerVoice::canPlaySound (SynthesiserSound* sound)
 {
@@ -78,7 +653,9 @@ bool SamplerVoice::canPlaySound (SynthesiserSound* sound)
 
 void SamplerVoice::startNote (int midiNoteNumber, float velocity, SynthesiserSound* s, int /*currentPitchWheelPosition*/)
 {
-    if (auto* sound = dynamic_cast<const SamplerSound*> (s))
+    releaseStream();
+
+    if (auto* sound = dynamic_cast<SamplerSound*> (s))
     {
         pitchRatio = std::pow (2.0, (midiNoteNumber - sound->midiRootNote) / 12.0)
                         * sound->sourceSampleRate / getSampleRate();
@@ -91,6 +668,9 @@ void SamplerVoice::startNote (int midiNoteNumber, float velocity, SynthesiserSou
         adsr.setParameters (sound->params);
 
         adsr.noteOn();
+
+        if (sound->isStreaming())
+            stream = sound->streamer->acquireStream (*sound, sound->preloadLength);
     }
     else
     {
@@ -108,6 +688,16 @@ void SamplerVoice::stopNote (float /*velocity*/, bool allowTailOff)
     {
         clearCurrentNote();
         adsr.reset();
+        releaseStream();
+    }
+}
+
+void SamplerVoice::releaseStream() noexcept
+{
+    if (stream != nullptr)
+    {
+        stream->samplerSound->streamer->releaseStream (stream);
+        stream = nullptr;
     }
 }
 
@@ -119,48 +709,490 @@ void SamplerVoice::renderNextBlock (AudioBuffer<float>& outputBuffer, int startS
 {
     if (auto* playingSound = static_cast<SamplerSound*> (getCurrentlyPlayingSound().get()))
     {
-        auto& data = *playingSound->data;
-        const float* const inL = data.getReadPointer (0);
-        const float* const inR = data.getNumChannels() > 1 ? data.getReadPointer (1) : nullptr;
+        // the longest chunk whose source frames will all fit into the window
+        auto maxChunkSize = jmax (1, (int) jmin ((double) SamplerInterpolators::maxChunkSize,
+                                                 (SamplerInterpolators::windowCapacity - SamplerInterpolators::numFramesBefore
+                                                    - SamplerInterpolators::numFramesAfter - 1) / pitchRatio));
+
+        while (numSamples > 0)
+        {
+            auto numThisTime = jmin (numSamples, maxChunkSize);
+
+            if (! renderChunk (*playingSound, outputBuffer, startSample, numThisTime))
+                break;
+
+            startSample += numThisTime;
+            numSamples  -= numThisTime;
+        }
+    }
+}
+
+bool SamplerVoice::renderChunk (SamplerSound& sound, AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    // without a stream, only the preloaded part of a streamed sound can be played
+    auto hasFinished = [&] (double position)
+    {
+        return position > sound.length
+                || (sound.isStreaming() && stream == nullptr && position >= sound.preloadLength);
+    };
+
+    // step through the positions in exactly the same way as the interpolators will,
+    // to find out how many samples can be played before the sound ends
+    auto lastPosition = sourceSamplePosition;
+    auto endPosition = sourceSamplePosition;
+    bool reachedEnd = false;
+    int numToRender = 0;
+
+    while (numToRender < numSamples)
+    {
+        ++numToRender;
+        lastPosition = endPosition;
+        endPosition += pitchRatio;
+
+        if (hasFinished (endPosition))
+        {
+            reachedEnd = true;
+            break;
+        }
+    }
+
+    auto firstFrame = (int64) sourceSamplePosition - SamplerInterpolators::numFramesBefore;
+    auto numFrames = (int) ((int64) lastPosition - firstFrame) + SamplerInterpolators::numFramesAfter + 1;
+
+    auto& data = *sound.data;
+    auto isStereo = data.getNumChannels() > 1;
+    const float* left;
+    const float* right;
+
+    if (! sound.isStreaming() && firstFrame >= 0 && firstFrame + numFrames <= data.getNumSamples())
+    {
+        left  = data.getReadPointer (0, (int) firstFrame);
+        right = data.getReadPointer (isStereo ? 1 : 0, (int) firstFrame);
+    }
+    else
+    {
+        if (! copySourceFrames (sound, firstFrame, numFrames))
+            ++(sound.streamer->reader->numUnderruns);
+
+        left  = sourceWindow.getReadPointer (0);
+        right = sourceWindow.getReadPointer (isStereo ? 1 : 0);
+    }
+
+    float envelope[SamplerInterpolators::maxChunkSize];
+    float tempL[SamplerInterpolators::maxChunkSize], tempR[SamplerInterpolators::maxChunkSize];
+    const float* processedR = tempL;
+
+    SamplerInterpolators::process (interpolation, left, firstFrame, sourceSamplePosition, pitchRatio, tempL, numToRender);
+    adsr.getNextBlock (envelope, numToRender);
+    FloatVectorOperations::multiply (tempL, envelope, numToRender);
+
+    if (isStereo)
+    {
+        SamplerInterpolators::process (interpolation, right, firstFrame, sourceSamplePosition, pitchRatio, tempR, numToRender);
+        FloatVectorOperations::multiply (tempR, envelope, numToRender);
+        processedR = tempR;
+    }
+
+    if (outputBuffer.getNumChannels() > 1)
+    {
+        outputBuffer.addFrom (0, startSample, tempL, numToRender, lgain);
+        outputBuffer.addFrom (1, startSample, processedR, numToRender, rgain);
+    }
+    else
+    {
+        outputBuffer.addFrom (0, startSample, tempL, numToRender, lgain * 0.5f);
+        outputBuffer.addFrom (0, startSample, processedR, numToRender, rgain * 0.5f);
+    }
+
+    sourceSamplePosition = endPosition;
+
+    if (stream != nullptr)
+    {
+        // hand back the frames that the interpolators won't need again
+        auto numReady = stream->fifo.getNumReady();
+        auto numFinished = (int) jlimit ((int64) 0, (int64) numReady,
+                                         (int64) sourceSamplePosition - SamplerInterpolators::numFramesBefore
+                                            - stream->firstSampleInFifo);
+        stream->fifo.finishedRead (numFinished);
+        stream->firstSampleInFifo += numFinished;
+    }
+
+    if (reachedEnd)
+    {
+        stopNote (0.0f, false);
+        return false;
+    }
+
+    return true;
+}
+
+bool SamplerVoice::copySourceFrames (SamplerSound& sound, int64 firstFrame, int numFrames)
+{
+    auto& data = *sound.data;
+    auto numChannels = data.getNumChannels();
+    auto headLength = (int64) data.getNumSamples();
+    auto endOfSound = sound.isStreaming() ? (int64) sound.length + 4 : headLength;
+    auto endFrame = firstFrame + numFrames;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        FloatVectorOperations::clear (sourceWindow.getWritePointer (ch), numFrames);
+
+    // the frames that are held in memory..
+    auto headStart = jmax (firstFrame, (int64) 0);
+    auto headEnd   = jmin (endFrame, headLength);
+
+    if (headEnd > headStart)
+        for (int ch = 0; ch < numChannels; ++ch)
+            FloatVectorOperations::copy (sourceWindow.getWritePointer (ch, (int) (headStart - firstFrame)),
+                                         data.getReadPointer (ch, (int) headStart), (int) (headEnd - headStart));
+
+    // ..and the ones that have to come from the disk stream
+    auto streamStart = jmax (firstFrame, headLength);
+    auto streamEnd   = jmin (endFrame, endOfSound);
+
+    if (streamEnd <= streamStart || stream == nullptr)
+        return true;
+
+    int start1, size1, start2, size2;
+    stream->fifo.prepareToRead (stream->fifo.getNumReady(), start1, size1, start2, size2);
+
+    auto fifoStart = stream->firstSampleInFifo;
+    auto availableStart = jmax (streamStart, fifoStart);
+    auto availableEnd   = jmin (streamEnd, fifoStart + size1 + size2);
+
+    if (availableEnd > availableStart)
+    {
+        auto fifoSize = stream->fifo.getTotalSize();
+        auto readPos = start1 + (int) (availableStart - fifoStart);
+        auto writePos = (int) (availableStart - firstFrame);
+        auto numToCopy = (int) (availableEnd - availableStart);
+
+        if (readPos >= fifoSize)
+            readPos -= fifoSize;
+
+        while (numToCopy > 0)
+        {
+            auto num = jmin (numToCopy, fifoSize - readPos);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                FloatVectorOperations::copy (sourceWindow.getWritePointer (ch, writePos),
+                                             stream->buffer.getReadPointer (ch, readPos), num);
+
+            readPos = 0;
+            writePos += num;
+            numToCopy -= num;
+        }
+    }
+
+    return availableStart == streamStart && availableEnd == streamEnd;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SamplerTests  : public UnitTest
+{
+public:
+    SamplerTests()  : UnitTest ("Sampler", "Audio") {}
+
+    enum
+    {
+        sampleRate = 44100,
+        numTestSamples = 50000,
+        blockSize = 512,
+        testNote = 60
+    };
+
+    static MemoryBlock createTestWav (double omega)
+    {
+        AudioBuffer<float> source (2, numTestSamples);
+
+        for (int i = 0; i < numTestSamples; ++i)
+        {
+            source.setSample (0, i, 0.5f * (float) std::sin (i * omega));
+            source.setSample (1, i, 0.5f * (float) std::cos (i * omega * 0.3));
+        }
+
+        MemoryBlock wav;
+
+        {
+            WavAudioFormat format;
+            std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (wav, false),
+                                                                               sampleRate, 2, 16, {}, 0));
+            writer->writeFromAudioSampleBuffer (source, 0, numTestSamples);
+        }
+
+        return wav;
+    }
+
+    static AudioFormatReader* createReader (const MemoryBlock& wav)
+    {
+        WavAudioFormat format;
+        return format.createReaderFor (new MemoryInputStream (wav, false), true);
+    }
+
+    static void prepare (Synthesiser& synth, SamplerSound* sound,
+                         SamplerVoice::Interpolation interpolation = SamplerVoice::Interpolation::linear,
+                         int noteToPlay = testNote)
+    {
+        auto* voice = new SamplerVoice();
+        voice->setInterpolation (interpolation);
+        synth.addVoice (voice);
+        synth.addSound (sound);
+        synth.setCurrentPlaybackSampleRate (sampleRate);
+        synth.noteOn (1, noteToPlay, 1.0f);
+    }
+
+    // Plays the sound an octave below its root note, and returns the largest difference
+    // between the output and the sine wave that was used to create it.
+    double getOctaveDownError (const MemoryBlock& wav, double omega, SamplerVoice::Interpolation interpolation)
+    {
+        std::unique_ptr<AudioFormatReader> reader (createReader (wav));
+        BigInteger notes;
+        notes.setRange (0, 128, true);
 
-        float* outL = outputBuffer.getWritePointer (0, startSample);
-        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+        Synthesiser synth;
+        prepare (synth, new SamplerSound ("test", *reader, notes, testNote + 12, 0.0, 0.1, 10.0),
+                 interpolation, testNote);
 
-        while (--numSamples >= 0)
+        const int numSamples = 2000;
+        AudioBuffer<float> output (2, numSamples);
+        output.clear();
+        synth.renderNextBlock (output, MidiBuffer(), 0, numSamples);
+
+        double maxError = 0;
+
+        for (int i = 10; i < numSamples; ++i)
+            maxError = jmax (maxError, std::abs (output.getSample (0, i) - 0.5 * std::sin (i * 0.5 * omega)));
+
+        return maxError;
+    }
+
+    // Plays the left channel of the sound an octave above its root note, and returns
+    // the RMS level of the output.
+    double getOctaveUpLevel (const MemoryBlock& wav, SamplerVoice::Interpolation interpolation)
+    {
+        std::unique_ptr<AudioFormatReader> reader (createReader (wav));
+        BigInteger notes;
+        notes.setRange (0, 128, true);
+
+        Synthesiser synth;
+        prepare (synth, new SamplerSound ("test", *reader, notes, testNote - 12, 0.0, 0.1, 10.0),
+                 interpolation, testNote);
+
+        const int numSamples = 4000;
+        AudioBuffer<float> output (2, numSamples);
+        output.clear();
+        synth.renderNextBlock (output, MidiBuffer(), 0, numSamples);
+
+        return output.getRMSLevel (0, 100, numSamples - 100);
+    }
+
+    void runTest() override
+    {
+        beginTest ("ADSR blocks match single samples");
         {
-            auto pos = (int) sourceSamplePosition;
-            auto alpha = (float) (sourceSamplePosition - pos);
-            auto invAlpha = 1.0f - alpha;
+            ADSR blockAdsr, sampleAdsr;
+
+            for (auto* adsr : { &blockAdsr, &sampleAdsr })
+            {
+                adsr->setSampleRate (1000.0);
+                adsr->setParameters ({ 0.1f, 0.05f, 0.5f, 0.2f });
+                adsr->noteOn();
+            }
+
+            float block[300];
+
+            for (int i = 0; i < 4; ++i)
+            {
+                if (i == 2)
+                {
+                    blockAdsr.noteOff();
+                    sampleAdsr.noteOff();
+                }
 
-            // just using a very simple linear interpolation here..
-            float l = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
-            float r = (inR != nullptr) ? (inR[pos] * invAlpha + inR[pos + 1] * alpha)
-                                       : l;
+                blockAdsr.getNextBlock (block, numElementsInArray (block));
 
-            auto envelopeValue = adsr.getNextSample();
+                for (auto value : block)
+                    expect (value == sampleAdsr.getNextSample());
+            }
+
+            expect (! blockAdsr.isActive());
+        }
 
-            l *= lgain * envelopeValue;
-            r *= rgain * envelopeValue;
+        beginTest ("Vectorised interpolation matches single samples");
+        {
+            Random random (1234);
+            float window[1024];
 
-            if (outR != nullptr)
+            for (auto& sample : window)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+
+            const int numSamples = 203;
+            const int64 windowStart = 100;
+            float output[numSamples];
+
+            for (auto increment : { 0.7731, 1.0, 1.37, 3.0 })
             {
-                *outL++ += l;
-                *outR++ += r;
+                auto startPosition = windowStart + SamplerInterpolators::numFramesBefore + 0.25;
+
+                SamplerInterpolators::process (SamplerVoice::Interpolation::linear, window, windowStart,
+                                               startPosition, increment, output, numSamples);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    auto position = startPosition + i * increment;
+                    expectWithinAbsoluteError (output[i], SamplerInterpolators::Linear::valueAt (window + ((int) position - windowStart),
+                                                                                                  (float) (position - (int) position)), 1.0e-6f);
+                }
+
+                SamplerInterpolators::process (SamplerVoice::Interpolation::cubic, window, windowStart,
+                                               startPosition, increment, output, numSamples);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    auto position = startPosition + i * increment;
+                    expectWithinAbsoluteError (output[i], SamplerInterpolators::Cubic::valueAt (window + ((int) position - windowStart),
+                                                                                                 (float) (position - (int) position)), 1.0e-6f);
+                }
+
+                SamplerInterpolators::process (SamplerVoice::Interpolation::sinc, window, windowStart,
+                                               startPosition, increment, output, numSamples);
+
+                auto& table = SamplerInterpolators::getSincTable (increment);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    auto position = startPosition + i * increment;
+                    expectWithinAbsoluteError (output[i], table.getValueAt (window + ((int) position - windowStart),
+                                                                            (float) (position - (int) position)), 1.0e-5f);
+                }
             }
-            else
+        }
+
+        beginTest ("Interpolation at the root note reproduces the sound");
+        {
+            auto wav = createTestWav (0.05);
+            std::unique_ptr<AudioFormatReader> reader (createReader (wav));
+            BigInteger notes;
+            notes.setRange (0, 128, true);
+
+            for (auto interpolation : { SamplerVoice::Interpolation::linear,
+                                        SamplerVoice::Interpolation::cubic,
+                                        SamplerVoice::Interpolation::sinc })
             {
-                *outL++ += (l + r) * 0.5f;
+                auto* sound = new SamplerSound ("test", *reader, notes, testNote, 0.0, 0.1, 10.0);
+                Synthesiser synth;
+                prepare (synth, sound, interpolation);
+
+                const int numSamples = 1000;
+                AudioBuffer<float> output (2, numSamples);
+                output.clear();
+                synth.renderNextBlock (output, MidiBuffer(), 0, numSamples);
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < numSamples; ++i)
+                        expectWithinAbsoluteError (output.getSample (ch, i), sound->getAudioData()->getSample (ch, i), 1.0e-6f);
             }
+        }
+
+        beginTest ("Higher order interpolation is more accurate");
+        {
+            const double omega = 0.3;
+            auto wav = createTestWav (omega);
+
+            auto linearError = getOctaveDownError (wav, omega, SamplerVoice::Interpolation::linear);
+            auto cubicError  = getOctaveDownError (wav, omega, SamplerVoice::Interpolation::cubic);
+            auto sincError   = getOctaveDownError (wav, omega, SamplerVoice::Interpolation::sinc);
+
+            expect (linearError < 0.01);
+            expect (cubicError < linearError * 0.5);
+            expect (sincError < linearError * 0.1);
+        }
 
-            sourceSamplePosition += pitchRatio;
+        beginTest ("Sinc interpolation doesn't alias when transposing upwards");
+        {
+            // A tone at 0.45 times the sample rate, played an octave up, is above the Nyquist
+            // frequency and should disappear rather than fold back down to 0.1
+            auto wav = createTestWav (0.9 * MathConstants<double>::pi);
+
+            auto linearAliasing = getOctaveUpLevel (wav, SamplerVoice::Interpolation::linear);
+            auto sincAliasing   = getOctaveUpLevel (wav, SamplerVoice::Interpolation::sinc);
+
+            expect (linearAliasing > 0.1, "linear " + String (linearAliasing));
+            expect (sincAliasing < 0.005, "sinc " + String (sincAliasing));
+        }
+
+        auto wav = createTestWav (0.01);
+        BigInteger notes;
+        notes.setRange (0, 128, true);
+
+        beginTest ("Streamed playback matches a preloaded sound");
+        {
+            // The thread isn't started: the test does the reading itself before each block,
+            // so the result doesn't depend on how quickly the reader thread gets scheduled
+            TimeSliceThread thread ("Sampler test reader");
+            SamplerDiskStreamer streamer (thread, 4, 8192);
+            expectEquals (streamer.getMaxNumStreams(), 4);
+
+            auto* streamReader = thread.getClient (0);
+            expect (streamReader != nullptr);
 
-            if (sourceSamplePosition > playingSound->length)
             {
-                stopNote (0.0f, false);
-                break;
+                std::unique_ptr<AudioFormatReader> preloadedReader (createReader (wav));
+
+                Synthesiser preloaded, streamed;
+                prepare (preloaded, new SamplerSound ("preloaded", *preloadedReader, notes, testNote, 0.0, 0.1, 10.0));
+
+                auto* streamedSound = new SamplerSound ("streamed", createReader (wav), notes, testNote,
+                                                        0.0, 0.1, 10.0, streamer, 0.05);
+                expect (streamedSound->isStreaming());
+                prepare (streamed, streamedSound);
+
+                expectEquals (streamer.getNumActiveStreams(), 1);
+
+                AudioBuffer<float> expected (2, blockSize), actual (2, blockSize);
+                MidiBuffer noMidi;
+
+                for (int pos = 0; pos < numTestSamples + blockSize; pos += blockSize)
+                {
+                    expected.clear();
+                    actual.clear();
+
+                    // fill every stream as far as it'll go
+                    while (streamReader->useTimeSlice() == 0)
+                    {}
+
+                    preloaded.renderNextBlock (expected, noMidi, 0, blockSize);
+                    streamed.renderNextBlock (actual, noMidi, 0, blockSize);
+
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < blockSize; ++i)
+                            if (actual.getSample (ch, i) != expected.getSample (ch, i))
+                                expect (false, "Sample mismatch at position " + String (pos + i));
+                }
+
+                expectEquals (streamer.getNumUnderruns(), 0);
+                expect (! streamed.getVoice (0)->isVoiceActive());
+                expectEquals (streamer.getNumActiveStreams(), 0);
             }
         }
+
+        beginTest ("Short samples are loaded into memory");
+        {
+            TimeSliceThread thread ("Sampler test reader");
+            SamplerDiskStreamer streamer (thread);
+
+            SamplerSound sound ("short", createReader (wav), notes, testNote, 0.0, 0.1, 10.0, streamer, 2.0);
+            expect (! sound.isStreaming());
+            expectEquals (sound.getAudioData()->getNumSamples(), numTestSamples + 4);
+        }
     }
-}
+};
+
+static SamplerTests samplerTests;
+
+#endif // JUCE_UNIT_TESTS
 
 } // namespace juce
@@ -27,12 +27,83 @@
 namespace juce
 {
 
+class SamplerSound;
+class SamplerVoice;
+
+//==============================================================================
+/**
+    Streams the audio for SamplerSounds from disk while they're being played.
+
+    A streaming SamplerSound only keeps the first part of its audio in memory. When a
+    SamplerVoice starts playing it, the voice takes one of this object's streams, and
+    the rest of the sample is read into the stream's FIFO on a background thread while
+    the voice plays the preloaded part. The voice then reads from the FIFO without any
+    locking.
+
+    Each time it runs, the background thread tops up whichever active stream has the
+    least audio buffered, so the voices that are closest to running out get served first.
+
+    The streamer must be kept alive for longer than any sounds or voices that use it.
+
+    @see SamplerSound, SamplerVoice
+
+    @tags{Audio}
+*/
+class JUCE_API  SamplerDiskStreamer
+{
+public:
+    //==============================================================================
+    /** Creates a streamer.
+
+        @param threadToUse          the thread that will do the reading. This must be started
+                                    by the caller, and must outlive this object
+        @param maxNumStreams        the number of voices that can stream at the same time. A voice
+                                    that can't get a stream will only play the preloaded part of
+                                    its sample
+        @param samplesPerStream     the size of each stream's FIFO, in samples
+    */
+    SamplerDiskStreamer (TimeSliceThread& threadToUse,
+                         int maxNumStreams = 64,
+                         int samplesPerStream = 32768);
+
+    /** Destructor. */
+    ~SamplerDiskStreamer();
+
+    //==============================================================================
+    /** Returns the maximum number of streams that can be active at once. */
+    int getMaxNumStreams() const noexcept;
+
+    /** Returns the number of streams that are currently being played by a voice. */
+    int getNumActiveStreams() const noexcept;
+
+    /** Returns the number of times that a voice needed some audio that hadn't been read
+        from disk yet. If this isn't zero, you may need a longer preload time or bigger
+        streams.
+    */
+    int getNumUnderruns() const noexcept;
+
+private:
+    //==============================================================================
+    friend class SamplerVoice;
+
+    struct Stream;
+    struct Reader;
+
+    std::unique_ptr<Reader> reader;
+
+    Stream* acquireStream (SamplerSound&, int64 firstSample) noexcept;
+    void releaseStream (Stream*) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerDiskStreamer)
+};
+
 //==============================================================================
 /**
     A subclass of SynthesiserSound that represents a sampled audio clip.
 
-    This is a pretty basic sampler, and just attempts to load the whole audio stream
-    into memory.
+    This is a pretty basic sampler. It either loads the whole audio stream into memory,
+    or only loads the start of it and streams the rest from disk using a
+    SamplerDiskStreamer.
 
     To use it, create a Synthesiser, add some SamplerVoice objects to it, then
     give it some SampledSound objects to play.
@@ -71,6 +142,39 @@ public:
                   double releaseTimeSecs,
                   double maxSampleLengthSeconds);
 
+    /** Creates a sampled sound that streams its audio from disk.
+
+        Only the first preloadTimeSecs of audio is read into memory here. The rest is
+        streamed from the reader by the SamplerDiskStreamer while the sound is playing.
+        If the whole sample is shorter than the preload time, it's just loaded into
+        memory as normal.
+
+        @param name                     a name for the sample
+        @param sourceToStreamFrom       the audio to play. This object takes ownership of the
+                                        reader, which must stay valid for as long as the sound
+                                        exists. Once it's been passed in, the reader is only
+                                        used by the streamer's background thread
+        @param midiNotes                the set of midi keys that this sound should be played on
+        @param midiNoteForNormalPitch   the midi note at which the sample should be played
+                                        with its natural rate
+        @param attackTimeSecs           the attack (fade-in) time, in seconds
+        @param releaseTimeSecs          the decay (fade-out) time, in seconds
+        @param maxSampleLengthSeconds   a maximum length of audio to play from the source, in seconds
+        @param streamer                 the streamer that voices will use to play this sound
+        @param preloadTimeSecs          the length of audio to keep in memory. This needs to be
+                                        long enough to cover the time it takes for the streamer to
+                                        start reading the rest of the sample
+    */
+    SamplerSound (const String& name,
+                  AudioFormatReader* sourceToStreamFrom,
+                  const BigInteger& midiNotes,
+                  int midiNoteForNormalPitch,
+                  double attackTimeSecs,
+                  double releaseTimeSecs,
+                  double maxSampleLengthSeconds,
+                  SamplerDiskStreamer& streamer,
+                  double preloadTimeSecs = 0.5);
+
     /** Destructor. */
     ~SamplerSound() override;
 
@@ -79,10 +183,16 @@ public:
     const String& getName() const noexcept                  { return name; }
 
     /** Returns the audio sample data.
-        This could return nullptr if there was a problem loading the data.
+        This could return nullptr if there was a problem loading the data. For a sound
+        that's streamed from disk, this only contains the preloaded part of the sample.
     */
     AudioBuffer<float>* getAudioData() const noexcept       { return data.get(); }
 
+    /** Returns true if this sound streams its audio from disk.
+        @see SamplerDiskStreamer
+    */
+    bool isStreaming() const noexcept                       { return streamer != nullptr; }
+
     //==============================================================================
     /** Changes the parameters of the ADSR envelope which will be applied to the sample. */
     void setEnvelopeParameters (ADSR::Parameters parametersToUse)    { params = parametersToUse; }
@@ -94,12 +204,15 @@ public:
 private:
     //==============================================================================
     friend class SamplerVoice;
+    friend class SamplerDiskStreamer;
 
     String name;
     std::unique_ptr<AudioBuffer<float>> data;
-    double sourceSampleRate;
+    std::unique_ptr<AudioFormatReader> reader;
+    SamplerDiskStreamer* streamer = nullptr;
+    double sourceSampleRate = 0;
     BigInteger midiNotes;
-    int length = 0, midiRootNote = 0;
+    int length = 0, preloadLength = 0, midiRootNote = 0;
 
     ADSR::Parameters params;
 
@@ -139,6 +252,23 @@ public:
 
     void renderNextBlock (AudioBuffer<float>&, int startSample, int numSamples) override;
 
+    //==============================================================================
+    /** The methods that a SamplerVoice can use to interpolate between the samples of a sound. */
+    enum class Interpolation
+    {
+        linear,     /**< Two-point linear interpolation. This is the cheapest, and is the default. */
+        cubic,      /**< Four-point Catmull-Rom interpolation. */
+        sinc        /**< Eight-point Kaiser-windowed sinc interpolation. */
+    };
+
+    /** Changes the interpolation method used when the voice plays a sound at a
+        different pitch or sample rate to the one it was recorded at.
+    */
+    void setInterpolation (Interpolation newInterpolation) noexcept     { interpolation = newInterpolation; }
+
+    /** Returns the interpolation method that's currently being used. */
+    Interpolation getInterpolation() const noexcept                     { return interpolation; }
+
 private:
     //==============================================================================
     double pitchRatio = 0;
@@ -146,6 +276,14 @@ private:
     float lgain = 0, rgain = 0;
 
     ADSR adsr;
+    Interpolation interpolation = Interpolation::linear;
+    AudioBuffer<float> sourceWindow;
+
+    SamplerDiskStreamer::Stream* stream = nullptr;
+
+    bool renderChunk (SamplerSound&, AudioBuffer<float>&, int startSample, int numSamples);
+    bool copySourceFrames (SamplerSound&, int64 firstFrame, int numFrames);
+    void releaseStream() noexcept;
 
     JUCE_LEAK_DETECTOR (SamplerVoice)
 };
@@ -2277,10 +2277,30 @@ public:
 
                         if (auto* param = comPluginInstance->getParamForVSTParamID (vstParamID))
                         {
-                            param->setValue (floatValue);
+                            if (pluginInstance->usesSampleAccurateAutomation())
+                            {
+                                // the plugin gets every point, and the final value is applied after processing
+                                pluginInstance->getParameterAutomation().addEvents (*param, (int) numPoints,
+                                    [paramQueue] (int point, int& samplePosition, float& newValue)
+                                    {
+                                        Steinberg::int32 pointOffset = 0;
+                                        double pointValue = 0.0;
+
+                                        if (paramQueue->getPoint (point, pointOffset, pointValue) != kResultTrue)
+                                            return false;
+
+                                        samplePosition = (int) pointOffset;
+                                        newValue = static_cast<float> (pointValue);
+                                        return true;
+                                    });
+                            }
+                            else
+                            {
+                                param->setValue (floatValue);
 
-                            inParameterChangedCallback = true;
-                            param->sendValueChangedMessageToListeners (floatValue);
+                                inParameterChangedCallback = true;
+                                param->sendValueChangedMessageToListeners (floatValue);
+                            }
                         }
                     }
                 }
@@ -2288,6 +2308,32 @@ public:
         }
     }
 
+    void applyFinalParameterValues (Vst::IParameterChanges& paramChanges)
+    {
+        auto numParamsChanged = paramChanges.getParameterCount();
+
+        for (Steinberg::int32 i = 0; i < numParamsChanged; ++i)
+        {
+            if (auto* paramQueue = paramChanges.getParameterData (i))
+            {
+                Steinberg::int32 offsetSamples = 0;
+                double value = 0.0;
+
+                if (paramQueue->getPoint (paramQueue->getPointCount() - 1, offsetSamples, value) == kResultTrue)
+                {
+                    if (auto* param = comPluginInstance->getParamForVSTParamID (paramQueue->getParameterId()))
+                    {
+                        auto floatValue = static_cast<float> (value);
+                        param->setValue (floatValue);
+
+                        inParameterChangedCallback = true;
+                        param->sendValueChangedMessageToListeners (floatValue);
+                    }
+                }
+            }
+        }
+    }
+
     void addParameterChangeToMidiBuffer (const Steinberg::int32 offsetSamples, const Vst::ParamID id, const double value)
     {
         // If the parameter is mapped to a MIDI CC message then insert it into the midiBuffer.
@@ -2332,6 +2378,7 @@ public:
         }
 
         midiBuffer.clear();
+        pluginInstance->getParameterAutomation().clear();
 
         if (data.inputParameterChanges != nullptr)
             processParameterChanges (*data.inputParameterChanges);
@@ -2355,6 +2402,11 @@ public:
         else if (processSetup.symbolicSampleSize == Vst::kSample64) processAudio<double> (data, channelListDouble);
         else jassertfalse;
 
+        if (data.inputParameterChanges != nullptr && pluginInstance->usesSampleAccurateAutomation())
+            applyFinalParameterValues (*data.inputParameterChanges);
+
+        pluginInstance->getParameterAutomation().clear();
+
        #if JucePlugin_ProducesMidiOutput
         if (data.outputEvents != nullptr)
             MidiEventList::toEventList (*data.outputEvents, midiBuffer);
@@ -2578,6 +2630,11 @@ private:
 
         midiBuffer.ensureSize (2048);
         midiBuffer.clear();
+
+        // processParameterChanges() never grows this on the audio thread, so any points past
+        // this many are dropped, although each parameter still ends up at its final value
+        p.getParameterAutomation().ensureSize (4096);
+        p.getParameterAutomation().clear();
     }
 
     //==============================================================================
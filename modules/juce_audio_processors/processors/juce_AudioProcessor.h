@@ -927,6 +927,85 @@ public:
     */
     virtual void setNonRealtime (bool isNonRealtime) noexcept;
 
+    //==============================================================================
+    /** Tells the host whether this processor wants sample-accurate parameter automation.
+
+        Normally a host applies any parameter changes before calling processBlock(), so
+        the processor only sees the latest value of each parameter for the whole block.
+        If you enable this, the host leaves the parameter values alone and instead puts
+        the changes, along with their positions within the block, into the buffer that
+        getParameterAutomation() returns. You can then use
+        processParameterAutomationInSections() to split your processing at those points.
+
+        Once the block has been processed, the host sets each automated parameter to its
+        final value and notifies its listeners, whether or not the processor used the
+        events.
+
+        Currently the VST3 wrapper and the AudioProcessorGraph support this.
+
+        @see getParameterAutomation, processParameterAutomationInSections
+    */
+    void setUsesSampleAccurateAutomation (bool shouldUseSampleAccurateAutomation) noexcept  { sampleAccurateAutomation = shouldUseSampleAccurateAutomation; }
+
+    /** Returns true if this processor wants sample-accurate parameter automation.
+        @see setUsesSampleAccurateAutomation
+    */
+    bool usesSampleAccurateAutomation() const noexcept                  { return sampleAccurateAutomation; }
+
+    /** Returns the parameter changes for the block that's being processed.
+
+        A host fills this in before calling processBlock() and clears it afterwards. The
+        positions of the events are relative to the start of the block, in the same way as
+        the timestamps of the events in the MidiBuffer.
+
+        @see setUsesSampleAccurateAutomation, processParameterAutomationInSections
+    */
+    ParameterAutomationBuffer& getParameterAutomation() noexcept        { return parameterAutomation; }
+
+    /** Splits a block into sections at each point where an automated parameter changes.
+
+        For each section, any parameter changes at its start are applied with
+        AudioProcessorParameter::setValue() (so no listeners get called on the audio
+        thread), and then the callback is called with the section's start sample and
+        length. For example:
+
+        @code
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer&) override
+        {
+            processParameterAutomationInSections (buffer.getNumSamples(), [&] (int start, int num)
+            {
+                buffer.applyGain (start, num, gainParameter->get());
+            });
+        }
+        @endcode
+
+        Changes that fall less than minimumSectionLength samples after the start of a
+        section are applied at the start of that section, which keeps the number of
+        sections down when the automation is very dense. Changes beyond the end of the
+        block are applied after the last section.
+    */
+    template <typename Callback>
+    void processParameterAutomationInSections (int numSamples, Callback&& processSection,
+                                               int minimumSectionLength = 1)
+    {
+        auto event = parameterAutomation.begin();
+        auto end = parameterAutomation.end();
+        minimumSectionLength = jmax (1, minimumSectionLength);
+
+        for (int sectionStart = 0; sectionStart < numSamples;)
+        {
+            for (; event != end && event->samplePosition < sectionStart + minimumSectionLength; ++event)
+                event->parameter->setValue (event->value);
+
+            auto sectionEnd = event != end ? jmin (event->samplePosition, numSamples) : numSamples;
+            processSection (sectionStart, sectionEnd - sectionStart);
+            sectionStart = sectionEnd;
+        }
+
+        for (; event != end; ++event)
+            event->parameter->setValue (event->value);
+    }
+
     //==============================================================================
     /** Creates the processor's GUI.
 
@@ -1651,8 +1730,9 @@ private:
     Component::SafePointer<AudioProcessorEditor> activeEditor;
     double currentSampleRate = 0;
     int blockSize = 0, latencySamples = 0;
-    bool suspended = false, nonRealtime = false;
+    bool suspended = false, nonRealtime = false, sampleAccurateAutomation = false;
     ProcessingPrecision processingPrecision = singlePrecision;
+    ParameterAutomationBuffer parameterAutomation;
     CriticalSection callbackLock, listenerLock;
 
     friend class Bus;
@@ -24,11 +24,14 @@
   ==============================================================================
 */
 
+#include "../../juce_audio_basics/utilities/juce_AudioRenderThreadPool.h"
+
 namespace juce
 {
 
+//==============================================================================
 template <typename FloatType>
-struct GraphRenderSequence
+struct GraphRenderSequence  : public AudioRenderThreadPool::Job
 {
     GraphRenderSequence() {}
 
@@ -36,11 +39,16 @@ struct GraphRenderSequence
     {
         FloatType** audioBuffers;
         MidiBuffer* midiBuffers;
+        bool* silentChannels;
         AudioPlayHead* audioPlayHead;
         int numSamples;
+        bool measurePerformance;
     };
 
-    void perform (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages, AudioPlayHead* audioPlayHead)
+    void perform (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages, AudioPlayHead* audioPlayHead,
+                  AudioRenderThreadPool* threadPool = nullptr, bool measurePerformance = false,
+                  const ParameterAutomationBuffer* parameterAutomation = nullptr,
+                  int automationStart = 0, int automationEnd = std::numeric_limits<int>::max())
     {
         auto numSamples = buffer.getNumSamples();
         auto maxSamples = renderingBuffer.getNumSamples();
@@ -54,25 +62,44 @@ struct GraphRenderSequence
             {
                 AudioBuffer<FloatType> startAudio (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), maxSamples);
                 midiMessages.clear (maxSamples, numSamples);
-                perform (startAudio, midiMessages, audioPlayHead);
+                perform (startAudio, midiMessages, audioPlayHead, threadPool, measurePerformance,
+                         parameterAutomation, automationStart, automationStart + maxSamples);
             }
 
             AudioBuffer<FloatType> endAudio (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), maxSamples, numSamples - maxSamples);
-            perform (endAudio, tempMIDI, audioPlayHead);
+            perform (endAudio, tempMIDI, audioPlayHead, threadPool, measurePerformance,
+                     parameterAutomation, automationStart + maxSamples, automationEnd);
             return;
         }
 
+        if (parameterAutomation != nullptr)
+            routeParameterAutomation (*parameterAutomation, automationStart, automationEnd);
+
         currentAudioInputBuffer = &buffer;
         currentAudioOutputBuffer.setSize (jmax (1, buffer.getNumChannels()), numSamples);
         currentAudioOutputBuffer.clear();
         currentMidiInputBuffer = &midiMessages;
         currentMidiOutputBuffer.clear();
 
+        // a channel is only known to be silent once an op has written silence into it during this block
+        silentChannels.clear ((size_t) renderingBuffer.getNumChannels());
+        silentChannels[0] = true;
+
         {
-            const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(), audioPlayHead, numSamples };
+            const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(),
+                                    silentChannels, audioPlayHead, numSamples, measurePerformance };
 
-            for (auto* op : renderOps)
-                op->perform (context);
+            if (threadPool != nullptr && threadPool->getNumThreads() > 0 && renderOps.size() > 1)
+            {
+                currentContext = &context;
+                threadPool->perform (*this);
+                currentContext = nullptr;
+            }
+            else
+            {
+                for (auto* op : renderOps)
+                    performOp (*op, context);
+            }
         }
 
         for (int i = 0; i < buffer.getNumChannels(); ++i)
@@ -83,56 +110,215 @@ struct GraphRenderSequence
         currentAudioInputBuffer = nullptr;
     }
 
+    /*  Passes the graph's automation events for the samples from startSample up to (but not
+        including) endSample on to the nodes whose processors own the parameters. Events for any
+        other parameters are left for whoever is hosting the graph.
+    */
+    void routeParameterAutomation (const ParameterAutomationBuffer& automation, int startSample, int endSample)
+    {
+        for (auto& event : automation)
+        {
+            if (event.samplePosition >= endSample)
+                break;
+
+            // events before the start of the block are applied at the start of its first section
+            if (event.samplePosition < startSample && startSample > 0)
+                continue;
+
+            if (auto* destination = findAutomationDestination (event.parameter))
+                destination->addEvent (*event.parameter, event.value, jmax (0, event.samplePosition - startSample));
+        }
+    }
+
+    /*  The nodes have already been left at the final values, so this just tells the listeners.
+        Like the plugin wrappers, it sends one message per parameter with its final value, rather
+        than one for every event. Walking backwards through the events marks each parameter's
+        final one on its route, so this only takes two route lookups per event.
+    */
+    void sendParameterChangeMessages (const ParameterAutomationBuffer& automation)
+    {
+        for (auto* event = automation.end(); event != automation.begin();)
+        {
+            --event;
+
+            if (auto* route = findParameterRoute (event->parameter))
+                if (route->finalEvent == nullptr)
+                    route->finalEvent = event;
+        }
+
+        for (auto& event : automation)
+        {
+            if (auto* route = findParameterRoute (event.parameter))
+            {
+                if (route->finalEvent == &event)
+                {
+                    route->finalEvent = nullptr;
+                    event.parameter->sendValueChangedMessageToListeners (event.value);
+                }
+            }
+        }
+    }
+
     void addClearChannelOp (int index)
     {
-        createOp ([=] (const Context& c)    { FloatVectorOperations::clear (c.audioBuffers[index], c.numSamples); });
+        createOp ({}, { audioResource (index) },
+                  [=] (const Context& c)
+                  {
+                      FloatVectorOperations::clear (c.audioBuffers[index], c.numSamples);
+                      c.silentChannels[index] = true;
+                  });
     }
 
     void addCopyChannelOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { FloatVectorOperations::copy (c.audioBuffers[dstIndex],
-                                                                           c.audioBuffers[srcIndex],
-                                                                           c.numSamples); });
+        createOp ({ audioResource (srcIndex) }, { audioResource (dstIndex) },
+                  [=] (const Context& c)
+                  {
+                      FloatVectorOperations::copy (c.audioBuffers[dstIndex], c.audioBuffers[srcIndex], c.numSamples);
+                      c.silentChannels[dstIndex] = c.silentChannels[srcIndex];
+                  });
     }
 
     void addAddChannelOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { FloatVectorOperations::add (c.audioBuffers[dstIndex],
-                                                                          c.audioBuffers[srcIndex],
-                                                                          c.numSamples); });
+        createOp ({ audioResource (srcIndex), audioResource (dstIndex) }, { audioResource (dstIndex) },
+                  [=] (const Context& c)
+                  {
+                      // adding silence doesn't change anything
+                      if (c.silentChannels[srcIndex])
+                          return;
+
+                      FloatVectorOperations::add (c.audioBuffers[dstIndex], c.audioBuffers[srcIndex], c.numSamples);
+                      c.silentChannels[dstIndex] = false;
+                  });
     }
 
     void addClearMidiBufferOp (int index)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[index].clear(); });
+        createOp ({}, { midiResource (index) },
+                  [=] (const Context& c)    { c.midiBuffers[index].clear(); });
     }
 
     void addCopyMidiBufferOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; });
+        createOp ({ midiResource (srcIndex) }, { midiResource (dstIndex) },
+                  [=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; });
     }
 
-    void addAddMidiBufferOp (int srcIndex, int dstIndex)
+    void addAddMidiBuffersOp (const Array<int>& srcIndexes, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex].addEvents (c.midiBuffers[srcIndex],
-                                                                                 0, c.numSamples, 0); });
+        auto* op = renderOps.add (new AddMidiBuffersOp (srcIndexes, dstIndex));
+
+        for (auto srcIndex : srcIndexes)
+            op->reads.add (midiResource (srcIndex));
+
+        op->reads.add (midiResource (dstIndex));
+        op->writes.add (midiResource (dstIndex));
     }
 
     void addDelayChannelOp (int chan, int delaySize)
     {
-        renderOps.add (new DelayChannelOp (chan, delaySize));
+        auto* op = renderOps.add (new DelayChannelOp (chan, delaySize));
+        op->reads.add (audioResource (chan));
+        op->writes.add (audioResource (chan));
     }
 
     void addProcessOp (const AudioProcessorGraph::Node::Ptr& node,
                        const Array<int>& audioChannelsUsed, int totalNumChans, int midiBuffer)
     {
-        renderOps.add (new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer));
+        auto* op = new ProcessOp (node, audioChannelsUsed, totalNumChans, midiBuffer);
+
+        // the ops added since the last node are the ones that prepare this node's inputs
+        for (int i = firstOpForNextNode; i < renderOps.size(); ++i)
+            renderOps.getUnchecked (i)->statsNode = node.get();
+
+        op->statsNode = node.get();
+        op->isProcessOp = true;
+        renderOps.add (op);
+        firstOpForNextNode = renderOps.size();
+
+        ParameterRouteComparator comparator;
+        auto& automation = op->processor.getParameterAutomation();
+
+        for (auto* parameter : op->processor.getParameters())
+            parameterRoutes.addSorted (comparator, { parameter, &automation, nullptr });
+
+        for (auto chan : op->audioChannelsToUse)
+        {
+            op->reads.addIfNotAlreadyThere (audioResource (chan));
+
+            // the first buffer is the shared read-only empty one, so mustn't count as a write
+            if (chan != 0)
+                op->writes.addIfNotAlreadyThere (audioResource (chan));
+        }
+
+        op->reads.add (midiResource (midiBuffer));
+        op->writes.add (midiResource (midiBuffer));
+
+        // I/O nodes all read or write the graph's own input and output buffers
+        if (dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (node->getProcessor()) != nullptr)
+            op->writes.add (graphIOResource);
+    }
+
+    /*  Works out which ops must have finished before each op can start, so that the
+        sequence can be rendered by several threads at once. Two ops are ordered if one
+        of them writes to a buffer that the other one reads or writes; the buffers
+        re-used by the builder are also respected this way.
+    */
+    void calculateDependencies()
+    {
+        Array<Array<int>> dependants;
+        dependants.resize (renderOps.size());
+
+        std::map<int, int> lastWriters;
+        std::map<int, Array<int>> readersSinceLastWrite;
+
+        auto addDependency = [&] (int from, int to)
+        {
+            if (from != to)
+                dependants.getReference (from).addIfNotAlreadyThere (to);
+        };
+
+        for (int i = 0; i < renderOps.size(); ++i)
+        {
+            auto& op = *renderOps.getUnchecked (i);
+
+            for (auto r : op.reads)
+            {
+                auto writer = lastWriters.find (r);
+
+                if (writer != lastWriters.end())
+                    addDependency (writer->second, i);
+            }
+
+            for (auto w : op.writes)
+            {
+                auto writer = lastWriters.find (w);
+
+                if (writer != lastWriters.end())
+                    addDependency (writer->second, i);
+
+                for (auto reader : readersSinceLastWrite[w])
+                    addDependency (reader, i);
+            }
+
+            for (auto r : op.reads)
+                if (! op.writes.contains (r))
+                    readersSinceLastWrite[r].add (i);
+
+            for (auto w : op.writes)
+            {
+                lastWriters[w] = i;
+                readersSinceLastWrite[w].clearQuick();
+            }
+        }
+
+        setDependencies (dependants);
     }
 
     void prepareBuffers (int blockSize)
     {
-        renderingBuffer.setSize (numBuffersNeeded + 1, blockSize);
-        renderingBuffer.clear();
+        allocateRenderingBuffer (numBuffersNeeded + 1, blockSize);
         currentAudioOutputBuffer.setSize (numBuffersNeeded + 1, blockSize);
         currentAudioOutputBuffer.clear();
 
@@ -140,6 +326,8 @@ struct GraphRenderSequence
         currentMidiInputBuffer = nullptr;
         currentMidiOutputBuffer.clear();
 
+        silentChannels.calloc ((size_t) renderingBuffer.getNumChannels());
+
         midiBuffers.clearQuick();
         midiBuffers.resize (numMidiBuffersNeeded);
 
@@ -153,15 +341,17 @@ struct GraphRenderSequence
 
     void releaseBuffers()
     {
-        renderingBuffer.setSize (1, 1);
+        allocateRenderingBuffer (1, 1);
         currentAudioOutputBuffer.setSize (1, 1);
+        silentChannels.calloc (1);
         currentAudioInputBuffer = nullptr;
         currentMidiInputBuffer = nullptr;
         currentMidiOutputBuffer.clear();
         midiBuffers.clear();
     }
 
-    int numBuffersNeeded = 0, numMidiBuffersNeeded = 0;
+    int numBuffersNeeded = 0, numMidiBuffersNeeded = 0, latencySamples = 0;
+    Array<AudioProcessorGraph::NodeID> nodeOrder;
 
     AudioBuffer<FloatType> renderingBuffer, currentAudioOutputBuffer;
     AudioBuffer<FloatType>* currentAudioInputBuffer = nullptr;
@@ -172,7 +362,32 @@ struct GraphRenderSequence
     Array<MidiBuffer> midiBuffers;
     MidiBuffer tempMIDI;
 
+    HeapBlock<bool> silentChannels;
+
 private:
+    //==============================================================================
+    /*  All the channels live in one zeroed block, and each one starts on a new cache
+        line, so that channels written by different render threads never share a line.
+    */
+    void allocateRenderingBuffer (int numChannels, int numSamples)
+    {
+        const size_t alignment = 64;
+        auto bytesPerChannel = ((size_t) numSamples * sizeof (FloatType) + alignment - 1) & ~(alignment - 1);
+
+        renderingData.calloc (bytesPerChannel * (size_t) numChannels + alignment);
+        renderingChannels.malloc ((size_t) numChannels);
+
+        auto* start = renderingData + ((alignment - ((pointer_sized_uint) renderingData.get() & (alignment - 1))) & (alignment - 1));
+
+        for (int i = 0; i < numChannels; ++i)
+            renderingChannels[i] = reinterpret_cast<FloatType*> (start + bytesPerChannel * (size_t) i);
+
+        renderingBuffer = AudioBuffer<FloatType> (renderingChannels, numChannels, numSamples);
+    }
+
+    HeapBlock<char> renderingData;
+    HeapBlock<FloatType*> renderingChannels;
+
     //==============================================================================
     struct RenderingOp
     {
@@ -180,14 +395,97 @@ private:
         virtual ~RenderingOp() {}
         virtual void perform (const Context&) = 0;
 
+        // the buffers that this op uses, as returned by audioResource() and midiResource()
+        Array<int> reads, writes;
+
+        // the node whose timing statistics this op's time is added to
+        AudioProcessorGraph::Node* statsNode = nullptr;
+        bool isProcessOp = false, wasSkipped = false;
+
         JUCE_LEAK_DETECTOR (RenderingOp)
     };
 
     OwnedArray<RenderingOp> renderOps;
+    const Context* currentContext = nullptr;
+    int firstOpForNextNode = 0;
+
+    //==============================================================================
+    // Maps each of the nodes' parameters to the automation buffer of the processor that owns it
+    struct ParameterRoute
+    {
+        AudioProcessorParameter* parameter;
+        ParameterAutomationBuffer* destination;
+        const ParameterAutomationBuffer::Event* finalEvent;    // only used by sendParameterChangeMessages()
+    };
+
+    struct ParameterRouteComparator
+    {
+        static int compareElements (const ParameterRoute& first, const ParameterRoute& second) noexcept
+        {
+            return first.parameter < second.parameter ? -1 : (second.parameter < first.parameter ? 1 : 0);
+        }
+    };
+
+    Array<ParameterRoute> parameterRoutes;
+
+    ParameterRoute* findParameterRoute (AudioProcessorParameter* parameter) const noexcept
+    {
+        ParameterRouteComparator comparator;
+        auto index = parameterRoutes.indexOfSorted (comparator, ParameterRoute { parameter, nullptr, nullptr });
+        return index >= 0 ? &parameterRoutes.getReference (index) : nullptr;
+    }
+
+    ParameterAutomationBuffer* findAutomationDestination (AudioProcessorParameter* parameter) const noexcept
+    {
+        auto* route = findParameterRoute (parameter);
+        return route != nullptr ? route->destination : nullptr;
+    }
+
+    enum { graphIOResource = -1 };
+
+    static int audioResource (int bufferIndex) noexcept     { return bufferIndex * 2; }
+    static int midiResource (int bufferIndex) noexcept      { return bufferIndex * 2 + 1; }
+
+    void runTask (int taskIndex) override
+    {
+        performOp (*renderOps.getUnchecked (taskIndex), *currentContext);
+    }
+
+    static void performOp (RenderingOp& op, const Context& c)
+    {
+        if (! c.measurePerformance || op.statsNode == nullptr)
+        {
+            op.perform (c);
+            return;
+        }
+
+        auto startTime = Time::getHighResolutionTicks();
+        op.perform (c);
+        auto elapsed = Time::getHighResolutionTicks() - startTime;
+
+        auto& stats = op.statsNode->statsCounters;
+
+        if (! op.isProcessOp)
+        {
+            stats.bufferCopyTicks += elapsed;
+        }
+        else if (op.wasSkipped)
+        {
+            ++stats.numSkipped;
+        }
+        else
+        {
+            auto sampleRate = op.statsNode->getProcessor()->getSampleRate();
+            auto deadline = sampleRate > 0 ? Time::secondsToHighResolutionTicks (c.numSamples / sampleRate)
+                                           : std::numeric_limits<int64>::max();
+
+            stats.addProcessTime (elapsed, deadline);
+        }
+    }
 
     //==============================================================================
     template <typename LambdaType>
-    void createOp (LambdaType&& fn)
+    void createOp (Array<int> reads, Array<int> writes, LambdaType&& fn)
     {
         struct LambdaOp  : public RenderingOp
         {
@@ -197,7 +495,9 @@ private:
             LambdaType function;
         };
 
-        renderOps.add (new LambdaOp (std::move (fn)));
+        auto* op = renderOps.add (new LambdaOp (std::move (fn)));
+        op->reads = std::move (reads);
+        op->writes = std::move (writes);
     }
 
     //==============================================================================
@@ -213,6 +513,20 @@ private:
 
         void perform (const Context& c) override
         {
+            if (c.silentChannels[channel])
+            {
+                // once the delay line only holds silence, silence in means silence out
+                if (numSilentSamplesIn >= bufferSize)
+                    return;
+
+                c.silentChannels[channel] = (numSilentSamplesIn >= bufferSize - 1);
+                numSilentSamplesIn += c.numSamples;
+            }
+            else
+            {
+                numSilentSamplesIn = 0;
+            }
+
             auto* data = c.audioBuffers[channel];
 
             for (int i = c.numSamples; --i >= 0;)
@@ -227,11 +541,37 @@ private:
 
         HeapBlock<FloatType> buffer;
         const int channel, bufferSize;
-        int readIndex = 0, writeIndex;
+        int readIndex = 0, writeIndex, numSilentSamplesIn = 0;
 
         JUCE_DECLARE_NON_COPYABLE (DelayChannelOp)
     };
 
+    //==============================================================================
+    // Merges all the midi that's going into a node with a single call, rather than
+    // adding each source's events to the destination one at a time.
+    struct AddMidiBuffersOp  : public RenderingOp
+    {
+        AddMidiBuffersOp (const Array<int>& srcIndexes, int dstIndex)
+            : sourceIndexes (srcIndexes), destIndex (dstIndex)
+        {
+            sources.calloc ((size_t) sourceIndexes.size());
+        }
+
+        void perform (const Context& c) override
+        {
+            for (int i = 0; i < sourceIndexes.size(); ++i)
+                sources[i] = c.midiBuffers + sourceIndexes.getUnchecked (i);
+
+            c.midiBuffers[destIndex].addEventsFromBuffers (sources, sourceIndexes.size(), 0, c.numSamples);
+        }
+
+        const Array<int> sourceIndexes;
+        const int destIndex;
+        HeapBlock<const MidiBuffer*> sources;
+
+        JUCE_DECLARE_NON_COPYABLE (AddMidiBuffersOp)
+    };
+
     //==============================================================================
     struct ProcessOp   : public RenderingOp
     {
@@ -242,7 +582,10 @@ private:
               processor (*n->getProcessor()),
               audioChannelsToUse (audioChannelsUsed),
               totalChans (jmax (1, totalNumChans)),
-              midiBufferToUse (midiBuffer)
+              numInputChans (jmin (totalChans, processor.getTotalNumInputChannels())),
+              midiBufferToUse (midiBuffer),
+              canSleep (numInputChans > 0 && ! (processor.acceptsMidi() || processor.producesMidi())
+                         && dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (&processor) == nullptr)
         {
             audioChannels.calloc ((size_t) totalChans);
 
@@ -252,6 +595,32 @@ private:
 
         void perform (const Context& c) override
         {
+            // processors that haven't asked for sample-accurate automation just see the final values
+            if (! processor.usesSampleAccurateAutomation())
+                applyParameterAutomation();
+
+            this->wasSkipped = canSleep && updateSilentInputCount (c);
+
+            if (this->wasSkipped)
+            {
+                applyParameterAutomation();
+
+                // the inputs are silent and the tail has died away, so the outputs would be
+                // silent too - the input channels already are, so just clear the rest
+                for (int i = numInputChans; i < totalChans; ++i)
+                {
+                    auto chan = audioChannelsToUse.getUnchecked (i);
+
+                    if (! c.silentChannels[chan])
+                    {
+                        FloatVectorOperations::clear (c.audioBuffers[chan], c.numSamples);
+                        c.silentChannels[chan] = true;
+                    }
+                }
+
+                return;
+            }
+
             processor.setPlayHead (c.audioPlayHead);
 
             for (int i = 0; i < totalChans; ++i)
@@ -263,6 +632,80 @@ private:
                 buffer.clear();
             else
                 callProcess (buffer, c.midiBuffers[midiBufferToUse]);
+
+            applyParameterAutomation();
+
+            // if the processor cleared its buffer we already know the answer, otherwise
+            // each channel is checked, which stops at the first non-zero sample
+            auto allClear = buffer.hasBeenCleared();
+
+            for (int i = 0; i < totalChans; ++i)
+            {
+                auto chan = audioChannelsToUse.getUnchecked (i);
+
+                if (chan != 0)
+                    c.silentChannels[chan] = allClear || isSilent (audioChannels[i], c.numSamples);
+            }
+        }
+
+        /*  Keeps count of how long the inputs have been silent for, and returns true if it's
+            been long enough that the node can be skipped.
+        */
+        bool updateSilentInputCount (const Context& c)
+        {
+            auto inputIsSilent = c.midiBuffers[midiBufferToUse].isEmpty();
+
+            for (int i = 0; i < numInputChans && inputIsSilent; ++i)
+                inputIsSilent = c.silentChannels[audioChannelsToUse.getUnchecked (i)];
+
+            if (! inputIsSilent || ! node->isSleepingAllowed())
+            {
+                numSilentSamplesIn = 0;
+                return false;
+            }
+
+            if (numSilentSamplesIn == 0)
+            {
+                auto tailSeconds = processor.getTailLengthSeconds();
+
+                // processors with an infinite tail never go to sleep
+                numSilentSamplesNeeded = (tailSeconds >= 0 && tailSeconds < 3600.0)
+                                            ? (int64) (tailSeconds * processor.getSampleRate()) + processor.getLatencySamples()
+                                            : std::numeric_limits<int64>::max();
+            }
+
+            if (numSilentSamplesIn >= numSilentSamplesNeeded)
+                return true;
+
+            numSilentSamplesIn += c.numSamples;
+            return false;
+        }
+
+        /*  Leaves the processor's automated parameters at their final values, and clears the
+            events so they don't get used again in the next block. This may be running on one
+            of the render threads, so the listeners are told about the changes later on, by the
+            thread that called the graph's processBlock().
+        */
+        void applyParameterAutomation()
+        {
+            auto& automation = processor.getParameterAutomation();
+
+            if (automation.isEmpty())
+                return;
+
+            for (auto& event : automation)
+                event.parameter->setValue (event.value);
+
+            automation.clear();
+        }
+
+        static bool isSilent (const FloatType* data, int numSamples) noexcept
+        {
+            for (int i = 0; i < numSamples; ++i)
+                if (data[i] != 0)
+                    return false;
+
+            return true;
         }
 
         void callProcess (AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
@@ -315,7 +758,9 @@ private:
         Array<int> audioChannelsToUse;
         HeapBlock<FloatType*> audioChannels;
         AudioBuffer<float> tempBufferFloat, tempBufferDouble;
-        const int totalChans, midiBufferToUse;
+        const int totalChans, numInputChans, midiBufferToUse;
+        const bool canSleep;
+        int64 numSilentSamplesIn = 0, numSilentSamplesNeeded = 0;
 
         JUCE_DECLARE_NON_COPYABLE (ProcessOp)
     };
@@ -323,107 +768,260 @@ private:
 
 //==============================================================================
 //==============================================================================
-template <typename RenderSequence>
-struct RenderSequenceBuilder
+/*  An immutable copy of a graph's nodes and connections.
+
+    The rendering sequence is built from one of these rather than from the graph
+    itself, so that it can be built on a background thread while the graph carries
+    on being edited on the message thread.
+*/
+struct GraphTopology
 {
-    RenderSequenceBuilder (AudioProcessorGraph& g, RenderSequence& s)
-        : graph (g), sequence (s)
-    {
-        createOrderedNodeList();
+    using NodeID = AudioProcessorGraph::NodeID;
+    using NodeAndChannel = AudioProcessorGraph::NodeAndChannel;
+    using Connection = AudioProcessorGraph::Connection;
 
-        audioBuffers.add (AssignedBuffer::createReadOnlyEmpty()); // first buffer is read-only zeros
-        midiBuffers .add (AssignedBuffer::createReadOnlyEmpty());
+    struct NodeInfo
+    {
+        AudioProcessorGraph::Node::Ptr node;
+        int numInputs, numOutputs, latencySamples;
+        bool acceptsMidi, producesMidi;
+    };
 
-        for (int i = 0; i < orderedNodes.size(); ++i)
+    GraphTopology (const AudioProcessorGraph& graph)
+        : connections (graph.getConnections())
+    {
+        for (auto* n : graph.getNodes())
         {
-            createRenderingOpsForNode (*orderedNodes.getUnchecked(i), i);
-            markAnyUnusedBuffersAsFree (audioBuffers, i);
-            markAnyUnusedBuffersAsFree (midiBuffers, i);
-        }
+            auto& p = *n->getProcessor();
 
-        graph.setLatencySamples (totalLatency);
+            nodes.push_back ({ n, p.getTotalNumInputChannels(), p.getTotalNumOutputChannels(),
+                               p.getLatencySamples(), p.acceptsMidi(), p.producesMidi() });
+        }
+    }
 
-        s.numBuffersNeeded = audioBuffers.size();
-        s.numMidiBuffersNeeded = midiBuffers.size();
+    bool isConnected (const Connection& c) const noexcept
+    {
+        return std::binary_search (connections.begin(), connections.end(), c);
     }
 
-    //==============================================================================
-    using NodeID = AudioProcessorGraph::NodeID;
+    Array<NodeAndChannel> getSourcesForChannel (NodeAndChannel destination) const
+    {
+        Array<NodeAndChannel> results;
 
-    AudioProcessorGraph& graph;
-    RenderSequence& sequence;
+        for (auto& c : connections)
+            if (c.destination == destination)
+                results.add (c.source);
 
-    Array<AudioProcessorGraph::Node*> orderedNodes;
+        return results;
+    }
 
-    struct AssignedBuffer
-    {
-        AudioProcessorGraph::NodeAndChannel channel;
+    /*  Returns the nodes in an order where each node comes after all of its inputs.
 
-        static AssignedBuffer createReadOnlyEmpty() noexcept    { return { { zeroNodeID(), 0 } }; }
-        static AssignedBuffer createFree() noexcept             { return { { freeNodeID(), 0 } }; }
+        If the previous order is still valid for the current connections, it's kept and
+        any new nodes are just appended, so that small edits don't re-plan the whole
+        sequence. Otherwise a fresh topological sort is done, where nodes in feedback
+        loops are placed in the order in which they were added to the graph.
+    */
+    std::vector<const NodeInfo*> createNodeOrder (const Array<NodeID>& previousOrder) const
+    {
+        std::map<uint32, int> indexOfNode;
 
-        bool isReadOnlyEmpty() const noexcept                   { return channel.nodeID == zeroNodeID(); }
-        bool isFree() const noexcept                            { return channel.nodeID == freeNodeID(); }
-        bool isAssigned() const noexcept                        { return ! (isReadOnlyEmpty() || isFree()); }
+        for (size_t i = 0; i < nodes.size(); ++i)
+            indexOfNode[nodes[i].node->nodeID.uid] = (int) i;
 
-        void setFree() noexcept                                 { channel = { freeNodeID(), 0 }; }
-        void setAssignedToNonExistentNode() noexcept            { channel = { anonNodeID(), 0 }; }
+        std::vector<const NodeInfo*> result;
 
-    private:
-        static NodeID anonNodeID() { return NodeID (0x7ffffffd); }
-        static NodeID zeroNodeID() { return NodeID (0x7ffffffe); }
-        static NodeID freeNodeID() { return NodeID (0x7fffffff); }
-    };
+        if (! previousOrder.isEmpty())
+        {
+            std::vector<bool> isAlreadyInOrder (nodes.size(), false);
 
-    Array<AssignedBuffer> audioBuffers, midiBuffers;
+            for (auto nodeID : previousOrder)
+            {
+                auto index = indexOfNode.find (nodeID.uid);
 
-    enum { readOnlyEmptyBufferIndex = 0 };
+                if (index != indexOfNode.end())
+                {
+                    result.push_back (&nodes[(size_t) index->second]);
+                    isAlreadyInOrder[(size_t) index->second] = true;
+                }
+            }
 
-    struct Delay
-    {
-        NodeID nodeID;
-        int delay;
-    };
+            for (size_t i = 0; i < nodes.size(); ++i)
+                if (! isAlreadyInOrder[i])
+                    result.push_back (&nodes[i]);
 
-    HashMap<uint32, int> delays;
-    int totalLatency = 0;
+            std::map<uint32, int> position;
 
-    int getNodeDelay (NodeID nodeID) const noexcept
-    {
-        return delays[nodeID.uid];
-    }
+            for (size_t i = 0; i < result.size(); ++i)
+                position[result[i]->node->nodeID.uid] = (int) i;
 
-    int getInputLatencyForNode (NodeID nodeID) const
-    {
-        int maxLatency = 0;
+            if (std::all_of (connections.begin(), connections.end(), [&] (const Connection& c)
+                             { return position[c.source.nodeID.uid] < position[c.destination.nodeID.uid]; }))
+                return result;
 
-        for (auto&& c : graph.getConnections())
-            if (c.destination.nodeID == nodeID)
-                maxLatency = jmax (maxLatency, getNodeDelay (c.source.nodeID));
+            result.clear();
+        }
 
-        return maxLatency;
-    }
+        std::vector<int> numUnprocessedInputs (nodes.size(), 0);
+        std::vector<std::vector<int>> destinations (nodes.size());
 
-    //==============================================================================
-    void createOrderedNodeList()
-    {
-        for (auto* node : graph.getNodes())
+        for (auto& c : connections)
         {
-            int j = 0;
+            auto src = indexOfNode[c.source.nodeID.uid];
+            auto dst = indexOfNode[c.destination.nodeID.uid];
+            auto& d = destinations[(size_t) src];
 
-            for (; j < orderedNodes.size(); ++j)
-                if (graph.isAnInputTo (*node, *orderedNodes.getUnchecked(j)))
-                  break;
-
-            orderedNodes.insert (j, node);
+            if (std::find (d.begin(), d.end(), dst) == d.end())
+            {
+                d.push_back (dst);
+                ++numUnprocessedInputs[(size_t) dst];
+            }
         }
-    }
 
-    int findBufferForInputAudioChannel (AudioProcessorGraph::Node& node, const int inputChan,
-                                        const int ourRenderingIndex, const int maxLatency)
-    {
-        auto& processor = *node.getProcessor();
-        auto numOuts = processor.getTotalNumOutputChannels();
+        // a min-heap, so that ready nodes are taken in the order they were added to the graph
+        std::vector<int> ready;
+        std::vector<bool> isDone (nodes.size(), false);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (numUnprocessedInputs[i] == 0)
+                ready.push_back ((int) i);
+
+        while (result.size() < nodes.size())
+        {
+            int next = -1;
+
+            if (! ready.empty())
+            {
+                std::pop_heap (ready.begin(), ready.end(), std::greater<int>());
+                next = ready.back();
+                ready.pop_back();
+            }
+            else
+            {
+                // there's a feedback loop, so just break it at the earliest node
+                for (size_t i = 0; i < nodes.size() && next < 0; ++i)
+                    if (! isDone[i])
+                        next = (int) i;
+            }
+
+            isDone[(size_t) next] = true;
+            result.push_back (&nodes[(size_t) next]);
+
+            for (auto d : destinations[(size_t) next])
+            {
+                if (! isDone[(size_t) d] && --numUnprocessedInputs[(size_t) d] == 0)
+                {
+                    ready.push_back (d);
+                    std::push_heap (ready.begin(), ready.end(), std::greater<int>());
+                }
+            }
+        }
+
+        return result;
+    }
+
+    std::vector<NodeInfo> nodes;
+    std::vector<Connection> connections;
+};
+
+//==============================================================================
+template <typename RenderSequence>
+struct RenderSequenceBuilder
+{
+    RenderSequenceBuilder (const GraphTopology& t, const Array<AudioProcessorGraph::NodeID>& previousOrder,
+                           RenderSequence& s)
+        : topology (t), sequence (s)
+    {
+        orderedNodes = topology.createNodeOrder (previousOrder);
+        findLastReaders();
+
+        audioBuffers.add (AssignedBuffer::createReadOnlyEmpty()); // first buffer is read-only zeros
+        midiBuffers .add (AssignedBuffer::createReadOnlyEmpty());
+
+        for (int i = 0; i < (int) orderedNodes.size(); ++i)
+        {
+            createRenderingOpsForNode (*orderedNodes[(size_t) i], i);
+            markAnyUnusedBuffersAsFree (audioBuffers, i + 1);
+            markAnyUnusedBuffersAsFree (midiBuffers, i + 1);
+        }
+
+        s.calculateDependencies();
+        s.latencySamples = totalLatency;
+        s.numBuffersNeeded = audioBuffers.size();
+        s.numMidiBuffersNeeded = midiBuffers.size();
+
+        for (auto* info : orderedNodes)
+            s.nodeOrder.add (info->node->nodeID);
+    }
+
+    //==============================================================================
+    using NodeID = AudioProcessorGraph::NodeID;
+    using NodeInfo = GraphTopology::NodeInfo;
+
+    const GraphTopology& topology;
+    RenderSequence& sequence;
+
+    std::vector<const NodeInfo*> orderedNodes;
+
+    struct AssignedBuffer
+    {
+        AudioProcessorGraph::NodeAndChannel channel;
+        int timeFreed = 0;
+
+        static AssignedBuffer createReadOnlyEmpty() noexcept    { return { { zeroNodeID(), 0 } }; }
+        static AssignedBuffer createFree() noexcept             { return { { freeNodeID(), 0 } }; }
+
+        bool isReadOnlyEmpty() const noexcept                   { return channel.nodeID == zeroNodeID(); }
+        bool isFree() const noexcept                            { return channel.nodeID == freeNodeID(); }
+        bool isAssigned() const noexcept                        { return ! (isReadOnlyEmpty() || isFree()); }
+
+        void setFree() noexcept                                 { channel = { freeNodeID(), 0 }; }
+        void setAssignedToNonExistentNode() noexcept            { channel = { anonNodeID(), 0 }; }
+
+    private:
+        static NodeID anonNodeID() { return NodeID (0x7ffffffd); }
+        static NodeID zeroNodeID() { return NodeID (0x7ffffffe); }
+        static NodeID freeNodeID() { return NodeID (0x7fffffff); }
+    };
+
+    Array<AssignedBuffer> audioBuffers, midiBuffers;
+    int numBuffersFreed = 0;
+
+    enum { readOnlyEmptyBufferIndex = 0 };
+
+    // for each node output, the position in orderedNodes of the last node that reads it
+    std::map<uint64, int> lastReaders;
+
+    struct Delay
+    {
+        NodeID nodeID;
+        int delay;
+    };
+
+    HashMap<uint32, int> delays;
+    int totalLatency = 0;
+
+    int getNodeDelay (NodeID nodeID) const noexcept
+    {
+        return delays[nodeID.uid];
+    }
+
+    int getInputLatencyForNode (NodeID nodeID) const
+    {
+        int maxLatency = 0;
+
+        for (auto&& c : topology.connections)
+            if (c.destination.nodeID == nodeID)
+                maxLatency = jmax (maxLatency, getNodeDelay (c.source.nodeID));
+
+        return maxLatency;
+    }
+
+    //==============================================================================
+    int findBufferForInputAudioChannel (const NodeInfo& node, const int inputChan,
+                                        const int ourRenderingIndex, const int maxLatency)
+    {
+        auto numOuts = node.numOutputs;
 
         auto sources = getSourcesForChannel (node, inputChan);
 
@@ -527,10 +1125,11 @@ struct RenderSequenceBuilder
                 if (srcIndex >= 0)
                 {
                     auto nodeDelay = getNodeDelay (src.nodeID);
+                    auto isNeededLater = isBufferNeededLater (ourRenderingIndex, inputChan, src);
 
                     if (nodeDelay < maxLatency)
                     {
-                        if (! isBufferNeededLater (ourRenderingIndex, inputChan, src))
+                        if (! isNeededLater)
                         {
                             sequence.addDelayChannelOp (srcIndex, maxLatency - nodeDelay);
                         }
@@ -544,6 +1143,10 @@ struct RenderSequenceBuilder
                     }
 
                     sequence.addAddChannelOp (srcIndex, bufIndex);
+
+                    // this source's lifetime ends here, so the rest of this node can have its buffer
+                    if (! isNeededLater)
+                        freeBuffer (audioBuffers.getReference (srcIndex));
                 }
             }
         }
@@ -551,9 +1154,8 @@ struct RenderSequenceBuilder
         return bufIndex;
     }
 
-    int findBufferForInputMidiChannel (AudioProcessorGraph::Node& node, int ourRenderingIndex)
+    int findBufferForInputMidiChannel (const NodeInfo& node, int ourRenderingIndex)
     {
-        auto& processor = *node.getProcessor();
         auto sources = getSourcesForChannel (node, AudioProcessorGraph::midiChannelIndex);
 
         // No midi inputs..
@@ -561,7 +1163,7 @@ struct RenderSequenceBuilder
         {
             auto midiBufferToUse = getFreeBuffer (midiBuffers); // need to pick a buffer even if the processor doesn't use midi
 
-            if (processor.acceptsMidi() || processor.producesMidi())
+            if (node.acceptsMidi || node.producesMidi)
                 sequence.addClearMidiBufferOp (midiBufferToUse);
 
             return midiBufferToUse;
@@ -628,6 +1230,8 @@ struct RenderSequenceBuilder
             reusableInputIndex = 0;
         }
 
+        Array<int> buffersToAdd;
+
         for (int i = 0; i < sources.size(); ++i)
         {
             if (i != reusableInputIndex)
@@ -635,22 +1239,25 @@ struct RenderSequenceBuilder
                 auto srcIndex = getBufferContaining (sources.getUnchecked(i));
 
                 if (srcIndex >= 0)
-                    sequence.addAddMidiBufferOp (srcIndex, midiBufferToUse);
+                    buffersToAdd.add (srcIndex);
             }
         }
 
+        if (! buffersToAdd.isEmpty())
+            sequence.addAddMidiBuffersOp (buffersToAdd, midiBufferToUse);
+
         return midiBufferToUse;
     }
 
-    void createRenderingOpsForNode (AudioProcessorGraph::Node& node, const int ourRenderingIndex)
+    void createRenderingOpsForNode (const NodeInfo& node, const int ourRenderingIndex)
     {
-        auto& processor = *node.getProcessor();
-        auto numIns  = processor.getTotalNumInputChannels();
-        auto numOuts = processor.getTotalNumOutputChannels();
+        auto nodeID = node.node->nodeID;
+        auto numIns  = node.numInputs;
+        auto numOuts = node.numOutputs;
         auto totalChans = jmax (numIns, numOuts);
 
         Array<int> audioChannelsToUse;
-        auto maxLatency = getInputLatencyForNode (node.nodeID);
+        auto maxLatency = getInputLatencyForNode (nodeID);
 
         for (int inputChan = 0; inputChan < numIns; ++inputChan)
         {
@@ -661,7 +1268,7 @@ struct RenderSequenceBuilder
             audioChannelsToUse.add (index);
 
             if (inputChan < numOuts)
-                audioBuffers.getReference (index).channel = { node.nodeID, inputChan };
+                audioBuffers.getReference (index).channel = { nodeID, inputChan };
         }
 
         for (int outputChan = numIns; outputChan < numOuts; ++outputChan)
@@ -670,45 +1277,56 @@ struct RenderSequenceBuilder
             jassert (index != 0);
             audioChannelsToUse.add (index);
 
-            audioBuffers.getReference (index).channel = { node.nodeID, outputChan };
+            audioBuffers.getReference (index).channel = { nodeID, outputChan };
         }
 
         auto midiBufferToUse = findBufferForInputMidiChannel (node, ourRenderingIndex);
 
-        if (processor.producesMidi())
-            midiBuffers.getReference (midiBufferToUse).channel = { node.nodeID, AudioProcessorGraph::midiChannelIndex };
+        if (node.producesMidi)
+            midiBuffers.getReference (midiBufferToUse).channel = { nodeID, AudioProcessorGraph::midiChannelIndex };
 
-        delays.set (node.nodeID.uid, maxLatency + processor.getLatencySamples());
+        delays.set (nodeID.uid, maxLatency + node.latencySamples);
 
         if (numOuts == 0)
             totalLatency = maxLatency;
 
-        sequence.addProcessOp (node, audioChannelsToUse, totalChans, midiBufferToUse);
+        sequence.addProcessOp (node.node, audioChannelsToUse, totalChans, midiBufferToUse);
     }
 
     //==============================================================================
-    Array<AudioProcessorGraph::NodeAndChannel> getSourcesForChannel (AudioProcessorGraph::Node& node, int inputChannelIndex)
+    Array<AudioProcessorGraph::NodeAndChannel> getSourcesForChannel (const NodeInfo& node, int inputChannelIndex)
     {
-        Array<AudioProcessorGraph::NodeAndChannel> results;
-        AudioProcessorGraph::NodeAndChannel nc { node.nodeID, inputChannelIndex };
-
-        for (auto&& c : graph.getConnections())
-            if (c.destination == nc)
-                results.add (c.source);
-
-        return results;
+        return topology.getSourcesForChannel ({ node.node->nodeID, inputChannelIndex });
     }
 
+    /*  Picks the buffer that was freed most recently, as it's the one most likely to
+        still be in the cache.
+    */
     static int getFreeBuffer (Array<AssignedBuffer>& buffers)
     {
+        int best = -1;
+
         for (int i = 1; i < buffers.size(); ++i)
-            if (buffers.getReference(i).isFree())
-                return i;
+        {
+            auto& b = buffers.getReference (i);
+
+            if (b.isFree() && (best < 0 || b.timeFreed > buffers.getReference (best).timeFreed))
+                best = i;
+        }
+
+        if (best >= 0)
+            return best;
 
         buffers.add (AssignedBuffer::createFree());
         return buffers.size() - 1;
     }
 
+    void freeBuffer (AssignedBuffer& b) noexcept
+    {
+        b.setFree();
+        b.timeFreed = ++numBuffersFreed;
+    }
+
     int getBufferContaining (AudioProcessorGraph::NodeAndChannel output) const noexcept
     {
         int i = 0;
@@ -728,34 +1346,69 @@ struct RenderSequenceBuilder
     {
         for (auto& b : buffers)
             if (b.isAssigned() && ! isBufferNeededLater (stepIndex, -1, b.channel))
-                b.setFree();
+                freeBuffer (b);
+    }
+
+    static uint64 getChannelKey (AudioProcessorGraph::NodeAndChannel c) noexcept
+    {
+        return (((uint64) c.nodeID.uid) << 32) | (uint32) c.channelIndex;
+    }
+
+    /*  Works out the lifetime of every node output up-front, so that buffers can be freed
+        as soon as the last node that reads them has been rendered.
+    */
+    void findLastReaders()
+    {
+        std::map<uint32, int> positionOfNode;
+
+        for (size_t i = 0; i < orderedNodes.size(); ++i)
+            positionOfNode[orderedNodes[i]->node->nodeID.uid] = (int) i;
+
+        for (auto& c : topology.connections)
+        {
+            auto position = positionOfNode.find (c.destination.nodeID.uid);
+
+            if (position == positionOfNode.end())
+                continue;
+
+            auto& dest = *orderedNodes[(size_t) position->second];
+
+            // connections to channels that the node doesn't have are ignored
+            if (! c.destination.isMIDI() && c.destination.channelIndex >= dest.numInputs)
+                continue;
+
+            auto result = lastReaders.insert ({ getChannelKey (c.source), position->second });
+
+            if (! result.second)
+                result.first->second = jmax (result.first->second, position->second);
+        }
     }
 
     bool isBufferNeededLater (int stepIndexToSearchFrom,
                               int inputChannelOfIndexToIgnore,
                               AudioProcessorGraph::NodeAndChannel output) const
     {
-        while (stepIndexToSearchFrom < orderedNodes.size())
-        {
-            auto* node = orderedNodes.getUnchecked (stepIndexToSearchFrom);
+        auto lastReader = lastReaders.find (getChannelKey (output));
 
-            if (output.isMIDI())
-            {
-                if (inputChannelOfIndexToIgnore != AudioProcessorGraph::midiChannelIndex
-                     && graph.isConnected ({ { output.nodeID, AudioProcessorGraph::midiChannelIndex },
-                                             { node->nodeID,  AudioProcessorGraph::midiChannelIndex } }))
-                    return true;
-            }
-            else
-            {
-                for (int i = 0; i < node->getProcessor()->getTotalNumInputChannels(); ++i)
-                    if (i != inputChannelOfIndexToIgnore && graph.isConnected ({ output, { node->nodeID, i } }))
-                        return true;
-            }
+        if (lastReader == lastReaders.end() || lastReader->second < stepIndexToSearchFrom)
+            return false;
 
-            inputChannelOfIndexToIgnore = -1;
-            ++stepIndexToSearchFrom;
-        }
+        if (lastReader->second > stepIndexToSearchFrom || inputChannelOfIndexToIgnore < 0)
+            return true;
+
+        // the last reader is the node at this step, so check whether it reads the
+        // output on any channel other than the one that's being ignored
+        auto& node = *orderedNodes[(size_t) stepIndexToSearchFrom];
+        auto nodeID = node.node->nodeID;
+
+        if (output.isMIDI())
+            return inputChannelOfIndexToIgnore != AudioProcessorGraph::midiChannelIndex
+                    && topology.isConnected ({ { output.nodeID, AudioProcessorGraph::midiChannelIndex },
+                                               { nodeID,        AudioProcessorGraph::midiChannelIndex } });
+
+        for (int i = 0; i < node.numInputs; ++i)
+            if (i != inputChannelOfIndexToIgnore && topology.isConnected ({ output, { nodeID, i } }))
+                return true;
 
         return false;
     }
@@ -798,6 +1451,7 @@ AudioProcessorGraph::Node::Node (NodeID n, AudioProcessor* p) noexcept
     : nodeID (n), processor (p)
 {
     jassert (processor != nullptr);
+    statsCounters.reset();
 }
 
 void AudioProcessorGraph::Node::prepare (double newSampleRate, int newBlockSize,
@@ -808,6 +1462,9 @@ void AudioProcessorGraph::Node::prepare (double newSampleRate, int newBlockSize,
         isPrepared = true;
         setParentGraph (graph);
 
+        // the graph adds automation events to this on the audio thread, so it mustn't need to grow
+        processor->getParameterAutomation().ensureSize (1024);
+
         // try to align the precision of the processor and the graph
         processor->setProcessingPrecision (processor->supportsDoublePrecisionProcessing() ? precision
                                                                                           : singlePrecision);
@@ -839,6 +1496,84 @@ bool AudioProcessorGraph::Node::Connection::operator== (const Connection& other)
         && otherChannel == other.otherChannel;
 }
 
+//==============================================================================
+bool AudioProcessorGraph::Node::isSleepingAllowed() const noexcept
+{
+    return sleepingAllowed;
+}
+
+void AudioProcessorGraph::Node::setSleepingAllowed (bool shouldBeAllowedToSleep) noexcept
+{
+    sleepingAllowed = shouldBeAllowedToSleep;
+}
+
+//==============================================================================
+void AudioProcessorGraph::Node::StatsCounters::reset() noexcept
+{
+    numProcessed = 0;
+    numSkipped = 0;
+    numDeadlineMisses = 0;
+    totalTicks = 0;
+    minTicks = std::numeric_limits<int64>::max();
+    maxTicks = 0;
+    bufferCopyTicks = 0;
+
+    for (auto& h : histogram)
+        h = 0;
+}
+
+void AudioProcessorGraph::Node::StatsCounters::addProcessTime (int64 ticks, int64 deadlineTicks) noexcept
+{
+    ++numProcessed;
+    totalTicks += ticks;
+
+    // only one thread renders a node at a time, so these don't need to be atomic updates
+    if (ticks < minTicks.load (std::memory_order_relaxed))  minTicks.store (ticks, std::memory_order_relaxed);
+    if (ticks > maxTicks.load (std::memory_order_relaxed))  maxTicks.store (ticks, std::memory_order_relaxed);
+
+    if (ticks > deadlineTicks)
+        ++numDeadlineMisses;
+
+    auto microseconds = (int64) (Time::highResolutionTicksToSeconds (ticks) * 1.0e6);
+    int bin = 0;
+
+    while (microseconds > 0 && bin < ProcessingStats::numHistogramBins - 1)
+    {
+        microseconds >>= 1;
+        ++bin;
+    }
+
+    ++histogram[bin];
+}
+
+AudioProcessorGraph::Node::ProcessingStats AudioProcessorGraph::Node::getProcessingStats() const noexcept
+{
+    auto ticksToMs = [] (int64 ticks)  { return Time::highResolutionTicksToSeconds (ticks) * 1000.0; };
+
+    ProcessingStats result;
+    result.numBlocksProcessed = statsCounters.numProcessed;
+    result.numBlocksSkipped   = statsCounters.numSkipped;
+    result.numDeadlineMisses  = statsCounters.numDeadlineMisses;
+    result.totalBufferCopyMilliseconds = ticksToMs (statsCounters.bufferCopyTicks);
+
+    if (result.numBlocksProcessed > 0)
+    {
+        result.minProcessMilliseconds = ticksToMs (jmin (statsCounters.minTicks.load(), statsCounters.maxTicks.load()));
+        result.maxProcessMilliseconds = ticksToMs (statsCounters.maxTicks);
+        result.averageProcessMilliseconds = ticksToMs (statsCounters.totalTicks) / (double) result.numBlocksProcessed;
+    }
+
+    for (int i = 0; i < ProcessingStats::numHistogramBins; ++i)
+        result.processTimeHistogram[i] = statsCounters.histogram[i];
+
+    return result;
+}
+
+void AudioProcessorGraph::Node::resetProcessingStats() noexcept
+{
+    statsCounters.reset();
+}
+
 //==============================================================================
 bool AudioProcessorGraph::Node::isBypassed() const noexcept
 {
@@ -866,6 +1601,160 @@ void AudioProcessorGraph::Node::setBypassed (bool shouldBeBypassed) noexcept
 struct AudioProcessorGraph::RenderSequenceFloat   : public GraphRenderSequence<float> {};
 struct AudioProcessorGraph::RenderSequenceDouble  : public GraphRenderSequence<double> {};
 
+struct AudioProcessorGraph::RenderThreadPool  : public AudioRenderThreadPool
+{
+    RenderThreadPool (int numThreads) : AudioRenderThreadPool (numThreads, "Graph Render Thread") {}
+};
+
+//==============================================================================
+/*  A pair of rendering sequences built from a snapshot of the graph.
+
+    Once built, these are handed to the audio thread, which swaps them with the
+    sequences it's currently using and hands the old ones back, so that they can be
+    deleted on the message thread.
+*/
+struct AudioProcessorGraph::PreparedSequences
+{
+    PreparedSequences (const AudioProcessorGraph& graph, const Array<NodeID>& previousOrder, uint32 version)
+        : topology (graph),
+          previousNodeOrder (previousOrder),
+          topologyVersion (version),
+          blockSize (graph.getBlockSize())
+    {
+    }
+
+    void build()
+    {
+        sequenceF.reset (new RenderSequenceFloat());
+        sequenceD.reset (new RenderSequenceDouble());
+
+        RenderSequenceBuilder<RenderSequenceFloat>  builderF (topology, previousNodeOrder, *sequenceF);
+        RenderSequenceBuilder<RenderSequenceDouble> builderD (topology, previousNodeOrder, *sequenceD);
+
+        sequenceF->prepareBuffers (blockSize);
+        sequenceD->prepareBuffers (blockSize);
+    }
+
+    GraphTopology topology;
+    const Array<NodeID> previousNodeOrder;
+    const uint32 topologyVersion;
+    const int blockSize;
+
+    std::unique_ptr<RenderSequenceFloat> sequenceF;
+    std::unique_ptr<RenderSequenceDouble> sequenceD;
+
+    JUCE_DECLARE_NON_COPYABLE (PreparedSequences)
+};
+
+//==============================================================================
+/*  Builds rendering sequences in the background, so that editing a large graph
+    doesn't stall the message thread.
+
+    Finished sequences are picked up by the graph's handleAsyncUpdate(), and are only
+    ever deleted on the message thread, because they may hold the last reference to
+    nodes which have been removed from the graph.
+
+    Once a sequence has been handed over, the audio thread swaps it in at the start of
+    its next block. If that doesn't happen within a short time, e.g. because the audio
+    callback has stopped, this thread swaps it in instead.
+*/
+struct AudioProcessorGraph::SequenceBuilderThread  : public Thread
+{
+    SequenceBuilderThread (AudioProcessorGraph& g)  : Thread ("Graph Sequence Builder"), graph (g)
+    {
+        startThread();
+    }
+
+    ~SequenceBuilderThread() override
+    {
+        stopThread (-1);
+    }
+
+    bool isBusy() const
+    {
+        const ScopedLock sl (lock);
+        return waiting != nullptr || isBuilding;
+    }
+
+    void startBuilding (PreparedSequences* sequences)
+    {
+        {
+            const ScopedLock sl (lock);
+            jassert (waiting == nullptr && finished == nullptr);
+            waiting.reset (sequences);
+        }
+
+        notify();
+    }
+
+    PreparedSequences* takeFinishedSequences()
+    {
+        const ScopedLock sl (lock);
+        return finished.release();
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            PreparedSequences* next;
+
+            {
+                const ScopedLock sl (lock);
+                next = waiting.release();
+                isBuilding = (next != nullptr);
+            }
+
+            if (next != nullptr)
+            {
+                next->build();
+
+                {
+                    const ScopedLock sl (lock);
+                    finished.reset (next);
+                    isBuilding = false;
+                }
+
+                graph.triggerAsyncUpdate();
+                continue;
+            }
+
+            if (graph.pendingSequences.load() != nullptr)
+            {
+                if (graph.isPrepared.get() != 0)
+                    wait (audioThreadTimeoutMs);
+
+                const ScopedLock sl (graph.getCallbackLock());
+                graph.swapInPendingSequences();
+            }
+
+            // once the old sequences have been retired, let the message thread delete them
+            if (graph.retiredSequences.load() != nullptr)
+                graph.triggerAsyncUpdate();
+
+            {
+                // a new job or a request to stop may have arrived while this thread was
+                // waiting for the audio thread, and the notification used up by that wait
+                const ScopedLock sl (lock);
+
+                if (waiting != nullptr || threadShouldExit())
+                    continue;
+            }
+
+            wait (-1);
+        }
+    }
+
+    enum { audioThreadTimeoutMs = 100 };
+
+    AudioProcessorGraph& graph;
+    CriticalSection lock;
+    std::unique_ptr<PreparedSequences> waiting, finished;
+    bool isBuilding = false;
+
+    JUCE_DECLARE_NON_COPYABLE (SequenceBuilderThread)
+};
+
 //==============================================================================
 AudioProcessorGraph::AudioProcessorGraph()
 {
@@ -873,8 +1762,10 @@ AudioProcessorGraph::AudioProcessorGraph()
 
 AudioProcessorGraph::~AudioProcessorGraph()
 {
+    sequenceBuilderThread.reset();
     clearRenderingSequence();
     clear();
+    setNumRenderThreads (0);
 }
 
 const String AudioProcessorGraph::getName() const
@@ -886,6 +1777,7 @@ const String AudioProcessorGraph::getName() const
 void AudioProcessorGraph::topologyChanged()
 {
     sendChangeMessage();
+    ++topologyVersion;
 
     if (isPrepared.get() != 0)
         triggerAsyncUpdate();
@@ -1177,44 +2069,108 @@ bool AudioProcessorGraph::removeIllegalConnections()
 }
 
 //==============================================================================
-void AudioProcessorGraph::clearRenderingSequence()
+void AudioProcessorGraph::setNumRenderThreads (int numThreads)
 {
-    std::unique_ptr<RenderSequenceFloat> oldSequenceF;
-    std::unique_ptr<RenderSequenceDouble> oldSequenceD;
+    numThreads = jmax (0, numThreads);
+
+    if (numThreads == getNumRenderThreads())
+        return;
+
+    std::unique_ptr<RenderThreadPool> newPool (numThreads > 0 ? new RenderThreadPool (numThreads) : nullptr);
 
     {
         const ScopedLock sl (getCallbackLock());
-        std::swap (renderSequenceFloat, oldSequenceF);
-        std::swap (renderSequenceDouble, oldSequenceD);
+        std::swap (renderThreadPool, newPool);
     }
 }
 
-bool AudioProcessorGraph::anyNodesNeedPreparing() const noexcept
+int AudioProcessorGraph::getNumRenderThreads() const noexcept
 {
-    for (auto* node : nodes)
-        if (! node->isPrepared)
-            return true;
+    return renderThreadPool != nullptr ? renderThreadPool->getNumThreads() : 0;
+}
 
-    return false;
+void AudioProcessorGraph::setPerformanceMonitoringEnabled (bool shouldBeEnabled) noexcept
+{
+    performanceMonitoringEnabled = shouldBeEnabled;
 }
 
-void AudioProcessorGraph::buildRenderingSequence()
+bool AudioProcessorGraph::isPerformanceMonitoringEnabled() const noexcept
 {
-    std::unique_ptr<RenderSequenceFloat>  newSequenceF (new RenderSequenceFloat());
-    std::unique_ptr<RenderSequenceDouble> newSequenceD (new RenderSequenceDouble());
+    return performanceMonitoringEnabled;
+}
 
-    {
-        MessageManagerLock mml;
+//==============================================================================
+void AudioProcessorGraph::clearRenderingSequence()
+{
+    std::unique_ptr<RenderSequenceFloat> oldSequenceF;
+    std::unique_ptr<RenderSequenceDouble> oldSequenceD;
+    std::unique_ptr<PreparedSequences> oldPendingSequences;
 
-        RenderSequenceBuilder<RenderSequenceFloat>  builderF (*this, *newSequenceF);
-        RenderSequenceBuilder<RenderSequenceDouble> builderD (*this, *newSequenceD);
+    {
+        const ScopedLock sl (getCallbackLock());
+        std::swap (renderSequenceFloat, oldSequenceF);
+        std::swap (renderSequenceDouble, oldSequenceD);
+        oldPendingSequences.reset (pendingSequences.exchange (nullptr));
     }
 
+    deleteRetiredSequences();
+}
+
+void AudioProcessorGraph::deleteRetiredSequences()
+{
+    std::unique_ptr<PreparedSequences> retired (retiredSequences.exchange (nullptr));
+}
+
+// This must be called with the callback lock held
+void AudioProcessorGraph::swapInPendingSequences() noexcept
+{
+    // the old sequences can only be handed back once the message thread has deleted the previous ones
+    if (retiredSequences.load() != nullptr)
+        return;
+
+    if (auto* pending = pendingSequences.exchange (nullptr))
     {
-        const ScopedLock sl (getCallbackLock());
-        newSequenceF->prepareBuffers (getBlockSize());
-        newSequenceD->prepareBuffers (getBlockSize());
+        std::swap (renderSequenceFloat, pending->sequenceF);
+        std::swap (renderSequenceDouble, pending->sequenceD);
+        retiredSequences = pending;
     }
+}
+
+void AudioProcessorGraph::installPreparedSequences (std::unique_ptr<PreparedSequences> prepared)
+{
+    // ignore any sequence that's older than the one that was last installed
+    if (prepared->topologyVersion <= lastInstalledVersion)
+        return;
+
+    lastInstalledVersion = prepared->topologyVersion;
+
+    // none of the new nodes are being rendered yet, so they can be prepared without stopping playback
+    for (auto& info : prepared->topology.nodes)
+        info.node->prepare (getSampleRate(), getBlockSize(), this, getProcessingPrecision());
+
+    setLatencySamples (prepared->sequenceF->latencySamples);
+    lastNodeOrder = prepared->sequenceF->nodeOrder;
+
+    deleteRetiredSequences();
+    std::unique_ptr<PreparedSequences> unusedSequences (pendingSequences.exchange (prepared.release()));
+
+    if (sequenceBuilderThread != nullptr)
+        sequenceBuilderThread->notify();
+}
+
+bool AudioProcessorGraph::anyNodesNeedPreparing() const noexcept
+{
+    for (auto* node : nodes)
+        if (! node->isPrepared)
+            return true;
+
+    return false;
+}
+
+void AudioProcessorGraph::buildRenderingSequence()
+{
+    std::unique_ptr<PreparedSequences> prepared (new PreparedSequences (*this, lastNodeOrder, topologyVersion));
+    prepared->build();
 
     if (anyNodesNeedPreparing())
     {
@@ -1228,16 +2184,49 @@ void AudioProcessorGraph::buildRenderingSequence()
             node->prepare (getSampleRate(), getBlockSize(), this, getProcessingPrecision());
     }
 
-    const ScopedLock sl (getCallbackLock());
+    setLatencySamples (prepared->sequenceF->latencySamples);
+    lastNodeOrder = prepared->sequenceF->nodeOrder;
+    lastRequestedVersion = lastInstalledVersion = topologyVersion;
+
+    std::unique_ptr<PreparedSequences> oldPendingSequences;
 
-    std::swap (renderSequenceFloat, newSequenceF);
-    std::swap (renderSequenceDouble, newSequenceD);
+    {
+        const ScopedLock sl (getCallbackLock());
+
+        std::swap (renderSequenceFloat, prepared->sequenceF);
+        std::swap (renderSequenceDouble, prepared->sequenceD);
+        oldPendingSequences.reset (pendingSequences.exchange (nullptr));
+    }
 }
 
 void AudioProcessorGraph::handleAsyncUpdate()
 {
-    buildRenderingSequence();
-    isPrepared = 1;
+    if (isPrepared.get() == 0)
+    {
+        buildRenderingSequence();
+        isPrepared = 1;
+        return;
+    }
+
+    // While playing, topology changes are built on a background thread, and the audio
+    // thread picks up the new sequence at the start of its next block.
+    deleteRetiredSequences();
+
+    if (sequenceBuilderThread == nullptr)
+        sequenceBuilderThread.reset (new SequenceBuilderThread (*this));
+
+    // a sequence that couldn't be swapped in until the retired ones had gone can be now
+    if (pendingSequences.load() != nullptr)
+        sequenceBuilderThread->notify();
+
+    if (auto* finished = sequenceBuilderThread->takeFinishedSequences())
+        installPreparedSequences (std::unique_ptr<PreparedSequences> (finished));
+
+    if (lastRequestedVersion != topologyVersion && ! sequenceBuilderThread->isBusy())
+    {
+        lastRequestedVersion = topologyVersion;
+        sequenceBuilderThread->startBuilding (new PreparedSequences (*this, lastNodeOrder, topologyVersion));
+    }
 }
 
 //==============================================================================
@@ -1245,6 +2234,7 @@ void AudioProcessorGraph::prepareToPlay (double sampleRate, int estimatedSamples
 {
     setRateAndBufferSizeDetails (sampleRate, estimatedSamplesPerBlock);
     clearRenderingSequence();
+    isPrepared = 0;
 
     if (isNonRealtime() && MessageManager::getInstance()->isThisTheMessageThread())
         handleAsyncUpdate();
@@ -1297,30 +2287,44 @@ bool AudioProcessorGraph::producesMidi() const                      { return tru
 void AudioProcessorGraph::getStateInformation (juce::MemoryBlock&)  {}
 void AudioProcessorGraph::setStateInformation (const void*, int)    {}
 
-template <typename FloatType, typename SequenceType>
+template <typename FloatType, typename SequenceType, typename SwapFunction>
 static void processBlockForBuffer (AudioBuffer<FloatType>& buffer, MidiBuffer& midiMessages,
                                    AudioProcessorGraph& graph,
                                    std::unique_ptr<SequenceType>& renderSequence,
-                                   Atomic<int>& isPrepared)
+                                   AudioRenderThreadPool* threadPool,
+                                   Atomic<int>& isPrepared,
+                                   SwapFunction&& swapInPendingSequences)
 {
+    auto performSequence = [&]
+    {
+        if (renderSequence != nullptr)
+        {
+            auto& automation = graph.getParameterAutomation();
+
+            renderSequence->perform (buffer, midiMessages, graph.getPlayHead(), threadPool,
+                                     graph.isPerformanceMonitoringEnabled(), &automation);
+
+            renderSequence->sendParameterChangeMessages (automation);
+        }
+    };
+
     if (graph.isNonRealtime())
     {
         while (isPrepared.get() == 0)
             Thread::sleep (1);
 
         const ScopedLock sl (graph.getCallbackLock());
-
-        if (renderSequence != nullptr)
-            renderSequence->perform (buffer, midiMessages, graph.getPlayHead());
+        swapInPendingSequences();
+        performSequence();
     }
     else
     {
         const ScopedLock sl (graph.getCallbackLock());
+        swapInPendingSequences();
 
         if (isPrepared.get() == 1)
         {
-            if (renderSequence != nullptr)
-                renderSequence->perform (buffer, midiMessages, graph.getPlayHead());
+            performSequence();
         }
         else
         {
@@ -1335,7 +2339,8 @@ void AudioProcessorGraph::processBlock (AudioBuffer<float>& buffer, MidiBuffer&
     if (isPrepared.get() == 0 && MessageManager::getInstance()->isThisTheMessageThread())
         handleAsyncUpdate();
 
-    processBlockForBuffer<float> (buffer, midiMessages, *this, renderSequenceFloat, isPrepared);
+    processBlockForBuffer<float> (buffer, midiMessages, *this, renderSequenceFloat, renderThreadPool.get(), isPrepared,
+                                  [this] { swapInPendingSequences(); });
 }
 
 void AudioProcessorGraph::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midiMessages)
@@ -1343,7 +2348,8 @@ void AudioProcessorGraph::processBlock (AudioBuffer<double>& buffer, MidiBuffer&
     if (isPrepared.get() == 0 && MessageManager::getInstance()->isThisTheMessageThread())
         handleAsyncUpdate();
 
-    processBlockForBuffer<double> (buffer, midiMessages, *this, renderSequenceDouble, isPrepared);
+    processBlockForBuffer<double> (buffer, midiMessages, *this, renderSequenceDouble, renderThreadPool.get(), isPrepared,
+                                   [this] { swapInPendingSequences(); });
 }
 
 //==============================================================================
@@ -1502,4 +2508,637 @@ void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorG
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorGraphTests  : public UnitTest
+{
+public:
+    AudioProcessorGraphTests() : UnitTest ("AudioProcessorGraph", "Audio Processors") {}
+
+    void runTest() override
+    {
+        ScopedJuceInitialiser_GUI scopedJuceInitialiser_gui;
+
+        // The graph builds its rendering sequences and installs topology changes on the
+        // message thread, so these tests have to run there too
+        if (! MessageManager::getInstance()->isThisTheMessageThread())
+        {
+            logMessage ("Skipping the AudioProcessorGraph tests, as they aren't running on the message thread");
+            return;
+        }
+
+        beginTest ("Parallel rendering matches serial rendering");
+        {
+            AudioBuffer<float> serial, parallel;
+
+            renderTestGraph (serial, 0);
+            renderTestGraph (parallel, 3);
+
+            expectEquals (parallel.getNumChannels(), serial.getNumChannels());
+
+            for (int ch = 0; ch < serial.getNumChannels(); ++ch)
+                for (int i = 0; i < serial.getNumSamples(); ++i)
+                    expectEquals (parallel.getSample (ch, i), serial.getSample (ch, i));
+
+            expect (serial.getMagnitude (0, serial.getNumSamples()) > 0.0f);
+        }
+
+        beginTest ("Topology changes while playing are picked up");
+        {
+            const int blockSize = 32;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+            auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+            auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection ({ { input->nodeID, ch }, { output->nodeID, ch } });
+
+            prepareGraph (graph, blockSize);
+            expectEquals (processOnes (graph, blockSize), 1.0f);
+
+            auto gain = graph.addNode (new GainProcessor (0.25f));
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                graph.removeConnection ({ { input->nodeID, ch }, { output->nodeID, ch } });
+                graph.addConnection ({ { input->nodeID, ch }, { gain->nodeID, ch } });
+                graph.addConnection ({ { gain->nodeID, ch }, { output->nodeID, ch } });
+            }
+
+            auto result = 1.0f;
+
+            for (int i = 0; i < 500 && result == 1.0f; ++i)
+            {
+                MessageManager::getInstance()->runDispatchLoopUntil (5);
+                result = processOnes (graph, blockSize);
+            }
+
+            expectEquals (result, 0.25f);
+            graph.releaseResources();
+        }
+
+        beginTest ("Topology changes are installed when the audio callback has stopped");
+        {
+            const int blockSize = 32;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+            auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+            auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+
+            bool gainWasDeleted = false;
+            auto* gainProcessor = new GainProcessor (0.25f);
+            gainProcessor->deletedFlag = &gainWasDeleted;
+            auto gainID = graph.addNode (gainProcessor)->nodeID;
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                graph.addConnection ({ { input->nodeID, ch }, { gainID, ch } });
+                graph.addConnection ({ { gainID, ch }, { output->nodeID, ch } });
+            }
+
+            prepareGraph (graph, blockSize);
+            expectEquals (processOnes (graph, blockSize), 0.25f);
+
+            // The old sequence holds the last reference to the removed node, so it can
+            // only be deleted once a new sequence has been swapped in, which has to happen
+            // without any more calls to processBlock()
+            graph.removeNode (gainID);
+
+            for (int i = 0; i < 500 && ! gainWasDeleted; ++i)
+                MessageManager::getInstance()->runDispatchLoopUntil (5);
+
+            expect (gainWasDeleted);
+            expectEquals (processOnes (graph, blockSize), 0.0f);
+            graph.releaseResources();
+        }
+
+        beginTest ("Nodes with silent inputs go to sleep");
+        {
+            const int blockSize = 441;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+            auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+            auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+            auto first  = graph.addNode (new GainProcessor (0.5f));
+            auto second = graph.addNode (new GainProcessor (0.5f));
+
+            auto& firstGain  = *static_cast<GainProcessor*> (first->getProcessor());
+            auto& secondGain = *static_cast<GainProcessor*> (second->getProcessor());
+            secondGain.tailLengthSeconds = 0.1;
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                graph.addConnection ({ { input->nodeID, ch },  { first->nodeID, ch } });
+                graph.addConnection ({ { first->nodeID, ch },  { second->nodeID, ch } });
+                graph.addConnection ({ { second->nodeID, ch }, { output->nodeID, ch } });
+            }
+
+            prepareGraph (graph, blockSize);
+
+            expectEquals (processBlockOf (graph, blockSize, 1.0f), 0.25f);
+            expectEquals (firstGain.numBlocksProcessed, 1);
+            expectEquals (secondGain.numBlocksProcessed, 1);
+
+            // the first node has no tail so sleeps straight away, the second one
+            // carries on for the 10 blocks that its tail lasts
+            for (int i = 0; i < 20; ++i)
+                expectEquals (processBlockOf (graph, blockSize, 0.0f), 0.0f);
+
+            expectEquals (firstGain.numBlocksProcessed, 1);
+            expectEquals (secondGain.numBlocksProcessed, 11);
+
+            expectEquals (processBlockOf (graph, blockSize, 1.0f), 0.25f);
+            expectEquals (firstGain.numBlocksProcessed, 2);
+            expectEquals (secondGain.numBlocksProcessed, 12);
+
+            first->setSleepingAllowed (false);
+            expect (! first->isSleepingAllowed());
+
+            for (int i = 0; i < 20; ++i)
+                processBlockOf (graph, blockSize, 0.0f);
+
+            expectEquals (firstGain.numBlocksProcessed, 22);
+            expectEquals (secondGain.numBlocksProcessed, 22);
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Per-node performance monitoring");
+        {
+            const int blockSize = 256;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+            auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+            auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+            auto gain   = graph.addNode (new GainProcessor (0.5f));
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                graph.addConnection ({ { input->nodeID, ch }, { gain->nodeID, ch } });
+                graph.addConnection ({ { gain->nodeID, ch },  { output->nodeID, ch } });
+            }
+
+            prepareGraph (graph, blockSize);
+
+            processOnes (graph, blockSize);
+            expectEquals (gain->getProcessingStats().numBlocksProcessed, (int64) 0);
+
+            expect (! graph.isPerformanceMonitoringEnabled());
+            graph.setPerformanceMonitoringEnabled (true);
+            expect (graph.isPerformanceMonitoringEnabled());
+
+            for (int i = 0; i < 10; ++i)
+                processOnes (graph, blockSize);
+
+            for (int i = 0; i < 5; ++i)
+                processBlockOf (graph, blockSize, 0.0f);
+
+            auto stats = gain->getProcessingStats();
+            expectEquals (stats.numBlocksProcessed, (int64) 10);
+            expectEquals (stats.numBlocksSkipped, (int64) 5);
+            expect (stats.minProcessMilliseconds <= stats.averageProcessMilliseconds);
+            expect (stats.averageProcessMilliseconds <= stats.maxProcessMilliseconds);
+            expect (stats.numDeadlineMisses <= stats.numBlocksProcessed);
+
+            int64 histogramTotal = 0;
+
+            for (auto count : stats.processTimeHistogram)
+                histogramTotal += count;
+
+            expectEquals (histogramTotal, stats.numBlocksProcessed);
+            expectEquals (input->getProcessingStats().numBlocksProcessed, (int64) 15);
+
+            gain->resetProcessingStats();
+            stats = gain->getProcessingStats();
+            expectEquals (stats.numBlocksProcessed, (int64) 0);
+            expectEquals (stats.maxProcessMilliseconds, 0.0);
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Buffers are re-used");
+        {
+            // a chain of stereo nodes can be processed entirely in place
+            expectEquals (countBuffersNeeded (1, 20), 3);
+
+            // parallel chains only need their outputs kept until they're mixed together
+            expectEquals (countBuffersNeeded (8, 3), 17);
+
+            // the buffers of the chains that get mixed into a node are free again for
+            // anything which that node, or the one after it, needs
+            expectEquals (countBuffersNeeded (4, 1, 3), 9);
+        }
+
+        beginTest ("Sample-accurate parameter automation");
+        {
+            for (auto sampleAccurate : { true, false })
+            {
+                for (int numThreads : { 0, 2 })
+                {
+                    checkParameterAutomation (sampleAccurate, numThreads, 32);
+
+                    // blocks bigger than the graph was prepared for get split up
+                    checkParameterAutomation (sampleAccurate, numThreads, 16);
+                }
+            }
+        }
+
+        beginTest ("Midi from several sources is merged");
+        {
+            const int blockSize = 32, numSources = 5;
+
+            AudioProcessorGraph graph;
+            graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+            using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+            auto midiOutput = graph.addNode (new IOProcessor (IOProcessor::midiOutputNode));
+
+            for (int i = 0; i < numSources; ++i)
+            {
+                auto source = graph.addNode (new MidiSourceProcessor (i + 1));
+                graph.addConnection ({ { source->nodeID, AudioProcessorGraph::midiChannelIndex },
+                                       { midiOutput->nodeID, AudioProcessorGraph::midiChannelIndex } });
+            }
+
+            prepareGraph (graph, blockSize);
+
+            for (int block = 0; block < 3; ++block)
+            {
+                AudioBuffer<float> buffer (2, blockSize);
+                buffer.clear();
+                MidiBuffer midi;
+                graph.processBlock (buffer, midi);
+
+                int lastTime = 0;
+                int numEventsOnChannel[numSources + 1] = {};
+                bool eventsAreInOrder = true;
+
+                MidiBuffer::Iterator iter (midi);
+                MidiMessage message;
+                int time;
+
+                while (iter.getNextEvent (message, time))
+                {
+                    eventsAreInOrder = eventsAreInOrder && time >= lastTime && time < blockSize
+                                         && message.getNoteNumber() == MidiSourceProcessor::getNoteForEvent (numEventsOnChannel[message.getChannel()]);
+                    lastTime = time;
+                    ++numEventsOnChannel[message.getChannel()];
+                }
+
+                expect (eventsAreInOrder);
+                expectEquals (midi.getNumEvents(), numSources * (int) MidiSourceProcessor::numEventsInBlock);
+
+                for (int ch = 1; ch <= numSources; ++ch)
+                    expectEquals (numEventsOnChannel[ch], (int) MidiSourceProcessor::numEventsInBlock);
+            }
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Render thread count");
+        {
+            AudioProcessorGraph graph;
+            expectEquals (graph.getNumRenderThreads(), 0);
+            graph.setNumRenderThreads (2);
+            expectEquals (graph.getNumRenderThreads(), 2);
+            graph.setNumRenderThreads (0);
+            expectEquals (graph.getNumRenderThreads(), 0);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct GainProcessor  : public AudioProcessor
+    {
+        GainProcessor (float g)
+            : AudioProcessor (BusesProperties().withInput  ("Input",  AudioChannelSet::stereo())
+                                               .withOutput ("Output", AudioChannelSet::stereo())),
+              gain (g)
+        {}
+
+        ~GainProcessor() override
+        {
+            if (deletedFlag != nullptr)
+                *deletedFlag = true;
+        }
+
+        const String getName() const override                           { return "Gain"; }
+        void prepareToPlay (double, int) override                       {}
+        void releaseResources() override                                {}
+        void processBlock (AudioBuffer<float>& b, MidiBuffer&) override  { b.applyGain (gain); ++numBlocksProcessed; }
+        double getTailLengthSeconds() const override                    { return tailLengthSeconds; }
+        bool acceptsMidi() const override                               { return false; }
+        bool producesMidi() const override                              { return false; }
+        AudioProcessorEditor* createEditor() override                   { return nullptr; }
+        bool hasEditor() const override                                 { return false; }
+        int getNumPrograms() override                                   { return 1; }
+        int getCurrentProgram() override                                { return 0; }
+        void setCurrentProgram (int) override                           {}
+        const String getProgramName (int) override                      { return {}; }
+        void changeProgramName (int, const String&) override            {}
+        void getStateInformation (MemoryBlock&) override                {}
+        void setStateInformation (const void*, int) override            {}
+
+        const float gain;
+        double tailLengthSeconds = 0;
+        int numBlocksProcessed = 0;
+        bool* deletedFlag = nullptr;
+    };
+
+    struct AutomatedGainProcessor  : public GainProcessor
+    {
+        AutomatedGainProcessor()  : GainProcessor (1.0f)
+        {
+            addParameter (gainParameter = new AudioParameterFloat ("gain", "Gain", 0.0f, 1.0f, 1.0f));
+        }
+
+        void processBlock (AudioBuffer<float>& b, MidiBuffer&) override
+        {
+            processParameterAutomationInSections (b.getNumSamples(), [&] (int start, int num)
+            {
+                b.applyGain (start, num, gainParameter->get());
+                ++numSections;
+            });
+        }
+
+        AudioParameterFloat* gainParameter;
+        int numSections = 0;
+    };
+
+    // Produces a few notes on its own midi channel, plus one that's beyond the end of the block
+    struct MidiSourceProcessor  : public GainProcessor
+    {
+        MidiSourceProcessor (int channelToUse)  : GainProcessor (1.0f), channel (channelToUse) {}
+
+        enum { numEventsInBlock = 4 };
+
+        static int getNoteForEvent (int index) noexcept     { return 60 + index; }
+
+        void processBlock (AudioBuffer<float>& b, MidiBuffer& midi) override
+        {
+            const int times[] = { 0, channel, channel, b.getNumSamples() - 1 };
+
+            midi.clear();
+
+            for (int i = 0; i < numEventsInBlock; ++i)
+                midi.addEvent (MidiMessage::noteOn (channel, getNoteForEvent (i), (uint8) 100), times[i]);
+
+            midi.addEvent (MidiMessage::noteOff (channel, 60), b.getNumSamples() + 10);
+        }
+
+        bool acceptsMidi() const override       { return true; }
+        bool producesMidi() const override      { return true; }
+
+        const int channel;
+    };
+
+    struct ParameterListener  : public AudioProcessorParameter::Listener
+    {
+        void parameterValueChanged (int, float newValue) override
+        {
+            lastValue = newValue;
+            ++numCalls;
+            calledOnOtherThread = calledOnOtherThread || Thread::getCurrentThreadId() != testThread;
+        }
+
+        void parameterGestureChanged (int, bool) override {}
+
+        Thread::ThreadID testThread = Thread::getCurrentThreadId();
+        float lastValue = -1.0f;
+        int numCalls = 0;
+        bool calledOnOtherThread = false;
+    };
+
+    void checkParameterAutomation (bool sampleAccurate, int numThreads, int preparedBlockSize)
+    {
+        const int blockSize = 32;
+
+        AudioProcessorGraph graph;
+        graph.setNumRenderThreads (numThreads);
+        graph.setPlayConfigDetails (2, 2, 44100.0, preparedBlockSize);
+
+        using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+        auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+        auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+        auto node   = graph.addNode (new AutomatedGainProcessor());
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            graph.addConnection ({ { input->nodeID, ch }, { node->nodeID, ch } });
+            graph.addConnection ({ { node->nodeID, ch },  { output->nodeID, ch } });
+        }
+
+        auto& processor = *static_cast<AutomatedGainProcessor*> (node->getProcessor());
+        processor.setUsesSampleAccurateAutomation (sampleAccurate);
+
+        ParameterListener listener;
+        processor.gainParameter->addListener (&listener);
+
+        prepareGraph (graph, preparedBlockSize);
+
+        // an event for a parameter that none of the nodes own should be left alone
+        AudioParameterFloat unroutedParameter ("other", "Other", 0.0f, 1.0f, 1.0f);
+
+        auto& automation = graph.getParameterAutomation();
+        automation.addEvent (*processor.gainParameter, 0.25f, 20);
+        automation.addEvent (*processor.gainParameter, 0.5f, 10);
+        automation.addEvent (unroutedParameter, 0.0f, 5);
+
+        expectEquals (automation.getNumEvents(), 3);
+        expectEquals (automation.getFirstEventTime(), 5);
+        expectEquals (automation.getLastEventTime(), 20);
+
+        AudioBuffer<float> buffer (2, blockSize);
+        MidiBuffer midi;
+
+        for (int ch = 0; ch < 2; ++ch)
+            FloatVectorOperations::fill (buffer.getWritePointer (ch), 1.0f, blockSize);
+
+        graph.processBlock (buffer, midi);
+        automation.clear();
+
+        auto isSplit = preparedBlockSize < blockSize;
+        int numWrong = 0;
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            // when the block is split, each part only gets the events that fall inside it
+            auto expected = sampleAccurate ? (i < 10 ? 1.0f : (i < 20 ? 0.5f : 0.25f))
+                                           : ((isSplit && i < preparedBlockSize) ? 0.5f : 0.25f);
+
+            if (buffer.getSample (0, i) != expected)
+                ++numWrong;
+        }
+
+        expectEquals (numWrong, 0);
+        expectEquals (processor.numSections, sampleAccurate ? (isSplit ? 4 : 3) : (isSplit ? 2 : 1));
+        expectEquals (processor.gainParameter->get(), 0.25f);
+        expect (processor.getParameterAutomation().isEmpty());
+        expectEquals (unroutedParameter.get(), 1.0f);
+
+        // the listener only hears about the final value, however many events there were
+        expectEquals (listener.numCalls, 1);
+        expectEquals (listener.lastValue, 0.25f);
+        expect (! listener.calledOnOtherThread);
+
+        // once the events have been cleared, nothing changes in the next block
+        processor.numSections = 0;
+        graph.processBlock (buffer, midi);
+        expectEquals (listener.numCalls, 1);
+        expectEquals (processor.gainParameter->get(), 0.25f);
+
+        processor.gainParameter->removeListener (&listener);
+        graph.releaseResources();
+    }
+
+    static float processBlockOf (AudioProcessorGraph& graph, int blockSize, float value)
+    {
+        AudioBuffer<float> buffer (2, blockSize);
+        MidiBuffer midi;
+
+        for (int ch = 0; ch < 2; ++ch)
+            FloatVectorOperations::fill (buffer.getWritePointer (ch), value, blockSize);
+
+        graph.processBlock (buffer, midi);
+        return buffer.getSample (0, blockSize - 1);
+    }
+
+    // Builds the rendering sequence straight away, rather than with an async update
+    static void prepareGraph (AudioProcessorGraph& graph, int blockSize)
+    {
+        graph.setNonRealtime (true);
+        graph.prepareToPlay (44100.0, blockSize);
+        graph.setNonRealtime (false);
+    }
+
+    static float processOnes (AudioProcessorGraph& graph, int blockSize)
+    {
+        return processBlockOf (graph, blockSize, 1.0f);
+    }
+
+    /*  Builds a graph with some parallel chains of nodes, which either go straight to the
+        output or are mixed into a node that's then sent through some more parallel chains.
+    */
+    static int countBuffersNeeded (int numChains, int chainLength, int numChainsAfterMix = 0)
+    {
+        AudioProcessorGraph graph;
+        graph.setPlayConfigDetails (2, 2, 44100.0, 64);
+
+        using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+        auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+        auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+
+        auto connect = [&] (AudioProcessorGraph::Node::Ptr source, AudioProcessorGraph::Node::Ptr dest)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection ({ { source->nodeID, ch }, { dest->nodeID, ch } });
+        };
+
+        auto addChains = [&] (AudioProcessorGraph::Node::Ptr source, AudioProcessorGraph::Node::Ptr dest, int num)
+        {
+            for (int chain = 0; chain < num; ++chain)
+            {
+                auto previous = source;
+
+                for (int i = 0; i < chainLength; ++i)
+                {
+                    auto node = graph.addNode (new GainProcessor (0.5f));
+                    connect (previous, node);
+                    previous = node;
+                }
+
+                connect (previous, dest);
+            }
+        };
+
+        if (numChainsAfterMix > 0)
+        {
+            auto mix = graph.addNode (new GainProcessor (0.5f));
+            addChains (input, mix, numChains);
+            addChains (mix, output, numChainsAfterMix);
+        }
+        else
+        {
+            addChains (input, output, numChains);
+        }
+
+        GraphTopology topology (graph);
+        GraphRenderSequence<float> sequence;
+        RenderSequenceBuilder<GraphRenderSequence<float>> builder (topology, {}, sequence);
+        return sequence.numBuffersNeeded;
+    }
+
+    void renderTestGraph (AudioBuffer<float>& result, int numThreads)
+    {
+        const int blockSize = 64, numBlocks = 4;
+
+        AudioProcessorGraph graph;
+        graph.setNumRenderThreads (numThreads);
+        graph.setPlayConfigDetails (2, 2, 44100.0, blockSize);
+
+        using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+        auto input  = graph.addNode (new IOProcessor (IOProcessor::audioInputNode));
+        auto output = graph.addNode (new IOProcessor (IOProcessor::audioOutputNode));
+
+        // several parallel chains of differing length, which all mix into the output
+        for (int chain = 0; chain < 6; ++chain)
+        {
+            auto previous = input;
+
+            for (int i = 0; i <= chain % 3; ++i)
+            {
+                auto node = graph.addNode (new GainProcessor (0.5f + 0.1f * (float) (chain + i)));
+
+                for (int ch = 0; ch < 2; ++ch)
+                    graph.addConnection ({ { previous->nodeID, ch }, { node->nodeID, ch } });
+
+                previous = node;
+            }
+
+            for (int ch = 0; ch < 2; ++ch)
+                graph.addConnection ({ { previous->nodeID, ch }, { output->nodeID, ch } });
+        }
+
+        prepareGraph (graph, blockSize);
+
+        result.setSize (2, blockSize * numBlocks);
+        Random random (1234);
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            AudioBuffer<float> buffer (2, blockSize);
+            MidiBuffer midi;
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample (ch, i, random.nextFloat() * 2.0f - 1.0f);
+
+            graph.processBlock (buffer, midi);
+
+            for (int ch = 0; ch < 2; ++ch)
+                result.copyFrom (ch, block * blockSize, buffer, ch, 0, blockSize);
+        }
+
+        graph.releaseResources();
+    }
+};
+
+static AudioProcessorGraphTests audioProcessorGraphTests;
+
+#endif
+
 } // namespace juce
@@ -41,6 +41,15 @@ namespace juce
     To play back a graph through an audio device, you might want to use an
     AudioProcessorPlayer object.
 
+    To automate the nodes' parameters sample-accurately, add events for them to the
+    graph's own getParameterAutomation() buffer on the audio thread, before calling the
+    graph's processBlock(), and clear it afterwards. The graph passes each event on to
+    the node whose processor owns the parameter (or applies it up front if that node
+    hasn't asked for sample-accurate automation). Once the block has been rendered, the
+    nodes' parameters are left at their final values and their listeners are notified
+    on the thread that called processBlock(). Events for any other parameters are left
+    alone.
+
     @tags{Audio}
 */
 class JUCE_API  AudioProcessorGraph   : public AudioProcessor,
@@ -125,6 +134,81 @@ public:
         /** Tell this node to bypass processing. */
         void setBypassed (bool shouldBeBypassed) noexcept;
 
+        //==============================================================================
+        /** Returns true if the graph may skip this node while its inputs are silent.
+            @see setSleepingAllowed
+        */
+        bool isSleepingAllowed() const noexcept;
+
+        /** Lets the graph skip this node while its inputs are silent.
+
+            The graph keeps track of which of its buffers contain digital silence. Once all
+            of a node's audio inputs have been silent (and its midi input empty) for longer
+            than the processor's tail length plus its latency, the graph stops calling its
+            processBlock() method and treats its outputs as silent, until some sound arrives
+            at its inputs again.
+
+            This is allowed by default, but only applies to processors that have audio
+            inputs and that neither accept nor produce midi. You should turn it off for
+            nodes that can make a sound with silent inputs, e.g. a test tone generator
+            with a sidechain input, or a processor that needs to be called regularly for
+            some other reason.
+        */
+        void setSleepingAllowed (bool shouldBeAllowedToSleep) noexcept;
+
+        //==============================================================================
+        /** A snapshot of the timing statistics that the graph has gathered for a node.
+            @see getProcessingStats, AudioProcessorGraph::setPerformanceMonitoringEnabled
+        */
+        struct JUCE_API  ProcessingStats
+        {
+            /** The number of blocks for which the processor was called. */
+            int64 numBlocksProcessed = 0;
+
+            /** The number of blocks that were skipped because the node was asleep.
+                @see setSleepingAllowed
+            */
+            int64 numBlocksSkipped = 0;
+
+            /** The shortest, average and longest times spent processing a block, in milliseconds. */
+            double minProcessMilliseconds = 0, averageProcessMilliseconds = 0, maxProcessMilliseconds = 0;
+
+            /** The number of blocks that took longer to process than the duration of the
+                audio in them, i.e. blocks where this node alone would have caused a glitch.
+            */
+            int64 numDeadlineMisses = 0;
+
+            /** The total time spent copying, mixing and delaying the buffers that feed
+                this node's inputs, in milliseconds.
+            */
+            double totalBufferCopyMilliseconds = 0;
+
+            enum { numHistogramBins = 16 };
+
+            /** A histogram of the time taken to process each block.
+
+                The first bin counts blocks that took less than a microsecond, and each bin
+                after that covers twice the time range of the previous one, so bin n counts
+                blocks that took between 2^(n-1) and 2^n microseconds. The last bin also
+                includes anything longer.
+            */
+            int64 processTimeHistogram[numHistogramBins] = {};
+        };
+
+        /** Returns the timing statistics gathered for this node.
+
+            These are only collected while the graph's performance monitoring is turned on.
+            This is safe to call from any thread while the graph is rendering, but as the
+            counters are updated independently, the values may be from slightly different
+            moments in time.
+
+            @see AudioProcessorGraph::setPerformanceMonitoringEnabled
+        */
+        ProcessingStats getProcessingStats() const noexcept;
+
+        /** Resets all of this node's timing statistics. */
+        void resetProcessingStats() noexcept;
+
         //==============================================================================
         /** A convenient typedef for referring to a pointer to a node object. */
         using Ptr = ReferenceCountedObjectPtr<Node>;
@@ -144,6 +228,21 @@ public:
         const std::unique_ptr<AudioProcessor> processor;
         Array<Connection> inputs, outputs;
         bool isPrepared = false, bypassed = false;
+        std::atomic<bool> sleepingAllowed { true };
+
+        struct StatsCounters
+        {
+            void reset() noexcept;
+            void addProcessTime (int64 ticks, int64 deadlineTicks) noexcept;
+
+            std::atomic<int64> numProcessed, numSkipped, numDeadlineMisses,
+                               totalTicks, minTicks, maxTicks, bufferCopyTicks;
+            std::atomic<int64> histogram[ProcessingStats::numHistogramBins];
+        };
+
+        StatsCounters statsCounters;
+
+        template <typename FloatType> friend struct GraphRenderSequence;
 
         Node (NodeID, AudioProcessor*) noexcept;
 
@@ -272,6 +371,43 @@ public:
     */
     bool removeIllegalConnections();
 
+    //==============================================================================
+    /** Enables multi-threaded rendering of the graph.
+
+        When numThreads is greater than zero, the graph starts that many real-time
+        worker threads, and nodes which don't depend on each other's output are
+        processed concurrently on them, with the thread that calls processBlock()
+        also taking part. Passing zero (the default) processes all the nodes serially
+        on the calling thread.
+
+        If you enable this, the processors in the graph must be happy to have their
+        processBlock() methods called from threads other than the audio callback thread.
+    */
+    void setNumRenderThreads (int numThreads);
+
+    /** Returns the number of worker threads used for rendering.
+        @see setNumRenderThreads
+    */
+    int getNumRenderThreads() const noexcept;
+
+    //==============================================================================
+    /** Turns the collection of per-node timing statistics on or off.
+
+        While this is enabled, the graph times each of its nodes' processBlock() calls
+        and the buffer operations that feed them, and adds the results to counters that
+        you can read from any thread with Node::getProcessingStats(). This makes it easy
+        to find out which processor is using up the audio callback's time budget.
+        Measuring the times adds a small overhead, so it's off by default.
+
+        @see Node::getProcessingStats, Node::resetProcessingStats
+    */
+    void setPerformanceMonitoringEnabled (bool shouldBeEnabled) noexcept;
+
+    /** Returns true if per-node timing statistics are being collected.
+        @see setPerformanceMonitoringEnabled
+    */
+    bool isPerformanceMonitoringEnabled() const noexcept;
+
     //==============================================================================
     /** A special type of AudioProcessor that can live inside an AudioProcessorGraph
         in order to use the audio that comes into and out of the graph itself.
@@ -393,14 +529,28 @@ private:
     std::unique_ptr<RenderSequenceFloat> renderSequenceFloat;
     std::unique_ptr<RenderSequenceDouble> renderSequenceDouble;
 
+    struct RenderThreadPool;
+    std::unique_ptr<RenderThreadPool> renderThreadPool;
+
+    struct PreparedSequences;
+    struct SequenceBuilderThread;
+    std::unique_ptr<SequenceBuilderThread> sequenceBuilderThread;
+    std::atomic<PreparedSequences*> pendingSequences { nullptr }, retiredSequences { nullptr };
+    Array<NodeID> lastNodeOrder;
+    uint32 topologyVersion = 0, lastRequestedVersion = 0, lastInstalledVersion = 0;
+
     friend class AudioGraphIOProcessor;
 
     Atomic<int> isPrepared { 0 };
+    std::atomic<bool> performanceMonitoringEnabled { false };
 
     void topologyChanged();
     void handleAsyncUpdate() override;
     void clearRenderingSequence();
     void buildRenderingSequence();
+    void installPreparedSequences (std::unique_ptr<PreparedSequences>);
+    void swapInPendingSequences() noexcept;
+    void deleteRetiredSequences();
     bool anyNodesNeedPreparing() const noexcept;
     bool isConnected (Node* src, int sourceChannel, Node* dest, int destChannel) const noexcept;
     bool isAnInputTo (Node& src, Node& dst, int recursionCheck) const noexcept;
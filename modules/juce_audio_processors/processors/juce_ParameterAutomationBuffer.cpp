@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+ParameterAutomationBuffer::ParameterAutomationBuffer() noexcept {}
+ParameterAutomationBuffer::~ParameterAutomationBuffer() {}
+
+void ParameterAutomationBuffer::clear() noexcept
+{
+    events.clearQuick();
+}
+
+void ParameterAutomationBuffer::addEvent (AudioProcessorParameter& parameter, float newNormalisedValue, int samplePosition)
+{
+    // the events are normally added in order, so look for the insertion point from the end
+    auto index = events.size();
+
+    while (index > 0 && events.getReference (index - 1).samplePosition > samplePosition)
+        --index;
+
+    events.insert (index, { &parameter, samplePosition, newNormalisedValue });
+}
+
+void ParameterAutomationBuffer::ensureSize (int minimumNumEvents)
+{
+    events.ensureStorageAllocated (minimumNumEvents);
+    scratch.ensureStorageAllocated (minimumNumEvents);
+    maxNumEvents = jmax (maxNumEvents, minimumNumEvents);
+}
+
+namespace
+{
+    using AutomationEvent = ParameterAutomationBuffer::Event;
+
+    // Merges two sorted runs, keeping the events from the first one before any at the same position
+    void mergeAutomationRuns (const AutomationEvent* a, int numA, const AutomationEvent* b, int numB, AutomationEvent* dest) noexcept
+    {
+        while (numA > 0 && numB > 0)
+        {
+            if (b->samplePosition < a->samplePosition)  { *dest++ = *b++; --numB; }
+            else                                        { *dest++ = *a++; --numA; }
+        }
+
+        while (--numA >= 0)  *dest++ = *a++;
+        while (--numB >= 0)  *dest++ = *b++;
+    }
+
+    bool areAutomationEventsSorted (const AutomationEvent* e, int num) noexcept
+    {
+        for (int i = 1; i < num; ++i)
+            if (e[i].samplePosition < e[i - 1].samplePosition)
+                return false;
+
+        return true;
+    }
+}
+
+void ParameterAutomationBuffer::mergeNewEvents (int firstNewEvent) noexcept
+{
+    auto numNew = events.size() - firstNewEvent;
+
+    if (numNew <= 0)
+        return;
+
+    jassert (numNew <= maxNumEvents);
+    scratch.resize (numNew);
+
+    auto* newEvents = events.getRawDataPointer() + firstNewEvent;
+    auto* temp = scratch.getRawDataPointer();
+
+    // A host's queue is normally already in order, but if not, it gets a stable
+    // bottom-up merge sort, going back and forth between the new events and the scratch space
+    if (! areAutomationEventsSorted (newEvents, numNew))
+    {
+        auto* source = newEvents;
+        auto* dest = temp;
+
+        for (int width = 1; width < numNew; width *= 2)
+        {
+            for (int start = 0; start < numNew; start += 2 * width)
+            {
+                auto numA = jmin (width, numNew - start);
+                auto numB = jlimit (0, width, numNew - start - width);
+                mergeAutomationRuns (source + start, numA, source + start + numA, numB, dest + start);
+            }
+
+            std::swap (source, dest);
+        }
+
+        if (source != newEvents)
+            std::copy (source, source + numNew, newEvents);
+    }
+
+    // then the new events are merged into the old ones from the back, so nothing needs moving
+    // twice, and the old events stay in front of any new ones at the same position
+    if (firstNewEvent > 0 && newEvents[0].samplePosition < newEvents[-1].samplePosition)
+    {
+        std::copy (newEvents, newEvents + numNew, temp);
+
+        auto* all = events.getRawDataPointer();
+        auto oldIndex = firstNewEvent - 1;
+        auto newIndex = numNew - 1;
+
+        for (auto destIndex = events.size() - 1; newIndex >= 0; --destIndex)
+        {
+            if (oldIndex >= 0 && all[oldIndex].samplePosition > temp[newIndex].samplePosition)
+                all[destIndex] = all[oldIndex--];
+            else
+                all[destIndex] = temp[newIndex--];
+        }
+    }
+
+    scratch.clearQuick();
+}
+
+int ParameterAutomationBuffer::getFirstEventTime() const noexcept
+{
+    return events.isEmpty() ? 0 : events.getReference (0).samplePosition;
+}
+
+int ParameterAutomationBuffer::getLastEventTime() const noexcept
+{
+    return events.isEmpty() ? 0 : events.getReference (events.size() - 1).samplePosition;
+}
+
+#if JUCE_UNIT_TESTS
+
+static struct ParameterAutomationBufferTests final   : public UnitTest
+{
+    ParameterAutomationBufferTests() : UnitTest ("ParameterAutomationBuffer", "AudioProcessor parameters") {}
+
+    struct Change
+    {
+        int samplePosition;
+        float value;
+    };
+
+    static void addChanges (ParameterAutomationBuffer& buffer, AudioProcessorParameter& parameter, const Array<Change>& changes)
+    {
+        buffer.addEvents (parameter, changes.size(), [&changes] (int index, int& samplePosition, float& value)
+        {
+            samplePosition = changes.getReference (index).samplePosition;
+            value = changes.getReference (index).value;
+            return true;
+        });
+    }
+
+    static bool buffersMatch (const ParameterAutomationBuffer& a, const ParameterAutomationBuffer& b)
+    {
+        if (a.getNumEvents() != b.getNumEvents())
+            return false;
+
+        for (auto *e1 = a.begin(), *e2 = b.begin(); e1 != a.end(); ++e1, ++e2)
+            if (e1->parameter != e2->parameter || e1->samplePosition != e2->samplePosition || e1->value != e2->value)
+                return false;
+
+        return true;
+    }
+
+    void runTest() override
+    {
+        AudioParameterFloat p1 ("p1", "P1", 0.0f, 1.0f, 0.0f);
+        AudioParameterFloat p2 ("p2", "P2", 0.0f, 1.0f, 0.0f);
+
+        beginTest ("Out-of-order changes are merged in the same order as adding them one at a time");
+        {
+            auto random = getRandom();
+
+            for (int i = 0; i < 100; ++i)
+            {
+                ParameterAutomationBuffer merged, reference;
+                merged.ensureSize (1000);
+
+                for (int queue = random.nextInt (6); --queue >= 0;)
+                {
+                    auto& parameter = random.nextBool() ? p1 : p2;
+                    Array<Change> changes;
+
+                    // a small range of positions, so that there are lots of events at the same position
+                    for (int n = random.nextInt (40); --n >= 0;)
+                        changes.add ({ random.nextInt (32), random.nextFloat() });
+
+                    if (random.nextBool())
+                        std::sort (changes.begin(), changes.end(),
+                                   [] (const Change& a, const Change& b) { return a.samplePosition < b.samplePosition; });
+
+                    addChanges (merged, parameter, changes);
+
+                    for (auto& c : changes)
+                        reference.addEvent (parameter, c.value, c.samplePosition);
+                }
+
+                expect (buffersMatch (merged, reference));
+            }
+        }
+
+        beginTest ("Changes that don't fit are left out");
+        {
+            ParameterAutomationBuffer buffer;
+            buffer.ensureSize (8);
+
+            Array<Change> changes;
+
+            for (int n = 0; n < 20; ++n)
+                changes.add ({ 20 - n, (float) n / 20.0f });
+
+            addChanges (buffer, p1, changes);
+            expectEquals (buffer.getNumEvents(), 8);
+            expectEquals (buffer.getFirstEventTime(), 13);
+            expectEquals (buffer.getLastEventTime(), 20);
+
+            addChanges (buffer, p2, changes);
+            expectEquals (buffer.getNumEvents(), 8);
+        }
+    }
+} parameterAutomationBufferTests;
+
+#endif
+
+} // namespace juce
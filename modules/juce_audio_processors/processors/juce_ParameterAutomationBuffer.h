@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Holds a list of sample-accurate parameter changes for a block of audio.
+
+    Analogous to the MidiBuffer, this holds a set of parameter changes with integer
+    sample positions, relative to the start of the block. The events are kept sorted
+    by position, and events at the same position stay in the order they were added.
+
+    Each AudioProcessor has one of these, which hosts fill in before calling
+    processBlock() if the processor has asked for sample-accurate automation.
+
+    @see AudioProcessor::getParameterAutomation, AudioProcessor::setUsesSampleAccurateAutomation
+
+    @tags{Audio}
+*/
+class JUCE_API  ParameterAutomationBuffer
+{
+public:
+    //==============================================================================
+    /** Describes a change to a parameter's value. */
+    struct Event
+    {
+        /** The parameter that's being changed. */
+        AudioProcessorParameter* parameter;
+
+        /** The position of the change, in samples from the start of the block. */
+        int samplePosition;
+
+        /** The parameter's new normalised value, in the range 0 to 1. */
+        float value;
+    };
+
+    //==============================================================================
+    /** Creates an empty buffer. */
+    ParameterAutomationBuffer() noexcept;
+
+    /** Destructor. */
+    ~ParameterAutomationBuffer();
+
+    //==============================================================================
+    /** Removes all the events from the buffer. */
+    void clear() noexcept;
+
+    /** Returns true if the buffer is empty. */
+    bool isEmpty() const noexcept                       { return events.isEmpty(); }
+
+    /** Returns the number of events in the buffer. */
+    int getNumEvents() const noexcept                   { return events.size(); }
+
+    /** Adds a parameter change to the buffer.
+
+        The event is inserted after any other events at the same sample position.
+        This will only allocate if the buffer needs to grow, so call ensureSize()
+        beforehand if you're going to use it on the audio thread.
+    */
+    void addEvent (AudioProcessorParameter& parameter, float newNormalisedValue, int samplePosition);
+
+    /** Adds a list of changes to a single parameter, such as a host's automation queue.
+
+        For each index from 0 to numChanges - 1, this calls
+        getChange (int index, int& samplePosition, float& newNormalisedValue), which should
+        return false if there's no change at that index. The changes don't have to be in
+        order: they're sorted and then merged with the existing events in one pass, which is
+        much quicker than adding them one at a time when they're out of order.
+
+        This never allocates, so it's safe to use on the audio thread. It will only add
+        up to the number of events given to ensureSize(), and any changes that don't fit
+        are left out.
+    */
+    template <typename GetChangeFunction>
+    void addEvents (AudioProcessorParameter& parameter, int numChanges, GetChangeFunction&& getChange)
+    {
+        auto firstNewEvent = events.size();
+
+        for (int i = 0; i < numChanges && events.size() < maxNumEvents; ++i)
+        {
+            int samplePosition = 0;
+            float value = 0.0f;
+
+            if (getChange (i, samplePosition, value))
+                events.add ({ &parameter, samplePosition, value });
+        }
+
+        mergeNewEvents (firstNewEvent);
+    }
+
+    /** Preallocates space for the given number of events. */
+    void ensureSize (int minimumNumEvents);
+
+    /** Returns the position of the first event, or 0 if the buffer is empty. */
+    int getFirstEventTime() const noexcept;
+
+    /** Returns the position of the last event, or 0 if the buffer is empty. */
+    int getLastEventTime() const noexcept;
+
+    //==============================================================================
+    /** Returns a pointer to the first event. */
+    const Event* begin() const noexcept                 { return events.begin(); }
+
+    /** Returns a pointer just past the last event. */
+    const Event* end() const noexcept                   { return events.end(); }
+
+private:
+    //==============================================================================
+    Array<Event> events, scratch;
+    int maxNumEvents = 0;
+
+    void mergeNewEvents (int firstNewEvent) noexcept;
+
+    JUCE_LEAK_DETECTOR (ParameterAutomationBuffer)
+};
+
+} // namespace juce
@@ -0,0 +1,560 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+static MemoryBlock xmlToMemoryBlock (const XmlElement& xml)
+{
+    MemoryBlock block;
+    MemoryOutputStream out (block, false);
+    out << xml.createDocument ({}, true, false);
+    out.flush();
+    return block;
+}
+
+static std::unique_ptr<XmlElement> memoryBlockToXml (const MemoryBlock& block)
+{
+    return std::unique_ptr<XmlElement> (XmlDocument::parse (block.toString()));
+}
+
+//==============================================================================
+struct ChildProcessPluginScanner::Worker  : public ChildProcessMaster
+{
+    Worker (ChildProcessPluginScanner& o)  : owner (o) {}
+
+    ~Worker() override
+    {
+        killSlaveProcess();
+    }
+
+    // These are virtual so that the tests can stand in for the worker process
+    virtual bool launchProcess()                            { return launchSlaveProcess (owner.executable, owner.commandLineID, 0, 0); }
+    virtual bool sendRequest (const MemoryBlock& request)   { return sendMessageToSlave (request); }
+    virtual void killProcess()                              { killSlaveProcess(); }
+
+    enum class Result { succeeded, failed, abandoned };
+
+    Result scan (AudioPluginFormat& format, const String& fileOrIdentifier,
+                 OwnedArray<PluginDescription>& result)
+    {
+        if (! isRunning)
+            isRunning = launchProcess();
+
+        if (! isRunning)
+        {
+            // the worker couldn't be launched, so the best we can do is to scan it here
+            format.findAllTypesForFile (result, fileOrIdentifier);
+            return Result::succeeded;
+        }
+
+        {
+            const ScopedLock sl (replyLock);
+            reply.reset();
+            connectionLost = false;
+        }
+
+        replyReceived.reset();
+
+        XmlElement request ("SCAN");
+        request.setAttribute ("format", format.getName());
+        request.setAttribute ("identifier", fileOrIdentifier);
+
+        if (! sendRequest (xmlToMemoryBlock (request)))
+        {
+            stop();
+            return Result::failed;
+        }
+
+        auto startTime = Time::getMillisecondCounter();
+
+        while (! replyReceived.wait (50))
+        {
+            if (owner.shouldExit())
+            {
+                stop();
+                return Result::abandoned;
+            }
+
+            // a plugin that hangs is treated in the same way as one that crashes
+            if (Time::getMillisecondCounter() - startTime > (uint32) owner.timeoutMs)
+            {
+                stop();
+                return Result::failed;
+            }
+        }
+
+        const ScopedLock sl (replyLock);
+
+        if (connectionLost || reply == nullptr)
+        {
+            stop();
+            return Result::failed;
+        }
+
+        forEachXmlChildElement (*reply, e)
+        {
+            PluginDescription desc;
+
+            if (desc.loadFromXml (*e))
+                result.add (new PluginDescription (desc));
+        }
+
+        return Result::succeeded;
+    }
+
+    void stop()
+    {
+        killProcess();
+        isRunning = false;
+    }
+
+    void handleMessageFromSlave (const MemoryBlock& message) override
+    {
+        {
+            const ScopedLock sl (replyLock);
+            reply = memoryBlockToXml (message);
+        }
+
+        replyReceived.signal();
+    }
+
+    void handleConnectionLost() override
+    {
+        {
+            const ScopedLock sl (replyLock);
+            connectionLost = true;
+        }
+
+        replyReceived.signal();
+    }
+
+    ChildProcessPluginScanner& owner;
+    bool isRunning = false, isBusy = false;
+
+    CriticalSection replyLock;
+    std::unique_ptr<XmlElement> reply;
+    bool connectionLost = false;
+    WaitableEvent replyReceived;
+
+    JUCE_DECLARE_NON_COPYABLE (Worker)
+};
+
+//==============================================================================
+ChildProcessPluginScanner::ChildProcessPluginScanner (const File& workerExecutable, int numWorkerProcesses,
+                                                      int scanTimeoutMs, const String& commandLineUniqueID)
+    : executable (workerExecutable),
+      commandLineID (commandLineUniqueID),
+      timeoutMs (jmax (1000, scanTimeoutMs))
+{
+    for (int i = jmax (1, numWorkerProcesses); --i >= 0;)
+        workers.add (new Worker (*this));
+}
+
+ChildProcessPluginScanner::~ChildProcessPluginScanner()
+{
+    // all scans must have finished before this is deleted
+    jassert (std::none_of (workers.begin(), workers.end(), [] (Worker* w) { return w->isBusy; }));
+}
+
+bool ChildProcessPluginScanner::findPluginTypesFor (AudioPluginFormat& format,
+                                                    OwnedArray<PluginDescription>& result,
+                                                    const String& fileOrIdentifier)
+{
+    auto* worker = acquireWorker();
+
+    if (worker == nullptr)
+        return true;
+
+    auto scanResult = worker->scan (format, fileOrIdentifier, result);
+    releaseWorker (worker);
+
+    // returning false blacklists the plugin, which mustn't happen if the scan was cancelled
+    return scanResult != Worker::Result::failed;
+}
+
+void ChildProcessPluginScanner::scanFinished()
+{
+    const ScopedLock sl (workerLock);
+
+    for (auto* w : workers)
+        if (! w->isBusy)
+            w->stop();
+}
+
+ChildProcessPluginScanner::Worker* ChildProcessPluginScanner::acquireWorker()
+{
+    for (;;)
+    {
+        {
+            const ScopedLock sl (workerLock);
+
+            for (auto* w : workers)
+            {
+                if (! w->isBusy)
+                {
+                    w->isBusy = true;
+                    return w;
+                }
+            }
+        }
+
+        if (shouldExit())
+            return nullptr;
+
+        workerReleased.wait (50);
+    }
+}
+
+void ChildProcessPluginScanner::releaseWorker (Worker* worker)
+{
+    {
+        const ScopedLock sl (workerLock);
+        worker->isBusy = false;
+    }
+
+    workerReleased.signal();
+}
+
+//==============================================================================
+ChildProcessPluginScanner::WorkerProcess::WorkerProcess (AudioPluginFormatManager& formats)
+    : formatManager (formats)
+{
+}
+
+ChildProcessPluginScanner::WorkerProcess::~WorkerProcess() {}
+
+void ChildProcessPluginScanner::WorkerProcess::handleMessageFromMaster (const MemoryBlock& message)
+{
+    if (auto request = memoryBlockToXml (message))
+    {
+        if (request->hasTagName ("SCAN"))
+        {
+            auto formatName = request->getStringAttribute ("format");
+            auto identifier = request->getStringAttribute ("identifier");
+
+            // plugins generally expect to be loaded on the message thread
+            MessageManager::callAsync ([this, formatName, identifier] { scanFile (formatName, identifier); });
+        }
+    }
+}
+
+void ChildProcessPluginScanner::WorkerProcess::scanFile (const String& formatName, const String& fileOrIdentifier)
+{
+    OwnedArray<PluginDescription> found;
+
+    for (int i = 0; i < formatManager.getNumFormats(); ++i)
+    {
+        auto* format = formatManager.getFormat (i);
+
+        if (format->getName() == formatName)
+        {
+            format->findAllTypesForFile (found, fileOrIdentifier);
+            break;
+        }
+    }
+
+    XmlElement reply ("SCANRESULT");
+
+    for (auto* desc : found)
+        reply.addChildElement (desc->createXml());
+
+    sendMessageToMaster (xmlToMemoryBlock (reply));
+}
+
+void ChildProcessPluginScanner::WorkerProcess::handleConnectionLost()
+{
+    if (auto* app = JUCEApplicationBase::getInstance())
+        app->systemRequestedQuit();
+    else
+        MessageManager::getInstance()->stopDispatchLoop();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct ChildProcessPluginScannerTests  : public UnitTest
+{
+    ChildProcessPluginScannerTests()  : UnitTest ("ChildProcessPluginScanner", "Audio") {}
+
+    static PluginDescription createDescription (const String& fileOrIdentifier)
+    {
+        PluginDescription desc;
+        desc.name = fileOrIdentifier;
+        desc.pluginFormatName = "Stub";
+        desc.fileOrIdentifier = fileOrIdentifier;
+        desc.uid = fileOrIdentifier.hashCode();
+        return desc;
+    }
+
+    //==============================================================================
+    struct StubFormat  : public AudioPluginFormat
+    {
+        String getName() const override                                     { return "Stub"; }
+
+        void findAllTypesForFile (OwnedArray<PluginDescription>& results, const String& fileOrIdentifier) override
+        {
+            ++numInProcessScans;
+            results.add (new PluginDescription (createDescription (fileOrIdentifier)));
+        }
+
+        bool fileMightContainThisPluginType (const String&) override         { return true; }
+        String getNameOfPluginFromIdentifier (const String& id) override    { return id; }
+        bool pluginNeedsRescanning (const PluginDescription&) override      { return false; }
+        bool doesPluginStillExist (const PluginDescription&) override       { return true; }
+        bool canScanForPlugins() const override                             { return true; }
+        StringArray searchPathsForPlugins (const FileSearchPath&, bool, bool) override  { return {}; }
+        FileSearchPath getDefaultLocationsToSearch() override               { return {}; }
+
+        void createPluginInstance (const PluginDescription&, double, int, void*, PluginCreationCallback) override  {}
+        bool requiresUnblockedMessageThreadDuringCreation (const PluginDescription&) const noexcept override       { return false; }
+
+        std::atomic<int> numInProcessScans { 0 };
+    };
+
+    //==============================================================================
+    /*  Stands in for the worker processes. Requests are answered in batches, once
+        requestsPerBatch of them are waiting, so a batch can only complete if that
+        many files are being scanned at the same time.
+    */
+    struct StubProcesses
+    {
+        enum class Behaviour { answersInBatches, neverAnswers, failsToLaunch };
+
+        StubProcesses (Behaviour b, int batchSize, const File& pedal)
+            : behaviour (b), requestsPerBatch (batchSize), deadMansPedal (pedal)
+        {}
+
+        void addRequest (ChildProcessPluginScanner::Worker& worker, const String& fileOrIdentifier)
+        {
+            requestSent.signal();
+
+            if (behaviour != Behaviour::answersInBatches)
+                return;
+
+            const ScopedLock sl (lock);
+            waiting.add ({ &worker, fileOrIdentifier });
+
+            if (waiting.size() < requestsPerBatch)
+                return;
+
+            // every file that's being scanned must be in the dead-man's pedal file
+            auto filesBeingScanned = readDeadMansPedalFile (deadMansPedal);
+
+            for (auto& request : waiting)
+            {
+                pedalListedEveryScan = pedalListedEveryScan && filesBeingScanned.contains (request.second);
+
+                XmlElement reply ("SCANRESULT");
+                reply.addChildElement (createDescription (request.second).createXml());
+                request.first->handleMessageFromSlave (xmlToMemoryBlock (reply));
+            }
+
+            waiting.clear();
+        }
+
+        const Behaviour behaviour;
+        const int requestsPerBatch;
+        const File deadMansPedal;
+
+        CriticalSection lock;
+        Array<std::pair<ChildProcessPluginScanner::Worker*, String>> waiting;
+        bool pedalListedEveryScan = true;
+        std::atomic<int> numKilled { 0 };
+        WaitableEvent requestSent;
+    };
+
+    struct StubWorker  : public ChildProcessPluginScanner::Worker
+    {
+        StubWorker (ChildProcessPluginScanner& o, StubProcesses& p)  : Worker (o), processes (p) {}
+
+        bool launchProcess() override
+        {
+            return processes.behaviour != StubProcesses::Behaviour::failsToLaunch;
+        }
+
+        bool sendRequest (const MemoryBlock& request) override
+        {
+            auto xml = memoryBlockToXml (request);
+            processes.addRequest (*this, xml->getStringAttribute ("identifier"));
+            return true;
+        }
+
+        void killProcess() override
+        {
+            ++processes.numKilled;
+        }
+
+        StubProcesses& processes;
+    };
+
+    static void addScanner (KnownPluginList& list, StubProcesses& processes, int numWorkers, int timeoutMs)
+    {
+        auto* scanner = new ChildProcessPluginScanner (File(), numWorkers, timeoutMs);
+        scanner->workers.clear();
+
+        for (int i = 0; i < numWorkers; ++i)
+            scanner->workers.add (new StubWorker (*scanner, processes));
+
+        list.setCustomScanner (scanner);
+    }
+
+    static StringArray createFileList (int numFiles)
+    {
+        StringArray files;
+
+        for (int i = 0; i < numFiles; ++i)
+            files.add ("plugin" + String (i));
+
+        return files;
+    }
+
+    //==============================================================================
+    void runTest() override
+    {
+        StubFormat format;
+        TemporaryFile pedalTemp;
+        auto deadMansPedal = pedalTemp.getFile();
+
+        beginTest ("Files are scanned in parallel");
+        {
+            const int numThreads = 4;
+            StubProcesses processes (StubProcesses::Behaviour::answersInBatches, numThreads, deadMansPedal);
+            KnownPluginList list;
+            addScanner (list, processes, numThreads, 10000);
+
+            {
+                PluginDirectoryScanner scanner (list, format, {}, false, deadMansPedal);
+                scanner.setFilesOrIdentifiersToScan (createFileList (numThreads * 3));
+
+                ThreadPool pool (numThreads);
+
+                for (int i = 0; i < numThreads; ++i)
+                    pool.addJob ([&scanner]
+                    {
+                        String name;
+
+                        while (scanner.scanNextFile (true, name))
+                        {}
+                    });
+
+                auto endTime = Time::getMillisecondCounter() + 60000;
+
+                while (pool.getNumJobs() > 0 && Time::getMillisecondCounter() < endTime)
+                    Thread::sleep (5);
+
+                expectEquals (pool.getNumJobs(), 0);
+                expect (scanner.getFailedFiles().isEmpty());
+            }
+
+            expectEquals (list.getNumTypes(), numThreads * 3);
+            expect (list.getBlacklistedFiles().isEmpty());
+            expect (processes.pedalListedEveryScan);
+            expect (readDeadMansPedalFile (deadMansPedal).isEmpty());
+            expectEquals (format.numInProcessScans.load(), 0);
+        }
+
+        beginTest ("A worker that hangs is killed and its file blacklisted");
+        {
+            StubProcesses processes (StubProcesses::Behaviour::neverAnswers, 1, deadMansPedal);
+            KnownPluginList list;
+            addScanner (list, processes, 1, 1000);
+
+            {
+                PluginDirectoryScanner scanner (list, format, {}, false, deadMansPedal);
+                scanner.setFilesOrIdentifiersToScan ({ "hangs" });
+
+                String name;
+                scanner.scanNextFile (true, name);
+
+                expectEquals (processes.numKilled.load(), 1);
+                expect (scanner.getFailedFiles().isEmpty());
+            }
+
+            expect (list.getBlacklistedFiles() == StringArray ("hangs"));
+            expectEquals (list.getNumTypes(), 0);
+            expect (readDeadMansPedalFile (deadMansPedal).isEmpty());
+        }
+
+        beginTest ("Files are scanned in-process if a worker can't be launched");
+        {
+            StubProcesses processes (StubProcesses::Behaviour::failsToLaunch, 1, deadMansPedal);
+            KnownPluginList list;
+            addScanner (list, processes, 2, 10000);
+            format.numInProcessScans = 0;
+
+            {
+                PluginDirectoryScanner scanner (list, format, {}, false, deadMansPedal);
+                scanner.setFilesOrIdentifiersToScan (createFileList (3));
+
+                String name;
+
+                while (scanner.scanNextFile (true, name))
+                {}
+
+                expect (scanner.getFailedFiles().isEmpty());
+            }
+
+            expectEquals (format.numInProcessScans.load(), 3);
+            expectEquals (list.getNumTypes(), 3);
+            expect (list.getBlacklistedFiles().isEmpty());
+        }
+
+        beginTest ("A cancelled scan isn't recorded as a failure");
+        {
+            StubProcesses processes (StubProcesses::Behaviour::neverAnswers, 1, deadMansPedal);
+            KnownPluginList list;
+            addScanner (list, processes, 1, 60000);
+
+            {
+                PluginDirectoryScanner scanner (list, format, {}, false, deadMansPedal);
+                scanner.setFilesOrIdentifiersToScan ({ "cancelled" });
+
+                ThreadPool pool (1);
+
+                pool.addJob ([&scanner]
+                {
+                    String name;
+                    scanner.scanNextFile (true, name);
+                });
+
+                expect (processes.requestSent.wait (10000));
+                expect (pool.removeAllJobs (true, 10000));
+                expect (scanner.getFailedFiles().isEmpty());
+            }
+
+            expect (list.getBlacklistedFiles().isEmpty());
+            expectEquals (list.getNumTypes(), 0);
+        }
+    }
+};
+
+static ChildProcessPluginScannerTests childProcessPluginScannerTests;
+
+#endif // JUCE_UNIT_TESTS
+
+} // namespace juce
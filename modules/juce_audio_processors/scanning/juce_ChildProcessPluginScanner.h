@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A KnownPluginList::CustomScanner that scans plugins in a pool of child processes.
+
+    Each file is sent to a separate worker process to be loaded, so a plugin that
+    crashes or hangs only takes down its worker (which gets restarted) rather than
+    your app, and gets blacklisted in the same way as if it had crashed during a
+    normal scan. Because each worker can load a different plugin at the same time,
+    scanning with several threads - see PluginListComponent::setNumberOfThreadsForScanning()
+    or call PluginDirectoryScanner::scanNextFile() from several threads yourself -
+    lets a large folder of plugins get scanned many times faster.
+
+    The workers are launched from an executable that you supply, which will usually be
+    your own app. When it starts, it must check its command line for a scanner request
+    and, if it finds one, create a WorkerProcess instead of starting up normally:
+
+    @code
+    void initialise (const String& commandLine) override
+    {
+        auto worker = std::make_unique<ChildProcessPluginScanner::WorkerProcess> (formatManager);
+
+        if (worker->initialiseFromCommandLine (commandLine, ChildProcessPluginScanner::defaultCommandLineID))
+        {
+            scannerWorker = std::move (worker);
+            return;
+        }
+
+        // ..carry on starting the app as normal
+    }
+    @endcode
+
+    If a worker process can't be launched, the plugins are scanned in-process instead.
+
+    @see KnownPluginList::setCustomScanner, PluginDirectoryScanner
+
+    @tags{Audio}
+*/
+class JUCE_API  ChildProcessPluginScanner  : public KnownPluginList::CustomScanner
+{
+public:
+    //==============================================================================
+    /** Creates a scanner.
+
+        @param workerExecutable     the executable to launch for each worker (normally your
+                                    own app, i.e. File::getSpecialLocation (File::currentExecutableFile))
+        @param numWorkerProcesses   the maximum number of workers that can be running at once
+        @param scanTimeoutMs        how long a worker is given to scan a file before it's killed
+                                    and the file gets blacklisted
+        @param commandLineUniqueID  the ID that the workers look for on their command line
+    */
+    ChildProcessPluginScanner (const File& workerExecutable,
+                               int numWorkerProcesses = SystemStats::getNumCpus(),
+                               int scanTimeoutMs = 60000,
+                               const String& commandLineUniqueID = defaultCommandLineID);
+
+    /** Destructor. This kills any worker processes that are still running. */
+    ~ChildProcessPluginScanner() override;
+
+    //==============================================================================
+    /** @internal */
+    bool findPluginTypesFor (AudioPluginFormat&, OwnedArray<PluginDescription>&, const String&) override;
+    /** @internal */
+    void scanFinished() override;
+
+    //==============================================================================
+    /** The command-line ID that the scanner and its workers use if you don't give them another one. */
+    static constexpr const char* defaultCommandLineID = "jucepluginscanner";
+
+    //==============================================================================
+    /**
+        The object that does the scanning inside each worker process.
+
+        Create one of these in the worker's startup code and call initialiseFromCommandLine()
+        on it. When the connection to the scanner is lost, it tells the app to quit.
+    */
+    class JUCE_API  WorkerProcess  : public ChildProcessSlave
+    {
+    public:
+        /** Creates a worker that will use the given formats to scan any files it's sent. */
+        explicit WorkerProcess (AudioPluginFormatManager& formatsToUse);
+
+        /** Destructor. */
+        ~WorkerProcess() override;
+
+        /** @internal */
+        void handleMessageFromMaster (const MemoryBlock&) override;
+        /** @internal */
+        void handleConnectionLost() override;
+
+    private:
+        void scanFile (const String& formatName, const String& fileOrIdentifier);
+
+        AudioPluginFormatManager& formatManager;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkerProcess)
+    };
+
+private:
+    //==============================================================================
+    struct Worker;
+
+   #if JUCE_UNIT_TESTS
+    friend struct ChildProcessPluginScannerTests;
+   #endif
+
+    Worker* acquireWorker();
+    void releaseWorker (Worker*);
+
+    const File executable;
+    const String commandLineID;
+    const int timeoutMs;
+
+    OwnedArray<Worker> workers;
+    CriticalSection workerLock;
+    WaitableEvent workerReleased;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChildProcessPluginScanner)
+};
+
+} // namespace juce
@@ -355,6 +355,23 @@ void KnownPluginList::recreateFromXml (const XmlElement& xml)
     }
 }
 
+void KnownPluginList::recreateFromCache (const PluginListCache& cache)
+{
+    {
+        ScopedLock lock (typesArrayLock);
+
+        // the cache was written from a list, so there's no need to check for duplicates here
+        types.clearQuick (true);
+        types.ensureStorageAllocated (cache.getNumTypes());
+
+        for (int i = 0; i < cache.getNumTypes(); ++i)
+            types.add (new PluginDescription (cache.getType (i)));
+    }
+
+    blacklist = cache.getBlacklistedFiles();
+    sendChangeMessage();
+}
+
 //==============================================================================
 struct PluginTreeUtils
 {
@@ -172,6 +172,15 @@ public:
     /** Recreates the state of this list from its stored XML format. */
     void recreateFromXml (const XmlElement& xml);
 
+    /** Recreates the state of this list from a binary cache file.
+
+        This is much quicker than recreateFromXml() for big lists. To create the cache,
+        use PluginListCache::writeToFile().
+
+        @see PluginListCache
+    */
+    void recreateFromCache (const PluginListCache& cache);
+
     //==============================================================================
     /** A structure that recursively holds a tree of plugins.
         @see KnownPluginList::createTree()
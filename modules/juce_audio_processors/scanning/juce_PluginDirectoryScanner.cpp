@@ -35,6 +35,16 @@ static StringArray readDeadMansPedalFile (const File& file)
     return lines;
 }
 
+// A custom scanner gives up on a file when the job that's scanning it is told to stop,
+// so in that case finding no plugins doesn't mean that the file failed to load.
+static bool isScanBeingCancelled()
+{
+    if (auto* job = ThreadPoolJob::getCurrentThreadPoolJob())
+        return job->shouldExit();
+
+    return false;
+}
+
 PluginDirectoryScanner::PluginDirectoryScanner (KnownPluginList& listToAddTo,
                                                 AudioPluginFormat& formatToLookFor,
                                                 FileSearchPath directoriesToSearch,
@@ -97,19 +107,19 @@ bool PluginDirectoryScanner::scanNextFile (bool dontRescanIfAlreadyInList,
             OwnedArray<PluginDescription> typesFound;
 
             // Add this plugin to the end of the dead-man's pedal list in case it crashes...
-            auto crashedPlugins = readDeadMansPedalFile (deadMansPedalFile);
-            crashedPlugins.removeString (file);
-            crashedPlugins.add (file);
-            setDeadMansPedalFile (crashedPlugins);
+            updateDeadMansPedalFile (file, true);
 
             list.scanAndAddFile (file, dontRescanIfAlreadyInList, typesFound, format);
 
             // Managed to load without crashing, so remove it from the dead-man's-pedal..
-            crashedPlugins.removeString (file);
-            setDeadMansPedalFile (crashedPlugins);
+            updateDeadMansPedalFile (file, false);
 
-            if (typesFound.size() == 0 && ! list.getBlacklistedFiles().contains (file))
+            if (typesFound.size() == 0 && ! list.getBlacklistedFiles().contains (file)
+                 && ! isScanBeingCancelled())
+            {
+                const ScopedLock sl (lock);
                 failedFiles.add (file);
+            }
         }
     }
 
@@ -123,6 +133,20 @@ bool PluginDirectoryScanner::skipNextFile()
     return --nextIndex > 0;
 }
 
+void PluginDirectoryScanner::updateDeadMansPedalFile (const String& file, bool isBeingScanned)
+{
+    // other threads may be scanning at the same time, so the file has to be re-read each time
+    const ScopedLock sl (lock);
+
+    auto crashedPlugins = readDeadMansPedalFile (deadMansPedalFile);
+    crashedPlugins.removeString (file);
+
+    if (isBeingScanned)
+        crashedPlugins.add (file);
+
+    setDeadMansPedalFile (crashedPlugins);
+}
+
 void PluginDirectoryScanner::setDeadMansPedalFile (const StringArray& newContents)
 {
     if (deadMansPedalFile.getFullPathName().isNotEmpty())
@@ -34,6 +34,10 @@ namespace juce
     To use one of these, create it and call scanNextFile() repeatedly, until
     it returns false.
 
+    scanNextFile() can be called from several threads at once to scan more than one
+    file at a time. This is most useful when the list has a custom scanner that loads
+    the plugins in separate processes, such as a ChildProcessPluginScanner.
+
     @tags{Audio}
 */
 class JUCE_API  PluginDirectoryScanner
@@ -129,9 +133,11 @@ private:
     Atomic<int> nextIndex;
     float progress = 0;
     const bool allowAsync;
+    CriticalSection lock;
 
     void updateProgress();
     void setDeadMansPedalFile (const StringArray& newContents);
+    void updateDeadMansPedalFile (const String& file, bool isBeingScanned);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginDirectoryScanner)
 };
@@ -0,0 +1,478 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+/*  The layout of a cache file, where all numbers are little-endian:
+
+    header:         magic, version, numTypes, numBlacklisted, entriesStart,
+                    sortedIndexStart, blacklistStart, stringsStart, stringsSize (all uint32)
+    entries:        numTypes fixed-size records, in list order (see EntryLayout)
+    sorted index:   numTypes uint32 entry indexes, sorted by the entries' fileOrIdentifier
+    blacklist:      numBlacklisted uint32 string offsets
+    strings:        null-terminated UTF-8 strings, each one only stored once
+*/
+namespace PluginListCacheHelpers
+{
+    enum : uint32
+    {
+        magicNumber  = 0x434c504a,  // "JPLC"
+        formatVersion = 1,
+        headerSize   = 40
+    };
+
+    enum EntryLayout
+    {
+        nameField = 0,
+        descriptiveNameField,
+        formatNameField,
+        categoryField,
+        manufacturerField,
+        versionField,
+        fileOrIdentifierField,
+        numStringFields,
+
+        uidOffset           = numStringFields * 4,
+        numInputsOffset     = uidOffset + 4,
+        numOutputsOffset    = numInputsOffset + 4,
+        flagsOffset         = numOutputsOffset + 4,
+        fileModTimeOffset   = flagsOffset + 8,
+        infoUpdateOffset    = fileModTimeOffset + 8,
+        entrySize           = infoUpdateOffset + 8
+    };
+
+    enum Flags
+    {
+        isInstrumentFlag       = 1,
+        hasSharedContainerFlag = 2
+    };
+
+    struct StringTable
+    {
+        uint32 add (const String& s)
+        {
+            if (offsets.contains (s))
+                return offsets[s];
+
+            auto offset = (uint32) data.getDataSize();
+            offsets.set (s, offset);
+            data << s.toRawUTF8();
+            data.writeByte (0);
+            return offset;
+        }
+
+        MemoryOutputStream data;
+        HashMap<String, uint32> offsets;
+    };
+}
+
+//==============================================================================
+PluginListCache::PluginListCache (const File& cacheFile)
+    : file (cacheFile, MemoryMappedFile::readOnly)
+{
+    data = static_cast<const uint8*> (file.getData());
+    dataSize = file.getSize();
+
+    if (! validate())
+        numTypes = -1;
+}
+
+PluginListCache::~PluginListCache() {}
+
+uint32 PluginListCache::readInt (size_t position) const noexcept
+{
+    return ByteOrder::littleEndianInt (data + position);
+}
+
+bool PluginListCache::validate()
+{
+    using namespace PluginListCacheHelpers;
+
+    if (data == nullptr || dataSize < headerSize
+         || readInt (0) != magicNumber || readInt (4) != formatVersion)
+        return false;
+
+    auto types       = readInt (8);
+    auto blacklisted = readInt (12);
+
+    entriesStart     = readInt (16);
+    sortedIndexStart = readInt (20);
+    blacklistStart   = readInt (24);
+    stringsStart     = readInt (28);
+    stringsSize      = readInt (32);
+
+    auto fits = [this] (uint64 start, uint64 size)  { return start + size <= dataSize; };
+
+    if (types > 0x1000000 || blacklisted > 0x1000000
+         || ! fits (entriesStart, (uint64) types * entrySize)
+         || ! fits (sortedIndexStart, (uint64) types * 4)
+         || ! fits (blacklistStart, (uint64) blacklisted * 4)
+         || ! fits (stringsStart, stringsSize))
+        return false;
+
+    // as long as the pool ends with a terminator, any offset inside it gives a valid string
+    if (stringsSize == 0 || data[stringsStart + stringsSize - 1] != 0)
+        return false;
+
+    numTypes = (int) types;
+    numBlacklisted = (int) blacklisted;
+
+    for (int i = 0; i < numTypes; ++i)
+    {
+        if (readInt (sortedIndexStart + (size_t) i * 4) >= types)
+            return false;
+
+        for (int field = 0; field < numStringFields; ++field)
+            if (ByteOrder::littleEndianInt (getEntry (i) + field * 4) >= stringsSize)
+                return false;
+    }
+
+    for (int i = 0; i < numBlacklisted; ++i)
+        if (readInt (blacklistStart + (size_t) i * 4) >= stringsSize)
+            return false;
+
+    return true;
+}
+
+const uint8* PluginListCache::getEntry (int index) const noexcept
+{
+    jassert (isPositiveAndBelow (index, numTypes));
+    return data + entriesStart + (size_t) index * PluginListCacheHelpers::entrySize;
+}
+
+const char* PluginListCache::getString (uint32 offset) const noexcept
+{
+    return reinterpret_cast<const char*> (data + stringsStart + offset);
+}
+
+const char* PluginListCache::getString (const uint8* entry, int field) const noexcept
+{
+    return getString (ByteOrder::littleEndianInt (entry + field * 4));
+}
+
+//==============================================================================
+PluginDescription PluginListCache::getType (int index) const
+{
+    using namespace PluginListCacheHelpers;
+
+    PluginDescription desc;
+
+    if (isPositiveAndBelow (index, numTypes))
+    {
+        auto* entry = getEntry (index);
+
+        desc.name               = String::fromUTF8 (getString (entry, nameField));
+        desc.descriptiveName    = String::fromUTF8 (getString (entry, descriptiveNameField));
+        desc.pluginFormatName   = String::fromUTF8 (getString (entry, formatNameField));
+        desc.category           = String::fromUTF8 (getString (entry, categoryField));
+        desc.manufacturerName   = String::fromUTF8 (getString (entry, manufacturerField));
+        desc.version            = String::fromUTF8 (getString (entry, versionField));
+        desc.fileOrIdentifier   = String::fromUTF8 (getString (entry, fileOrIdentifierField));
+        desc.uid                = (int) ByteOrder::littleEndianInt (entry + uidOffset);
+        desc.numInputChannels   = (int) ByteOrder::littleEndianInt (entry + numInputsOffset);
+        desc.numOutputChannels  = (int) ByteOrder::littleEndianInt (entry + numOutputsOffset);
+
+        auto flags = ByteOrder::littleEndianInt (entry + flagsOffset);
+        desc.isInstrument       = (flags & isInstrumentFlag) != 0;
+        desc.hasSharedContainer = (flags & hasSharedContainerFlag) != 0;
+
+        desc.lastFileModTime    = Time ((int64) ByteOrder::littleEndianInt64 (entry + fileModTimeOffset));
+        desc.lastInfoUpdateTime = Time ((int64) ByteOrder::littleEndianInt64 (entry + infoUpdateOffset));
+    }
+
+    return desc;
+}
+
+String PluginListCache::getFileOrIdentifier (int index) const
+{
+    if (isPositiveAndBelow (index, numTypes))
+        return String::fromUTF8 (getString (getEntry (index), PluginListCacheHelpers::fileOrIdentifierField));
+
+    return {};
+}
+
+Time PluginListCache::getLastFileModTime (int index) const
+{
+    if (isPositiveAndBelow (index, numTypes))
+        return Time ((int64) ByteOrder::littleEndianInt64 (getEntry (index) + PluginListCacheHelpers::fileModTimeOffset));
+
+    return {};
+}
+
+Array<int> PluginListCache::getIndexesOfTypesForFile (const String& fileOrIdentifier) const
+{
+    Array<int> result;
+    auto* target = fileOrIdentifier.toRawUTF8();
+
+    auto compareWithSorted = [this, target] (int sortedPos)
+    {
+        auto index = (int) readInt (sortedIndexStart + (size_t) sortedPos * 4);
+        return std::strcmp (getString (getEntry (index), PluginListCacheHelpers::fileOrIdentifierField), target);
+    };
+
+    // find the first entry that isn't less than the target..
+    int start = 0, end = getNumTypes();
+
+    while (start < end)
+    {
+        auto mid = (start + end) / 2;
+
+        if (compareWithSorted (mid) < 0)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    for (; start < numTypes && compareWithSorted (start) == 0; ++start)
+        result.add ((int) readInt (sortedIndexStart + (size_t) start * 4));
+
+    result.sort();
+    return result;
+}
+
+bool PluginListCache::isListingUpToDate (const String& fileOrIdentifier, AudioPluginFormat& formatToUse) const
+{
+    auto indexes = getIndexesOfTypesForFile (fileOrIdentifier);
+
+    if (indexes.isEmpty())
+        return false;
+
+    for (auto index : indexes)
+        if (formatToUse.pluginNeedsRescanning (getType (index)))
+            return false;
+
+    return true;
+}
+
+StringArray PluginListCache::getBlacklistedFiles() const
+{
+    StringArray result;
+
+    for (int i = 0; i < numBlacklisted; ++i)
+        result.add (String::fromUTF8 (getString (readInt (blacklistStart + (size_t) i * 4))));
+
+    return result;
+}
+
+//==============================================================================
+bool PluginListCache::writeToFile (const KnownPluginList& list, const File& cacheFile)
+{
+    using namespace PluginListCacheHelpers;
+
+    StringTable strings;
+    MemoryOutputStream entries;
+    Array<const char*> fileNames;
+
+    for (auto* desc : list)
+    {
+        auto fileNameOffset = strings.add (desc->fileOrIdentifier);
+
+        for (auto* s : { &desc->name, &desc->descriptiveName, &desc->pluginFormatName, &desc->category,
+                         &desc->manufacturerName, &desc->version })
+            entries.writeInt ((int) strings.add (*s));
+
+        entries.writeInt ((int) fileNameOffset);
+        entries.writeInt (desc->uid);
+        entries.writeInt (desc->numInputChannels);
+        entries.writeInt (desc->numOutputChannels);
+        entries.writeInt ((desc->isInstrument ? isInstrumentFlag : 0)
+                           | (desc->hasSharedContainer ? hasSharedContainerFlag : 0));
+        entries.writeInt (0);
+        entries.writeInt64 (desc->lastFileModTime.toMilliseconds());
+        entries.writeInt64 (desc->lastInfoUpdateTime.toMilliseconds());
+
+        fileNames.add (desc->fileOrIdentifier.toRawUTF8());
+    }
+
+    Array<int> sortedIndex;
+
+    for (int i = 0; i < fileNames.size(); ++i)
+        sortedIndex.add (i);
+
+    std::stable_sort (sortedIndex.begin(), sortedIndex.end(),
+                      [&fileNames] (int a, int b)  { return std::strcmp (fileNames.getUnchecked (a), fileNames.getUnchecked (b)) < 0; });
+
+    auto& blacklist = list.getBlacklistedFiles();
+    Array<uint32> blacklistOffsets;
+
+    for (auto& b : blacklist)
+        blacklistOffsets.add (strings.add (b));
+
+    if (strings.data.getDataSize() == 0)
+        strings.add ({});
+
+    auto numEntries       = (uint32) sortedIndex.size();
+    auto entriesStart     = (uint32) headerSize;
+    auto sortedIndexStart = entriesStart + numEntries * (uint32) entrySize;
+    auto blacklistStart   = sortedIndexStart + numEntries * 4;
+    auto stringsStart     = blacklistStart + (uint32) blacklistOffsets.size() * 4;
+
+    TemporaryFile temp (cacheFile);
+
+    {
+        FileOutputStream out (temp.getFile());
+
+        if (! out.openedOk())
+            return false;
+
+        for (auto value : { (uint32) magicNumber, (uint32) formatVersion, numEntries, (uint32) blacklistOffsets.size(),
+                            entriesStart, sortedIndexStart, blacklistStart, stringsStart, (uint32) strings.data.getDataSize(), 0u })
+            out.writeInt ((int) value);
+
+        out.write (entries.getData(), entries.getDataSize());
+
+        for (auto index : sortedIndex)
+            out.writeInt (index);
+
+        for (auto offset : blacklistOffsets)
+            out.writeInt ((int) offset);
+
+        out.write (strings.data.getData(), strings.data.getDataSize());
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PluginListCacheTests  : public UnitTest
+{
+public:
+    PluginListCacheTests() : UnitTest ("PluginListCache", "Audio") {}
+
+    static PluginDescription createDescription (const String& fileName, int uid)
+    {
+        PluginDescription desc;
+        desc.name = "Plugin " + String (uid);
+        desc.descriptiveName = desc.name + " (descriptive)";
+        desc.pluginFormatName = "VST3";
+        desc.category = uid % 2 == 0 ? "Fx" : "Instrument";
+        desc.manufacturerName = String (CharPointer_UTF8 ("Manufacturer \xc3\xa9"));
+        desc.version = "1.0." + String (uid);
+        desc.fileOrIdentifier = fileName;
+        desc.lastFileModTime = Time (1500000000000 + uid);
+        desc.lastInfoUpdateTime = Time (1600000000000 + uid);
+        desc.uid = uid;
+        desc.isInstrument = uid % 2 != 0;
+        desc.numInputChannels = uid % 3;
+        desc.numOutputChannels = 2;
+        desc.hasSharedContainer = uid % 4 == 0;
+        return desc;
+    }
+
+    void expectSameDescription (const PluginDescription& a, const PluginDescription& b)
+    {
+        std::unique_ptr<XmlElement> xmlA (a.createXml()), xmlB (b.createXml());
+        expect (xmlA->isEquivalentTo (xmlB.get(), false));
+    }
+
+    void runTest() override
+    {
+        TemporaryFile temp;
+        auto cacheFile = temp.getFile();
+
+        KnownPluginList list;
+
+        for (int i = 0; i < 40; ++i)
+            list.addType (createDescription ("/plugins/" + String (i % 13) + ".vst3", i));
+
+        list.addToBlacklist ("/plugins/broken.vst3");
+
+        beginTest ("Round trip");
+        {
+            expect (PluginListCache::writeToFile (list, cacheFile));
+
+            PluginListCache cache (cacheFile);
+            expect (cache.isValid());
+            expectEquals (cache.getNumTypes(), list.getNumTypes());
+
+            for (int i = 0; i < list.getNumTypes(); ++i)
+                expectSameDescription (cache.getType (i), *list.getType (i));
+
+            expect (cache.getBlacklistedFiles() == list.getBlacklistedFiles());
+        }
+
+        beginTest ("Lookup by file");
+        {
+            PluginListCache cache (cacheFile);
+
+            for (int f = 0; f < 13; ++f)
+            {
+                auto fileName = "/plugins/" + String (f) + ".vst3";
+                Array<int> expected;
+
+                for (int i = 0; i < list.getNumTypes(); ++i)
+                    if (list.getType (i)->fileOrIdentifier == fileName)
+                        expected.add (i);
+
+                expect (cache.getIndexesOfTypesForFile (fileName) == expected);
+            }
+
+            expect (cache.getIndexesOfTypesForFile ("/plugins/missing.vst3").isEmpty());
+        }
+
+        beginTest ("Recreating a list");
+        {
+            KnownPluginList recreated;
+            recreated.recreateFromCache (PluginListCache (cacheFile));
+
+            expectEquals (recreated.getNumTypes(), list.getNumTypes());
+
+            for (int i = 0; i < list.getNumTypes(); ++i)
+                expectSameDescription (*recreated.getType (i), *list.getType (i));
+
+            expect (recreated.getBlacklistedFiles() == list.getBlacklistedFiles());
+        }
+
+        beginTest ("Bad files are rejected");
+        {
+            MemoryBlock contents;
+            cacheFile.loadFileAsData (contents);
+
+            cacheFile.replaceWithData (contents.getData(), contents.getSize() - 1);
+            expect (! PluginListCache (cacheFile).isValid());
+
+            cacheFile.replaceWithText ("<KNOWNPLUGINS/>");
+            expect (! PluginListCache (cacheFile).isValid());
+            expectEquals (PluginListCache (cacheFile).getNumTypes(), 0);
+
+            expect (! PluginListCache (cacheFile.getSiblingFile ("doesNotExist")).isValid());
+        }
+    }
+};
+
+static PluginListCacheTests pluginListCacheTests;
+
+#endif // JUCE_UNIT_TESTS
+
+} // namespace juce
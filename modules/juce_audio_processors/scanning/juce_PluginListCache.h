@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+class KnownPluginList;
+
+//==============================================================================
+/**
+    A read-only, memory-mapped binary snapshot of a KnownPluginList.
+
+    Loading a large plugin list from XML means parsing the whole document before a
+    host can do anything else. A cache file written with writeToFile() is a flat table
+    that gets mapped straight into memory, so opening one costs almost nothing, and
+    each PluginDescription is only built when you ask for it.
+
+    The entries are indexed by their file or identifier, so you can check whether a
+    file's listing is still up-to-date without creating anything. To bring a
+    KnownPluginList back to life, pass the cache to KnownPluginList::recreateFromCache(),
+    and then scan with dontRescanIfAlreadyInList set to true so that only the files
+    that have changed will get loaded again.
+
+    The file keeps the list's order and its blacklist. If a file is missing, truncated,
+    or was written by an incompatible version, isValid() will return false.
+
+    @see KnownPluginList
+
+    @tags{Audio}
+*/
+class JUCE_API  PluginListCache
+{
+public:
+    //==============================================================================
+    /** Opens a cache file that was written by writeToFile(). */
+    explicit PluginListCache (const File& cacheFile);
+
+    /** Destructor. */
+    ~PluginListCache();
+
+    /** Writes the contents of a KnownPluginList to a cache file, replacing it if it
+        already exists. Returns true on success.
+    */
+    static bool writeToFile (const KnownPluginList& list, const File& cacheFile);
+
+    //==============================================================================
+    /** Returns true if the file was opened and its contents look correct. */
+    bool isValid() const noexcept                       { return numTypes >= 0; }
+
+    /** Returns the number of types in the cache, in the same order as the list they came from. */
+    int getNumTypes() const noexcept                    { return jmax (0, numTypes); }
+
+    /** Creates the description for one of the types. */
+    PluginDescription getType (int index) const;
+
+    /** Returns the file or identifier for one of the types, without creating its description. */
+    String getFileOrIdentifier (int index) const;
+
+    /** Returns the modification time that the file had when one of the types was scanned. */
+    Time getLastFileModTime (int index) const;
+
+    /** Returns the indexes of all the types that were found in the given file.
+        This is a binary search, so it's cheap even for very large lists.
+    */
+    Array<int> getIndexesOfTypesForFile (const String& fileOrIdentifier) const;
+
+    /** Returns true if the file is in the cache and none of its types need rescanning
+        according to the given format.
+
+        @see KnownPluginList::isListingUpToDate
+    */
+    bool isListingUpToDate (const String& fileOrIdentifier, AudioPluginFormat& formatToUse) const;
+
+    /** Returns the blacklist that was stored with the list. */
+    StringArray getBlacklistedFiles() const;
+
+private:
+    //==============================================================================
+    const uint8* getEntry (int index) const noexcept;
+    const char* getString (const uint8* entry, int field) const noexcept;
+    const char* getString (uint32 offset) const noexcept;
+    uint32 readInt (size_t position) const noexcept;
+    bool validate();
+
+    MemoryMappedFile file;
+    const uint8* data = nullptr;
+    size_t dataSize = 0;
+    int numTypes = -1, numBlacklisted = 0;
+    uint32 entriesStart = 0, sortedIndexStart = 0, blacklistStart = 0, stringsStart = 0, stringsSize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginListCache)
+};
+
+} // namespace juce
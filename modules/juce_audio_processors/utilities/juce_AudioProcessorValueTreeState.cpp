@@ -65,6 +65,77 @@ bool AudioProcessorValueTreeState::Parameter::isAutomatable() const     { return
 bool AudioProcessorValueTreeState::Parameter::isDiscrete() const        { return discrete; }
 bool AudioProcessorValueTreeState::Parameter::isBoolean() const         { return boolean; }
 
+//==============================================================================
+/*  A bounded queue of parameter indices that any number of threads can push into, but
+    only one thread at a time can pop from.
+
+    Each adapter has a flag for each queue that stops it being added more than once, so a
+    queue whose capacity is at least the number of parameters can never overflow.
+*/
+class AudioProcessorValueTreeState::ChangeQueue
+{
+public:
+    ChangeQueue() = default;
+
+    /*  Only call this while parameters are being added, when nothing else can be
+        pushing or popping.
+    */
+    void ensureCapacity (int numParameters)
+    {
+        if (numParameters <= capacity)
+            return;
+
+        std::vector<int> pending;
+
+        for (int index; pop (index);)
+            pending.push_back (index);
+
+        capacity = nextPowerOfTwo (numParameters);
+        slots.reset (new std::atomic<int>[(size_t) capacity]);
+
+        for (int i = 0; i < capacity; ++i)
+            slots[(size_t) i].store (-1);
+
+        writePosition = 0;
+        readPosition = 0;
+
+        for (auto index : pending)
+            push (index);
+    }
+
+    void push (int index) noexcept
+    {
+        auto position = writePosition.fetch_add (1, std::memory_order_relaxed);
+        slots[(size_t) (position & (uint32) (capacity - 1))].store (index, std::memory_order_release);
+    }
+
+    bool pop (int& index) noexcept
+    {
+        if (capacity == 0)
+            return false;
+
+        auto& slot = slots[(size_t) (readPosition & (uint32) (capacity - 1))];
+        index = slot.load (std::memory_order_acquire);
+
+        // a negative value means that the slot is empty, or that a writer has
+        // claimed it but not finished writing yet
+        if (index < 0)
+            return false;
+
+        slot.store (-1, std::memory_order_relaxed);
+        ++readPosition;
+        return true;
+    }
+
+private:
+    std::unique_ptr<std::atomic<int>[]> slots;
+    int capacity = 0;
+    std::atomic<uint32> writePosition { 0 };
+    uint32 readPosition = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (ChangeQueue)
+};
+
 //==============================================================================
 class AudioProcessorValueTreeState::ParameterAdapter   : private AudioProcessorParameter::Listener
 {
@@ -136,11 +207,33 @@ public:
         return true;
     }
 
+    void setOwner (AudioProcessorValueTreeState& newOwner, int newIndex) noexcept
+    {
+        owner = &newOwner;
+        index = newIndex;
+    }
+
+    // These must be cleared (by the thread that pops from the corresponding queue) before
+    // the value is read, so that a change made in the meantime will be queued again.
+    std::atomic<bool> queuedForAudioThread { false }, queuedForMessageThread { false };
+
     ValueTree tree;
 
 private:
     void parameterGestureChanged (int, bool) override {}
 
+    void queueChange() noexcept
+    {
+        if (owner == nullptr)
+            return;
+
+        if (! queuedForMessageThread.exchange (true, std::memory_order_acq_rel))
+            owner->messageThreadChanges->push (index);
+
+        if (! queuedForAudioThread.exchange (true, std::memory_order_acq_rel))
+            owner->audioThreadChanges->push (index);
+    }
+
     void parameterValueChanged (int, float) override
     {
         const auto newValue = denormalise (parameter.getValue());
@@ -152,6 +245,7 @@ private:
         listeners.call ([=](Listener& l) { l.parameterChanged (parameter.paramID, unnormalisedValue); });
         listenersNeedCalling = false;
         needsUpdate = true;
+        queueChange();
     }
 
     float denormalise (float normalised) const
@@ -173,6 +267,8 @@ private:
     }
 
     RangedAudioParameter& parameter;
+    AudioProcessorValueTreeState* owner = nullptr;
+    int index = -1;
     ListenerList<Listener> listeners;
     float unnormalisedValue{};
     std::atomic<bool> needsUpdate { true };
@@ -238,7 +334,9 @@ AudioProcessorValueTreeState::AudioProcessorValueTreeState (AudioProcessor& proc
 }
 
 AudioProcessorValueTreeState::AudioProcessorValueTreeState (AudioProcessor& p, UndoManager* um)
-    : processor (p), undoManager (um)
+    : processor (p), undoManager (um),
+      audioThreadChanges (new ChangeQueue()),
+      messageThreadChanges (new ChangeQueue())
 {
     startTimerHz (10);
     state.addListener (this);
@@ -292,7 +390,18 @@ RangedAudioParameter* AudioProcessorValueTreeState::createAndAddParameter (std::
 //==============================================================================
 void AudioProcessorValueTreeState::addParameterAdapter (RangedAudioParameter& param)
 {
-    adapterTable.emplace (param.paramID, std::make_unique<ParameterAdapter> (param));
+    auto adapter = std::make_unique<ParameterAdapter> (param);
+    auto* adapterPtr = adapter.get();
+
+    if (adapterTable.emplace (param.paramID, std::move (adapter)).second)
+    {
+        auto numParameters = (int) adaptersByIndex.size() + 1;
+        audioThreadChanges->ensureCapacity (numParameters);
+        messageThreadChanges->ensureCapacity (numParameters);
+
+        adapterPtr->setOwner (*this, (int) adaptersByIndex.size());
+        adaptersByIndex.push_back (adapterPtr);
+    }
 }
 
 AudioProcessorValueTreeState::ParameterAdapter* AudioProcessorValueTreeState::getParameterAdapter (StringRef paramID) const
@@ -313,6 +422,26 @@ void AudioProcessorValueTreeState::removeParameterListener (StringRef paramID, L
         p->removeListener (listener);
 }
 
+int AudioProcessorValueTreeState::getChangedParameters (ParameterChange* changes, int maxNumChanges) noexcept
+{
+    int numChanges = 0;
+
+    for (int index; numChanges < maxNumChanges && audioThreadChanges->pop (index);)
+    {
+        auto& adapter = *adaptersByIndex[(size_t) index];
+        adapter.queuedForAudioThread.store (false, std::memory_order_release);
+
+        changes[numChanges++] = { &adapter.getParameter(), index, adapter.getDenormalisedValue() };
+    }
+
+    return numChanges;
+}
+
+int AudioProcessorValueTreeState::getNumParameters() const noexcept
+{
+    return (int) adaptersByIndex.size();
+}
+
 Value AudioProcessorValueTreeState::getParameterAsValue (StringRef paramID) const
 {
     if (auto* adapter = getParameterAdapter (paramID))
@@ -396,6 +525,10 @@ void AudioProcessorValueTreeState::updateParameterConnectionsToChildTrees()
         }
     }
 
+    // the trees have all changed, so every parameter that hasn't been written yet needs flushing
+    for (auto& p : adapterTable)
+        p.second->flushToTree (valuePropertyID, undoManager);
+
     flushParameterValuesToValueTree();
 }
 
@@ -430,8 +563,14 @@ bool AudioProcessorValueTreeState::flushParameterValuesToValueTree()
 
     bool anyUpdated = false;
 
-    for (auto& p : adapterTable)
-        anyUpdated |= p.second->flushToTree (valuePropertyID, undoManager);
+    // only the parameters that have changed need to be visited
+    for (int index; messageThreadChanges->pop (index);)
+    {
+        auto& adapter = *adaptersByIndex[(size_t) index];
+        adapter.queuedForMessageThread.store (false, std::memory_order_release);
+
+        anyUpdated |= adapter.flushToTree (valuePropertyID, undoManager);
+    }
 
     return anyUpdated;
 }
@@ -1031,6 +1170,110 @@ public:
             expectEquals (*proc.state.getRawParameterValue (key), value);
         }
 
+        beginTest ("Changed parameters are collected once each, with their latest values");
+        {
+            TestAudioProcessor proc;
+            Array<RangedAudioParameter*> params;
+
+            for (int i = 0; i < 3; ++i)
+                params.add (proc.state.createAndAddParameter (std::make_unique<Parameter> ("id" + String (i), String(), String(),
+                                                                                           NormalisableRange<float>(), 0.0f,
+                                                                                           nullptr, nullptr)));
+
+            expectEquals (proc.state.getNumParameters(), 3);
+
+            AudioProcessorValueTreeState::ParameterChange changes[3];
+            expectEquals (proc.state.getChangedParameters (changes, 3), 0);
+
+            params[2]->setValueNotifyingHost (0.25f);
+            params[0]->setValueNotifyingHost (0.5f);
+            params[2]->setValueNotifyingHost (0.75f);
+
+            expectEquals (proc.state.getChangedParameters (changes, 3), 2);
+            expect (changes[0].parameter == params[2]);
+            expectEquals (changes[0].index, 2);
+            expectEquals (changes[0].value, 0.75f);
+            expect (changes[1].parameter == params[0]);
+            expectEquals (changes[1].value, 0.5f);
+
+            expectEquals (proc.state.getChangedParameters (changes, 3), 0);
+
+            for (auto* p : params)
+                p->setValueNotifyingHost (1.0f);
+
+            expectEquals (proc.state.getChangedParameters (changes, 2), 2);
+            expectEquals (proc.state.getChangedParameters (changes, 2), 1);
+            expect (changes[0].parameter == params[2]);
+        }
+
+        beginTest ("Changes from several threads reach the audio thread and the state");
+        {
+            const int numParams = 1000;
+            ParameterLayout layout;
+
+            for (int i = 0; i < numParams; ++i)
+                layout.add (std::make_unique<AudioParameterFloat> ("id" + String (i), String(), 0.0f, 1.0f, 0.0f));
+
+            TestAudioProcessor proc (std::move (layout));
+            auto& params = proc.getParameters();
+
+            struct Writer  : public Thread
+            {
+                Writer (const OwnedArray<AudioProcessorParameter>& p, int first)
+                    : Thread ("APVTS writer"), params (p), firstParam (first) {}
+
+                void run() override
+                {
+                    for (int pass = 1; pass <= 10; ++pass)
+                        for (int i = firstParam; i < params.size(); i += 2)
+                            params.getUnchecked (i)->setValueNotifyingHost (pass / 10.0f);
+                }
+
+                const OwnedArray<AudioProcessorParameter>& params;
+                int firstParam;
+            };
+
+            Writer evenWriter (params, 0), oddWriter (params, 1);
+            evenWriter.startThread();
+            oddWriter.startThread();
+
+            std::vector<float> lastValues ((size_t) numParams, 0.0f);
+            AudioProcessorValueTreeState::ParameterChange changes[64];
+
+            auto collectChanges = [&]
+            {
+                for (;;)
+                {
+                    auto numChanges = proc.state.getChangedParameters (changes, numElementsInArray (changes));
+
+                    for (int i = 0; i < numChanges; ++i)
+                        lastValues[(size_t) changes[i].index] = changes[i].value;
+
+                    if (numChanges < numElementsInArray (changes))
+                        return;
+                }
+            };
+
+            while (evenWriter.isThreadRunning() || oddWriter.isThreadRunning())
+                collectChanges();
+
+            collectChanges();
+
+            auto copy = proc.state.copyState();
+            int numWrong = 0;
+
+            for (int i = 0; i < numParams; ++i)
+            {
+                if (lastValues[(size_t) i] != 1.0f)
+                    ++numWrong;
+
+                if ((float) copy.getChildWithProperty ("id", "id" + String (i)).getProperty ("value") != 1.0f)
+                    ++numWrong;
+            }
+
+            expectEquals (numWrong, 0);
+        }
+
         beginTest ("After adding an APVTS::Parameter, its value is the default value");
         {
             TestAudioProcessor proc;
@@ -310,6 +310,41 @@ public:
     /** Removes a callback that was previously added with addParameterCallback(). */
     void removeParameterListener (StringRef parameterID, Listener* listener);
 
+    //==============================================================================
+    /** Describes a change to one of the parameters, as returned by getChangedParameters(). */
+    struct ParameterChange
+    {
+        /** The parameter that changed. */
+        RangedAudioParameter* parameter;
+
+        /** The parameter's index, in the order in which parameters were added to this object. */
+        int index;
+
+        /** The parameter's denormalised value at the time the change was collected. */
+        float value;
+    };
+
+    /** Fills an array with the parameters that have changed since the last time this
+        method was called.
+
+        This is intended to be called once per block from your processBlock() method, as
+        an alternative to attaching listeners or polling every parameter. It doesn't lock
+        or allocate, and its cost only depends on how many parameters have actually
+        changed, so it's suitable for processors with thousands of parameters.
+
+        Each parameter appears at most once, along with its latest value, however many
+        times it was changed. If more than maxNumChanges parameters have changed, the
+        rest will be returned by the next call.
+
+        Only one thread (normally the audio thread) should call this method.
+
+        @returns the number of changes that were written into the array
+    */
+    int getChangedParameters (ParameterChange* changes, int maxNumChanges) noexcept;
+
+    /** Returns the number of parameters that this object is managing. */
+    int getNumParameters() const noexcept;
+
     //==============================================================================
     /** Returns a Value object that can be used to control a particular parameter. */
     Value getParameterAsValue (StringRef parameterID) const;
@@ -521,6 +556,7 @@ private:
 
     //==============================================================================
     class ParameterAdapter;
+    class ChangeQueue;
 
    #if JUCE_UNIT_TESTS
     friend struct ParameterAdapterTests;
@@ -543,7 +579,12 @@ private:
 
     const Identifier valueType { "PARAM" }, valuePropertyID { "value" }, idPropertyID { "id" };
 
+    // These queues hold the indices of changed parameters. They must outlive the adapters,
+    // which push into them from whichever thread the parameter gets changed on.
+    std::unique_ptr<ChangeQueue> audioThreadChanges, messageThreadChanges;
+
     std::map<String, std::unique_ptr<ParameterAdapter>> adapterTable;
+    std::vector<ParameterAdapter*> adaptersByIndex;
 
     CriticalSection valueTreeChanging;
 
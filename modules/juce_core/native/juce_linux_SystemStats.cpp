@@ -152,6 +152,7 @@ void CPUInformation::initialise() noexcept
     hasSSE42           = flags.contains ("sse4_2");
     hasAVX             = flags.contains ("avx");
     hasAVX2            = flags.contains ("avx2");
+    hasFMA3            = flags.containsWholeWord ("fma");
     hasAVX512F         = flags.contains ("avx512f");
     hasAVX512BW        = flags.contains ("avx512bw");
     hasAVX512CD        = flags.contains ("avx512cd");
@@ -65,6 +65,25 @@ namespace SystemStatsHelpers
 
         a = la; b = lb; c = lc; d = ld;
     }
+
+    // Returns the register states that the OS has enabled in XCR0. The AVX instructions
+    // fault unless the OS saves their registers, even if the CPU supports them.
+    static uint64 getEnabledXSaveState (uint32 cpuidFeatureFlags)
+    {
+        if ((cpuidFeatureFlags & (1u << 27)) == 0) // OSXSAVE
+            return 0;
+
+        uint32 lo = 0, hi = 0;
+        asm ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+        return ((uint64) hi << 32) | lo;
+    }
+
+    static bool isSysctlFlagSet (const char* name)
+    {
+        int value = 0;
+        size_t len = sizeof (value);
+        return sysctlbyname (name, &value, &len, nullptr, 0) == 0 && value != 0;
+    }
    #endif
 }
 
@@ -75,6 +94,14 @@ void CPUInformation::initialise() noexcept
     uint32 a = 0, b = 0, d = 0, c = 0;
     SystemStatsHelpers::doCPUID (a, b, c, d, 1);
 
+    // The AVX features need the XMM and YMM state (XCR0 bits 1 and 2) to be enabled. macOS
+    // only enables the AVX-512 state (bits 5, 6 and 7) when a thread first uses it, so for
+    // that the kernel's own flag has to be checked too.
+    auto xsaveState = SystemStatsHelpers::getEnabledXSaveState (c);
+    const bool osSupportsAVX    = (xsaveState & 0x06) == 0x06;
+    const bool osSupportsAVX512 = osSupportsAVX && ((xsaveState & 0xe0) == 0xe0
+                                                      || SystemStatsHelpers::isSysctlFlagSet ("hw.optional.avx512f"));
+
     hasMMX   = (d & (1u << 23)) != 0;
     hasSSE   = (d & (1u << 25)) != 0;
     hasSSE2  = (d & (1u << 26)) != 0;
@@ -83,20 +110,21 @@ void CPUInformation::initialise() noexcept
     hasSSSE3 = (c & (1u <<  9)) != 0;
     hasSSE41 = (c & (1u << 19)) != 0;
     hasSSE42 = (c & (1u << 20)) != 0;
-    hasAVX   = (c & (1u << 28)) != 0;
+    hasAVX   = (c & (1u << 28)) != 0 && osSupportsAVX;
+    hasFMA3  = (c & (1u << 12)) != 0 && osSupportsAVX;
 
     SystemStatsHelpers::doCPUID (a, b, c, d, 7);
-    hasAVX2            = (b & (1u <<  5)) != 0;
-    hasAVX512F         = (b & (1u << 16)) != 0;
-    hasAVX512DQ        = (b & (1u << 17)) != 0;
-    hasAVX512IFMA      = (b & (1u << 21)) != 0;
-    hasAVX512PF        = (b & (1u << 26)) != 0;
-    hasAVX512ER        = (b & (1u << 27)) != 0;
-    hasAVX512CD        = (b & (1u << 28)) != 0;
-    hasAVX512BW        = (b & (1u << 30)) != 0;
-    hasAVX512VL        = (b & (1u << 31)) != 0;
-    hasAVX512VBMI      = (c & (1u <<  1)) != 0;
-    hasAVX512VPOPCNTDQ = (c & (1u << 14)) != 0;
+    hasAVX2            = (b & (1u <<  5)) != 0 && osSupportsAVX;
+    hasAVX512F         = (b & (1u << 16)) != 0 && osSupportsAVX512;
+    hasAVX512DQ        = (b & (1u << 17)) != 0 && osSupportsAVX512;
+    hasAVX512IFMA      = (b & (1u << 21)) != 0 && osSupportsAVX512;
+    hasAVX512PF        = (b & (1u << 26)) != 0 && osSupportsAVX512;
+    hasAVX512ER        = (b & (1u << 27)) != 0 && osSupportsAVX512;
+    hasAVX512CD        = (b & (1u << 28)) != 0 && osSupportsAVX512;
+    hasAVX512BW        = (b & (1u << 30)) != 0 && osSupportsAVX512;
+    hasAVX512VL        = (b & (1u << 31)) != 0 && osSupportsAVX512;
+    hasAVX512VBMI      = (c & (1u <<  1)) != 0 && osSupportsAVX512;
+    hasAVX512VPOPCNTDQ = (c & (1u << 14)) != 0 && osSupportsAVX512;
    #endif
 
     numLogicalCPUs = (int) [[NSProcessInfo processInfo] activeProcessorCount];
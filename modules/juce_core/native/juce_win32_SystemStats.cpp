@@ -63,11 +63,29 @@ static void callCPUID (int result[4], int infoType)
    #if JUCE_PROJUCER_LIVE_BUILD
     std::fill (result, result + 4, 0);
    #else
-    __cpuid (result, infoType);
+    __cpuidex (result, infoType, 0);
    #endif
 }
 #endif
 
+// Returns the register states that the OS has enabled in XCR0. The AVX and AVX-512
+// instructions fault unless the OS saves their registers, even if the CPU supports them.
+static uint64 getEnabledXSaveState (int cpuidFeatureFlags) noexcept
+{
+    if ((cpuidFeatureFlags & (1 << 27)) == 0) // OSXSAVE
+        return 0;
+
+   #if JUCE_MINGW
+    uint32 lo = 0, hi = 0;
+    asm ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+    return ((uint64) hi << 32) | lo;
+   #elif JUCE_PROJUCER_LIVE_BUILD
+    return 0;
+   #else
+    return (uint64) _xgetbv (0);
+   #endif
+}
+
 String SystemStats::getCpuVendor()
 {
     int info[4] = { 0 };
@@ -138,30 +156,37 @@ void CPUInformation::initialise() noexcept
     int info[4] = { 0 };
     callCPUID (info, 1);
 
+    // The AVX features need the XMM and YMM state (XCR0 bits 1 and 2) to be enabled, and
+    // AVX-512 also needs the opmask and ZMM state (bits 5, 6 and 7).
+    auto xsaveState = getEnabledXSaveState (info[2]);
+    const bool osSupportsAVX    = (xsaveState & 0x06) == 0x06;
+    const bool osSupportsAVX512 = (xsaveState & 0xe6) == 0xe6;
+
     // NB: IsProcessorFeaturePresent doesn't work on XP
     hasMMX   = (info[3] & (1 << 23)) != 0;
     hasSSE   = (info[3] & (1 << 25)) != 0;
     hasSSE2  = (info[3] & (1 << 26)) != 0;
     hasSSE3  = (info[2] & (1 <<  0)) != 0;
-    hasAVX   = (info[2] & (1 << 28)) != 0;
+    hasAVX   = (info[2] & (1 << 28)) != 0 && osSupportsAVX;
     hasSSSE3 = (info[2] & (1 <<  9)) != 0;
     hasSSE41 = (info[2] & (1 << 19)) != 0;
     hasSSE42 = (info[2] & (1 << 20)) != 0;
+    hasFMA3  = (info[2] & (1 << 12)) != 0 && osSupportsAVX;
     has3DNow = (info[1] & (1 << 31)) != 0;
 
     callCPUID (info, 7);
 
-    hasAVX2            = (info[1] & (1 << 5))   != 0;
-    hasAVX512F         = (info[1] & (1u << 16)) != 0;
-    hasAVX512DQ        = (info[1] & (1u << 17)) != 0;
-    hasAVX512IFMA      = (info[1] & (1u << 21)) != 0;
-    hasAVX512PF        = (info[1] & (1u << 26)) != 0;
-    hasAVX512ER        = (info[1] & (1u << 27)) != 0;
-    hasAVX512CD        = (info[1] & (1u << 28)) != 0;
-    hasAVX512BW        = (info[1] & (1u << 30)) != 0;
-    hasAVX512VL        = (info[1] & (1u << 31)) != 0;
-    hasAVX512VBMI      = (info[2] & (1u <<  1)) != 0;
-    hasAVX512VPOPCNTDQ = (info[2] & (1u << 14)) != 0;
+    hasAVX2            = (info[1] & (1 << 5))   != 0 && osSupportsAVX;
+    hasAVX512F         = (info[1] & (1u << 16)) != 0 && osSupportsAVX512;
+    hasAVX512DQ        = (info[1] & (1u << 17)) != 0 && osSupportsAVX512;
+    hasAVX512IFMA      = (info[1] & (1u << 21)) != 0 && osSupportsAVX512;
+    hasAVX512PF        = (info[1] & (1u << 26)) != 0 && osSupportsAVX512;
+    hasAVX512ER        = (info[1] & (1u << 27)) != 0 && osSupportsAVX512;
+    hasAVX512CD        = (info[1] & (1u << 28)) != 0 && osSupportsAVX512;
+    hasAVX512BW        = (info[1] & (1u << 30)) != 0 && osSupportsAVX512;
+    hasAVX512VL        = (info[1] & (1u << 31)) != 0 && osSupportsAVX512;
+    hasAVX512VBMI      = (info[2] & (1u <<  1)) != 0 && osSupportsAVX512;
+    hasAVX512VPOPCNTDQ = (info[2] & (1u << 14)) != 0 && osSupportsAVX512;
 
     SYSTEM_INFO systemInfo;
     GetNativeSystemInfo (&systemInfo);
@@ -93,6 +93,7 @@ struct CPUInformation
     bool hasMMX      = false, hasSSE        = false, hasSSE2       = false, hasSSE3 = false,
          has3DNow    = false, hasSSSE3      = false, hasSSE41      = false,
          hasSSE42    = false, hasAVX        = false, hasAVX2       = false,
+         hasFMA3     = false,
          hasAVX512F  = false, hasAVX512BW   = false, hasAVX512CD   = false,
          hasAVX512DQ = false, hasAVX512ER   = false, hasAVX512IFMA = false,
          hasAVX512PF = false, hasAVX512VBMI = false, hasAVX512VL   = false,
@@ -118,6 +119,7 @@ bool SystemStats::hasSSE41() noexcept           { return getCPUInformation().has
 bool SystemStats::hasSSE42() noexcept           { return getCPUInformation().hasSSE42; }
 bool SystemStats::hasAVX() noexcept             { return getCPUInformation().hasAVX; }
 bool SystemStats::hasAVX2() noexcept            { return getCPUInformation().hasAVX2; }
+bool SystemStats::hasFMA3() noexcept            { return getCPUInformation().hasFMA3; }
 bool SystemStats::hasAVX512F() noexcept         { return getCPUInformation().hasAVX512F; }
 bool SystemStats::hasAVX512BW() noexcept        { return getCPUInformation().hasAVX512BW; }
 bool SystemStats::hasAVX512CD() noexcept        { return getCPUInformation().hasAVX512CD; }
@@ -178,6 +178,7 @@ public:
     static bool hasSSE42() noexcept;           /**< Returns true if Intel SSE4.2 instructions are available. */
     static bool hasAVX() noexcept;             /**< Returns true if Intel AVX instructions are available. */
     static bool hasAVX2() noexcept;            /**< Returns true if Intel AVX2 instructions are available. */
+    static bool hasFMA3() noexcept;            /**< Returns true if Intel FMA3 fused multiply-add instructions are available. */
     static bool hasAVX512F() noexcept;         /**< Returns true if Intel AVX-512 Foundation instructions are available. */
     static bool hasAVX512BW() noexcept;        /**< Returns true if Intel AVX-512 Byte and Word instructions are available. */
     static bool hasAVX512CD() noexcept;        /**< Returns true if Intel AVX-512 Conflict Detection instructions are available. */
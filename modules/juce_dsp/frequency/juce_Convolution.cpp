@@ -29,6 +29,243 @@ namespace juce
 namespace dsp
 {
 
+//==============================================================================
+/** A thread which runs the tail partitions of non-uniformly partitioned
+    convolution engines, so that their cost isn't paid on the audio thread.
+
+    The jobs are posted by the audio thread, and each one has a deadline: the
+    moment when its output is going to be needed. If the background thread hasn't
+    started a job by then, the audio thread takes it back and runs it itself. The
+    audio thread never waits for this thread though: if it's in the middle of a
+    job, that job's result is dropped when it's late.
+
+    One of these is shared by all the Convolution objects that use non-uniform
+    partitioning, so however many of them there are, there's only ever one thread.
+*/
+struct ConvolutionBackgroundThread  : private Thread
+{
+    struct Job
+    {
+        Job() = default;
+        virtual ~Job() {}
+
+        virtual void runJob() noexcept = 0;
+
+        /** Gives the calling thread exclusive use of the job, unless another thread
+            has it already, in which case this returns false straight away.
+        */
+        bool tryToClaim() noexcept          { return ! isClaimed.exchange (true, std::memory_order_acquire); }
+        void release() noexcept             { isClaimed.store (false, std::memory_order_release); }
+
+        /** Runs the job on the calling thread, unless another thread is running it. */
+        bool tryToRun() noexcept
+        {
+            if (! tryToClaim())
+                return false;
+
+            runJob();
+            release();
+            return true;
+        }
+
+        /** When this is false, the background thread leaves the job alone. */
+        std::atomic<bool> runsInBackground { true };
+
+        std::atomic<bool> isClaimed { false };
+
+        JUCE_DECLARE_NON_COPYABLE (Job)
+    };
+
+    ConvolutionBackgroundThread()  : Thread ("Convolution Tail")
+    {
+        startThread (9);
+    }
+
+    ~ConvolutionBackgroundThread()
+    {
+        stopThread (2000);
+    }
+
+    /** Registers a job which can be run by this thread. */
+    void addJob (Job& job)
+    {
+        const ScopedLock sl (lock);
+        jobs.addIfNotAlreadyThere (&job);
+    }
+
+    /** Unregisters a job, waiting for this thread to finish it if it's currently
+        running it. This must never be called by the audio thread.
+    */
+    void removeJob (Job& job)
+    {
+        const ScopedLock sl (lock);
+        jobs.removeFirstMatchingValue (&job);
+    }
+
+    /** Called by the audio thread when it has posted some work to a registered job. */
+    void notifyJobPosted() noexcept
+    {
+        notify();
+    }
+
+private:
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            {
+                const ScopedLock sl (lock);
+
+                for (auto* job : jobs)
+                    if (job->runsInBackground.load (std::memory_order_relaxed))
+                        job->tryToRun();
+            }
+
+            wait (-1);
+        }
+    }
+
+    CriticalSection lock;
+    Array<Job*> jobs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionBackgroundThread)
+};
+
+//==============================================================================
+/** A set of spectra stored contiguously in SIMD-aligned memory.
+
+    Each spectrum has room for an in-place real-only FFT, and once prepared for
+    the convolution it uses a split-complex layout: the real parts of the first
+    half of the bins, followed by their imaginary parts, followed by the real part
+    of the Nyquist bin. This lets the complex products be done on whole SIMD
+    registers without any shuffling.
+*/
+struct ConvolutionSpectra
+{
+    void setSize (size_t newNumSpectra, size_t newFFTSize)
+    {
+        numSpectra = newNumSpectra;
+        spectrumSize = newFFTSize * 2;
+
+        data.malloc (numSpectra * spectrumSize + alignmentPadding);
+        clear();
+    }
+
+    void clear() noexcept
+    {
+        FloatVectorOperations::clear (data.get(), static_cast<int> (numSpectra * spectrumSize + alignmentPadding));
+    }
+
+    float* getSpectrum (size_t index) const noexcept
+    {
+        jassert (index < numSpectra);
+
+       #if JUCE_USE_SIMD
+        return SIMDRegister<float>::getNextSIMDAlignedPtr (data.get()) + index * spectrumSize;
+       #else
+        return data.get() + index * spectrumSize;
+       #endif
+    }
+
+    size_t getNumSpectra() const noexcept      { return numSpectra; }
+
+    /** Adds the products of pairs of prepared spectra to the output spectrum.
+
+        All the products are accumulated in registers for a group of bins before
+        being written, so the output is only read and written once whatever the
+        number of pairs. Spectra which aren't SIMD-aligned, or whose halves aren't a
+        whole number of registers, are done with the scalar loop.
+    */
+    static void multiplyAccumulate (float* output, const float* const* inputs, const float* const* impulses,
+                                    size_t numPairs, size_t FFTSize) noexcept
+    {
+        auto FFTSizeDiv2 = FFTSize / 2;
+        size_t i = 0;
+
+       #if JUCE_USE_SIMD
+        using Register = SIMDRegister<float>;
+
+        if (canUseRegisters (output, inputs, impulses, numPairs, FFTSizeDiv2))
+        {
+            for (; i < FFTSizeDiv2; i += Register::size())
+            {
+                auto outputReal = Register::fromRawArray (output + i);
+                auto outputImag = Register::fromRawArray (output + FFTSizeDiv2 + i);
+
+                for (size_t n = 0; n < numPairs; ++n)
+                {
+                    auto inputReal   = Register::fromRawArray (inputs[n] + i);
+                    auto inputImag   = Register::fromRawArray (inputs[n] + FFTSizeDiv2 + i);
+                    auto impulseReal = Register::fromRawArray (impulses[n] + i);
+                    auto impulseImag = Register::fromRawArray (impulses[n] + FFTSizeDiv2 + i);
+
+                    outputReal = Register::multiplyAdd (outputReal, inputReal, impulseReal) - inputImag * impulseImag;
+                    outputImag = Register::multiplyAdd (Register::multiplyAdd (outputImag, inputReal, impulseImag), inputImag, impulseReal);
+                }
+
+                outputReal.copyToRawArray (output + i);
+                outputImag.copyToRawArray (output + FFTSizeDiv2 + i);
+            }
+        }
+       #endif
+
+        for (; i < FFTSizeDiv2; ++i)
+        {
+            for (size_t n = 0; n < numPairs; ++n)
+            {
+                auto inputReal   = inputs[n][i],   inputImag   = inputs[n][FFTSizeDiv2 + i];
+                auto impulseReal = impulses[n][i], impulseImag = impulses[n][FFTSizeDiv2 + i];
+
+                output[i]               += inputReal * impulseReal - inputImag * impulseImag;
+                output[FFTSizeDiv2 + i] += inputReal * impulseImag + inputImag * impulseReal;
+            }
+        }
+
+        for (size_t n = 0; n < numPairs; ++n)
+            output[FFTSize] += inputs[n][FFTSize] * impulses[n][FFTSize];
+    }
+
+private:
+    static constexpr size_t alignmentPadding = 16;
+
+   #if JUCE_USE_SIMD
+    // The spectra from getSpectrum() always pass this when the FFT size is a power of two
+    static bool canUseRegisters (const float* output, const float* const* inputs, const float* const* impulses,
+                                 size_t numPairs, size_t FFTSizeDiv2) noexcept
+    {
+        using Register = SIMDRegister<float>;
+
+        if (FFTSizeDiv2 % Register::size() != 0 || ! Register::isSIMDAligned (output))
+            return false;
+
+        for (size_t n = 0; n < numPairs; ++n)
+            if (! Register::isSIMDAligned (inputs[n]) || ! Register::isSIMDAligned (impulses[n]))
+                return false;
+
+        return true;
+    }
+   #endif
+
+    HeapBlock<float> data;
+    size_t numSpectra = 0, spectrumSize = 0;
+};
+
+//==============================================================================
+/** The impulse response of one channel, cut into partitions which have been
+    transformed to the frequency domain. It is never modified once created, so it
+    can be shared by all the engines using the same impulse response.
+*/
+struct ConvolutionImpulse  : public ReferenceCountedObject
+{
+    using Ptr = ReferenceCountedObjectPtr<ConvolutionImpulse>;
+
+    size_t blockSize = 0, FFTSize = 0;
+    ConvolutionSpectra segments;
+
+    Ptr tail;   // the partitions of the tail of a non-uniform engine, or nullptr
+};
+
+//==============================================================================
 /** This class is the convolution engine itself, processing only one channel at
     a time of input signal.
 */
@@ -36,6 +273,12 @@ struct ConvolutionEngine
 {
     ConvolutionEngine() = default;
 
+    ~ConvolutionEngine()
+    {
+        if (tail != nullptr && backgroundThread != nullptr)
+            backgroundThread->removeJob (*tail);
+    }
+
     //==============================================================================
     struct ProcessingInformation
     {
@@ -67,6 +310,7 @@ struct ConvolutionEngine
 
         double sampleRate = 0;
         size_t maximumBufferSize = 0;
+        int headSize = 0;
     };
 
     //==============================================================================
@@ -75,117 +319,246 @@ struct ConvolutionEngine
         bufferInput.clear();
         bufferOverlap.clear();
         bufferTempOutput.clear();
-
-        for (auto i = 0; i < buffersInputSegments.size(); ++i)
-            buffersInputSegments.getReference (i).clear();
+        buffersInputSegments.clear();
 
         currentSegment = 0;
         inputDataPos = 0;
+
+        if (tailPartitionSize > 0)
+        {
+            tailInput.clear();
+            tailOutput.clear();
+            tailInputPos = 0;
+            tailSlotDue = -1;
+
+            // if the background thread is busy with the tail, it's reset once it has finished
+            if (! tryToResetTail())
+                tailNeedsReset = true;
+        }
     }
 
-    /** Initalize all the states and objects to perform the convolution. */
-    void initializeConvolutionEngine (ProcessingInformation& info, int channel)
+    /** Cuts the impulse response of one channel into partitions and transforms
+        them to the frequency domain.
+
+        When info.headSize is not zero, only the start of the impulse response is
+        processed with zero latency using the block size, and the remaining part is
+        cut into bigger partitions for a second engine, which runs on the
+        background thread if one has been set.
+    */
+    static ConvolutionImpulse::Ptr createImpulse (ProcessingInformation& info, int channel)
     {
-        blockSize = (size_t) nextPowerOfTwo ((int) info.maximumBufferSize);
+        auto* channelData = info.buffer->getReadPointer (channel);
+        auto impulseSize = (size_t) info.finalSize;
+        auto headBlockSize = (size_t) nextPowerOfTwo ((int) info.maximumBufferSize);
 
-        FFTSize = blockSize > 128 ? 2 * blockSize
-                                  : 4 * blockSize;
+        if (info.headSize > 0)
+        {
+            // The tail output of a partition is needed one partition after it has been
+            // received, which is the time left to the background thread to process it
+            auto partitionSize = jmax ((size_t) nextPowerOfTwo (info.headSize) / 2, headBlockSize);
 
-        numSegments = ((size_t) info.finalSize) / (FFTSize - blockSize) + 1u;
+            if (impulseSize > 2 * partitionSize)
+            {
+                auto head = createUniformImpulse (channelData, 2 * partitionSize, headBlockSize);
+                head->tail = createUniformImpulse (channelData + 2 * partitionSize, impulseSize - 2 * partitionSize, partitionSize);
+                return head;
+            }
+        }
 
-        numInputSegments = (blockSize > 128 ? numSegments : 3 * numSegments);
+        return createUniformImpulse (channelData, impulseSize, headBlockSize);
+    }
 
-        FFTobject.reset (new FFT (roundToInt (std::log2 (FFTSize))));
+    /** Cuts an impulse response into partitions of the same size. */
+    static ConvolutionImpulse::Ptr createUniformImpulse (const float* channelData, size_t impulseSize, size_t partitionSize)
+    {
+        ConvolutionImpulse::Ptr newImpulse (new ConvolutionImpulse());
 
-        bufferInput.setSize      (1, static_cast<int> (FFTSize));
-        bufferOutput.setSize     (1, static_cast<int> (FFTSize * 2));
-        bufferTempOutput.setSize (1, static_cast<int> (FFTSize * 2));
-        bufferOverlap.setSize    (1, static_cast<int> (FFTSize));
+        auto fftSize = partitionSize > 128 ? 2 * partitionSize
+                                           : 4 * partitionSize;
 
-        buffersInputSegments.clear();
-        buffersImpulseSegments.clear();
-        bufferOutput.clear();
+        auto numImpulseSegments = impulseSize / (fftSize - partitionSize) + 1u;
 
-        for (size_t i = 0; i < numInputSegments; ++i)
-        {
-            AudioBuffer<float> newInputSegment;
-            newInputSegment.setSize (1, static_cast<int> (FFTSize * 2));
-            buffersInputSegments.add (newInputSegment);
-        }
+        newImpulse->blockSize = partitionSize;
+        newImpulse->FFTSize = fftSize;
+
+        newImpulse->segments.setSize (numImpulseSegments, fftSize);
 
-        for (auto i = 0u; i < numSegments; ++i)
+        FFT FFTTempObject (roundToInt (std::log2 (fftSize)));
+
+        for (size_t n = 0; n < numImpulseSegments; ++n)
         {
-            AudioBuffer<float> newImpulseSegment;
-            newImpulseSegment.setSize (1, static_cast<int> (FFTSize * 2));
-            buffersImpulseSegments.add (newImpulseSegment);
+            auto* impulseResponse = newImpulse->segments.getSpectrum (n);
+
+            if (n == 0)
+                impulseResponse[0] = 1.0f;
+
+            for (size_t i = 0; i < fftSize - partitionSize; ++i)
+                if (i + n * (fftSize - partitionSize) < impulseSize)
+                    impulseResponse[i] = channelData[i + n * (fftSize - partitionSize)];
+
+            FFTTempObject.performRealOnlyForwardTransform (impulseResponse);
+            prepareForConvolution (impulseResponse, fftSize);
         }
 
-        std::unique_ptr<FFT> FFTTempObject (new FFT (roundToInt (std::log2 (FFTSize))));
+        return newImpulse;
+    }
+
+    /** Initalize all the states and objects to perform the convolution. */
+    void initializeConvolutionEngine (ProcessingInformation& info, int channel)
+    {
+        initializeConvolutionEngine (createImpulse (info, channel));
+    }
 
-        auto* channelData = info.buffer->getWritePointer (channel);
+    /** Initalize all the states and objects to perform the convolution with an
+        impulse response which has already been transformed.
+    */
+    void initializeConvolutionEngine (ConvolutionImpulse::Ptr newImpulse)
+    {
+        // the background thread must let go of the tail engine while it's changed
+        if (tail != nullptr && backgroundThread != nullptr)
+            backgroundThread->removeJob (*tail);
+
+        tailPartitionSize = 0;
+        initializeUniformPartitions (newImpulse);
 
-        for (size_t n = 0; n < numSegments; ++n)
+        if (newImpulse->tail != nullptr)
         {
-            buffersImpulseSegments.getReference (static_cast<int> (n)).clear();
+            auto partitionSize = newImpulse->tail->blockSize;
 
-            auto* impulseResponse = buffersImpulseSegments.getReference (static_cast<int> (n)).getWritePointer (0);
+            if (tail == nullptr)
+            {
+                tail.reset (new TailJob());
+                tail->engine.reset (new ConvolutionEngine());
+                tail->runsInBackground = tailRunsInBackground.load();
+            }
 
-            if (n == 0)
-                impulseResponse[0] = 1.0f;
+            tail->engine->initializeUniformPartitions (newImpulse->tail);
+
+            for (auto& slot : tail->slots)
+            {
+                slot.input.setSize  (1, static_cast<int> (partitionSize));
+                slot.output.setSize (1, static_cast<int> (partitionSize));
+            }
 
-            for (size_t i = 0; i < FFTSize - blockSize; ++i)
-                if (i + n * (FFTSize - blockSize) < (size_t) info.finalSize)
-                    impulseResponse[i] = channelData[i + n * (FFTSize - blockSize)];
+            tailInput.setSize   (1, static_cast<int> (partitionSize));
+            tailOutput.setSize  (1, static_cast<int> (partitionSize));
+            tailScratch.setSize (1, static_cast<int> (blockSize));
 
-            FFTTempObject->performRealOnlyForwardTransform (impulseResponse);
-            prepareForConvolution (impulseResponse);
+            tailPartitionSize = partitionSize;
         }
 
         reset();
 
+        if (tail != nullptr && backgroundThread != nullptr)
+            backgroundThread->addJob (*tail);
+
         isReady = true;
     }
 
-    /** Copy the states of another engine. */
-    void copyStateFromOtherEngine (const ConvolutionEngine& other)
+    /** Sets the thread on which the tail partitions of a non-uniform engine are
+        processed. If it's nullptr, they are processed by the audio thread.
+    */
+    void setBackgroundThread (ConvolutionBackgroundThread* newThread)
     {
-        if (FFTSize != other.FFTSize)
+        if (tail != nullptr)
         {
-            FFTobject.reset (new FFT (roundToInt (std::log2 (other.FFTSize))));
-            FFTSize = other.FFTSize;
-        }
+            if (backgroundThread != nullptr)
+                backgroundThread->removeJob (*tail);
 
-        currentSegment      = other.currentSegment;
-        numInputSegments    = other.numInputSegments;
-        numSegments         = other.numSegments;
-        blockSize           = other.blockSize;
-        inputDataPos        = other.inputDataPos;
+            if (newThread != nullptr)
+                newThread->addJob (*tail);
+        }
 
-        bufferInput         = other.bufferInput;
-        bufferTempOutput    = other.bufferTempOutput;
-        bufferOutput        = other.bufferOutput;
+        backgroundThread = newThread;
+    }
 
-        buffersInputSegments    = other.buffersInputSegments;
-        buffersImpulseSegments  = other.buffersImpulseSegments;
-        bufferOverlap           = other.bufferOverlap;
+    /** When this is false, the tail partitions are always processed by the audio
+        thread when their output is needed, so that none of them can be dropped.
+    */
+    void setTailRunsInBackground (bool shouldRunInBackground) noexcept
+    {
+        tailRunsInBackground = shouldRunInBackground;
 
-        isReady = true;
+        if (tail != nullptr)
+            tail->runsInBackground = shouldRunInBackground;
     }
 
-    /** Performs the uniform partitioned convolution using FFT. */
+    /** Performs the partitioned convolution using FFT. */
     void processSamples (const float* input, float* output, size_t numSamples)
     {
+        // the impulse response is still being prepared on the background thread
         if (! isReady)
+        {
+            FloatVectorOperations::clear (output, static_cast<int> (numSamples));
+            return;
+        }
+
+        if (tailPartitionSize == 0)
+        {
+            processHeadSamples (input, output, numSamples);
             return;
+        }
 
+        // The tail is gathered first in a separate buffer, since input and output
+        // might be the same
+        auto maxChunkSize = (size_t) tailScratch.getNumSamples();
+        auto* scratch = tailScratch.getWritePointer (0);
+
+        for (size_t numSamplesProcessed = 0; numSamplesProcessed < numSamples;)
+        {
+            auto numSamplesToProcess = jmin (numSamples - numSamplesProcessed, maxChunkSize);
+
+            processTailSamples (input + numSamplesProcessed, scratch, numSamplesToProcess);
+            processHeadSamples (input + numSamplesProcessed, output + numSamplesProcessed, numSamplesToProcess);
+            FloatVectorOperations::add (output + numSamplesProcessed, scratch, static_cast<int> (numSamplesToProcess));
+
+            numSamplesProcessed += numSamplesToProcess;
+        }
+    }
+
+    //==============================================================================
+    /** Prepares the uniform partitioned convolution of the given impulse response. */
+    void initializeUniformPartitions (ConvolutionImpulse::Ptr newImpulse)
+    {
+        impulse = newImpulse;
+
+        blockSize = impulse->blockSize;
+        FFTSize = impulse->FFTSize;
+        numSegments = impulse->segments.getNumSpectra();
+
+        numInputSegments = (blockSize > 128 ? numSegments : 3 * numSegments);
+
+        FFTobject.reset (new FFT (roundToInt (std::log2 (FFTSize))));
+
+        bufferInput.setSize      (1, static_cast<int> (FFTSize));
+        bufferOverlap.setSize    (1, static_cast<int> (FFTSize));
+
+        bufferOutput.setSize (1, FFTSize);
+        bufferTempOutput.setSize (1, FFTSize);
+        buffersInputSegments.setSize (numInputSegments, FFTSize);
+
+        inputSegmentPointers.malloc (numSegments);
+        impulseSegmentPointers.malloc (numSegments);
+
+        for (size_t i = 0; i < numSegments; ++i)
+            impulseSegmentPointers[i] = impulse->segments.getSpectrum (i);
+
+        reset();
+
+        isReady = true;
+    }
+
+    /** Performs the uniform partitioned convolution using FFT. */
+    void processHeadSamples (const float* input, float* output, size_t numSamples)
+    {
         // Overlap-add, zero latency convolution algorithm with uniform partitioning
         size_t numSamplesProcessed = 0;
 
         auto indexStep = numInputSegments / numSegments;
 
         auto* inputData      = bufferInput.getWritePointer (0);
-        auto* outputTempData = bufferTempOutput.getWritePointer (0);
-        auto* outputData     = bufferOutput.getWritePointer (0);
+        auto* outputTempData = bufferTempOutput.getSpectrum (0);
+        auto* outputData     = bufferOutput.getSpectrum (0);
         auto* overlapData    = bufferOverlap.getWritePointer (0);
 
         while (numSamplesProcessed < numSamples)
@@ -196,12 +569,12 @@ struct ConvolutionEngine
             // copy the input samples
             FloatVectorOperations::copy (inputData + inputDataPos, input + numSamplesProcessed, static_cast<int> (numSamplesToProcess));
 
-            auto* inputSegmentData = buffersInputSegments.getReference (static_cast<int> (currentSegment)).getWritePointer (0);
+            auto* inputSegmentData = buffersInputSegments.getSpectrum (currentSegment);
             FloatVectorOperations::copy (inputSegmentData, inputData, static_cast<int> (FFTSize));
 
             // Forward FFT
             FFTobject->performRealOnlyForwardTransform (inputSegmentData);
-            prepareForConvolution (inputSegmentData);
+            prepareForConvolution (inputSegmentData, FFTSize);
 
             // Complex multiplication
             if (inputDataWasEmpty)
@@ -217,17 +590,17 @@ struct ConvolutionEngine
                     if (index >= numInputSegments)
                         index -= numInputSegments;
 
-                    convolutionProcessingAndAccumulate (buffersInputSegments.getReference (static_cast<int> (index)).getWritePointer (0),
-                                                        buffersImpulseSegments.getReference (static_cast<int> (i)).getWritePointer (0),
-                                                        outputTempData);
+                    inputSegmentPointers[i] = buffersInputSegments.getSpectrum (index);
                 }
+
+                ConvolutionSpectra::multiplyAccumulate (outputTempData, inputSegmentPointers + 1, impulseSegmentPointers + 1,
+                                                        numSegments - 1, FFTSize);
             }
 
             FloatVectorOperations::copy (outputData, outputTempData, static_cast<int> (FFTSize + 1));
 
-            convolutionProcessingAndAccumulate (buffersInputSegments.getReference (static_cast<int> (currentSegment)).getWritePointer (0),
-                                                buffersImpulseSegments.getReference (0).getWritePointer (0),
-                                                outputData);
+            inputSegmentPointers[0] = inputSegmentData;
+            ConvolutionSpectra::multiplyAccumulate (outputData, inputSegmentPointers, impulseSegmentPointers, 1, FFTSize);
 
             // Inverse FFT
             updateSymmetricFrequencyDomainData (outputData);
@@ -261,32 +634,131 @@ struct ConvolutionEngine
         }
     }
 
-    /** After each FFT, this function is called to allow convolution to be performed with only 4 SIMD functions calls. */
-    void prepareForConvolution (float *samples) noexcept
+    /** Gathers the input of the tail engine, and returns its output delayed by the
+        size of the head. Each full partition of input is posted to the tail job,
+        whose result is collected one partition later.
+    */
+    void processTailSamples (const float* input, float* output, size_t numSamples)
     {
-        auto FFTSizeDiv2 = FFTSize / 2;
+        auto* inputData  = tailInput.getWritePointer (0);
+        auto* outputData = tailOutput.getWritePointer (0);
 
-        for (size_t i = 0; i < FFTSizeDiv2; i++)
-            samples[i] = samples[2 * i];
+        for (size_t numSamplesProcessed = 0; numSamplesProcessed < numSamples;)
+        {
+            auto numSamplesToProcess = jmin (numSamples - numSamplesProcessed, tailPartitionSize - tailInputPos);
 
-        samples[FFTSizeDiv2] = 0;
+            FloatVectorOperations::copy (inputData + tailInputPos, input + numSamplesProcessed, static_cast<int> (numSamplesToProcess));
+            FloatVectorOperations::copy (output + numSamplesProcessed, outputData + tailInputPos, static_cast<int> (numSamplesToProcess));
 
-        for (size_t i = 1; i < FFTSizeDiv2; i++)
-            samples[i + FFTSizeDiv2] = -samples[2 * (FFTSize - i) + 1];
+            tailInputPos += numSamplesToProcess;
+            numSamplesProcessed += numSamplesToProcess;
+
+            if (tailInputPos == tailPartitionSize)
+            {
+                tailInputPos = 0;
+                collectTailOutput();
+                postTailInput();
+            }
+        }
     }
 
-    /** Does the convolution operation itself only on half of the frequency domain samples. */
-    void convolutionProcessingAndAccumulate (const float *input, const float *impulse, float *output)
+    /** Called at the deadline of the partition posted one partition earlier. If no
+        other thread has started it, it's run here, but if the background thread is in
+        the middle of it, its output is dropped rather than waited for, and the late
+        result is thrown away when it arrives.
+    */
+    void collectTailOutput() noexcept
     {
-        auto FFTSizeDiv2 = FFTSize / 2;
+        auto hasOutput = false;
+
+        if (tailSlotDue >= 0)
+        {
+            auto& slot = tail->slots[tailSlotDue];
+
+            if (slot.state.load (std::memory_order_acquire) != TailJob::slotDone)
+                tail->tryToRun();
+
+            if (slot.state.load (std::memory_order_acquire) == TailJob::slotDone)
+            {
+                tailOutput.copyFrom (0, 0, slot.output, 0, 0, static_cast<int> (tailPartitionSize));
+                hasOutput = true;
+            }
+            else
+            {
+                ++numDroppedTailPartitions;
+            }
+
+            tailSlotDue = -1;
+        }
 
-        FloatVectorOperations::addWithMultiply      (output, input, impulse, static_cast<int> (FFTSizeDiv2));
-        FloatVectorOperations::subtractWithMultiply (output, &(input[FFTSizeDiv2]), &(impulse[FFTSizeDiv2]), static_cast<int> (FFTSizeDiv2));
+        if (! hasOutput)
+            tailOutput.clear();
 
-        FloatVectorOperations::addWithMultiply      (&(output[FFTSizeDiv2]), input, &(impulse[FFTSizeDiv2]), static_cast<int> (FFTSizeDiv2));
-        FloatVectorOperations::addWithMultiply      (&(output[FFTSizeDiv2]), &(input[FFTSizeDiv2]), impulse, static_cast<int> (FFTSizeDiv2));
+        for (auto& slot : tail->slots)
+            if (slot.state.load (std::memory_order_acquire) == TailJob::slotDone)
+                slot.state.store (TailJob::slotFree, std::memory_order_release);
+    }
 
-        output[FFTSize] += input[FFTSize] * impulse[FFTSize];
+    /** Hands the partition of input which has just been gathered to the tail job. */
+    void postTailInput() noexcept
+    {
+        if (tailNeedsReset && ! tryToResetTail())
+            return;
+
+        auto& slot = tail->slots[nextTailSlotToPost];
+
+        if (slot.state.load (std::memory_order_acquire) != TailJob::slotFree)
+        {
+            // The job is so far behind that this partition can't be queued, and leaving
+            // it out would put the tail engine out of step, so it starts again from
+            // silence as soon as it's free.
+            tailNeedsReset = true;
+            return;
+        }
+
+        slot.input.copyFrom (0, 0, tailInput, 0, 0, static_cast<int> (tailPartitionSize));
+        slot.state.store (TailJob::slotPosted, std::memory_order_release);
+
+        tailSlotDue = nextTailSlotToPost;
+        nextTailSlotToPost = (nextTailSlotToPost + 1) % TailJob::numSlots;
+
+        if (backgroundThread != nullptr && tailRunsInBackground.load (std::memory_order_relaxed))
+            backgroundThread->notifyJobPosted();
+    }
+
+    /** Clears the tail engine and the partitions queued for it, unless another
+        thread is running the job.
+    */
+    bool tryToResetTail() noexcept
+    {
+        if (! tail->tryToClaim())
+            return false;
+
+        for (auto& slot : tail->slots)
+            slot.state.store (TailJob::slotFree, std::memory_order_relaxed);
+
+        tail->nextSlotToRun = 0;
+        tail->engine->reset();
+        tail->release();
+
+        nextTailSlotToPost = 0;
+        tailSlotDue = -1;
+        tailNeedsReset = false;
+        return true;
+    }
+
+    /** After each FFT, this function is called to allow convolution to be performed with only 4 SIMD functions calls. */
+    static void prepareForConvolution (float *samples, size_t size) noexcept
+    {
+        auto FFTSizeDiv2 = size / 2;
+
+        for (size_t i = 0; i < FFTSizeDiv2; i++)
+            samples[i] = samples[2 * i];
+
+        samples[FFTSizeDiv2] = 0;
+
+        for (size_t i = 1; i < FFTSizeDiv2; i++)
+            samples[i + FFTSizeDiv2] = -samples[2 * (size - i) + 1];
     }
 
     /** Undo the re-organization of samples from the function prepareForConvolution.
@@ -318,17 +790,126 @@ struct ConvolutionEngine
     size_t FFTSize = 0;
     size_t currentSegment = 0, numInputSegments = 0, numSegments = 0, blockSize = 0, inputDataPos = 0;
 
-    AudioBuffer<float> bufferInput, bufferOutput, bufferTempOutput, bufferOverlap;
-    Array<AudioBuffer<float>> buffersInputSegments, buffersImpulseSegments;
+    AudioBuffer<float> bufferInput, bufferOverlap;
+    ConvolutionSpectra bufferOutput, bufferTempOutput, buffersInputSegments;
+    HeapBlock<const float*> inputSegmentPointers, impulseSegmentPointers;
+    ConvolutionImpulse::Ptr impulse;
 
     bool isReady = false;
 
+    //==============================================================================
+    /** Processes the partitions of the tail in the order they were posted. Each one
+        has its own slot, whose buffers belong to the audio thread while it's free, and
+        to the thread running the job from the moment it's posted until it's done.
+    */
+    struct TailJob  : public ConvolutionBackgroundThread::Job
+    {
+        void runJob() noexcept override
+        {
+            for (;;)
+            {
+                auto& slot = slots[nextSlotToRun];
+
+                if (slot.state.load (std::memory_order_acquire) != slotPosted)
+                    return;
+
+                engine->processSamples (slot.input.getReadPointer (0), slot.output.getWritePointer (0), (size_t) slot.input.getNumSamples());
+                slot.state.store (slotDone, std::memory_order_release);
+
+                nextSlotToRun = (nextSlotToRun + 1) % numSlots;
+            }
+        }
+
+        enum { slotFree = 0, slotPosted, slotDone };
+        enum { numSlots = 3 };
+
+        struct Slot
+        {
+            AudioBuffer<float> input, output;
+            std::atomic<int> state { slotFree };
+        };
+
+        std::unique_ptr<ConvolutionEngine> engine;
+        Slot slots[numSlots];
+        int nextSlotToRun = 0;      // only used by the thread which has claimed the job
+    };
+
+    std::unique_ptr<TailJob> tail;
+    ConvolutionBackgroundThread* backgroundThread = nullptr;
+    std::atomic<bool> tailRunsInBackground { true };
+
+    size_t tailPartitionSize = 0, tailInputPos = 0;
+    AudioBuffer<float> tailInput, tailOutput, tailScratch;
+    int nextTailSlotToPost = 0, tailSlotDue = -1;
+    bool tailNeedsReset = false;
+    int numDroppedTailPartitions = 0;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ConvolutionEngine)
 };
 
 
 
+//==============================================================================
+/** Keeps the transformed impulse responses loaded by all the Convolution objects,
+    so that when the same impulse response is loaded several times with the same
+    settings, it's only loaded, resampled and transformed once, and all the
+    engines share the same partitions in memory.
+*/
+struct ConvolutionImpulseCache
+{
+    /** The transformed channels of an impulse response. */
+    struct Entry  : public ReferenceCountedObject
+    {
+        using Ptr = ReferenceCountedObjectPtr<Entry>;
+
+        bool matches (const String& otherKey, const MemoryBlock& otherSourceData) const noexcept
+        {
+            return key == otherKey && sourceData == otherSourceData;
+        }
+
+        String key;
+        MemoryBlock sourceData;  // a copy of the impulse response, if it was loaded from memory
+        ConvolutionImpulse::Ptr channels[2];
+    };
+
+    /** Returns the entry with the given key and source data, or nullptr. */
+    Entry::Ptr find (const String& key, const MemoryBlock& sourceData) const
+    {
+        const ScopedLock sl (lock);
+
+        for (auto* entry : entries)
+            if (entry->matches (key, sourceData))
+                return entry;
+
+        return {};
+    }
+
+    /** Adds a new entry, and returns the one which must be used, which might have
+        been added by another Convolution object in the meantime.
+    */
+    Entry::Ptr add (Entry::Ptr newEntry)
+    {
+        const ScopedLock sl (lock);
+
+        // removes the entries which aren't used by any Convolution object anymore
+        for (auto i = entries.size(); --i >= 0;)
+            if (entries.getObjectPointerUnchecked (i)->getReferenceCount() == 1)
+                entries.remove (i);
+
+        for (auto* entry : entries)
+            if (entry->matches (newEntry->key, newEntry->sourceData))
+                return entry;
+
+        entries.add (newEntry);
+        return newEntry;
+    }
+
+private:
+    CriticalSection lock;
+    ReferenceCountedArray<Entry> entries;
+};
+
 //==============================================================================
 /** Manages all the changes requested by the main convolution engine, to minimize
     the number of calls of the convolution engine initialization, and the potential
@@ -353,7 +934,7 @@ struct Convolution::Pimpl  : private Thread
     using SourceType = ConvolutionEngine::ProcessingInformation::SourceType;
 
     //==============================================================================
-    Pimpl()  : Thread ("Convolution"), abstractFifo (fifoSize)
+    Pimpl (int headSize = 0)  : Thread ("Convolution"), abstractFifo (fifoSize)
     {
         abstractFifo.reset();
         fifoRequestsType.resize (fifoSize);
@@ -367,10 +948,17 @@ struct Convolution::Pimpl  : private Thread
 
         currentInfo.maximumBufferSize = 0;
         currentInfo.buffer = &impulseResponse;
+        currentInfo.headSize = headSize;
+
+        if (headSize > 0)
+        {
+            backgroundThread.reset (new SharedResourcePointer<ConvolutionBackgroundThread>());
+
+            for (auto* e : engines)
+                e->setBackgroundThread (*backgroundThread);
+        }
 
         temporaryBuffer.setSize (2, static_cast<int> (maximumTimeInSamples), false, false, true);
-        impulseResponseOriginal.setSize (2, static_cast<int> (maximumTimeInSamples), false, false, true);
-        impulseResponse.setSize (2, static_cast<int> (maximumTimeInSamples), false, false, true);
     }
 
     ~Pimpl()
@@ -382,7 +970,13 @@ struct Convolution::Pimpl  : private Thread
     /** Inits the size of the interpolation buffer. */
     void initProcessing (int maximumBufferSize)
     {
-        stopThread (1000);
+        if (isThreadRunning())
+        {
+            stopThread (1000);
+
+            // the change which has been interrupted must be done again
+            addToFifo (ChangeRequest::changeEngine, juce::var (0));
+        }
 
         interpolationBuffer.setSize (1, maximumBufferSize, false, false, true);
         mustInterpolate = false;
@@ -481,6 +1075,16 @@ struct Convolution::Pimpl  : private Thread
     */
     void processFifo()
     {
+        // After a change of sample rate, block size or engine, the background thread
+        // prepares new engines which replace the old ones straight away
+        if (mustSwapEngines.exchange (false))
+        {
+            for (auto channel = 0; channel < 2; ++channel)
+                engines.swap (channel, channel + 2);
+
+            mustInterpolate = false;
+        }
+
         if (getNumRemainingEntries() == 0 || isThreadRunning() || mustInterpolate)
             return;
 
@@ -675,17 +1279,9 @@ struct Convolution::Pimpl  : private Thread
             copyBufferToTemporaryLocation (newBuffer);
         }
 
-        // action depending on the change level
-        if (changeLevel == 3)
-        {
-            loadImpulseResponse();
-            processImpulseResponse();
-            initializeConvolutionEngines();
-        }
-        else if (changeLevel > 0)
-        {
+        // the impulse response is looked up in the cache, or loaded, on the background thread
+        if (changeLevel > 0)
             startThread();
-        }
     }
 
     //==============================================================================
@@ -707,14 +1303,23 @@ struct Convolution::Pimpl  : private Thread
     /** Resets the convolution engines states. */
     void reset()
     {
-        for (auto* e : engines)
-            e->reset();
+        // the background thread might still be preparing the engines 2-3
+        auto numEnginesToReset = isThreadRunning() ? 2 : engines.size();
+
+        for (auto i = 0; i < numEnginesToReset; ++i)
+            engines[i]->reset();
 
         mustInterpolate = false;
 
         processFifo();
     }
 
+    /** Makes the audio thread process the tails of the engines itself, when rendering offline. */
+    void setNonRealtime (bool shouldBeNonRealtime) noexcept
+    {
+        isNonRealtime = shouldBeNonRealtime;
+    }
+
     /** Convolution processing handling interpolation between previous and new states
         of the convolution engines.
     */
@@ -722,6 +1327,16 @@ struct Convolution::Pimpl  : private Thread
     {
         processFifo();
 
+        auto shouldRunTailsInBackground = ! isNonRealtime.load();
+
+        if (shouldRunTailsInBackground != tailsRunInBackground)
+        {
+            tailsRunInBackground = shouldRunTailsInBackground;
+
+            for (auto* e : engines)
+                e->setTailRunsInBackground (shouldRunTailsInBackground);
+        }
+
         size_t numChannels = jmin (input.getNumChannels(), (size_t) (currentInfo.wantsStereo ? 2 : 1));
         size_t numSamples  = jmin (input.getNumSamples(), output.getNumSamples());
 
@@ -763,7 +1378,7 @@ struct Convolution::Pimpl  : private Thread
                 mustInterpolate = false;
 
                 for (auto channel = 0; channel < 2; ++channel)
-                    engines[channel]->copyStateFromOtherEngine (*engines[channel + 2]);
+                    engines.swap (channel, channel + 2);
             }
         }
 
@@ -781,20 +1396,115 @@ private:
     */
     void run() override
     {
-        if (changeLevel == 2)
+        if (prepareImpulseResponse())
+            initializeConvolutionEngines();
+    }
+
+    /** Gets the transformed impulse response matching the current settings, from
+        the cache if it has already been loaded by any Convolution object, or by
+        loading, processing and transforming it otherwise.
+
+        Returns false if the thread has been asked to stop in the meantime.
+    */
+    bool prepareImpulseResponse()
+    {
+        MemoryBlock sourceData;
+        auto key = getImpulseCacheKey (sourceData);
+
+        if (auto entry = impulseCache->find (key, sourceData))
+        {
+            currentImpulse = entry;
+
+            if (changeLevel >= 2)
+                isOriginalLoaded = false;
+
+            return true;
+        }
+
+        if (impulseResponse.getNumSamples() == 0)
+        {
+            impulseResponseOriginal.setSize (2, static_cast<int> (maximumTimeInSamples), false, false, true);
+            impulseResponse.setSize (2, static_cast<int> (maximumTimeInSamples), false, false, true);
+        }
+
+        if (changeLevel >= 2 || ! isOriginalLoaded)
         {
             loadImpulseResponse();
+            isOriginalLoaded = true;
 
             if (isThreadRunning() && threadShouldExit())
-                return;
+                return false;
         }
 
         processImpulseResponse();
 
-        if (isThreadRunning() && threadShouldExit())
-            return;
+        if ((isThreadRunning() && threadShouldExit()) || currentInfo.maximumBufferSize == 0)
+            return false;
+
+        ConvolutionImpulseCache::Entry::Ptr entry (new ConvolutionImpulseCache::Entry());
+        entry->key = key;
+        entry->sourceData = std::move (sourceData);
+        entry->channels[0] = ConvolutionEngine::createImpulse (currentInfo, 0);
+        entry->channels[1] = currentInfo.originalNumChannels > 1 ? ConvolutionEngine::createImpulse (currentInfo, 1)
+                                                                 : entry->channels[0];
 
-        initializeConvolutionEngines();
+        currentImpulse = impulseCache->add (entry);
+        return true;
+    }
+
+    /** Returns a string identifying the impulse response source and all the
+        settings which have an effect on its transformed partitions.
+
+        An impulse response which is loaded from memory is only identified by a hash
+        of its content in the key, so a copy of that content is also returned in
+        sourceData, and the cache compares it too before reusing an entry.
+    */
+    String getImpulseCacheKey (MemoryBlock& sourceData)
+    {
+        String key;
+
+        if (currentInfo.sourceType == SourceType::sourceBinaryData)
+        {
+            sourceData.replaceWith (currentInfo.sourceData, currentInfo.sourceDataSize);
+            key << "data " << getHashString (sourceData) << " " << currentInfo.sourceDataSize;
+        }
+        else if (currentInfo.sourceType == SourceType::sourceAudioFile)
+        {
+            key << "file " << currentInfo.fileImpulseResponse.getFullPathName()
+                << " " << currentInfo.fileImpulseResponse.getLastModificationTime().toMilliseconds()
+                << " " << currentInfo.fileImpulseResponse.getSize();
+        }
+        else
+        {
+            {
+                const SpinLock::ScopedLockType sl (processLock);
+
+                for (auto channel = 0; channel < currentInfo.originalNumChannels; ++channel)
+                    sourceData.append (temporaryBuffer.getReadPointer (channel),
+                                       sizeof (float) * (size_t) currentInfo.originalSize);
+            }
+
+            key << "buffer " << getHashString (sourceData)
+                << " " << currentInfo.originalSize << " " << currentInfo.originalNumChannels
+                << " " << currentInfo.originalSampleRate;
+        }
+
+        key << " " << currentInfo.wantedSize << " " << (int) currentInfo.wantsTrimming << " " << (int) currentInfo.wantsNormalisation
+            << " " << currentInfo.sampleRate << " " << (int) currentInfo.maximumBufferSize << " " << currentInfo.headSize;
+
+        return key;
+    }
+
+    /** Returns the FNV-1a hash of a block of data, as a string. */
+    static String getHashString (const MemoryBlock& data)
+    {
+        auto hash = (uint64) 14695981039346656037ull;
+        auto* bytes = static_cast<const uint8*> (data.getData());
+
+        for (size_t i = 0; i < data.getSize(); ++i)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+
+        return String::toHexString ((int64) hash);
     }
 
     /** Loads the impulse response from the requested audio source. */
@@ -983,27 +1693,24 @@ private:
     */
     void initializeConvolutionEngines()
     {
-        if (currentInfo.maximumBufferSize == 0)
+        if (currentInfo.maximumBufferSize == 0 || currentImpulse == nullptr)
             return;
 
-        if (changeLevel == 3)
+        for (auto i = 0; i < 2; ++i)
         {
-            for (auto i = 0; i < 2; ++i)
-                engines[i]->initializeConvolutionEngine (currentInfo, i);
+            engines[i + 2]->initializeConvolutionEngine (currentImpulse->channels[i]);
+            engines[i + 2]->reset();
 
-            mustInterpolate = false;
+            if (isThreadRunning() && threadShouldExit())
+                return;
+        }
+
+        if (changeLevel == 3)
+        {
+            mustSwapEngines = true;
         }
         else
         {
-            for (auto i = 0; i < 2; ++i)
-            {
-                engines[i + 2]->initializeConvolutionEngine (currentInfo, i);
-                engines[i + 2]->reset();
-
-                if (isThreadRunning() && threadShouldExit())
-                    return;
-            }
-
             for (auto i = 0; i < 2; ++i)
             {
                 changeVolumes[i].setTargetValue (1.0f);
@@ -1041,14 +1748,23 @@ private:
 
     AudioBuffer<float> impulseResponseOriginal;     // a buffer with the original impulse response
     AudioBuffer<float> impulseResponse;             // a buffer with the impulse response trimmed, resampled, resized and normalised
+    bool isOriginalLoaded = false;                  // tells if impulseResponseOriginal contains the current source, which isn't loaded when it's found in the cache
+
+    SharedResourcePointer<ConvolutionImpulseCache> impulseCache;  // the impulse responses shared by all the Convolution objects
+    ConvolutionImpulseCache::Entry::Ptr currentImpulse;           // the impulse response used by the latest engines
 
     //==============================================================================
+    std::unique_ptr<SharedResourcePointer<ConvolutionBackgroundThread>> backgroundThread;  // processes the tails of all the non-uniform convolution engines
     OwnedArray<ConvolutionEngine> engines;          // the 4 convolution engines being used
 
     AudioBuffer<float> interpolationBuffer;         // a buffer to do the interpolation between the convolution engines 0-1 and 2-3
     LogRampedValue<float> changeVolumes[4];         // the volumes for each convolution engine during interpolation
 
     bool mustInterpolate = false;                   // tells if the convolution engines outputs must be currently interpolated
+    std::atomic<bool> mustSwapEngines { false };    // set when the engines 2-3 must replace the engines 0-1 without any interpolation
+
+    std::atomic<bool> isNonRealtime { false };      // set when rendering offline, so that no part of the tails is dropped
+    bool tailsRunInBackground = true;               // the last value given to the engines
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Pimpl)
@@ -1062,6 +1778,12 @@ Convolution::Convolution()
     pimpl->addToFifo (Convolution::Pimpl::ChangeRequest::changeEngine, juce::var (0));
 }
 
+Convolution::Convolution (const NonUniform& nonUniform)
+{
+    pimpl.reset (new Pimpl (jmax (0, nonUniform.headSizeInSamples)));
+    pimpl->addToFifo (Convolution::Pimpl::ChangeRequest::changeEngine, juce::var (0));
+}
+
 Convolution::~Convolution()
 {
 }
@@ -1191,6 +1913,11 @@ void Convolution::prepare (const ProcessSpec& spec)
     isActive = true;
 }
 
+void Convolution::setNonRealtime (bool isNonRealtime) noexcept
+{
+    pimpl->setNonRealtime (isNonRealtime);
+}
+
 void Convolution::reset() noexcept
 {
     dryBuffer.clear();
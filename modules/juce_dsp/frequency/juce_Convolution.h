@@ -31,7 +31,8 @@ namespace dsp
 
 /**
     Performs stereo uniform-partitioned convolution of an input signal with an
-    impulse response in the frequency domain, using the juce FFT class.
+    impulse response in the frequency domain, using the juce FFT class. A
+    non-uniform partitioning can be requested as well, see NonUniform.
 
     It provides some thread-safe functions to load impulse responses as well,
     from audio files or memory on the fly without any noticeable artefacts,
@@ -54,6 +55,34 @@ public:
     /** Initialises an object for performing convolution in the frequency domain. */
     Convolution();
 
+    /** Contains the configuration of a convolution using non-uniform partitioning.
+
+        The first part of the impulse response, the head, is processed with zero
+        latency using partitions of the size of the audio blocks. The rest of it is
+        processed with partitions of half the head size, on a background thread,
+        which is a lot more efficient for long impulse responses. There's only one
+        of these threads, which is shared by all the Convolution objects that use
+        non-uniform partitioning. If it hasn't got round to an object's tail by the
+        time the output is needed, the audio thread processes it instead. The audio
+        thread never waits for it though, so if it's still in the middle of a
+        partition by then, that partition is left out of the output. Use
+        setNonRealtime() when rendering faster than real time.
+
+        The head size is rounded up to a power of two, and a value of zero means that
+        the whole impulse response is processed with uniform partitioning.
+    */
+    struct NonUniform
+    {
+        int headSizeInSamples = 0;
+    };
+
+    /** Initialises an object for performing convolution in the frequency domain,
+        using non-uniform partitioning. The processing still has zero latency.
+
+        @see NonUniform
+    */
+    explicit Convolution (const NonUniform&);
+
     /** Destructor. */
     ~Convolution();
 
@@ -67,6 +96,16 @@ public:
     /** Resets the processing pipeline, ready to start a new stream of data. */
     void reset() noexcept;
 
+    /** Tells the convolution whether it's being used for offline rendering.
+
+        With non-uniform partitioning, the tail is then always processed by the
+        thread calling process(), so that none of it can be left out when the
+        blocks come faster than the background thread can keep up with.
+
+        @see NonUniform
+    */
+    void setNonRealtime (bool isNonRealtime) noexcept;
+
     /** Performs the filter operation on the given set of samples, with optional
         stereo processing.
     */
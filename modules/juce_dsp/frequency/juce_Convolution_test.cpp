@@ -0,0 +1,454 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+namespace dsp
+{
+
+struct ConvolutionEngineTest  : public UnitTest
+{
+    ConvolutionEngineTest()  : UnitTest ("Convolution engine", "DSP") {}
+
+    static void fillRandom (Random& random, float* buffer, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            buffer[i] = (2.0f * random.nextFloat()) - 1.0f;
+    }
+
+    static void performReferenceConvolution (const float* input, const float* impulse,
+                                             float* output, int numSamples, int impulseSize)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double sum = 0.0;
+
+            for (int j = 0; j < jmin (i + 1, impulseSize); ++j)
+                sum += (double) input[i - j] * (double) impulse[j];
+
+            output[i] = (float) sum;
+        }
+    }
+
+    // Checks the spectrum multiply-accumulate against a scalar reference. When the pointers are
+    // misaligned or the half-spectra aren't a whole number of registers, it has to fall back
+    // to the scalar loop rather than loading the registers from misaligned memory.
+    void runMultiplyAccumulateTest (Random& random, size_t FFTSize, size_t numPairs, bool misaligned)
+    {
+        const auto FFTSizeDiv2 = FFTSize / 2;
+        const auto spectrumSize = FFTSize + 1;
+        const auto stride = spectrumSize + 16;
+
+        HeapBlock<float> memory ((2 * numPairs + 1) * stride + 32);
+        auto* base = SIMDRegister<float>::getNextSIMDAlignedPtr (memory.get());
+
+        auto getSpectrum = [&] (size_t index)
+        {
+            auto* spectrum = base + index * stride;
+            return misaligned ? spectrum + 1 + (size_t) random.nextInt (3) : spectrum;
+        };
+
+        HeapBlock<const float*> inputs (numPairs), impulses (numPairs);
+        auto* output = getSpectrum (2 * numPairs);
+        fillRandom (random, output, spectrumSize);
+
+        for (size_t n = 0; n < numPairs; ++n)
+        {
+            auto* input   = getSpectrum (2 * n);
+            auto* impulse = getSpectrum (2 * n + 1);
+            fillRandom (random, input, spectrumSize);
+            fillRandom (random, impulse, spectrumSize);
+            inputs[n] = input;
+            impulses[n] = impulse;
+        }
+
+        HeapBlock<double> expected (spectrumSize);
+
+        for (size_t i = 0; i < spectrumSize; ++i)
+            expected[i] = output[i];
+
+        for (size_t n = 0; n < numPairs; ++n)
+        {
+            for (size_t i = 0; i < FFTSizeDiv2; ++i)
+            {
+                double inputReal   = inputs[n][i],   inputImag   = inputs[n][FFTSizeDiv2 + i];
+                double impulseReal = impulses[n][i], impulseImag = impulses[n][FFTSizeDiv2 + i];
+
+                expected[i]               += inputReal * impulseReal - inputImag * impulseImag;
+                expected[FFTSizeDiv2 + i] += inputReal * impulseImag + inputImag * impulseReal;
+            }
+
+            expected[FFTSize] += (double) inputs[n][FFTSize] * (double) impulses[n][FFTSize];
+        }
+
+        ConvolutionSpectra::multiplyAccumulate (output, inputs, impulses, numPairs, FFTSize);
+
+        double maxError = 0.0;
+
+        for (size_t i = 0; i < spectrumSize; ++i)
+            maxError = jmax (maxError, std::abs (output[i] - expected[i]));
+
+        expect (maxError < 1e-5 * (double) numPairs,
+                "FFT size " + String (FFTSize) + ", " + String (numPairs) + " pairs, maximum error " + String (maxError));
+    }
+
+    // Gives the background thread the time it would have in real time to finish the
+    // partition of the tail whose output is going to be needed next
+    static void waitForBackgroundThread (ConvolutionEngine& engine)
+    {
+        if (engine.tailSlotDue >= 0)
+            while (engine.tail->slots[engine.tailSlotDue].state.load() == ConvolutionEngine::TailJob::slotPosted)
+                Thread::yield();
+    }
+
+    void runEngineTest (Random& random, int impulseSize, int maximumBufferSize, int headSize,
+                        ConvolutionBackgroundThread* backgroundThread)
+    {
+        const int numSamples = 6000;
+
+        AudioBuffer<float> impulse (1, impulseSize), input (1, numSamples),
+                           output (1, numSamples), expected (1, numSamples);
+
+        fillRandom (random, impulse.getWritePointer (0), (size_t) impulseSize);
+        fillRandom (random, input.getWritePointer (0), (size_t) numSamples);
+
+        performReferenceConvolution (input.getReadPointer (0), impulse.getReadPointer (0),
+                                     expected.getWritePointer (0), numSamples, impulseSize);
+
+        ConvolutionEngine::ProcessingInformation info;
+        info.buffer = &impulse;
+        info.finalSize = impulseSize;
+        info.maximumBufferSize = (size_t) maximumBufferSize;
+        info.headSize = headSize;
+
+        ConvolutionEngine engine;
+        engine.setBackgroundThread (backgroundThread);
+        engine.initializeConvolutionEngine (info, 0);
+
+        // processes in place, with irregular block sizes
+        output.copyFrom (0, 0, input, 0, 0, numSamples);
+        auto* data = output.getWritePointer (0);
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            auto num = jmin (numSamples - pos, 1 + random.nextInt (maximumBufferSize));
+
+            if (backgroundThread != nullptr)
+                waitForBackgroundThread (engine);
+
+            engine.processSamples (data + pos, data + pos, (size_t) num);
+            pos += num;
+        }
+
+        expectEquals (engine.numDroppedTailPartitions, 0);
+
+        auto maxError = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            maxError = jmax (maxError, std::abs (data[i] - expected.getSample (0, i)));
+
+        expect (maxError < 1e-3f, "maximum error " + String (maxError));
+    }
+
+    // Several engines use the same background thread, and their blocks are interleaved
+    void runSharedThreadTest (Random& random, int numEngines, int impulseSize, int maximumBufferSize, int headSize)
+    {
+        const int numSamples = 6000;
+
+        ConvolutionBackgroundThread backgroundThread;
+        OwnedArray<ConvolutionEngine> engines;
+        OwnedArray<AudioBuffer<float>> impulses, outputs, expected;
+
+        for (int i = 0; i < numEngines; ++i)
+        {
+            auto* impulse = impulses.add (new AudioBuffer<float> (1, impulseSize));
+            auto* output = outputs.add (new AudioBuffer<float> (1, numSamples));
+            auto* reference = expected.add (new AudioBuffer<float> (1, numSamples));
+
+            fillRandom (random, impulse->getWritePointer (0), (size_t) impulseSize);
+            fillRandom (random, output->getWritePointer (0), (size_t) numSamples);
+
+            performReferenceConvolution (output->getReadPointer (0), impulse->getReadPointer (0),
+                                         reference->getWritePointer (0), numSamples, impulseSize);
+
+            ConvolutionEngine::ProcessingInformation info;
+            info.buffer = impulse;
+            info.finalSize = impulseSize;
+            info.maximumBufferSize = (size_t) maximumBufferSize;
+            info.headSize = headSize;
+
+            auto* engine = engines.add (new ConvolutionEngine());
+            engine->setBackgroundThread (&backgroundThread);
+            engine->initializeConvolutionEngine (info, 0);
+        }
+
+        for (int pos = 0; pos < numSamples;)
+        {
+            auto num = jmin (numSamples - pos, 1 + random.nextInt (maximumBufferSize));
+
+            for (int i = 0; i < numEngines; ++i)
+            {
+                auto* data = outputs[i]->getWritePointer (0, pos);
+                waitForBackgroundThread (*engines[i]);
+                engines[i]->processSamples (data, data, (size_t) num);
+            }
+
+            pos += num;
+        }
+
+        for (int i = 0; i < numEngines; ++i)
+        {
+            auto maxError = 0.0f;
+
+            for (int j = 0; j < numSamples; ++j)
+                maxError = jmax (maxError, std::abs (outputs[i]->getSample (0, j) - expected[i]->getSample (0, j)));
+
+            expect (maxError < 1e-3f, "maximum error " + String (maxError));
+        }
+
+        // the engines have to let go of their jobs before the thread is deleted
+        engines.clear();
+    }
+
+    void runConvolutionTest (Random& random, int impulseSize, int maximumBufferSize, int headSize)
+    {
+        AudioBuffer<float> impulse (1, impulseSize);
+        fillRandom (random, impulse.getWritePointer (0), (size_t) impulseSize);
+
+        Convolution convolution { Convolution::NonUniform { headSize } };
+        convolution.setNonRealtime (true);
+        convolution.prepare ({ 44100.0, (uint32) maximumBufferSize, 1 });
+        convolution.copyAndLoadImpulseResponseFromBuffer (impulse, 44100.0, false, false, false, (size_t) impulseSize);
+
+        auto processInBlocks = [&] (AudioBuffer<float>& buffer)
+        {
+            for (int pos = 0; pos < buffer.getNumSamples();)
+            {
+                auto num = jmin (buffer.getNumSamples() - pos, 1 + random.nextInt (maximumBufferSize));
+                AudioBlock<float> block (buffer.getArrayOfWritePointers(), 1, (size_t) pos, (size_t) num);
+                convolution.process (ProcessContextReplacing<float> (block));
+                pos += num;
+            }
+        };
+
+        // The impulse response is loaded on another thread and then faded in, so keep sending
+        // impulses until one comes back as the impulse response itself. This also checks that
+        // the output has no latency.
+        AudioBuffer<float> response (1, impulseSize * 2);
+        bool isLoaded = false;
+
+        for (int attempt = 0; attempt < 200 && ! isLoaded; ++attempt)
+        {
+            response.clear();
+            response.setSample (0, 0, 1.0f);
+            processInBlocks (response);
+
+            auto maxError = 0.0f;
+
+            for (int i = 0; i < response.getNumSamples(); ++i)
+                maxError = jmax (maxError, std::abs (response.getSample (0, i) - (i < impulseSize ? impulse.getSample (0, i) : 0.0f)));
+
+            isLoaded = maxError < 1e-3f;
+
+            if (! isLoaded)
+                Thread::sleep (10);
+        }
+
+        expect (isLoaded, "the impulse response was never loaded");
+
+        const int numSamples = 6000;
+        AudioBuffer<float> input (1, numSamples), expected (1, numSamples);
+        fillRandom (random, input.getWritePointer (0), (size_t) numSamples);
+
+        performReferenceConvolution (input.getReadPointer (0), impulse.getReadPointer (0),
+                                     expected.getWritePointer (0), numSamples, impulseSize);
+
+        processInBlocks (input);
+
+        auto maxError = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            maxError = jmax (maxError, std::abs (input.getSample (0, i) - expected.getSample (0, i)));
+
+        expect (maxError < 1e-3f, "maximum error " + String (maxError));
+    }
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Spectrum multiply-accumulate matches a scalar reference");
+
+        for (auto FFTSize : { 2, 4, 6, 18, 26, 64, 250, 1024 })
+            for (auto numPairs : { 1, 3, 8 })
+                for (auto misaligned : { false, true })
+                    runMultiplyAccumulateTest (random, (size_t) FFTSize, (size_t) numPairs, misaligned);
+
+        beginTest ("Uniform partitioning");
+        runEngineTest (random, 3000, 64, 0, nullptr);
+        runEngineTest (random, 3000, 512, 0, nullptr);
+        runEngineTest (random, 300, 2, 0, nullptr);
+
+        beginTest ("Non-uniform partitioning");
+        runEngineTest (random, 3000, 64, 256, nullptr);
+        runEngineTest (random, 5000, 100, 1024, nullptr);
+        runEngineTest (random, 200, 64, 256, nullptr);
+
+        beginTest ("Non-uniform partitioning with a background thread");
+        ConvolutionBackgroundThread backgroundThread;
+        runEngineTest (random, 3000, 64, 256, &backgroundThread);
+        runEngineTest (random, 5000, 100, 1024, &backgroundThread);
+
+        beginTest ("Non-uniform partitioning with a shared background thread");
+        runSharedThreadTest (random, 4, 3000, 64, 256);
+
+        beginTest ("The audio thread never waits for the tail");
+        {
+            const int impulseSize = 3000, numSamples = 4096;
+
+            AudioBuffer<float> impulse (1, impulseSize), buffer (1, numSamples);
+            fillRandom (random, impulse.getWritePointer (0), (size_t) impulseSize);
+
+            ConvolutionEngine::ProcessingInformation info;
+            info.buffer = &impulse;
+            info.finalSize = impulseSize;
+            info.maximumBufferSize = 64;
+            info.headSize = 256;
+
+            ConvolutionEngine engine;
+            engine.setBackgroundThread (&backgroundThread);
+            engine.initializeConvolutionEngine (info, 0);
+
+            // stands in for the background thread being in the middle of the job: if the
+            // engine waited for it, this would never return
+            expect (engine.tail->tryToClaim());
+
+            for (int pos = 0; pos < numSamples; pos += 64)
+                engine.processSamples (buffer.getReadPointer (0, pos), buffer.getWritePointer (0, pos), 64);
+
+            expect (engine.numDroppedTailPartitions > 0);
+            engine.tail->release();
+
+            // once it's free again, the tail starts again from silence
+            auto numDropped = engine.numDroppedTailPartitions;
+
+            for (int pos = 0; pos < numSamples; pos += 64)
+            {
+                waitForBackgroundThread (engine);
+                engine.processSamples (buffer.getReadPointer (0, pos), buffer.getWritePointer (0, pos), 64);
+            }
+
+            expectEquals (engine.numDroppedTailPartitions, numDropped);
+            expect (! engine.tailNeedsReset);
+        }
+
+        beginTest ("Convolution with non-uniform partitioning");
+        runConvolutionTest (random, 3000, 64, 256);
+        runConvolutionTest (random, 5000, 128, 1024);
+
+        beginTest ("Impulse responses are never prepared on the audio thread");
+        {
+            AudioBuffer<float> impulse (1, 1000), buffer (1, 64);
+            fillRandom (random, impulse.getWritePointer (0), 1000);
+
+            Convolution convolution;
+            convolution.prepare ({ 44100.0, 64, 1 });
+            convolution.copyAndLoadImpulseResponseFromBuffer (impulse, 44100.0, false, false, false, 1000);
+
+            // the first block can't wait for the background thread, so it's silent
+            buffer.setSample (0, 0, 1.0f);
+            AudioBlock<float> block (buffer);
+            convolution.process (ProcessContextReplacing<float> (block));
+
+            expectEquals (buffer.getMagnitude (0, 64), 0.0f);
+        }
+
+        beginTest ("Convolution objects share one background thread");
+        {
+            SharedResourcePointer<ConvolutionBackgroundThread> sharedThread;
+            expectEquals (sharedThread.getReferenceCount(), 1);
+
+            {
+                Convolution first  { Convolution::NonUniform { 256 } };
+                Convolution second { Convolution::NonUniform { 1024 } };
+                Convolution uniform;
+
+                expectEquals (sharedThread.getReferenceCount(), 3);
+            }
+
+            expectEquals (sharedThread.getReferenceCount(), 1);
+        }
+
+        beginTest ("Impulse response cache");
+        {
+            ConvolutionImpulseCache cache;
+            const MemoryBlock noData, data ("abcd", 4), otherData ("abce", 4);
+
+            ConvolutionImpulseCache::Entry::Ptr first (new ConvolutionImpulseCache::Entry());
+            first->key = "first";
+
+            expect (cache.find ("first", noData) == nullptr);
+            expect (cache.add (first) == first);
+            expect (cache.find ("first", noData) == first);
+
+            ConvolutionImpulseCache::Entry::Ptr duplicate (new ConvolutionImpulseCache::Entry());
+            duplicate->key = "first";
+            expect (cache.add (duplicate) == first);
+
+            // entries which are not used anymore are released
+            first = nullptr;
+
+            ConvolutionImpulseCache::Entry::Ptr second (new ConvolutionImpulseCache::Entry());
+            second->key = "second";
+            cache.add (second);
+
+            expect (cache.find ("first", noData) == nullptr);
+            expect (cache.find ("second", noData) == second);
+
+            // an entry with the same key but different source data, e.g. after a hash
+            // collision, must never be reused
+            ConvolutionImpulseCache::Entry::Ptr withData (new ConvolutionImpulseCache::Entry());
+            withData->key = "data";
+            withData->sourceData = data;
+            expect (cache.add (withData) == withData);
+            expect (cache.find ("data", data) == withData);
+            expect (cache.find ("data", otherData) == nullptr);
+            expect (cache.find ("data", noData) == nullptr);
+
+            ConvolutionImpulseCache::Entry::Ptr collision (new ConvolutionImpulseCache::Entry());
+            collision->key = "data";
+            collision->sourceData = otherData;
+            expect (cache.add (collision) == collision);
+            expect (cache.find ("data", otherData) == collision);
+            expect (cache.find ("data", data) == withData);
+        }
+    }
+};
+
+static ConvolutionEngineTest convolutionEngineTest;
+
+} // namespace dsp
+} // namespace juce
@@ -35,6 +35,18 @@ struct FFT::Instance
     virtual void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept = 0;
     virtual void performRealOnlyForwardTransform (float*, bool) const noexcept = 0;
     virtual void performRealOnlyInverseTransform (float*) const noexcept = 0;
+
+    virtual void performMultiChannelRealOnlyForwardTransform (float* const* channels, int numChannels, bool ignoreNegativeFreqs) const noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            performRealOnlyForwardTransform (channels[i], ignoreNegativeFreqs);
+    }
+
+    virtual void performMultiChannelRealOnlyInverseTransform (float* const* channels, int numChannels) const noexcept
+    {
+        for (int i = 0; i < numChannels; ++i)
+            performRealOnlyInverseTransform (channels[i]);
+    }
 };
 
 struct FFT::Engine
@@ -422,6 +434,417 @@ struct FFTFallback  : public FFT::Instance
 
 FFT::EngineImpl<FFTFallback> fftFallback;
 
+//==============================================================================
+//==============================================================================
+#if JUCE_USE_SIMD
+/** A radix-2 FFT working internally on split-complex data, so that all the
+    butterflies of the stages which are at least as wide as a SIMD register are
+    done with SIMDRegister. The real-only transforms are done with a complex FFT
+    of half the size. This is used when no FFT library is available.
+*/
+struct FFTSIMD  : public FFT::Instance
+{
+    // faster than the fallback, but slower than the vendor libraries
+    static constexpr int priority = 0;
+
+    static FFTSIMD* create (int order)
+    {
+        return new FFTSIMD (order);
+    }
+
+    FFTSIMD (int order)
+        : size (1 << order),
+          complexPlan (size),
+          realPlan (jmax (1, size / 2)),
+          realTwiddles ((size_t) (size / 2 + 1))
+    {
+        for (int k = 0; k <= size / 2; ++k)
+        {
+            auto angle = -2.0 * MathConstants<double>::pi * k / (double) size;
+            realTwiddles[k] = { (float) std::cos (angle), (float) std::sin (angle) };
+        }
+    }
+
+    void perform (const Complex<float>* input, Complex<float>* output, bool inverse) const noexcept override
+    {
+        if (size == 1)
+        {
+            *output = *input;
+            return;
+        }
+
+        withScratch (size, [&] (float* real, float* imag)
+        {
+            // the inverse transform is done by conjugating the input and the output
+            auto sign = inverse ? -1.0f : 1.0f;
+
+            for (int i = 0; i < size; ++i)
+            {
+                auto& c = input[complexPlan.bitReversed[i]];
+                real[i] = c.real();
+                imag[i] = sign * c.imag();
+            }
+
+            complexPlan.perform (real, imag);
+
+            auto scale = inverse ? 1.0f / (float) size : 1.0f;
+
+            for (int i = 0; i < size; ++i)
+                output[i] = { real[i] * scale, sign * imag[i] * scale };
+        });
+    }
+
+    void performRealOnlyForwardTransform (float* d, bool ignoreNegativeFreqs) const noexcept override
+    {
+        if (size == 1)
+            return;
+
+        auto half = size / 2;
+
+        withScratch (half, [&] (float* real, float* imag)
+        {
+            // the even and odd samples are transformed as the real and imaginary parts
+            for (int k = 0; k < half; ++k)
+            {
+                auto index = 2 * realPlan.bitReversed[k];
+                real[k] = d[index];
+                imag[k] = d[index + 1];
+            }
+
+            realPlan.perform (real, imag);
+            splitRealSpectrum (real, imag, 1, reinterpret_cast<Complex<float>*> (d), ignoreNegativeFreqs);
+        });
+    }
+
+    void performRealOnlyInverseTransform (float* d) const noexcept override
+    {
+        if (size == 1)
+            return;
+
+        auto half = size / 2;
+
+        withScratch (half, [&] (float* real, float* imag)
+        {
+            mergeRealSpectrum (reinterpret_cast<const Complex<float>*> (d), real, imag, 1);
+
+            realPlan.perform (real, imag);
+
+            auto scale = 1.0f / (float) half;
+
+            for (int k = 0; k < half; ++k)
+            {
+                d[2 * k]     = real[k] * scale;
+                d[2 * k + 1] = -imag[k] * scale;
+            }
+
+            FloatVectorOperations::clear (d + size, size);
+        });
+    }
+
+    void performMultiChannelRealOnlyForwardTransform (float* const* channels, int numChannels, bool ignoreNegativeFreqs) const noexcept override
+    {
+        if (size == 1)
+            return;
+
+        auto half = size / 2;
+        auto numLanes = (int) SIMDRegister<float>::size();
+        auto channel = 0;
+
+        // groups of channels are transformed together, one in each lane of the registers
+        for (; channel + numLanes <= numChannels; channel += numLanes)
+        {
+            auto* group = channels + channel;
+
+            withScratch (half * numLanes, [&] (float* real, float* imag)
+            {
+                for (int k = 0; k < half; ++k)
+                {
+                    auto index = 2 * realPlan.bitReversed[k];
+
+                    for (int lane = 0; lane < numLanes; ++lane)
+                    {
+                        real[k * numLanes + lane] = group[lane][index];
+                        imag[k * numLanes + lane] = group[lane][index + 1];
+                    }
+                }
+
+                realPlan.performLanes (real, imag);
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                    splitRealSpectrum (real + lane, imag + lane, numLanes,
+                                       reinterpret_cast<Complex<float>*> (group[lane]), ignoreNegativeFreqs);
+            });
+        }
+
+        for (; channel < numChannels; ++channel)
+            performRealOnlyForwardTransform (channels[channel], ignoreNegativeFreqs);
+    }
+
+    void performMultiChannelRealOnlyInverseTransform (float* const* channels, int numChannels) const noexcept override
+    {
+        if (size == 1)
+            return;
+
+        auto half = size / 2;
+        auto numLanes = (int) SIMDRegister<float>::size();
+        auto channel = 0;
+
+        for (; channel + numLanes <= numChannels; channel += numLanes)
+        {
+            auto* group = channels + channel;
+
+            withScratch (half * numLanes, [&] (float* real, float* imag)
+            {
+                for (int lane = 0; lane < numLanes; ++lane)
+                    mergeRealSpectrum (reinterpret_cast<const Complex<float>*> (group[lane]), real + lane, imag + lane, numLanes);
+
+                realPlan.performLanes (real, imag);
+
+                auto scale = 1.0f / (float) half;
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    auto* d = group[lane];
+
+                    for (int k = 0; k < half; ++k)
+                    {
+                        d[2 * k]     = real[k * numLanes + lane] * scale;
+                        d[2 * k + 1] = -imag[k * numLanes + lane] * scale;
+                    }
+
+                    FloatVectorOperations::clear (d + size, size);
+                }
+            });
+        }
+
+        for (; channel < numChannels; ++channel)
+            performRealOnlyInverseTransform (channels[channel]);
+    }
+
+private:
+    //==============================================================================
+    /** Turns the transform of the even and odd samples packed as a complex signal
+        into the spectrum of the real signal.
+    */
+    void splitRealSpectrum (const float* real, const float* imag, int stride,
+                            Complex<float>* out, bool ignoreNegativeFreqs) const noexcept
+    {
+        auto half = size / 2;
+
+        out[0]    = { real[0] + imag[0], 0.0f };
+        out[half] = { real[0] - imag[0], 0.0f };
+
+        for (int k = 1; k < half; ++k)
+        {
+            Complex<float> z (real[k * stride], imag[k * stride]);
+            Complex<float> zMirror (real[(half - k) * stride], -imag[(half - k) * stride]);
+
+            auto even = (z + zMirror) * 0.5f;
+            auto odd  = (z - zMirror) * Complex<float> (0.0f, -0.5f);
+
+            out[k] = even + realTwiddles[k] * odd;
+        }
+
+        if (! ignoreNegativeFreqs)
+            for (int k = half + 1; k < size; ++k)
+                out[k] = std::conj (out[size - k]);
+    }
+
+    /** Does the opposite of splitRealSpectrum, storing the result conjugated and
+        in bit-reversed order, ready for an inverse transform.
+    */
+    void mergeRealSpectrum (const Complex<float>* in, float* real, float* imag, int stride) const noexcept
+    {
+        auto half = size / 2;
+
+        for (int k = 0; k < half; ++k)
+        {
+            auto x = in[k];
+            auto xMirror = std::conj (in[half - k]);
+
+            auto even = (x + xMirror) * 0.5f;
+            auto odd  = (x - xMirror) * 0.5f * std::conj (realTwiddles[k]);
+            auto z = even + Complex<float> (0.0f, 1.0f) * odd;
+
+            auto index = realPlan.bitReversed[k] * stride;
+            real[index] = z.real();
+            imag[index] = -z.imag();
+        }
+    }
+
+    //==============================================================================
+    /** The bit reversal table and the twiddles of a complex FFT. */
+    struct Plan
+    {
+        Plan (int newSize)
+            : planSize (newSize), bitReversed ((size_t) newSize)
+        {
+            auto numBits = 0;
+
+            while ((1 << numBits) < planSize)
+                ++numBits;
+
+            for (int i = 0; i < planSize; ++i)
+            {
+                auto reversed = 0;
+
+                for (int bit = 0; bit < numBits; ++bit)
+                    if ((i & (1 << bit)) != 0)
+                        reversed |= 1 << (numBits - 1 - bit);
+
+                bitReversed[i] = reversed;
+            }
+
+            // the twiddles of the stage with butterflies of half-size h are stored from index h
+            twiddleStorage.calloc ((size_t) (2 * planSize) + alignmentPadding);
+            twiddlesReal = SIMDRegister<float>::getNextSIMDAlignedPtr (twiddleStorage.get());
+            twiddlesImag = twiddlesReal + planSize;
+
+            for (int h = 1; h < planSize; h <<= 1)
+            {
+                for (int j = 0; j < h; ++j)
+                {
+                    auto angle = -MathConstants<double>::pi * j / (double) h;
+                    twiddlesReal[h + j] = (float) std::cos (angle);
+                    twiddlesImag[h + j] = (float) std::sin (angle);
+                }
+            }
+        }
+
+        /** Performs an in-place forward transform of bit-reversed data. */
+        void perform (float* real, float* imag) const noexcept
+        {
+            using Register = SIMDRegister<float>;
+            const auto registerSize = (int) Register::size();
+
+            for (int h = 1; h < planSize; h <<= 1)
+            {
+                auto* wReal = twiddlesReal + h;
+                auto* wImag = twiddlesImag + h;
+
+                for (int start = 0; start < planSize; start += 2 * h)
+                {
+                    auto* aReal = real + start;
+                    auto* aImag = imag + start;
+                    auto* bReal = aReal + h;
+                    auto* bImag = aImag + h;
+
+                    if (h >= registerSize)
+                    {
+                        for (int j = 0; j < h; j += registerSize)
+                        {
+                            auto ar = Register::fromRawArray (aReal + j), ai = Register::fromRawArray (aImag + j);
+                            auto br = Register::fromRawArray (bReal + j), bi = Register::fromRawArray (bImag + j);
+                            auto wr = Register::fromRawArray (wReal + j), wi = Register::fromRawArray (wImag + j);
+
+                            auto tr = br * wr - bi * wi;
+                            auto ti = Register::multiplyAdd (br * wi, bi, wr);
+
+                            (ar + tr).copyToRawArray (aReal + j);
+                            (ai + ti).copyToRawArray (aImag + j);
+                            (ar - tr).copyToRawArray (bReal + j);
+                            (ai - ti).copyToRawArray (bImag + j);
+                        }
+                    }
+                    else
+                    {
+                        for (int j = 0; j < h; ++j)
+                        {
+                            auto tr = bReal[j] * wReal[j] - bImag[j] * wImag[j];
+                            auto ti = bReal[j] * wImag[j] + bImag[j] * wReal[j];
+
+                            bReal[j] = aReal[j] - tr;
+                            bImag[j] = aImag[j] - ti;
+                            aReal[j] += tr;
+                            aImag[j] += ti;
+                        }
+                    }
+                }
+            }
+        }
+
+        /** Performs in-place forward transforms of bit-reversed data, where each
+            group of consecutive floats holds the same bin of the transforms done
+            in the different lanes of a SIMD register.
+        */
+        void performLanes (float* real, float* imag) const noexcept
+        {
+            using Register = SIMDRegister<float>;
+            const auto numLanes = (int) Register::size();
+
+            for (int h = 1; h < planSize; h <<= 1)
+            {
+                for (int start = 0; start < planSize; start += 2 * h)
+                {
+                    for (int j = 0; j < h; ++j)
+                    {
+                        auto* aReal = real + (start + j) * numLanes;
+                        auto* aImag = imag + (start + j) * numLanes;
+                        auto* bReal = aReal + h * numLanes;
+                        auto* bImag = aImag + h * numLanes;
+
+                        auto ar = Register::fromRawArray (aReal), ai = Register::fromRawArray (aImag);
+                        auto br = Register::fromRawArray (bReal), bi = Register::fromRawArray (bImag);
+                        auto wr = Register::expand (twiddlesReal[h + j]), wi = Register::expand (twiddlesImag[h + j]);
+
+                        auto tr = br * wr - bi * wi;
+                        auto ti = Register::multiplyAdd (br * wi, bi, wr);
+
+                        (ar + tr).copyToRawArray (aReal);
+                        (ai + ti).copyToRawArray (aImag);
+                        (ar - tr).copyToRawArray (bReal);
+                        (ai - ti).copyToRawArray (bImag);
+                    }
+                }
+            }
+        }
+
+        int planSize;
+        HeapBlock<int> bitReversed;
+        HeapBlock<float> twiddleStorage;
+        float* twiddlesReal = nullptr;
+        float* twiddlesImag = nullptr;
+    };
+
+    //==============================================================================
+    /** Calls the function with two SIMD-aligned arrays of the given size, which are
+        on the stack unless they're too big.
+    */
+    template <typename FunctionType>
+    static void withScratch (int numElements, FunctionType&& function) noexcept
+    {
+        auto paddedSize = (size_t) numElements + alignmentPadding;
+        auto scratchSize = sizeof (float) * (2 * paddedSize + alignmentPadding);
+
+        auto run = [&] (float* scratch)
+        {
+            auto* real = SIMDRegister<float>::getNextSIMDAlignedPtr (scratch);
+            auto* imag = SIMDRegister<float>::getNextSIMDAlignedPtr (real + numElements);
+            function (real, imag);
+        };
+
+        if (scratchSize < maxFFTScratchSpaceToAlloca)
+        {
+            run (static_cast<float*> (alloca (scratchSize)));
+        }
+        else
+        {
+            HeapBlock<float> heapSpace (scratchSize / sizeof (float));
+            run (heapSpace.get());
+        }
+    }
+
+    static constexpr size_t alignmentPadding = 16;
+    static constexpr size_t maxFFTScratchSpaceToAlloca = 256 * 1024;
+
+    int size;
+    Plan complexPlan, realPlan;
+    HeapBlock<Complex<float>> realTwiddles;
+};
+
+FFT::EngineImpl<FFTSIMD> fftSIMD;
+#endif
+
 //==============================================================================
 //==============================================================================
 #if (JUCE_MAC || JUCE_IOS) && JUCE_USE_VDSP_FRAMEWORK
@@ -832,6 +1255,18 @@ void FFT::performRealOnlyInverseTransform (float* inputOutputData) const noexcep
         engine->performRealOnlyInverseTransform (inputOutputData);
 }
 
+void FFT::performRealOnlyForwardTransform (float* const* inputOutputData, int numChannels, bool ignoreNegativeFreqs) const noexcept
+{
+    if (engine != nullptr)
+        engine->performMultiChannelRealOnlyForwardTransform (inputOutputData, numChannels, ignoreNegativeFreqs);
+}
+
+void FFT::performRealOnlyInverseTransform (float* const* inputOutputData, int numChannels) const noexcept
+{
+    if (engine != nullptr)
+        engine->performMultiChannelRealOnlyInverseTransform (inputOutputData, numChannels);
+}
+
 void FFT::performFrequencyOnlyForwardTransform (float* inputOutputData) const noexcept
 {
     if (size == 1)
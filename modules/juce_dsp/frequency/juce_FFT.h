@@ -91,6 +91,24 @@ public:
     */
     void performRealOnlyInverseTransform (float* inputOutputData) const noexcept;
 
+    /** Performs in-place forward transforms on several blocks of real data, for
+        example the channels of a buffer or a sequence of frames.
+
+        Each of the arrays must follow the same rules as the one passed to
+        performRealOnlyForwardTransform(). Depending on the engine, the blocks may
+        be transformed together in the lanes of SIMD registers, which is faster
+        than transforming them one by one.
+    */
+    void performRealOnlyForwardTransform (float* const* inputOutputData, int numChannels,
+                                          bool dontCalculateNegativeFrequencies = false) const noexcept;
+
+    /** Performs the reverse operation of the multi-channel performRealOnlyForwardTransform().
+
+        Each of the arrays must follow the same rules as the one passed to
+        performRealOnlyInverseTransform().
+    */
+    void performRealOnlyInverseTransform (float* const* inputOutputData, int numChannels) const noexcept;
+
     /** Takes an array and simply transforms it to the magnitude frequency response
         spectrum. This may be handy for things like frequency displays or analysis.
         The size of the array passed in must be 2 * getSize().
@@ -132,6 +132,48 @@ struct FFTUnitTest  : public UnitTest
         }
     };
 
+    struct MultiChannelRealTest
+    {
+        static void run (FFTUnitTest& u)
+        {
+            Random random (378272);
+
+            for (size_t order = 0; order <= 8; ++order)
+            {
+                auto n = (1u << order);
+
+                FFT fft ((int) order);
+
+                for (int numChannels = 1; numChannels <= 11; numChannels += 5)
+                {
+                    AudioBuffer<float> input (numChannels, (int) n), multi (numChannels, (int) n * 2), single (numChannels, (int) n * 2);
+                    multi.clear();
+                    single.clear();
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                    {
+                        fillRandom (random, input.getWritePointer (channel), n);
+                        multi.copyFrom (channel, 0, input, channel, 0, (int) n);
+                        single.copyFrom (channel, 0, input, channel, 0, (int) n);
+
+                        fft.performRealOnlyForwardTransform (single.getWritePointer (channel));
+                    }
+
+                    fft.performRealOnlyForwardTransform (multi.getArrayOfWritePointers(), numChannels);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        u.expect (checkArrayIsSimilar (reinterpret_cast<const Complex<float>*> (multi.getReadPointer (channel)),
+                                                       reinterpret_cast<const Complex<float>*> (single.getReadPointer (channel)), n));
+
+                    fft.performRealOnlyInverseTransform (multi.getArrayOfWritePointers(), numChannels);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        u.expect (checkArrayIsSimilar (multi.getReadPointer (channel), input.getReadPointer (channel), n));
+                }
+            }
+        }
+    };
+
     struct FrequencyOnlyTest
     {
         static void run(FFTUnitTest& u)
@@ -202,6 +244,7 @@ struct FFTUnitTest  : public UnitTest
     void runTest() override
     {
         runTestForAllTypes<RealTest> ("Real input numbers Test");
+        runTestForAllTypes<MultiChannelRealTest> ("Multi-channel real input numbers Test");
         runTestForAllTypes<FrequencyOnlyTest> ("Frequency only Test");
         runTestForAllTypes<ComplexTest> ("Complex input numbers Test");
     }
@@ -88,6 +88,7 @@
 #include "containers/juce_SIMDRegister_test.cpp"
 #endif
 #include "frequency/juce_FFT_test.cpp"
+#include "frequency/juce_Convolution_test.cpp"
 #include "processors/juce_FIRFilter_test.cpp"
 #endif
 #endif